@@ -0,0 +1,215 @@
+#include "dataCache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "binarystream.h"
+#include "filesystem.h"
+
+namespace baseLib
+{
+	namespace
+	{
+		constexpr uint32_t g_chunkVersion = 1;
+	}
+
+	void DataCache::setStorageFolder(const std::string& _folder)
+	{
+		const auto folder = _folder.empty() ? std::string() : filesystem::validatePath(_folder);
+
+		if (!folder.empty())
+			filesystem::createDirectory(folder);
+
+		std::scoped_lock lock(m_mutex);
+		m_storageFolder = folder;
+	}
+
+	bool DataCache::get(Data& _data, const Key& _key)
+	{
+		std::string folder;
+
+		{
+			std::scoped_lock lock(m_mutex);
+
+			const auto it = m_index.find(_key);
+
+			if (it != m_index.end())
+			{
+				m_entries.splice(m_entries.begin(), m_entries, it->second);
+				_data = it->second->second;
+				return true;
+			}
+
+			folder = m_storageFolder;
+		}
+
+		if (folder.empty() || !loadFromDisk(_data, _key, folder))
+			return false;
+
+		std::scoped_lock lock(m_mutex);
+		insert(_key, _data);
+		return true;
+	}
+
+	void DataCache::add(const Key& _key, const Data& _data)
+	{
+		std::string folder;
+
+		{
+			std::scoped_lock lock(m_mutex);
+			insert(_key, _data);
+			folder = m_storageFolder;
+		}
+
+		if (folder.empty())
+			return;
+
+		saveToDisk(_key, _data, folder);
+		trimStorage(folder, _key.toString() + m_fileExtension);
+	}
+
+	void DataCache::remove(const Key& _key)
+	{
+		std::string folder;
+
+		{
+			std::scoped_lock lock(m_mutex);
+
+			const auto it = m_index.find(_key);
+
+			if (it != m_index.end())
+			{
+				m_entries.erase(it->second);
+				m_index.erase(it);
+			}
+
+			folder = m_storageFolder;
+		}
+
+		if (!folder.empty() && filesystem::exists(getFilename(_key, folder)))
+			filesystem::remove(getFilename(_key, folder));
+	}
+
+	bool DataCache::loadFromDisk(Data& _data, const Key& _key, const std::string& _folder) const
+	{
+		const auto filename = getFilename(_key, _folder);
+
+		if (!filesystem::exists(filename))
+			return false;
+
+		std::vector<uint8_t> fileData;
+
+		if (!filesystem::readFile(fileData, filename))
+			return false;
+
+		try
+		{
+			BinaryStream inStream(fileData);
+
+			auto s = inStream.tryReadChunk(m_chunkId, g_chunkVersion);
+
+			if (!s)
+				return false;
+
+			const auto key = s.readString();
+			const auto dataHash = s.readString();
+
+			Data data;
+			s.read(data);
+
+			// reject anything that is truncated or has been written partially
+			if (key != _key.toString() || data.empty() || dataHash != MD5(data).toString())
+				return false;
+
+			_data.swap(data);
+			return true;
+		}
+		catch (std::range_error&)
+		{
+			return false;
+		}
+	}
+
+	void DataCache::saveToDisk(const Key& _key, const Data& _data, const std::string& _folder) const
+	{
+		BinaryStream s;
+
+		{
+			ChunkWriter cw(s, m_chunkId, g_chunkVersion);
+
+			s.write(_key.toString());
+			s.write(MD5(_data).toString());
+			s.write(_data);
+		}
+
+		std::vector<uint8_t> fileData;
+		s.toVector(fileData);
+
+		filesystem::writeFile(getFilename(_key, _folder), fileData);
+	}
+
+	void DataCache::trimStorage(const std::string& _folder, const std::string& _keep) const
+	{
+		if (!m_maxStorageSize)
+			return;
+
+		std::vector<std::string> files;
+		filesystem::getDirectoryEntries(files, _folder);
+
+		std::vector<std::pair<std::string, filesystem::FileInfo>> entries;
+		uint64_t totalSize = 0;
+
+		for (auto& file : files)
+		{
+			filesystem::FileInfo info;
+
+			if (!filesystem::hasExtension(file, m_fileExtension) || !filesystem::getFileInfo(info, file))
+				continue;
+
+			totalSize += info.size;
+
+			if (filesystem::getFilenameWithoutPath(file) != _keep)
+				entries.emplace_back(std::move(file), info);
+		}
+
+		if (totalSize <= m_maxStorageSize)
+			return;
+
+		// oldest first, the file that has just been written is kept
+		std::sort(entries.begin(), entries.end(), [](const auto& _a, const auto& _b)
+		{
+			return _a.second.modificationTime < _b.second.modificationTime;
+		});
+
+		for (size_t i = 0; i < entries.size() && totalSize > m_maxStorageSize; ++i)
+		{
+			if (filesystem::remove(entries[i].first))
+				totalSize -= entries[i].second.size;
+		}
+	}
+
+	std::string DataCache::getFilename(const Key& _key, const std::string& _folder) const
+	{
+		return _folder + _key.toString() + m_fileExtension;
+	}
+
+	void DataCache::insert(const Key& _key, const Data& _data)
+	{
+		const auto it = m_index.find(_key);
+
+		if (it != m_index.end())
+		{
+			m_entries.splice(m_entries.begin(), m_entries, it->second);
+			return;
+		}
+
+		m_entries.emplace_front(_key, _data);
+		m_index.insert({_key, m_entries.begin()});
+
+		while (m_entries.size() > m_maxEntries)
+		{
+			m_index.erase(m_entries.back().first);
+			m_entries.pop_back();
+		}
+	}
+}
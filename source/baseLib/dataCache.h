@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "md5.h"
+
+namespace baseLib
+{
+	// Memory cache for binary data that is expensive to create, keyed by a hash of everything its creation depends on.
+	// Optionally backed by a folder on disk, entries are then shared between processes and survive restarts.
+	// Least recently used entries are dropped from memory, the oldest files are deleted once the folder grows too large
+	class DataCache
+	{
+	public:
+		using Key = MD5;
+		using Data = std::vector<uint8_t>;
+
+		template<size_t N, std::enable_if_t<N == 5, void*> = nullptr>
+		DataCache(char const(&_4Cc)[N], std::string _fileExtension, const size_t _maxEntries, const uint64_t _maxStorageSize)
+		: m_chunkId{_4Cc[0], _4Cc[1], _4Cc[2], _4Cc[3], 0}
+		, m_fileExtension(std::move(_fileExtension))
+		, m_maxEntries(_maxEntries)
+		, m_maxStorageSize(_maxStorageSize)
+		{
+		}
+
+		// enables the on-disk store. Entries are loaded from / written to this folder in addition to the memory cache
+		void setStorageFolder(const std::string& _folder);
+
+		bool get(Data& _data, const Key& _key);
+		void add(const Key& _key, const Data& _data);
+
+		// drops an entry, from memory and from disk
+		void remove(const Key& _key);
+
+	private:
+		bool loadFromDisk(Data& _data, const Key& _key, const std::string& _folder) const;
+		void saveToDisk(const Key& _key, const Data& _data, const std::string& _folder) const;
+		void trimStorage(const std::string& _folder, const std::string& _keep) const;
+		std::string getFilename(const Key& _key, const std::string& _folder) const;
+
+		void insert(const Key& _key, const Data& _data);
+
+		const char m_chunkId[5];
+		const std::string m_fileExtension;
+		const size_t m_maxEntries;
+		const uint64_t m_maxStorageSize;
+
+		std::mutex m_mutex;
+
+		// most recently used first
+		std::list<std::pair<Key, Data>> m_entries;
+		std::map<Key, std::list<std::pair<Key, Data>>::iterator> m_index;
+
+		std::string m_storageFolder;
+	};
+}
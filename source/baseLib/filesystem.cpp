@@ -26,6 +26,8 @@
 #define NOSERVICE
 #include <Windows.h>
 #include <shlobj_core.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #else
 #include <dlfcn.h>
 #endif
@@ -174,7 +176,11 @@ namespace baseLib::filesystem
                 continue;
             }
 
-            const auto size = getFileSize(file);
+            FileInfo info;
+            if (!getFileInfo(info, file))
+                continue;
+
+            const auto size = info.size;
 
             if (_minSize && size < _minSize)
 	            continue;
@@ -247,6 +253,22 @@ namespace baseLib::filesystem
         return size;
     }
 
+    bool getFileInfo(FileInfo& _info, const std::string& _file)
+    {
+#ifdef _WIN32
+		struct _stat64 statbuf;
+		if (_wstat64(utf8ToWide(_file).c_str(), &statbuf) != 0)
+			return false;
+#else
+		struct stat statbuf;
+		if (stat(_file.c_str(), &statbuf) != 0)
+			return false;
+#endif
+		_info.size = static_cast<uint64_t>(statbuf.st_size);
+		_info.modificationTime = static_cast<int64_t>(statbuf.st_mtime);
+		return true;
+    }
+
     bool isDirectory(const std::string& _path)
     {
 #ifdef USE_DIRENT
@@ -29,6 +29,18 @@ namespace baseLib
 		bool hasExtension(const std::string& _filename, const std::string& _extension);
 		size_t getFileSize(const std::string& _file);
 
+		struct FileInfo
+		{
+			uint64_t size = 0;
+			int64_t modificationTime = 0;	// seconds since epoch
+
+			bool operator == (const FileInfo& _other) const { return size == _other.size && modificationTime == _other.modificationTime; }
+			bool operator != (const FileInfo& _other) const { return !(*this == _other); }
+		};
+
+		// stat only, the file is not opened
+		bool getFileInfo(FileInfo& _info, const std::string& _file);
+
 		bool isDirectory(const std::string& _path);
 
 		bool writeFile(const std::string& _filename, const uint8_t* _data, size_t _size);
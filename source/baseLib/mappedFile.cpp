@@ -0,0 +1,137 @@
+#include "mappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define NOSERVICE
+#include <Windows.h>
+#include "filesystem.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace baseLib
+{
+	MappedFile::MappedFile(const std::string& _filename)
+	{
+		open(_filename);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& _other) noexcept
+	{
+		swap(_other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& _other) noexcept
+	{
+		if (this != &_other)
+		{
+			close();
+			swap(_other);
+		}
+		return *this;
+	}
+
+	bool MappedFile::open(const std::string& _filename)
+	{
+		close();
+
+#ifdef _WIN32
+		const auto nameW = filesystem::utf8ToWide(_filename);
+
+		// allow others to append to the file while it is mapped, the mapped range stays valid
+		auto* file = CreateFileW(nameW.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		auto* mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const auto* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_file = file;
+		m_mapping = mapping;
+		m_data = static_cast<const uint8_t*>(data);
+		m_size = static_cast<size_t>(size.QuadPart);
+#else
+		const int fd = ::open(_filename.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+
+		struct stat statbuf;
+		if (fstat(fd, &statbuf) != 0 || statbuf.st_size <= 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		const auto size = static_cast<size_t>(statbuf.st_size);
+
+		void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		// the mapping stays valid after the descriptor is closed
+		::close(fd);
+
+		if (data == MAP_FAILED)
+			return false;
+
+		m_data = static_cast<const uint8_t*>(data);
+		m_size = size;
+#endif
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (!m_data)
+			return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_mapping);
+		CloseHandle(m_file);
+		m_mapping = nullptr;
+		m_file = nullptr;
+#else
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	void MappedFile::swap(MappedFile& _other) noexcept
+	{
+		std::swap(m_data, _other.m_data);
+		std::swap(m_size, _other.m_size);
+#ifdef _WIN32
+		std::swap(m_file, _other.m_file);
+		std::swap(m_mapping, _other.m_mapping);
+#endif
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace baseLib
+{
+	// Read-only memory mapping of a whole file. Pages are loaded by the OS on first access and are shared with every
+	// other mapping of the same file
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::string& _filename);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator = (const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& _other) noexcept;
+		MappedFile& operator = (MappedFile&& _other) noexcept;
+
+		bool open(const std::string& _filename);
+		void close();
+
+		bool isValid() const { return m_data != nullptr; }
+
+		const uint8_t* data() const { return m_data; }
+		size_t size() const { return m_size; }
+
+		const uint8_t* begin() const { return m_data; }
+		const uint8_t* end() const { return m_data + m_size; }
+
+	private:
+		void swap(MappedFile& _other) noexcept;
+
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif
+	};
+}
@@ -1,5 +1,7 @@
 #include "audioBuffers.h"
 
+#include <algorithm>
+
 namespace bridgeLib
 {
 	AudioBuffers::AudioBuffers() = default;
@@ -67,4 +69,199 @@ namespace bridgeLib
 			--m_inputSize;
 		}
 	}
+
+	uint32_t AudioBuffers::registerBlock(const uint32_t _numSamples)
+	{
+		// if too many blocks are in flight, give up on the oldest one
+		if(m_sendSequence - m_nextSequence >= MaxBlocksInFlight)
+			concealMissingBlocks(m_outputSize + 1);
+
+		const auto sequence = m_sendSequence++;
+		m_blockSizes[sequence % MaxBlocksInFlight] = _numSamples;
+		return sequence;
+	}
+
+	bool AudioBuffers::writeOutputBlock(const uint32_t _sequence, const OutputBlock& _data, const uint32_t _numChannels, const uint32_t _numSamples)
+	{
+		// unsigned math to handle wrap around, blocks that have been concealed already or are unknown are dropped
+		const auto ahead = _sequence - m_nextSequence;
+
+		if(ahead >= m_sendSequence - m_nextSequence)
+			return false;
+
+		if(_numSamples != m_blockSizes[_sequence % MaxBlocksInFlight])
+			return false;
+
+		if(ahead == 0)
+		{
+			writeOutputBlock(_data, _numChannels, _numSamples);
+			++m_nextSequence;
+			writePendingBlocks();
+			return true;
+		}
+
+		if(ahead >= MaxPendingBlocks)
+			return false;
+
+		auto& block = m_pendingBlocks[_sequence % MaxPendingBlocks];
+
+		block.valid = true;
+		block.sequence = _sequence;
+		block.numChannels = _numChannels;
+		block.numSamples = _numSamples;
+
+		for(uint32_t c=0; c<_numChannels; ++c)
+			block.data[c].assign(_data[c].begin(), _data[c].begin() + _numSamples);
+
+		return true;
+	}
+
+	uint32_t AudioBuffers::concealMissingBlocks(const uint32_t _requiredSize)
+	{
+		uint32_t count = 0;
+
+		while(m_outputSize < _requiredSize && m_nextSequence != m_sendSequence)
+		{
+			const auto numSamples = m_blockSizes[m_nextSequence % MaxBlocksInFlight];
+
+			// repeat the history while fading it out. Each repetition starts with a crossfade from the newest sample
+			// of the history to its oldest one to prevent clicks
+			for(uint32_t c=0; c<m_outputChannels; ++c)
+			{
+				const auto& history = m_history[c];
+				const auto newest = history[(m_historyPos + ConcealHistoryLength - 1) % ConcealHistoryLength];
+
+				for(uint32_t i=0; i<numSamples; ++i)
+				{
+					const auto n = m_concealedSamples + i;
+
+					if(n >= ConcealDecayLength)
+					{
+						m_outputBuffers[c].push_back(0.0f);
+						continue;
+					}
+
+					const auto pos = n % ConcealHistoryLength;
+
+					auto out = history[(m_historyPos + pos) % ConcealHistoryLength];
+
+					if(pos < ConcealFadeLength)
+					{
+						const auto fade = static_cast<float>(pos + 1) / static_cast<float>(ConcealFadeLength);
+						out = newest + (out - newest) * fade;
+					}
+
+					out *= static_cast<float>(ConcealDecayLength - n) / static_cast<float>(ConcealDecayLength);
+
+					m_outputBuffers[c].push_back(out);
+					m_lastOutput[c] = out;
+				}
+
+				if(m_concealedSamples + numSamples >= ConcealDecayLength)
+					m_lastOutput[c] = 0.0f;
+			}
+
+			m_concealedSamples += numSamples;
+			m_outputSize += numSamples;
+
+			auto& pending = m_pendingBlocks[m_nextSequence % MaxPendingBlocks];
+			if(pending.valid && pending.sequence == m_nextSequence)
+				pending.valid = false;
+
+			++m_nextSequence;
+			++count;
+
+			m_fadeIn = true;
+
+			writePendingBlocks();
+		}
+
+		return count;
+	}
+
+	void AudioBuffers::resetSequence()
+	{
+		m_nextSequence = m_sendSequence;
+
+		for (auto& block : m_pendingBlocks)
+			block.valid = false;
+	}
+
+	void AudioBuffers::updateJitterLatency(const bool _concealed, const uint32_t _blockSize, const float _samplerate)
+	{
+		if(_concealed)
+		{
+			m_jitterLatency = std::min(m_jitterLatency + _blockSize, BufferSize / 4);
+			m_samplesWithoutConceal = 0;
+			return;
+		}
+
+		// try to reduce the latency again if nothing had to be concealed for ten seconds
+		m_samplesWithoutConceal += _blockSize;
+
+		if(m_samplesWithoutConceal < static_cast<uint32_t>(_samplerate * 10.0f))
+			return;
+
+		m_samplesWithoutConceal = 0;
+		m_jitterLatency -= std::min(m_jitterLatency, std::max(_blockSize >> 2, 1u));
+	}
+
+	void AudioBuffers::writeOutputBlock(const OutputBlock& _data, const uint32_t _numChannels, const uint32_t _numSamples)
+	{
+		for(uint32_t c=0; c<_numChannels; ++c)
+		{
+			const auto& data = _data[c];
+			auto& out = m_outputBuffers[c];
+
+			if(m_fadeIn)
+			{
+				// crossfade from the concealed output
+				const auto last = m_lastOutput[c];
+
+				for(uint32_t i=0; i<_numSamples; ++i)
+				{
+					const auto gain = i < ConcealFadeLength ? static_cast<float>(i + 1) / static_cast<float>(ConcealFadeLength) : 1.0f;
+					out.push_back(last + (data[i] - last) * gain);
+				}
+			}
+			else
+			{
+				for(uint32_t i=0; i<_numSamples; ++i)
+					out.push_back(data[i]);
+			}
+
+			if(_numSamples)
+				m_lastOutput[c] = data[_numSamples - 1];
+
+			// keep the most recent samples to be able to conceal blocks that get lost
+			auto& history = m_history[c];
+			const auto numHistory = std::min(_numSamples, ConcealHistoryLength);
+
+			for(uint32_t i=_numSamples - numHistory, p = m_historyPos; i<_numSamples; ++i, p = (p + 1) % ConcealHistoryLength)
+				history[p] = data[i];
+		}
+
+		m_historyPos = (m_historyPos + std::min(_numSamples, ConcealHistoryLength)) % ConcealHistoryLength;
+
+		m_outputChannels = _numChannels;
+		m_outputSize += _numSamples;
+		m_concealedSamples = 0;
+		m_fadeIn = false;
+	}
+
+	void AudioBuffers::writePendingBlocks()
+	{
+		while(m_nextSequence != m_sendSequence)
+		{
+			auto& block = m_pendingBlocks[m_nextSequence % MaxPendingBlocks];
+
+			if(!block.valid || block.sequence != m_nextSequence)
+				return;
+
+			writeOutputBlock(block.data, block.numChannels, block.numSamples);
+			block.valid = false;
+
+			++m_nextSequence;
+		}
+	}
 }
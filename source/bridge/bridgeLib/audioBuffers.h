@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "baseLib/binarystream.h"
 #include "dsp56kBase/ringbuffer.h"
 
@@ -12,9 +14,22 @@ namespace bridgeLib
 	public:
 		static constexpr uint32_t BufferSize = 16384;
 
+		// sequenced output: number of blocks that may be in flight and the number of blocks that can arrive ahead of the next expected one
+		static constexpr uint32_t MaxBlocksInFlight = 1024;
+		static constexpr uint32_t MaxPendingBlocks = 32;
+
+		// length of the crossfades applied around concealed blocks, in samples
+		static constexpr uint32_t ConcealFadeLength = 64;
+
+		// concealed blocks repeat the most recent output and fade out over the decay length, then turn to silence
+		static constexpr uint32_t ConcealHistoryLength = 1024;
+		static constexpr uint32_t ConcealDecayLength = 4096;
+
 		using RingBufferIn = dsp56k::RingBuffer<float, BufferSize, false, true>;
 		using RingBufferOut = dsp56k::RingBuffer<float, BufferSize, false, true>;
 
+		using OutputBlock = std::array<std::vector<float>, std::tuple_size_v<synthLib::TAudioOutputs>>;
+
 		AudioBuffers();
 
 		uint32_t getInputSize() const { return m_inputSize; }
@@ -39,12 +54,56 @@ namespace bridgeLib
 		void writeOutput(uint32_t _channel, const std::vector<float>& _data, uint32_t _numSamples);
 		void setLatency(uint32_t _newLatency, uint32_t _numSamplesToKeep);
 
+		// Sequenced output for transports that deliver blocks late, out of order or not at all. Each block sent
+		// is registered to get a sequence number, its reply is written with the same sequence number
+		uint32_t registerBlock(uint32_t _numSamples);
+		bool writeOutputBlock(uint32_t _sequence, const OutputBlock& _data, uint32_t _numChannels, uint32_t _numSamples);
+
+		// number of output channels to conceal if no block has been received yet
+		void setOutputChannelCount(const uint32_t _count) { m_outputChannels = std::min(_count, static_cast<uint32_t>(m_outputBuffers.size())); }
+
+		// replaces blocks that did not arrive in time until the output has at least _requiredSize samples. Blocks that arrive afterwards are dropped
+		uint32_t concealMissingBlocks(uint32_t _requiredSize);
+
+		// forgets about all blocks in flight, replies to them are dropped
+		void resetSequence();
+
+		// extra latency that is added for a lossy transport. It grows whenever blocks had to be concealed and shrinks slowly while the transport is stable
+		uint32_t getJitterLatency() const { return m_jitterLatency; }
+		void updateJitterLatency(bool _concealed, uint32_t _blockSize, float _samplerate);
+
 	private:
+		struct PendingBlock
+		{
+			bool valid = false;
+			uint32_t sequence = 0;
+			uint32_t numChannels = 0;
+			uint32_t numSamples = 0;
+			OutputBlock data;
+		};
+
+		void writeOutputBlock(const OutputBlock& _data, uint32_t _numChannels, uint32_t _numSamples);
+		void writePendingBlocks();
+
 		std::array<RingBufferIn, std::tuple_size_v<synthLib::TAudioInputs>> m_inputBuffers;
 		std::array<RingBufferOut, std::tuple_size_v<synthLib::TAudioOutputs>> m_outputBuffers;
 
 		uint32_t m_inputSize = 0;
 		uint32_t m_outputSize = 0;
 		uint32_t m_latency = 0;
+
+		uint32_t m_nextSequence = 0;
+		uint32_t m_sendSequence = 0;
+		std::array<uint32_t, MaxBlocksInFlight> m_blockSizes{};
+		std::array<PendingBlock, MaxPendingBlocks> m_pendingBlocks;
+		std::array<float, std::tuple_size_v<synthLib::TAudioOutputs>> m_lastOutput{};
+		std::array<std::array<float, ConcealHistoryLength>, std::tuple_size_v<synthLib::TAudioOutputs>> m_history{};
+		uint32_t m_historyPos = 0;			// oldest sample of the history
+		uint32_t m_concealedSamples = 0;	// samples concealed since the last block that arrived
+		uint32_t m_outputChannels = 0;
+		bool m_fadeIn = false;
+
+		uint32_t m_jitterLatency = 0;
+		uint32_t m_samplesWithoutConceal = 0;
 	};
 }
@@ -0,0 +1,142 @@
+#include "audioCodec.h"
+
+#include <algorithm>
+
+#include "baseLib/binarystream.h"
+
+#include "networkLib/exception.h"
+
+namespace bridgeLib
+{
+	namespace
+	{
+		constexpr float g_int24Scale = 8388608.0f;
+		constexpr float g_int24ScaleInv = 1.0f / g_int24Scale;
+
+		bool toInt24(int32_t& _dst, const float _value)
+		{
+			const auto scaled = _value * g_int24Scale;
+
+			// written like this to reject NaNs, too
+			if(!(scaled >= -g_int24Scale && scaled < g_int24Scale))
+				return false;
+
+			_dst = static_cast<int32_t>(scaled);
+			return static_cast<float>(_dst) == scaled;
+		}
+	}
+
+	AudioCodec::AudioCodec()
+	{
+		m_packBuffer.reserve(16384 * 3);
+		m_unpackBuffer.reserve(16384 * 3);
+	}
+
+	void AudioCodec::writeChannel(baseLib::BinaryStream& _out, const float* _data, const uint32_t _numSamples)
+	{
+		// if a channel has no data, write 0 for the length
+		if(!_data || !_numSamples)
+		{
+			_out.write<uint32_t>(0);
+			return;
+		}
+
+		_out.write(_numSamples);
+
+		const auto format = selectFormat(_data, _numSamples);
+
+		_out.write(format);
+
+		switch (format)
+		{
+		case AudioFormat::Float32:
+			_out.write(_data, _numSamples);
+			break;
+		case AudioFormat::Int24:
+			{
+				if(m_packBuffer.size() < _numSamples * 3)
+					m_packBuffer.resize(_numSamples * 3);
+
+				auto* dst = m_packBuffer.data();
+
+				for(uint32_t i=0; i<_numSamples; ++i)
+				{
+					int32_t v;
+					toInt24(v, _data[i]);
+					*dst++ = static_cast<uint8_t>(v);
+					*dst++ = static_cast<uint8_t>(v >> 8);
+					*dst++ = static_cast<uint8_t>(v >> 16);
+				}
+
+				_out.write(m_packBuffer.data(), _numSamples * 3);
+			}
+			break;
+		case AudioFormat::Silence:
+			break;
+		}
+	}
+
+	uint32_t AudioCodec::readChannel(baseLib::BinaryStream& _in, float* _data, const uint32_t _maxSamples)
+	{
+		const auto numSamples = _in.read<uint32_t>();
+
+		if(!numSamples)
+			return 0;
+
+		if(numSamples > _maxSamples || !_data)
+			throw networkLib::NetException(networkLib::ConnectionLost, "Received audio block exceeds buffer size");
+
+		const auto format = _in.read<AudioFormat>();
+
+		switch (format)
+		{
+		case AudioFormat::Float32:
+			_in.read(_data, numSamples);
+			break;
+		case AudioFormat::Int24:
+			{
+				if(m_unpackBuffer.size() < numSamples * 3)
+					m_unpackBuffer.resize(numSamples * 3);
+
+				_in.read(m_unpackBuffer.data(), numSamples * 3);
+
+				const auto* src = m_unpackBuffer.data();
+
+				for(uint32_t i=0; i<numSamples; ++i, src += 3)
+				{
+					// shift into the upper 24 bits and back down to sign-extend
+					const auto v = static_cast<int32_t>(static_cast<uint32_t>(src[0]) << 8 | static_cast<uint32_t>(src[1]) << 16 | static_cast<uint32_t>(src[2]) << 24) >> 8;
+					_data[i] = static_cast<float>(v) * g_int24ScaleInv;
+				}
+			}
+			break;
+		case AudioFormat::Silence:
+			std::fill_n(_data, numSamples, 0.0f);
+			break;
+		default:
+			throw networkLib::NetException(networkLib::ConnectionLost, "Received audio block has unknown format");
+		}
+		return numSamples;
+	}
+
+	AudioFormat AudioCodec::selectFormat(const float* _data, const uint32_t _numSamples) const
+	{
+		const uint32_t formats = m_remoteFormats;
+
+		if(formats & audioFormatFlag(AudioFormat::Silence))
+		{
+			if(std::all_of(_data, _data + _numSamples, [](const float _v) { return _v == 0.0f; }))
+				return AudioFormat::Silence;
+		}
+
+		// DSP outputs are 24 bit, but inputs coming from the host or devices applying gain might not be
+		if(formats & audioFormatFlag(AudioFormat::Int24))
+		{
+			int32_t v;
+			if(std::all_of(_data, _data + _numSamples, [&v](const float _v) { return toInt24(v, _v); }))
+				return AudioFormat::Int24;
+		}
+
+		return AudioFormat::Float32;
+	}
+}
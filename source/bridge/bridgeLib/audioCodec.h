@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "types.h"
+
+namespace baseLib
+{
+	class BinaryStream;
+}
+
+namespace bridgeLib
+{
+	// Encodes / decodes the channels of an Audio command. Each channel is sent in the smallest format that the receiver
+	// supports and that represents the data without loss
+	class AudioCodec
+	{
+	public:
+		AudioCodec();
+
+		// formats that the remote side is able to decode, as advertised via PluginDesc / ServerInfo
+		void setRemoteFormats(const uint32_t _formats) { m_remoteFormats = _formats; }
+		uint32_t getRemoteFormats() const { return m_remoteFormats; }
+
+		void writeChannel(baseLib::BinaryStream& _out, const float* _data, uint32_t _numSamples);
+
+		// returns the number of samples written to _data, zero if the channel has no data
+		uint32_t readChannel(baseLib::BinaryStream& _in, float* _data, uint32_t _maxSamples);
+
+		AudioFormat selectFormat(const float* _data, uint32_t _numSamples) const;
+
+	private:
+		// the remote side may not know anything but floats until it told us otherwise
+		std::atomic<uint32_t> m_remoteFormats{audioFormatFlag(AudioFormat::Float32)};
+
+		// writing and reading happens on different threads
+		std::vector<uint8_t> m_packBuffer;
+		std::vector<uint8_t> m_unpackBuffer;
+	};
+}
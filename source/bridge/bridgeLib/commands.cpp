@@ -42,6 +42,8 @@ namespace bridgeLib
 		_s.write(protocolVersion);
 		_s.write(portUdp);
 		_s.write(portTcp);
+		_s.write(audioFormats);
+		_s.write(portUdpAudio);
 		return _s;
 	}
 
@@ -50,6 +52,8 @@ namespace bridgeLib
 		_s.read(protocolVersion);
 		_s.read(portUdp);
 		_s.read(portTcp);
+		_s.read(audioFormats);
+		_s.read(portUdpAudio);
 		return _s;
 	}
 
@@ -60,6 +64,7 @@ namespace bridgeLib
 		_s.write(pluginVersion);
 		_s.write(plugin4CC);
 		_s.write(sessionId);
+		_s.write(audioFormats);
 		return _s;
 	}
 
@@ -70,6 +75,7 @@ namespace bridgeLib
 		_s.read(pluginVersion);
 		plugin4CC = _s.readString();
 		_s.read(sessionId);
+		_s.read(audioFormats);
 		return _s;
 	}
 
@@ -126,12 +132,14 @@ namespace bridgeLib
 	baseLib::BinaryStream& RequestDeviceState::write(baseLib::BinaryStream& _s) const
 	{
 		_s.write(static_cast<uint32_t>(type));
+		_s.write(static_cast<uint8_t>(fullState ? 1 : 0));
 		return _s;
 	}
 
 	baseLib::BinaryStream& RequestDeviceState::read(baseLib::BinaryStream& _s)
 	{
 		type = static_cast<synthLib::StateType>(_s.read<uint32_t>());
+		fullState = _s.read<uint8_t>() != 0;
 		return _s;
 	}
 
@@ -139,6 +147,7 @@ namespace bridgeLib
 	{
 		_s.write(static_cast<uint32_t>(type));
 		_s.write(state);
+		_s.write(version);
 		return _s;
 	}
 
@@ -146,6 +155,43 @@ namespace bridgeLib
 	{
 		type = static_cast<synthLib::StateType>(_s.read<uint32_t>());
 		_s.read(state);
+		_s.read(version);
+		return _s;
+	}
+
+	baseLib::BinaryStream& DeviceStateDelta::write(baseLib::BinaryStream& _s) const
+	{
+		_s.write(static_cast<uint32_t>(type));
+		_s.write(baseVersion);
+		_s.write(version);
+		_s.write(size);
+		_s.write(blockSize);
+		_s.write(blockIndices);
+		_s.write(blockData);
+		return _s;
+	}
+
+	baseLib::BinaryStream& DeviceStateDelta::read(baseLib::BinaryStream& _s)
+	{
+		type = static_cast<synthLib::StateType>(_s.read<uint32_t>());
+		_s.read(baseVersion);
+		_s.read(version);
+		_s.read(size);
+		_s.read(blockSize);
+		_s.read(blockIndices);
+		_s.read(blockData);
+		return _s;
+	}
+
+	baseLib::BinaryStream& DeviceStateAck::write(baseLib::BinaryStream& _s) const
+	{
+		_s.write(version);
+		return _s;
+	}
+
+	baseLib::BinaryStream& DeviceStateAck::read(baseLib::BinaryStream& _s)
+	{
+		_s.read(version);
 		return _s;
 	}
 
@@ -33,8 +33,11 @@ namespace bridgeLib
 
 		Midi = cmd("MIDI"),
 		Audio = cmd("Wave"),
+		AudioUdp = cmd("WavU"),
 
 		DeviceState = cmd("DvSt"),
+		DeviceStateDelta = cmd("DvSd"),
+		DeviceStateAck = cmd("DvSA"),
 		RequestDeviceState = cmd("RqDS"),
 
 		SetSamplerate = cmd("SmpR"),
@@ -61,6 +64,8 @@ namespace bridgeLib
 		uint32_t protocolVersion;
 		uint32_t portUdp;
 		uint32_t portTcp;
+		uint32_t audioFormats = g_audioFormats;
+		uint32_t portUdpAudio = 0;	// zero if audio via UDP is not available
 
 		baseLib::BinaryStream& write(baseLib::BinaryStream& _s) const override;
 		baseLib::BinaryStream& read(baseLib::BinaryStream& _s) override;
@@ -73,6 +78,7 @@ namespace bridgeLib
 		uint32_t pluginVersion = 0;
 		std::string plugin4CC;
 		SessionId sessionId = 0;
+		uint32_t audioFormats = g_audioFormats;
 
 		PluginDesc()
 		{
@@ -132,6 +138,7 @@ namespace bridgeLib
 	struct RequestDeviceState : CommandStruct
 	{
 		synthLib::StateType type;
+		bool fullState = false;	// the reply is a full state even if a delta is possible
 
 		baseLib::BinaryStream& write(baseLib::BinaryStream& _s) const override;
 		baseLib::BinaryStream& read(baseLib::BinaryStream& _s) override;
@@ -141,6 +148,7 @@ namespace bridgeLib
 	{
 		synthLib::StateType type;
 		std::vector<uint8_t> state;
+		uint32_t version = 0;	// zero if the state is not tracked for delta updates
 
 		baseLib::BinaryStream& write(baseLib::BinaryStream& _s) const override;
 		baseLib::BinaryStream& read(baseLib::BinaryStream& _s) override;
@@ -148,6 +156,29 @@ namespace bridgeLib
 		bool isValid() const { return !state.empty(); }
 	};
 
+	// blocks of a device state that changed since the version that the receiver acknowledged last
+	struct DeviceStateDelta : CommandStruct
+	{
+		synthLib::StateType type;
+		uint32_t baseVersion = 0;
+		uint32_t version = 0;
+		uint32_t size = 0;		// size of the complete state
+		uint32_t blockSize = 0;
+		std::vector<uint32_t> blockIndices;
+		std::vector<uint8_t> blockData;	// all changed blocks in a row, the last block of a state may be shorter
+
+		baseLib::BinaryStream& write(baseLib::BinaryStream& _s) const override;
+		baseLib::BinaryStream& read(baseLib::BinaryStream& _s) override;
+	};
+
+	struct DeviceStateAck : CommandStruct
+	{
+		uint32_t version = 0;
+
+		baseLib::BinaryStream& write(baseLib::BinaryStream& _s) const override;
+		baseLib::BinaryStream& read(baseLib::BinaryStream& _s) override;
+	};
+
 	struct SetSamplerate : CommandStruct
 	{
 		float samplerate;
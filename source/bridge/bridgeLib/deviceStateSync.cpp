@@ -0,0 +1,135 @@
+#include "deviceStateSync.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bridgeLib
+{
+	namespace
+	{
+		// FNV-1a, seeded with the size as the last block of a state may be shorter than the others
+		uint64_t hashBlock(const uint8_t* _data, const size_t _size)
+		{
+			uint64_t h = 14695981039346656037ull ^ _size;
+
+			for(size_t i=0; i<_size; ++i)
+			{
+				h ^= _data[i];
+				h *= 1099511628211ull;
+			}
+
+			return h;
+		}
+	}
+
+	bool DeviceStateSync::prepare(DeviceState& _state, DeviceStateDelta& _delta)
+	{
+		// zero means untracked
+		if(++m_lastVersion == 0)
+			++m_lastVersion;
+
+		_state.version = m_lastVersion;
+
+		// if the previous update has not been acknowledged yet, we cannot tell which version the receiver has
+		const auto canSendDelta = m_acked.version && !m_sent.version && m_acked.type == _state.type;
+
+		createSnapshot(m_sent, _state);
+
+		if(!canSendDelta)
+			return false;
+
+		const auto& data = _state.state;
+
+		_delta.type = _state.type;
+		_delta.baseVersion = m_acked.version;
+		_delta.version = _state.version;
+		_delta.size = m_sent.size;
+		_delta.blockSize = BlockSize;
+		_delta.blockIndices.clear();
+		_delta.blockData.clear();
+
+		for(uint32_t i=0; i<static_cast<uint32_t>(m_sent.blockHashes.size()); ++i)
+		{
+			if(i < m_acked.blockHashes.size() && m_acked.blockHashes[i] == m_sent.blockHashes[i])
+				continue;
+
+			const auto begin = i * BlockSize;
+			const auto end = std::min(begin + BlockSize, m_sent.size);
+
+			_delta.blockIndices.push_back(i);
+			_delta.blockData.insert(_delta.blockData.end(), data.begin() + begin, data.begin() + end);
+
+			// not worth it if most of the state changed
+			if(_delta.blockData.size() > data.size() / 2)
+				return false;
+		}
+
+		return true;
+	}
+
+	void DeviceStateSync::onAck(const uint32_t _version)
+	{
+		if(!m_sent.version || m_sent.version != _version)
+			return;
+
+		std::swap(m_acked, m_sent);
+		m_sent.version = 0;
+	}
+
+	void DeviceStateSync::invalidate()
+	{
+		m_acked.version = 0;
+		m_sent.version = 0;
+	}
+
+	bool DeviceStateSync::apply(DeviceState& _state, const DeviceStateDelta& _delta)
+	{
+		if(!_state.version || _state.version != _delta.baseVersion || _state.type != _delta.type || !_delta.blockSize)
+			return false;
+
+		// validate first, the state must not be modified if the delta is broken
+		size_t dataSize = 0;
+
+		for (const auto index : _delta.blockIndices)
+		{
+			const auto begin = static_cast<uint64_t>(index) * _delta.blockSize;
+
+			if(begin >= _delta.size)
+				return false;
+
+			dataSize += static_cast<size_t>(std::min<uint64_t>(_delta.blockSize, _delta.size - begin));
+		}
+
+		if(dataSize != _delta.blockData.size())
+			return false;
+
+		_state.state.resize(_delta.size);
+
+		const auto* src = _delta.blockData.data();
+
+		for (const auto index : _delta.blockIndices)
+		{
+			const auto begin = static_cast<size_t>(index) * _delta.blockSize;
+			const auto size = std::min<size_t>(_delta.blockSize, _delta.size - begin);
+
+			::memcpy(&_state.state[begin], src, size);
+			src += size;
+		}
+
+		_state.version = _delta.version;
+		return true;
+	}
+
+	void DeviceStateSync::createSnapshot(Snapshot& _snapshot, const DeviceState& _state)
+	{
+		const auto& data = _state.state;
+
+		_snapshot.version = _state.version;
+		_snapshot.type = _state.type;
+		_snapshot.size = static_cast<uint32_t>(data.size());
+		_snapshot.blockHashes.clear();
+
+		for(size_t i=0; i<data.size(); i += BlockSize)
+			_snapshot.blockHashes.push_back(hashBlock(&data[i], std::min<size_t>(BlockSize, data.size() - i)));
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "commands.h"
+
+namespace bridgeLib
+{
+	// Sender side of device state updates. Remembers hashes of fixed-size blocks of the state that the receiver
+	// acknowledged last and creates deltas that contain only the blocks that changed since then
+	class DeviceStateSync
+	{
+	public:
+		static constexpr uint32_t BlockSize = 4096;
+
+		// assigns a new version to _state and fills _delta if a delta can be sent. Returns false if the state needs to
+		// be sent in full, either because nothing has been acknowledged yet or because most of the state changed
+		bool prepare(DeviceState& _state, DeviceStateDelta& _delta);
+
+		void onAck(uint32_t _version);
+
+		// the state of the receiver is unknown, the next update will be a full one
+		void invalidate();
+
+		// receiver side, returns false if the delta does not apply to _state. A full state needs to be requested then
+		static bool apply(DeviceState& _state, const DeviceStateDelta& _delta);
+
+	private:
+		struct Snapshot
+		{
+			uint32_t version = 0;
+			synthLib::StateType type = synthLib::StateTypeGlobal;
+			uint32_t size = 0;
+			std::vector<uint64_t> blockHashes;
+		};
+
+		static void createSnapshot(Snapshot& _snapshot, const DeviceState& _state);
+
+		uint32_t m_lastVersion = 0;
+
+		Snapshot m_acked;
+		Snapshot m_sent;
+	};
+}
@@ -11,6 +11,7 @@ namespace bridgeLib
 	TcpConnection::TcpConnection(std::unique_ptr<networkLib::TcpStream>&& _stream) : CommandReader(nullptr), m_stream(std::move(_stream))
 	{
 		m_audioTransferBuffer.reserve(16384);
+		m_audioReceiveBuffer.reserve(16384);
 
 		start();
 	}
@@ -27,6 +28,7 @@ namespace bridgeLib
 		case Command::Invalid:
 		case Command::Ping:
 		case Command::Pong:
+		case Command::AudioUdp:
 			break;
 		case Command::PluginInfo:			handleStruct<PluginDesc>(_in); break;
 		case Command::ServerInfo:			handleStruct<ServerInfo>(_in); break;
@@ -35,6 +37,8 @@ namespace bridgeLib
 		case Command::Midi:					handleMidi(_in); break;
 		case Command::Audio:				handleAudio(_in); break;
 		case Command::DeviceState:			handleDeviceState(_in); break;
+		case Command::DeviceStateDelta:		handleDeviceStateDelta(_in); break;
+		case Command::DeviceStateAck:		handleStruct<DeviceStateAck>(_in); break;
 		case Command::RequestDeviceState:	handleRequestDeviceState(_in); break;
 		case Command::DeviceCreateParams:	handleStruct<DeviceCreateParams>(_in); break;
 		case Command::SetSamplerate:		handleStruct<SetSamplerate>(_in); break;
@@ -64,12 +68,14 @@ namespace bridgeLib
 
 	void TcpConnection::send(const Command _command, const CommandStruct& _data)
 	{
+		std::scoped_lock lock(m_mutexSend);
 		m_writer.build(_command, _data);
 		m_writer.write(*m_stream);
 	}
 
 	void TcpConnection::send(Command _command)
 	{
+		std::scoped_lock lock(m_mutexSend);
 		m_writer.build(_command);
 		m_writer.write(*m_stream);
 	}
@@ -83,33 +89,25 @@ namespace bridgeLib
 		_in.read(ev.sysex);
 		_in.read(ev.offset);
 		ev.source = static_cast<synthLib::MidiEventSource>(_in.read<uint8_t>());
-		handleMidi(ev);
+		handleMidi(std::move(ev));
 	}
 
 	void TcpConnection::sendAudio(const float* const* _data, const uint32_t _numChannels, const uint32_t _numSamplesPerChannel)
 	{
+		std::scoped_lock lock(m_mutexSend);
 		auto& s = m_writer.build(Command::Audio);
 		s.write(static_cast<uint8_t>(_numChannels));
 		s.write(_numSamplesPerChannel);
 
 		for(uint32_t i=0; i<_numChannels; ++i)
-		{
-			// if a channel has data, write it. If not, write 0 for the length
-			if(const float* channelData = _data[i])
-			{
-				s.write(_numSamplesPerChannel);
-				s.write(channelData, _numSamplesPerChannel);
-			}
-			else
-			{
-				s.write(0);
-			}
-		}
+			m_audioCodec.writeChannel(s, _data[i], _numSamplesPerChannel);
+
 		send();
 	}
 
 	void TcpConnection::sendAudio(AudioBuffers& _buffers, const uint32_t _numChannels, uint32_t _numSamplesPerChannel)
 	{
+		std::scoped_lock lock(m_mutexSend);
 		auto& s = m_writer.build(Command::Audio);
 		s.write(static_cast<uint8_t>(_numChannels));
 		s.write(_numSamplesPerChannel);
@@ -120,8 +118,7 @@ namespace bridgeLib
 		for(uint32_t i=0; i<_numChannels; ++i)
 		{
 			_buffers.readInput(i, m_audioTransferBuffer, _numSamplesPerChannel);
-			s.write(_numSamplesPerChannel);
-			s.write(m_audioTransferBuffer.data(), _numSamplesPerChannel);
+			m_audioCodec.writeChannel(s, m_audioTransferBuffer.data(), _numSamplesPerChannel);
 		}
 
 		_buffers.onInputRead(_numSamplesPerChannel);
@@ -129,20 +126,14 @@ namespace bridgeLib
 		send();
 	}
 
-	uint32_t TcpConnection::handleAudio(float* const* _output, baseLib::BinaryStream& _in)
+	uint32_t TcpConnection::handleAudio(float* const* _output, const uint32_t _maxSamplesPerChannel, baseLib::BinaryStream& _in)
 	{
 		const uint32_t numChannels = _in.read<uint8_t>();
 		const uint32_t numSamplesMax = _in.read<uint32_t>();
 
 		for(uint32_t i=0; i<numChannels; ++i)
-		{
-			const auto numSamples = _in.read<uint32_t>();
-			if(numSamples)
-			{
-				assert(_output[i]);
-				_in.read(_output[i], numSamples);
-			}
-		}
+			m_audioCodec.readChannel(_in, _output[i], _maxSamplesPerChannel);
+
 		return numSamplesMax;
 	}
 
@@ -151,17 +142,15 @@ namespace bridgeLib
 		const uint32_t numChannels = _in.read<uint8_t>();
 		const uint32_t numSamplesMax = _in.read<uint32_t>();
 
+		if(m_audioReceiveBuffer.size() < numSamplesMax)
+			m_audioReceiveBuffer.resize(numSamplesMax);
+
 		for(uint32_t i=0; i<numChannels; ++i)
 		{
-			const auto numSamples = _in.read<uint32_t>();
+			const auto numSamples = m_audioCodec.readChannel(_in, m_audioReceiveBuffer.data(), numSamplesMax);
 
 			if(numSamples)
-			{
-				if(m_audioTransferBuffer.size() < numSamples)
-					m_audioTransferBuffer.resize(numSamples);
-				_in.read(m_audioTransferBuffer.data(), numSamples);
-				_buffers.writeOutput(i, m_audioTransferBuffer, numSamples);
-			}
+				_buffers.writeOutput(i, m_audioReceiveBuffer, numSamples);
 		}
 		_buffers.onOutputWritten(numSamplesMax);
 	}
@@ -192,6 +181,7 @@ namespace bridgeLib
 	{
 		if(!isValid())
 			return false;
+		std::scoped_lock lock(m_mutexSend);
 		auto& bs = m_writer.build(Command::Midi);
 		bs.write(_ev.a);
 		bs.write(_ev.b);
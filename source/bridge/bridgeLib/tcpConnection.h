@@ -1,5 +1,8 @@
 #pragma once
 
+#include <mutex>
+
+#include "audioCodec.h"
 #include "commandReader.h"
 #include "commandWriter.h"
 
@@ -52,26 +55,29 @@ namespace bridgeLib
 		virtual void handleData(const SetDspClockPercent& _params) {}
 		virtual void handleData(const SetUnknownCustomData& _params) {}
 		virtual void handleData(const Error& _error) {}
+		virtual void handleData(const DeviceStateAck& _ack) {}
 
 		virtual void handleDeviceInfo(baseLib::BinaryStream& _in);
 
 		// MIDI
 		bool send(const synthLib::SMidiEvent& _ev);
 		void handleMidi(baseLib::BinaryStream& _in);
-		virtual void handleMidi(const synthLib::SMidiEvent& _e) {}
+		virtual void handleMidi(synthLib::SMidiEvent&& _e) {}
 
 		// AUDIO
 		void sendAudio(const float* const* _data, uint32_t _numChannels, uint32_t _numSamplesPerChannel);
 		void sendAudio(AudioBuffers& _buffers, uint32_t _numChannels, uint32_t _numSamplesPerChannel);
-		static uint32_t handleAudio(float* const* _output, baseLib::BinaryStream& _in);
+		uint32_t handleAudio(float* const* _output, uint32_t _maxSamplesPerChannel, baseLib::BinaryStream& _in);
 		void handleAudio(AudioBuffers& _buffers, baseLib::BinaryStream& _in);
 		virtual void handleAudio(baseLib::BinaryStream& _in);
+		auto& getAudioCodec() { return m_audioCodec; }
 
 		// DEVICE STATE
 		virtual void handleRequestDeviceState(baseLib::BinaryStream& _in);
 		virtual void handleRequestDeviceState(bridgeLib::RequestDeviceState& _requestDeviceState) {}
 		virtual void handleDeviceState(baseLib::BinaryStream& _in);
 		virtual void handleDeviceState(DeviceState& _state) {}
+		virtual void handleDeviceStateDelta(baseLib::BinaryStream& _in) {}
 		const auto& getDeviceState() const { return m_deviceState; }
 		auto& getDeviceState() { return m_deviceState; }
 
@@ -96,11 +102,16 @@ namespace bridgeLib
 
 	private:
 		std::unique_ptr<networkLib::TcpStream> m_stream;
+
+		// commands may be sent from multiple threads
+		std::mutex m_mutexSend;
 		CommandWriter m_writer;
 
-		synthLib::SMidiEvent m_midiEvent;	// preallocated for receiver
+		synthLib::SMidiEvent m_midiEvent;	// reused by the receiver, the sysex is handed on by move
 
+		AudioCodec m_audioCodec;
 		std::vector<float> m_audioTransferBuffer;
+		std::vector<float> m_audioReceiveBuffer;
 
 		DeviceState m_deviceState;
 	};
@@ -8,11 +8,32 @@ namespace bridgeLib
 {
 	static constexpr uint32_t g_udpServerPort   = 56303;
 	static constexpr uint32_t g_tcpServerPort   = 56362;
+	static constexpr uint32_t g_udpAudioPort    = 56363;
 
-	static constexpr uint32_t g_protocolVersion = 1'00'03;
+	// audio blocks sent via UDP are split into packets that do not exceed this size. A datagram above the path MTU is
+	// fragmented and lost as a whole if a single fragment is lost. 1200 bytes leave room for IP/UDP headers and tunnels
+	static constexpr uint32_t g_udpAudioMaxPacketSize = 1200;
+
+	static constexpr uint32_t g_protocolVersion = 1'00'06;
 
 	using SessionId = uint64_t;
 
+	// encoding of a single audio channel in an Audio command
+	enum class AudioFormat : uint8_t
+	{
+		Float32,	// raw 32 bit floats
+		Int24,		// packed 24 bit integers, only used if all samples can be represented without loss
+		Silence		// all samples are zero, no payload
+	};
+
+	constexpr uint32_t audioFormatFlag(const AudioFormat _format)
+	{
+		return 1u << static_cast<uint32_t>(_format);
+	}
+
+	// audio formats that we are able to decode, advertised to the remote side via PluginDesc / ServerInfo
+	static constexpr uint32_t g_audioFormats = audioFormatFlag(AudioFormat::Float32) | audioFormatFlag(AudioFormat::Int24) | audioFormatFlag(AudioFormat::Silence);
+
 	enum class Platform
 	{
 		Windows,
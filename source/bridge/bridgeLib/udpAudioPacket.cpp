@@ -0,0 +1,66 @@
+#include "udpAudioPacket.h"
+
+#include <algorithm>
+
+#include "commands.h"
+
+namespace bridgeLib
+{
+	static_assert(sizeof(Command) == sizeof(uint32_t), "HeaderSize needs to be adjusted");
+
+	UdpAudioPacket::UdpAudioPacket() : m_stream(MaxSize)
+	{
+	}
+
+	baseLib::BinaryStream& UdpAudioPacket::build(const Header& _header)
+	{
+		m_stream.setWritePos(0);
+		m_stream.write(Command::AudioUdp);
+		m_stream.write(_header.sessionId);
+		m_stream.write(_header.sequence);
+		return m_stream;
+	}
+
+	uint8_t* UdpAudioPacket::prepareReceive()
+	{
+		m_stream.getVector().resize(MaxSize);
+		return m_stream.getVector().data();
+	}
+
+	bool UdpAudioPacket::onReceived(const uint32_t _size, Header& _header)
+	{
+		// the stream must not read beyond the received data
+		m_stream.getVector().resize(std::min(_size, MaxSize));
+		m_stream.setReadPos(0);
+
+		return readHeader(m_stream, _header);
+	}
+
+	bool UdpAudioPacket::readHeader(baseLib::BinaryStream& _in, Header& _header)
+	{
+		try
+		{
+			if(_in.read<Command>() != Command::AudioUdp)
+				return false;
+
+			_in.read(_header.sessionId);
+			_in.read(_header.sequence);
+			return true;
+		}
+		catch(std::range_error&)
+		{
+			return false;
+		}
+	}
+
+	uint32_t UdpAudioPacket::getMaxSamplesPerPacket(const uint32_t _numChannels)
+	{
+		const auto numChannels = std::max(_numChannels, 1u);
+		const auto overhead = HeaderSize + numChannels * ChannelHeaderSize;
+
+		if(overhead >= g_udpAudioMaxPacketSize)
+			return 1;
+
+		return std::max(1u, (g_udpAudioMaxPacketSize - overhead) / (numChannels * static_cast<uint32_t>(sizeof(float))));
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include "types.h"
+
+#include "baseLib/binarystream.h"
+
+namespace bridgeLib
+{
+	// A datagram of the UDP audio transport. It carries the session that it belongs to and a sequence number that is
+	// repeated by the reply, followed by an audio block in the same format as sent via TCP. Packets without channels
+	// are used to announce the sender address only
+	class UdpAudioPacket
+	{
+	public:
+		static constexpr uint32_t MaxSize = 65507;
+
+		// command, session id and sequence number, followed by channel count and sample count of the audio block
+		static constexpr uint32_t HeaderSize = sizeof(uint32_t) + sizeof(SessionId) + sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t);
+		// sample count and format of a single channel
+		static constexpr uint32_t ChannelHeaderSize = sizeof(uint32_t) + sizeof(uint8_t);
+
+		struct Header
+		{
+			SessionId sessionId = 0;
+			uint32_t sequence = 0;
+		};
+
+		UdpAudioPacket();
+
+		// returns the stream to write the audio block to
+		baseLib::BinaryStream& build(const Header& _header);
+
+		const uint8_t* data() { return m_stream.getVector().data(); }
+		uint32_t size() const { return m_stream.getWritePos(); }
+
+		// returns a buffer of MaxSize bytes to receive a datagram into
+		uint8_t* prepareReceive();
+
+		// returns false if the received datagram is no audio packet. If it is, the audio block can be read from getStream()
+		bool onReceived(uint32_t _size, Header& _header);
+
+		baseLib::BinaryStream& getStream() { return m_stream; }
+
+		// returns false if the stream does not contain an audio packet
+		static bool readHeader(baseLib::BinaryStream& _in, Header& _header);
+
+		// number of samples per channel that fit into one packet of at most g_udpAudioMaxPacketSize bytes
+		static uint32_t getMaxSamplesPerPacket(uint32_t _numChannels);
+
+	private:
+		baseLib::BinaryStream m_stream;
+	};
+}
@@ -1,15 +1,26 @@
 #include "deviceConnection.h"
 
 #include "remoteDevice.h"
+#include "udpAudioConnection.h"
+#include "bridgeLib/deviceStateSync.h"
 #include "dsp56kBase/logging.h"
+#include "networkLib/exception.h"
 #include "networkLib/logging.h"
 
 namespace bridgeClient
 {
 	static constexpr uint32_t g_replyTimeoutSecs = 10;
 
-	DeviceConnection::DeviceConnection(RemoteDevice& _device, std::unique_ptr<networkLib::TcpStream>&& _stream) : TcpConnection(std::move(_stream)), m_device(_device)
+	// fall back to TCP if this many blocks in a row did not arrive via UDP, the network might be dropping UDP traffic
+	static constexpr uint32_t g_udpMaxConcealedBlocks = 256;
+
+	DeviceConnection::DeviceConnection(RemoteDevice& _device, std::unique_ptr<networkLib::TcpStream>&& _stream, std::string _host)
+		: TcpConnection(std::move(_stream))
+		, m_device(_device)
+		, m_host(std::move(_host))
 	{
+		m_udpTransferBuffer.reserve(bridgeLib::AudioBuffers::BufferSize);
+
 		m_handleReplyFunc = [](bridgeLib::Command, baseLib::BinaryStream&){};
 
 		// send plugin description and device creation parameters, this will cause the server to either boot the device or ask for the rom if it doesn't have it yet
@@ -22,6 +33,7 @@ namespace bridgeClient
 	DeviceConnection::~DeviceConnection()
 	{
 		shutdown();
+		m_udpAudio.reset();
 	}
 
 	void DeviceConnection::handleCommand(const bridgeLib::Command _command, baseLib::BinaryStream& _in)
@@ -37,8 +49,36 @@ namespace bridgeClient
 		}
 	}
 
+	void DeviceConnection::handleData(const bridgeLib::ServerInfo& _info)
+	{
+		// sent by the server in reply to our plugin description, audio is sent uncompressed until then
+		getAudioCodec().setRemoteFormats(_info.audioFormats);
+
+		if(!_info.portUdpAudio || m_udpAudio || m_host.empty())
+			return;
+
+		m_udpAudio.reset(new UdpAudioConnection(*this, m_host, _info.portUdpAudio));
+
+		// an empty block announces our address and opens the socket so that we can start receiving
+		bridgeLib::UdpAudioPacket packet;
+		packet.build({m_device.getPluginDesc().sessionId, 0}).write<uint8_t>(0);
+
+		if(!m_udpAudio->send(packet))
+		{
+			m_udpAudio.reset();
+			return;
+		}
+
+		m_udpAudio->start();
+		m_udpAudioActive = true;
+
+		LOGNET(networkLib::LogLevel::Info, "Using UDP audio transport to " << m_host << ':' << _info.portUdpAudio);
+	}
+
 	void DeviceConnection::handleData(const bridgeLib::DeviceDesc& _desc)
 	{
+		// applied by the audio thread, it owns the audio buffers if UDP audio is active
+		m_outChannels = _desc.outChannels;
 		m_deviceDesc = _desc;
 		m_device.onBootFinished(_desc);
 	}
@@ -65,10 +105,15 @@ namespace bridgeClient
 
 	bool DeviceConnection::processAudio(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, const uint32_t _size, const uint32_t _latency)
 	{
+		if(m_udpAudioActive)
+			return processAudioUdp(_inputs, _outputs, _size, _latency);
+
 		m_audioBuffers.writeInput(_inputs, _size);
 
 		std::unique_lock lock(m_cvWaitMutex);
 
+		m_audioBuffers.setOutputChannelCount(m_outChannels);
+
 		const auto haveEnoughOutput = m_audioBuffers.getOutputSize() >= _size;
 
 		m_audioBuffers.setLatency(_latency, haveEnoughOutput ? 0 : _size);
@@ -115,14 +160,162 @@ namespace bridgeClient
 		m_cvWait.notify_one();
 	}
 
-	void DeviceConnection::handleMidi(const synthLib::SMidiEvent& _e)
+	bool DeviceConnection::processAudioUdp(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, const uint32_t _size, const uint32_t _latency)
 	{
-		m_midiOut.push_back(_e);
+		// the audio thread never waits for replies. Blocks that did not arrive yet are concealed, the jitter latency
+		// grows until replies arrive before they are needed
+		m_audioBuffers.writeInput(_inputs, _size);
+
+		readUdpReplies();
+
+		m_audioBuffers.setOutputChannelCount(m_outChannels);
+
+		const auto haveEnoughOutput = m_audioBuffers.getOutputSize() >= _size;
+
+		m_audioBuffers.setLatency(_latency + m_audioBuffers.getJitterLatency(), haveEnoughOutput ? 0 : _size);
+
+		const auto sendSize = m_audioBuffers.getInputSize();
+		const auto numChannels = m_device.getChannelCountIn();
+		// the reply carries the same number of samples for every output channel, it has to fit into a packet, too
+		const auto samplesPerPacket = bridgeLib::UdpAudioPacket::getMaxSamplesPerPacket(std::max(numChannels, m_outChannels.load()));
+
+		for(uint32_t i=0; i<sendSize; i += samplesPerPacket)
+		{
+			const auto numSamples = std::min(samplesPerPacket, sendSize - i);
+			sendAudioUdp(m_audioBuffers.registerBlock(numSamples), numChannels, numSamples);
+		}
+
+		m_audioBuffers.onInputRead(sendSize);
+
+		const auto samplerate = m_deviceDesc.samplerate > 0.0f ? m_deviceDesc.samplerate : 44100.0f;
+
+		const auto concealed = m_audioBuffers.concealMissingBlocks(_size);
+
+		m_audioBuffers.updateJitterLatency(concealed > 0, _size, samplerate);
+
+		m_udpConcealedBlocks = concealed ? m_udpConcealedBlocks + concealed : 0;
+
+		if(m_udpConcealedBlocks >= g_udpMaxConcealedBlocks)
+		{
+			LOGNET(networkLib::LogLevel::Warning, "Too many UDP audio packets lost, falling back to TCP");
+			m_udpAudioActive = false;
+			m_audioBuffers.resetSequence();
+		}
+
+		if(m_audioBuffers.getOutputSize() < _size)
+		{
+			LOG("Not enough audio data, closing connection");
+			close();
+			return false;
+		}
+
+		m_audioBuffers.readOutput(_outputs, _size);
+		return true;
+	}
+
+	void DeviceConnection::readUdpReplies()
+	{
+		uint32_t count;
+
+		{
+			// do not wait for the UDP thread, whatever it is adding now is picked up on the next block
+			std::unique_lock lock(m_udpReplyMutex, std::try_to_lock);
+
+			if(!lock.owns_lock())
+				return;
+
+			std::swap(m_udpReplies, m_udpRepliesAudio);
+			count = m_udpReplyCount;
+			m_udpReplyCount = 0;
+		}
+
+		for(uint32_t i=0; i<count; ++i)
+		{
+			const auto& r = m_udpRepliesAudio[i];
+			m_audioBuffers.writeOutputBlock(r.sequence, r.data, r.numChannels, r.numSamples);
+		}
+	}
+
+	void DeviceConnection::sendAudioUdp(const uint32_t _sequence, const uint32_t _numChannels, const uint32_t _numSamples)
+	{
+		auto& s = m_udpSendPacket.build({m_device.getPluginDesc().sessionId, _sequence});
+
+		s.write(static_cast<uint8_t>(_numChannels));
+		s.write(_numSamples);
+
+		if(m_udpTransferBuffer.size() < _numSamples)
+			m_udpTransferBuffer.resize(_numSamples);
+
+		for(uint32_t c=0; c<_numChannels; ++c)
+		{
+			m_audioBuffers.readInput(c, m_udpTransferBuffer, _numSamples);
+			getAudioCodec().writeChannel(s, m_udpTransferBuffer.data(), _numSamples);
+		}
+
+		// a lost packet is concealed on arrival of the reply
+		m_udpAudio->send(m_udpSendPacket);
+	}
+
+	void DeviceConnection::handleUdpAudio(const bridgeLib::UdpAudioPacket::Header& _header, baseLib::BinaryStream& _in)
+	{
+		if(!m_udpAudioActive || _header.sessionId != m_device.getPluginDesc().sessionId)
+			return;
+
+		try
+		{
+			const uint32_t numChannels = _in.read<uint8_t>();
+			const auto numSamples = _in.read<uint32_t>();
+
+			if(!numChannels || numChannels > m_udpReceiveBlock.size() || !numSamples || numSamples > bridgeLib::AudioBuffers::BufferSize)
+				return;
+
+			for(uint32_t c=0; c<numChannels; ++c)
+			{
+				auto& data = m_udpReceiveBlock[c];
+
+				if(data.size() < numSamples)
+					data.resize(numSamples);
+
+				if(!m_udpAudioCodec.readChannel(_in, data.data(), numSamples))
+					std::fill_n(data.begin(), numSamples, 0.0f);
+			}
+
+			std::unique_lock lock(m_udpReplyMutex);
+
+			// the audio thread does not pick up replies, audio processing might have been stopped
+			if(m_udpReplyCount >= bridgeLib::AudioBuffers::MaxBlocksInFlight)
+				return;
+
+			if(m_udpReplyCount >= m_udpReplies.size())
+				m_udpReplies.emplace_back();
+
+			auto& reply = m_udpReplies[m_udpReplyCount++];
+
+			reply.sequence = _header.sequence;
+			reply.numChannels = numChannels;
+			reply.numSamples = numSamples;
+
+			for(uint32_t c=0; c<numChannels; ++c)
+				reply.data[c].assign(m_udpReceiveBlock[c].begin(), m_udpReceiveBlock[c].begin() + numSamples);
+		}
+		catch(std::range_error&)
+		{
+			// truncated packet, will be concealed
+		}
+		catch(networkLib::NetException&)
+		{
+			// invalid audio data, will be concealed
+		}
+	}
+
+	void DeviceConnection::handleMidi(synthLib::SMidiEvent&& _e)
+	{
+		m_midiOut.push_back(std::move(_e));
 	}
 
 	void DeviceConnection::readMidiOut(std::vector<synthLib::SMidiEvent>& _midiOut)
 	{
-		_midiOut.insert(_midiOut.end(), m_midiOut.begin(), m_midiOut.end());
+		_midiOut.insert(_midiOut.end(), std::make_move_iterator(m_midiOut.begin()), std::make_move_iterator(m_midiOut.end()));
 		m_midiOut.clear();
 	}
 
@@ -143,6 +336,39 @@ namespace bridgeClient
 	void DeviceConnection::handleDeviceState(baseLib::BinaryStream& _in)
 	{
 		TcpConnection::handleDeviceState(_in);
+
+		const auto version = TcpConnection::getDeviceState().version;
+
+		if(version)
+		{
+			bridgeLib::DeviceStateAck ack;
+			ack.version = version;
+			send(bridgeLib::Command::DeviceStateAck, ack);
+		}
+
+		m_handleReplyFunc(bridgeLib::Command::DeviceState, _in);
+	}
+
+	void DeviceConnection::handleDeviceStateDelta(baseLib::BinaryStream& _in)
+	{
+		m_deviceStateDelta.read(_in);
+
+		if(!bridgeLib::DeviceStateSync::apply(TcpConnection::getDeviceState(), m_deviceStateDelta))
+		{
+			// we do not have the state that the delta is based on, the full state replies to a pending request, too
+			LOGNET(networkLib::LogLevel::Warning, "Device state delta cannot be applied, requesting full state");
+
+			bridgeLib::RequestDeviceState s;
+			s.type = m_deviceStateDelta.type;
+			s.fullState = true;
+			send(bridgeLib::Command::RequestDeviceState, s);
+			return;
+		}
+
+		bridgeLib::DeviceStateAck ack;
+		ack.version = m_deviceStateDelta.version;
+		send(bridgeLib::Command::DeviceStateAck, ack);
+
 		m_handleReplyFunc(bridgeLib::Command::DeviceState, _in);
 	}
 
@@ -154,6 +380,7 @@ namespace bridgeClient
 		auto& s = TcpConnection::getDeviceState();
 		s.state = _state;
 		s.type = _type;
+		s.version = 0;
 
 		sendAwaitReply([&]
 		{
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 
 #include "bridgeLib/audioBuffers.h"
 #include "bridgeLib/tcpConnection.h"
+#include "bridgeLib/udpAudioPacket.h"
 
 #include "synthLib/audioTypes.h"
 #include "synthLib/deviceTypes.h"
@@ -12,15 +14,17 @@
 namespace bridgeClient
 {
 	class RemoteDevice;
+	class UdpAudioConnection;
 
 	class DeviceConnection : public bridgeLib::TcpConnection
 	{
 	public:
-		DeviceConnection(RemoteDevice& _device, std::unique_ptr<networkLib::TcpStream>&& _stream);
+		DeviceConnection(RemoteDevice& _device, std::unique_ptr<networkLib::TcpStream>&& _stream, std::string _host);
 		~DeviceConnection() override;
 
 		void handleCommand(bridgeLib::Command _command, baseLib::BinaryStream& _in) override;
 
+		void handleData(const bridgeLib::ServerInfo& _info) override;
 		void handleData(const bridgeLib::DeviceDesc& _desc) override;
 		void handleDeviceInfo(baseLib::BinaryStream& _in) override;
 
@@ -32,14 +36,16 @@ namespace bridgeClient
 		// AUDIO
 		bool processAudio(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, uint32_t _size, uint32_t _latency);
 		void handleAudio(baseLib::BinaryStream& _in) override;
+		void handleUdpAudio(const bridgeLib::UdpAudioPacket::Header& _header, baseLib::BinaryStream& _in);
 
 		// MIDI
-		void handleMidi(const synthLib::SMidiEvent& _e) override;
+		void handleMidi(synthLib::SMidiEvent&& _e) override;
 		void readMidiOut(std::vector<synthLib::SMidiEvent>& _midiOut);
 
 		// DEVICE STATE
 		bool getDeviceState(std::vector<uint8_t>& _state, synthLib::StateType _type);
 		void handleDeviceState(baseLib::BinaryStream& _in) override;
+		void handleDeviceStateDelta(baseLib::BinaryStream& _in) override;
 		bool setDeviceState(const std::vector<uint8_t>& _state, synthLib::StateType _type);
 
 		void setSamplerate(float _samplerate);
@@ -47,6 +53,10 @@ namespace bridgeClient
 		void setDspClockPercent(uint32_t _percent);
 
 	private:
+		bool processAudioUdp(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, uint32_t _size, uint32_t _latency);
+		void sendAudioUdp(uint32_t _sequence, uint32_t _numChannels, uint32_t _numSamples);
+		void readUdpReplies();
+
 		bool sendAwaitReply(const std::function<void()>& _send, const std::function<void(baseLib::BinaryStream&)>& _reply, bridgeLib::Command _replyCommand);
 
 		RemoteDevice& m_device;
@@ -59,6 +69,32 @@ namespace bridgeClient
 
 		std::vector<synthLib::SMidiEvent> m_midiOut;
 
+		bridgeLib::DeviceStateDelta m_deviceStateDelta;
+
 		bridgeLib::AudioBuffers m_audioBuffers;
+
+		// UDP audio, used if the server supports it. Packets are sent from the audio thread and received on the UDP thread.
+		// While it is active, the audio buffers are owned by the audio thread, replies are queued and picked up by it
+		struct UdpReply
+		{
+			uint32_t sequence = 0;
+			uint32_t numChannels = 0;
+			uint32_t numSamples = 0;
+			bridgeLib::AudioBuffers::OutputBlock data;
+		};
+
+		std::string m_host;
+		std::atomic<bool> m_udpAudioActive{false};
+		std::atomic<uint32_t> m_outChannels{0};
+		uint32_t m_udpConcealedBlocks = 0;
+		bridgeLib::UdpAudioPacket m_udpSendPacket;
+		std::vector<float> m_udpTransferBuffer;
+		bridgeLib::AudioCodec m_udpAudioCodec;
+		bridgeLib::AudioBuffers::OutputBlock m_udpReceiveBlock;
+		std::mutex m_udpReplyMutex;
+		std::vector<UdpReply> m_udpReplies;			// filled by the UDP thread
+		uint32_t m_udpReplyCount = 0;
+		std::vector<UdpReply> m_udpRepliesAudio;	// swapped with the above by the audio thread
+		std::unique_ptr<UdpAudioConnection> m_udpAudio;
 	};
 }
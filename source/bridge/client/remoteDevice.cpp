@@ -269,7 +269,7 @@ namespace bridgeClient
 		// we are connected. Wait for device info as long as the connection is alive. The server will either
 		// close it if the requirements are not fulfilled (plugin not existing on server) or will eventually
 		// send device info after the device has bene opened on the server
-		m_connection.reset(new DeviceConnection(*this, std::move(stream)));
+		m_connection.reset(new DeviceConnection(*this, std::move(stream), host));
 
 		std::unique_lock lockCv(m_cvWaitMutex);
 		m_cvWait.wait(lockCv, [this]()
@@ -0,0 +1,65 @@
+#include "udpAudioConnection.h"
+
+#include <chrono>
+#include <thread>
+
+#include "deviceConnection.h"
+
+#include "networkLib/logging.h"
+
+#include "ptypes/pinet.h"
+
+namespace bridgeClient
+{
+	UdpAudioConnection::UdpAudioConnection(DeviceConnection& _connection, const std::string& _host, const uint32_t _port)
+		: m_connection(_connection)
+		, m_socket(std::make_unique<ptypes::ipmessage>(_host.c_str(), static_cast<int>(_port)))
+	{
+	}
+
+	UdpAudioConnection::~UdpAudioConnection()
+	{
+		stop();
+	}
+
+	bool UdpAudioConnection::send(bridgeLib::UdpAudioPacket& _packet)
+	{
+		try
+		{
+			m_socket->send(reinterpret_cast<const char*>(_packet.data()), static_cast<int>(_packet.size()));
+			return true;
+		}
+		catch(ptypes::exception* e)  // NOLINT(misc-throw-by-value-catch-by-reference)
+		{
+			LOGNET(networkLib::LogLevel::Warning, "Failed to send UDP audio: " << static_cast<const char*>(e->get_message()));
+			delete e;
+			return false;
+		}
+	}
+
+	void UdpAudioConnection::threadLoopFunc()
+	{
+		try
+		{
+			if(!m_socket->waitfor(100))
+				return;
+
+			const auto count = m_socket->receive(reinterpret_cast<char*>(m_receivePacket.prepareReceive()), static_cast<int>(bridgeLib::UdpAudioPacket::MaxSize));
+
+			if(count <= 0)
+				return;
+
+			bridgeLib::UdpAudioPacket::Header header;
+
+			if(m_receivePacket.onReceived(static_cast<uint32_t>(count), header))
+				m_connection.handleUdpAudio(header, m_receivePacket.getStream());
+		}
+		catch(ptypes::exception* e)  // NOLINT(misc-throw-by-value-catch-by-reference)
+		{
+			// happens if the server is not reachable, the TCP connection is responsible to detect disconnects
+			LOGNET(networkLib::LogLevel::Warning, "Failed to receive UDP audio: " << static_cast<const char*>(e->get_message()));
+			delete e;
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "bridgeLib/udpAudioPacket.h"
+
+#include "networkLib/networkThread.h"
+
+namespace ptypes
+{
+	class ipmessage;
+}
+
+namespace bridgeClient
+{
+	class DeviceConnection;
+
+	// Transports audio to and from the server via UDP, MIDI and device state stay on the TCP connection
+	class UdpAudioConnection : networkLib::NetworkThread
+	{
+	public:
+		UdpAudioConnection(DeviceConnection& _connection, const std::string& _host, uint32_t _port);
+		~UdpAudioConnection();
+
+		UdpAudioConnection(const UdpAudioConnection&) = delete;
+		UdpAudioConnection(UdpAudioConnection&&) = delete;
+		UdpAudioConnection& operator = (const UdpAudioConnection&) = delete;
+		UdpAudioConnection& operator = (UdpAudioConnection&&) = delete;
+
+		// receiving can start only after the first packet has been sent, the socket is opened on first use
+		using NetworkThread::start;
+
+		bool send(bridgeLib::UdpAudioPacket& _packet);
+
+	protected:
+		void threadLoopFunc() override;
+
+	private:
+		DeviceConnection& m_connection;
+		std::unique_ptr<ptypes::ipmessage> m_socket;
+		bridgeLib::UdpAudioPacket m_receivePacket;
+	};
+}
@@ -1,17 +1,24 @@
 #include "clientConnection.h"
 
+#include <cstring>
+
 #include "server.h"
 #include "bridgeLib/error.h"
+#include "networkLib/exception.h"
 #include "networkLib/logging.h"
 
 namespace bridgeServer
 {
 	static constexpr uint32_t g_audioBufferSize = 16384;
 
-	ClientConnection::ClientConnection(Server& _server, std::unique_ptr<networkLib::TcpStream>&& _stream, std::string _name)
+	// packets are dropped if the device cannot keep up, the client conceals them
+	static constexpr uint32_t g_maxQueuedUdpAudioPackets = 64;
+
+	ClientConnection::ClientConnection(Server& _server, std::unique_ptr<networkLib::TcpStream>&& _stream, std::string _name, const uint32_t _peerIp)
 		: TcpConnection(std::move(_stream))
 		, m_server(_server)
 		, m_name(std::move(_name))
+		, m_peerIp(_peerIp)
 	{
 		for(size_t i=0; i<m_audioInputBuffers.size(); ++i)
 		{
@@ -36,12 +43,14 @@ namespace bridgeServer
 	ClientConnection::~ClientConnection()
 	{
 		shutdown();
+		m_server.getScheduler().remove(*this);
 		destroyDevice();
 	}
 
-	void ClientConnection::handleMidi(const synthLib::SMidiEvent& _e)
+	void ClientConnection::handleMidi(synthLib::SMidiEvent&& _e)
 	{
-		m_midiIn.push_back(_e);
+		std::scoped_lock lock(m_mutexMidiIn);
+		m_midiIn.push_back(std::move(_e));
 	}
 
 	void ClientConnection::handleData(const bridgeLib::PluginDesc& _desc)
@@ -49,6 +58,18 @@ namespace bridgeServer
 		m_pluginDesc = _desc;
 		LOGNET(networkLib::LogLevel::Info, "Client " << m_name << " identified as plugin " << _desc.pluginName << ", version " << _desc.pluginVersion);
 		m_name = m_pluginDesc.pluginName + '-' + m_name;
+
+		// negotiate audio transport, the client needs to know which formats we can decode, too
+		getAudioCodec().setRemoteFormats(_desc.audioFormats);
+		m_udpAudioCodec.setRemoteFormats(_desc.audioFormats);
+
+		bridgeLib::ServerInfo si;
+		si.protocolVersion = bridgeLib::g_protocolVersion;
+		si.portTcp = bridgeLib::g_tcpServerPort;
+		si.portUdp = bridgeLib::g_udpServerPort;
+		si.portUdpAudio = m_server.getUdpAudioServer().getPort();
+		send(bridgeLib::Command::ServerInfo, si);
+
 		createDevice();
 	}
 
@@ -59,15 +80,15 @@ namespace bridgeServer
 		if(p.romData.empty())
 		{
 			// if no rom data has been transmitted, try to load from cache
-			const auto& romData = m_server.getRomPool().getRom(p.romHash);
+			auto rom = m_server.getRomPool().getRom(p.romHash);
 
-			if(!romData.empty())
+			if(rom)
 			{
 				// if we have the ROM, we are good to go
 				LOGNET(networkLib::LogLevel::Info, "ROM " << p.romName << " with hash " << p.romHash.toString() << " found, transfer skipped");
 
 				m_deviceCreateParams = p;
-				m_deviceCreateParams.romData = romData;
+				m_deviceCreateParams.rom = std::move(rom);
 
 				createDevice();
 			}
@@ -94,12 +115,22 @@ namespace bridgeServer
 			{
 				LOGNET(networkLib::LogLevel::Error, "Calculated hash " << calculatedHash.toString() << " of ROM " << p.romName << " does not match sent hash " <<  p.romHash.toString() << ", transfer error");
 				close();
+				return;
 			}
 
 			LOGNET(networkLib::LogLevel::Info, "Adding ROM " << p.romName << " with hash " << p.romHash.toString() << " to pool");
-			m_server.getRomPool().addRom(p.romName, p.romData);
+			auto rom = m_server.getRomPool().addRom(p.romName, p.romData);
+
+			if(!rom)
+			{
+				errorClose(bridgeLib::ErrorCode::FailedToCreateDevice, "Failed to store ROM " + p.romName);
+				return;
+			}
 
+			// keep the shared image only, the transmitted data is not needed anymore
 			m_deviceCreateParams = p;
+			m_deviceCreateParams.romData = {};
+			m_deviceCreateParams.rom = std::move(rom);
 
 			createDevice();
 		}
@@ -113,21 +144,231 @@ namespace bridgeServer
 			return;
 		}
 
-		const auto numSamples = TcpConnection::handleAudio(const_cast<float* const*>(m_audioInputs.data()), _in);
+		queueAudioJob(_in, false, 0, 0);
+	}
+
+	bool ClientConnection::handleUdpAudio(const bridgeLib::UdpAudioPacket::Header&, baseLib::BinaryStream& _in, const uint32_t _ip, const int _port)
+	{
+		// the session id is no secret, only accept audio from the host that is connected via TCP. Otherwise, anyone could
+		// inject audio into the session and have the replies sent to an arbitrary address
+		if(_ip != m_peerIp)
+			return false;
+
+		queueAudioJob(_in, true, _ip, _port);
+		return true;
+	}
+
+	void ClientConnection::queueAudioJob(baseLib::BinaryStream& _in, const bool _udp, const uint32_t _ip, const int _port)
+	{
+		AudioJob job;
+
+		{
+			std::scoped_lock lock(m_mutexAudioJobs);
+
+			if(_udp && m_audioJobs.size() >= g_maxQueuedUdpAudioPackets)
+				return;
+
+			if(!m_audioJobPool.empty())
+			{
+				job = std::move(m_audioJobPool.back());
+				m_audioJobPool.pop_back();
+			}
+		}
+
+		// the client runs out of audio one block duration after it has sent the block
+		const auto& data = _in.getVector();
+		const auto readPos = _in.getReadPos();
+
+		uint32_t numSamples = 0;
+
+		if(data.size() >= readPos + sizeof(uint8_t) + sizeof(uint32_t))
+			::memcpy(&numSamples, &data[readPos + sizeof(uint8_t)], sizeof(numSamples));
+
+		job.deadline = Scheduler::Clock::now() + std::chrono::duration_cast<Scheduler::Clock::duration>(std::chrono::duration<float>(getAudioSeconds(numSamples)));
+
+		job.data.assign(data.begin(), data.end());
+		job.udp = _udp;
+		job.ip = _ip;
+		job.port = _port;
+
+		// MIDI that arrived via TCP belongs to the audio block that follows it. For UDP, the order is not guaranteed
+		// anyway, MIDI is taken when the block is processed
+		if(!_udp)
+		{
+			std::scoped_lock lock(m_mutexMidiIn);
+			job.midi.swap(m_midiIn);
+		}
+
+		const auto deadline = job.deadline;
+
+		{
+			std::scoped_lock lock(m_mutexAudioJobs);
+			m_audioJobs.emplace_back(std::move(job));
+		}
+
+		m_server.getScheduler().schedule(*this, deadline);
+	}
+
+	float ClientConnection::processJob()
+	{
+		AudioJob job;
+
+		{
+			std::scoped_lock lock(m_mutexAudioJobs);
+
+			if(m_audioJobs.empty())
+				return 0.0f;
+
+			job = std::move(m_audioJobs.front());
+			m_audioJobs.pop_front();
+		}
+
+		const auto seconds = job.udp ? processUdpAudio(job) : processTcpAudio(job);
+
+		job.midi.clear();
 
-		m_device->process(m_audioInputs, m_audioOutputs, numSamples, m_midiIn, m_midiOut);
+		std::scoped_lock lock(m_mutexAudioJobs);
+		m_audioJobPool.emplace_back(std::move(job));
+
+		return seconds;
+	}
+
+	bool ClientConnection::getNextDeadline(Scheduler::Clock::time_point& _deadline)
+	{
+		std::scoped_lock lock(m_mutexAudioJobs);
+
+		if(m_audioJobs.empty())
+			return false;
+
+		_deadline = m_audioJobs.front().deadline;
+		return true;
+	}
+
+	float ClientConnection::processTcpAudio(AudioJob& _job)
+	{
+		auto& in = m_audioJobIn;
+
+		in.getVector().swap(_job.data);
+		in.setReadPos(0);
+
+		float seconds = 0.0f;
+
+		try
+		{
+			std::scoped_lock lock(m_mutexDevice);
+
+			if(m_device)
+			{
+				const auto numSamples = TcpConnection::handleAudio(const_cast<float* const*>(m_audioInputs.data()), g_audioBufferSize, in);
+
+				processAudio(numSamples, _job.midi);
+
+				sendAudio(m_audioOutputs.data(), std::min(static_cast<uint32_t>(m_audioOutputs.size()), m_device->getChannelCountOut()), numSamples);
+
+				seconds = getAudioSeconds(numSamples);
+			}
+		}
+		catch(std::range_error&)
+		{
+			LOGNET(networkLib::LogLevel::Error, m_name << ": Received truncated audio data, closing connection");
+			close();
+		}
+		catch(networkLib::NetException& e)
+		{
+			LOGNET(networkLib::LogLevel::Error, m_name << ": Network exception while processing audio: " << e.what());
+			close();
+		}
+
+		in.getVector().swap(_job.data);
+
+		return seconds;
+	}
+
+	float ClientConnection::processUdpAudio(AudioJob& _job)
+	{
+		auto& in = m_audioJobIn;
+
+		in.getVector().swap(_job.data);
+		in.setReadPos(0);
+
+		float seconds = 0.0f;
+
+		try
+		{
+			bridgeLib::UdpAudioPacket::Header header;
+
+			if(bridgeLib::UdpAudioPacket::readHeader(in, header))
+			{
+				const uint32_t numChannels = in.read<uint8_t>();
+				const auto numSamples = in.read<uint32_t>();
+
+				// packets without audio are sent by clients to announce their address
+				if(numChannels && numSamples && numChannels <= m_audioInputs.size() && numSamples <= g_audioBufferSize)
+				{
+					std::scoped_lock lock(m_mutexDevice);
+
+					if(m_device)
+					{
+						for(uint32_t c=0; c<numChannels; ++c)
+							m_udpAudioCodec.readChannel(in, m_audioInputBuffers[c].data(), g_audioBufferSize);
+
+						{
+							std::scoped_lock lockMidi(m_mutexMidiIn);
+							_job.midi.swap(m_midiIn);
+						}
+
+						processAudio(numSamples, _job.midi);
+
+						const auto numOutputs = std::min(static_cast<uint32_t>(m_audioOutputs.size()), m_device->getChannelCountOut());
+
+						auto& out = m_udpAudioReply.build(header);
+						out.write(static_cast<uint8_t>(numOutputs));
+						out.write(numSamples);
+
+						for(uint32_t c=0; c<numOutputs; ++c)
+							m_udpAudioCodec.writeChannel(out, m_audioOutputs[c], numSamples);
+
+						seconds = getAudioSeconds(numSamples);
+					}
+				}
+			}
+		}
+		catch(std::range_error&)
+		{
+			// truncated packet, the client conceals the missing reply
+		}
+		catch(networkLib::NetException&)
+		{
+			// invalid audio data
+		}
+
+		in.getVector().swap(_job.data);
+
+		if(seconds > 0.0f)
+			m_server.getUdpAudioServer().send(m_udpAudioReply, _job.ip, _job.port);
+
+		return seconds;
+	}
+
+	void ClientConnection::processAudio(const uint32_t _numSamples, std::vector<synthLib::SMidiEvent>& _midiIn)
+	{
+		m_device->process(m_audioInputs, m_audioOutputs, _numSamples, _midiIn, m_midiOut);
 
 		for (const auto& midiOut : m_midiOut)
 			send(midiOut);
 
-		sendAudio(m_audioOutputs.data(), std::min(static_cast<uint32_t>(m_audioOutputs.size()), m_device->getChannelCountOut()), numSamples);
-
-		m_midiIn.clear();
+		_midiIn.clear();
 
 		m_device->release(m_midiOut);
 	}
 
-	void ClientConnection::sendDeviceState(const synthLib::StateType _type)
+	float ClientConnection::getAudioSeconds(const uint32_t _numSamples) const
+	{
+		const float samplerate = m_samplerate;
+		return samplerate > 0.0f ? static_cast<float>(_numSamples) / samplerate : 0.0f;
+	}
+
+	void ClientConnection::sendDeviceState(const synthLib::StateType _type, const bool _fullState)
 	{
 		if(!m_device)
 			return;
@@ -137,9 +378,20 @@ namespace bridgeServer
 		state.type = _type;
 
 		state.state.clear();
-		m_device->getState(state.state, _type);
 
-		send(bridgeLib::Command::DeviceState, state);
+		{
+			std::scoped_lock lockDevice(m_mutexDevice);
+			m_device->getState(state.state, _type);
+		}
+
+		if(_fullState)
+			m_deviceStateSync.invalidate();
+
+		// only send what changed since the state that the client acknowledged last
+		if(m_deviceStateSync.prepare(state, m_deviceStateDelta))
+			send(bridgeLib::Command::DeviceStateDelta, m_deviceStateDelta);
+		else
+			send(bridgeLib::Command::DeviceState, state);
 	}
 
 	void ClientConnection::handleRequestDeviceState(bridgeLib::RequestDeviceState& _requestDeviceState)
@@ -150,7 +402,7 @@ namespace bridgeServer
 			return;
 		}
 
-		sendDeviceState(_requestDeviceState.type);
+		sendDeviceState(_requestDeviceState.type, _requestDeviceState.fullState);
 	}
 
 	void ClientConnection::handleDeviceState(bridgeLib::DeviceState& _in)
@@ -161,6 +413,7 @@ namespace bridgeServer
 			return;
 		}
 
+		std::scoped_lock lock(m_mutexDevice);
 		m_device->setState(_in.state, _in.type);
 		sendDeviceInfo();
 	}
@@ -168,9 +421,19 @@ namespace bridgeServer
 	void ClientConnection::handleDeviceState(baseLib::BinaryStream& _in)
 	{
 		std::scoped_lock lock(m_mutexDeviceState);
+
+		// the client replaced its state, deltas against the previous one are useless now
+		m_deviceStateSync.invalidate();
+
 		TcpConnection::handleDeviceState(_in);
 	}
 
+	void ClientConnection::handleData(const bridgeLib::DeviceStateAck& _ack)
+	{
+		std::scoped_lock lock(m_mutexDeviceState);
+		m_deviceStateSync.onAck(_ack.version);
+	}
+
 	void ClientConnection::handleException(const networkLib::NetException& _e)
 	{
 		exit(true);
@@ -185,6 +448,7 @@ namespace bridgeServer
 			return;
 		}
 
+		std::scoped_lock lock(m_mutexDevice);
 		m_device->setSamplerate(_params.samplerate);
 		sendDeviceInfo();
 	}
@@ -197,6 +461,7 @@ namespace bridgeServer
 			return;
 		}
 
+		std::scoped_lock lock(m_mutexDevice);
 		m_device->setDspClockPercent(_params.percent);
 		sendDeviceInfo();
 	}
@@ -209,6 +474,7 @@ namespace bridgeServer
 			return;
 		}
 
+		std::scoped_lock lock(m_mutexDevice);
 		m_device->setStateFromUnknownCustomData(_params.data);
 		sendDeviceInfo();
 	}
@@ -218,6 +484,7 @@ namespace bridgeServer
 		bridgeLib::DeviceDesc deviceDesc;
 
 		deviceDesc.samplerate = m_device->getSamplerate();
+		m_samplerate = deviceDesc.samplerate;
 		deviceDesc.outChannels = m_device->getChannelCountOut();
 		deviceDesc.inChannels = m_device->getChannelCountIn();
 		deviceDesc.dspClockPercent = m_device->getDspClockPercent();
@@ -236,9 +503,11 @@ namespace bridgeServer
 
 	void ClientConnection::createDevice()
 	{
-		if(m_pluginDesc.pluginVersion == 0 || m_deviceCreateParams.romData.empty())
+		if(m_pluginDesc.pluginVersion == 0 || !m_deviceCreateParams.rom)
 			return;
 
+		std::scoped_lock lock(m_mutexDevice);
+
 		m_device = m_server.getPlugins().createDevice(m_deviceCreateParams, m_pluginDesc);
 
 		if(!m_device)
@@ -251,10 +520,13 @@ namespace bridgeServer
 		LOGNET(networkLib::LogLevel::Info, "Created new device for plugin '" << d.pluginName << "', version " << d.pluginVersion << ", id " << d.plugin4CC);
 
 		// recover a previously lost connection if possible
-		const auto cachedDeviceState = m_server.getCachedDeviceState(d.sessionId);
+		auto cachedDeviceState = m_server.getCachedDeviceState(d.sessionId);
 
 		if(cachedDeviceState.isValid())
 		{
+			// the version belongs to the previous connection
+			cachedDeviceState.version = 0;
+
 			LOGNET(networkLib::LogLevel::Info, m_name << ": Recovering previous device state for session id " << d.sessionId);
 			send(bridgeLib::Command::DeviceState, cachedDeviceState);
 			m_device->setState(cachedDeviceState.state, cachedDeviceState.type);
@@ -271,6 +543,7 @@ namespace bridgeServer
 		if(isValid())
 		sendDeviceState(synthLib::StateTypeGlobal);
 
+		std::scoped_lock lock(m_mutexDevice);
 		m_server.getPlugins().destroyDevice(m_pluginDesc, m_device);
 		m_device = nullptr;
 	}
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include <mutex>
 
+#include "scheduler.h"
+
+#include "bridgeLib/deviceStateSync.h"
 #include "bridgeLib/tcpConnection.h"
+#include "bridgeLib/udpAudioPacket.h"
 #include "networkLib/networkThread.h"
 #include "networkLib/tcpStream.h"
 #include "synthLib/device.h"
@@ -11,13 +17,13 @@ namespace bridgeServer
 {
 	class Server;
 
-	class ClientConnection : public bridgeLib::TcpConnection
+	class ClientConnection : public bridgeLib::TcpConnection, public Scheduler::Session
 	{
 	public:
-		ClientConnection(Server& _server, std::unique_ptr<networkLib::TcpStream>&& _stream, std::string _name);
+		ClientConnection(Server& _server, std::unique_ptr<networkLib::TcpStream>&& _stream, std::string _name, uint32_t _peerIp);
 		~ClientConnection() override;
 
-		void handleMidi(const synthLib::SMidiEvent& _e) override;
+		void handleMidi(synthLib::SMidiEvent&& _e) override;
 		void handleData(const bridgeLib::PluginDesc& _desc) override;
 		void handleData(const bridgeLib::DeviceCreateParams& _params) override;
 		void handleData(const bridgeLib::SetSamplerate& _params) override;
@@ -25,23 +31,49 @@ namespace bridgeServer
 		void handleData(const bridgeLib::SetUnknownCustomData& _params) override;
 
 		void handleAudio(baseLib::BinaryStream& _in) override;
-		void sendDeviceState(synthLib::StateType _type);
+		// returns false if the packet has not been sent by this client
+		bool handleUdpAudio(const bridgeLib::UdpAudioPacket::Header& _header, baseLib::BinaryStream& _in, uint32_t _ip, int _port);
+		void sendDeviceState(synthLib::StateType _type, bool _fullState = false);
 		void handleRequestDeviceState(bridgeLib::RequestDeviceState& _requestDeviceState) override;
 		void handleDeviceState(bridgeLib::DeviceState& _in) override;
 		void handleDeviceState(baseLib::BinaryStream& _in) override;
+		void handleData(const bridgeLib::DeviceStateAck& _ack) override;
 		void handleException(const networkLib::NetException& _e) override;
 
 		const auto& getPluginDesc() const { return m_pluginDesc; }
+		const auto& getName() const { return m_name; }
+
+	protected:
+		float processJob() override;
+		bool getNextDeadline(Scheduler::Clock::time_point& _deadline) override;
 
 	private:
+		// an audio block that waits to be processed by the scheduler
+		struct AudioJob
+		{
+			std::vector<uint8_t> data;	// payload of an Audio command or a complete UDP audio packet
+			std::vector<synthLib::SMidiEvent> midi;
+			bool udp = false;
+			uint32_t ip = 0;
+			int port = 0;
+			Scheduler::Clock::time_point deadline;
+		};
+
 		void sendDeviceInfo();
 		void createDevice();
 		void destroyDevice();
 
 		void errorClose(bridgeLib::ErrorCode _code, const std::string& _err);
 
+		void queueAudioJob(baseLib::BinaryStream& _in, bool _udp, uint32_t _ip, int _port);
+		float processTcpAudio(AudioJob& _job);
+		float processUdpAudio(AudioJob& _job);
+		void processAudio(uint32_t _numSamples, std::vector<synthLib::SMidiEvent>& _midiIn);
+		float getAudioSeconds(uint32_t _numSamples) const;
+
 		Server& m_server;
 		std::string m_name;
+		const uint32_t m_peerIp;
 
 		bridgeLib::PluginDesc m_pluginDesc;
 		synthLib::DeviceCreateParams m_deviceCreateParams;
@@ -53,11 +85,28 @@ namespace bridgeServer
 
 		std::array<std::vector<float>, std::tuple_size_v<synthLib::TAudioInputs>> m_audioInputBuffers;
 		std::array<std::vector<float>, std::tuple_size_v<synthLib::TAudioOutputs>> m_audioOutputBuffers;
+		std::mutex m_mutexMidiIn;
 		std::vector<synthLib::SMidiEvent> m_midiIn;
 		std::vector<synthLib::SMidiEvent> m_midiOut;
 
 		bool m_romRequested = false;
 
 		std::mutex m_mutexDeviceState;
+		bridgeLib::DeviceStateSync m_deviceStateSync;
+		bridgeLib::DeviceStateDelta m_deviceStateDelta;
+
+		// the device is processed by the scheduler workers
+		std::mutex m_mutexDevice;
+		std::atomic<float> m_samplerate{0.0f};
+
+		// AUDIO JOBS
+		std::mutex m_mutexAudioJobs;
+		std::deque<AudioJob> m_audioJobs;
+		std::vector<AudioJob> m_audioJobPool;
+		baseLib::BinaryStream m_audioJobIn;
+
+		// UDP AUDIO
+		bridgeLib::UdpAudioPacket m_udpAudioReply;
+		bridgeLib::AudioCodec m_udpAudioCodec;
 	};
 }
@@ -11,7 +11,12 @@ namespace bridgeServer
 	Config::Config(int _argc, char** _argv)
 		: portTcp(bridgeLib::g_tcpServerPort)
 		, portUdp(bridgeLib::g_udpServerPort)
+		, portUdpAudio(bridgeLib::g_udpAudioPort)
 		, deviceStateRefreshMinutes(3)
+		, workerThreads(0)
+		, pinWorkerThreads(false)
+		, workerFirstCore(1)
+		, metricsLogSeconds(60)
 		, pluginsPath(getDefaultDataPath() + "plugins/")
 		, romsPath(getDefaultDataPath() + "roms/")
 	{
@@ -28,7 +33,12 @@ namespace bridgeServer
 
 		portTcp = config.getInt("tcpPort", static_cast<int>(portTcp));
 		portUdp = config.getInt("tcpPort", static_cast<int>(portUdp));
+		portUdpAudio = config.getInt("udpAudioPort", static_cast<int>(portUdpAudio));
 		deviceStateRefreshMinutes = config.getInt("deviceStateRefreshMinutes", static_cast<int>(deviceStateRefreshMinutes));
+		workerThreads = config.getInt("workerThreads", static_cast<int>(workerThreads));
+		pinWorkerThreads = config.getInt("pinWorkerThreads", pinWorkerThreads ? 1 : 0) != 0;
+		workerFirstCore = config.getInt("workerFirstCore", static_cast<int>(workerFirstCore));
+		metricsLogSeconds = config.getInt("metricsLogSeconds", static_cast<int>(metricsLogSeconds));
 		pluginsPath = config.get("pluginsPath", pluginsPath);
 		romsPath = config.get("romsPath", romsPath);
 
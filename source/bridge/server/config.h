@@ -11,7 +11,12 @@ namespace bridgeServer
 
 		uint32_t portTcp;
 		uint32_t portUdp;
+		uint32_t portUdpAudio;	// zero disables audio via UDP
 		uint32_t deviceStateRefreshMinutes;
+		uint32_t workerThreads;		// zero uses one worker per CPU core except one that is left to the network threads and the OS
+		bool pinWorkerThreads;
+		uint32_t workerFirstCore;	// pinned workers use the cores starting at this one, core 0 handles most interrupts
+		uint32_t metricsLogSeconds;	// zero disables logging of session metrics
 		std::string pluginsPath;
 		std::string romsPath;
 
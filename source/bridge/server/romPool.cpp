@@ -1,43 +1,161 @@
 #include "romPool.h"
 
+#include <cctype>
+#include <set>
+
 #include "config.h"
 
 #include "baseLib/filesystem.h"
-#include "baseLib/md5.h"
 
 #include "networkLib/logging.h"
 
+#include "synthLib/romIndex.h"
+
 namespace bridgeServer
 {
+	namespace
+	{
+		// ROMs received from clients are stored as <md5>.bin. Older versions stored them as <name>_<md5>.bin
+		bool getHashFromFilename(baseLib::MD5& _hash, const std::string& _file)
+		{
+			const auto name = baseLib::filesystem::stripExtension(baseLib::filesystem::getFilenameWithoutPath(_file));
+
+			if(name.size() < 32)
+				return false;
+
+			const auto pos = name.size() - 32;
+
+			if(pos > 0 && name[pos-1] != '_')
+				return false;
+
+			char digest[33]{};
+
+			for(size_t i=0; i<32; ++i)
+			{
+				const auto c = name[pos + i];
+				if(!std::isxdigit(static_cast<unsigned char>(c)))
+					return false;
+				digest[i] = c;
+			}
+
+			_hash = baseLib::MD5(digest);
+			return true;
+		}
+	}
+
 	RomPool::RomPool(Config& _config) : m_config(_config)
 	{
 		findRoms();
 	}
 
-	const RomData& RomPool::getRom(const baseLib::MD5& _hash)
+	synthLib::RomData::Ptr RomPool::getRom(const baseLib::MD5& _hash)
 	{
-		std::scoped_lock lock(m_mutex);
-
-		auto it = m_roms.find(_hash);
-		if(it == m_roms.end())
-			findRoms();
-		it = m_roms.find(_hash);
-		if(it != m_roms.end())
-			return it->second;
-		static RomData empty;
-		return empty;
+		std::string file;
+
+		{
+			std::scoped_lock lock(m_mutex);
+
+			auto it = m_files.find(_hash);
+
+			if(it == m_files.end())
+			{
+				findRoms();
+				it = m_files.find(_hash);
+			}
+
+			if(it == m_files.end())
+				return {};
+
+			file = it->second;
+		}
+
+		auto rom = synthLib::RomData::fromFile(file);
+
+		// The hash of the mapped image may have been taken from the index or the file name without looking at the
+		// content. Verify the content once before the ROM is handed out for the first time
+		bool verified;
+
+		{
+			std::scoped_lock lock(m_mutex);
+			verified = m_verified.find(_hash) != m_verified.end();
+		}
+
+		const auto contentHash = !rom || verified ? _hash : baseLib::MD5(rom->data(), static_cast<uint32_t>(rom->size()));
+
+		if(!rom || rom->getHash() != _hash || contentHash != _hash)
+		{
+			LOGNET(networkLib::LogLevel::Error, "ROM file " << file << " does not match its hash " << _hash.toString() << ", ignoring it");
+
+			// do not pick up the wrong hash from the index again
+			synthLib::RomIndex::Entry entry;
+
+			if(rom && baseLib::filesystem::getFileInfo(entry.fileInfo, file))
+			{
+				auto& index = synthLib::RomIndex::instance();
+				entry.hash = contentHash;
+				index.set(file, entry);
+				index.save();
+			}
+
+			std::scoped_lock lock(m_mutex);
+			m_files.erase(_hash);
+			return {};
+		}
+
+		{
+			std::scoped_lock lock(m_mutex);
+			m_verified.insert(_hash);
+		}
+
+		auto& index = synthLib::RomIndex::instance();
+
+		synthLib::RomIndex::Entry entry;
+
+		if(!index.get(entry, file) && baseLib::filesystem::getFileInfo(entry.fileInfo, file))
+		{
+			entry.hash = _hash;
+			index.set(file, entry);
+			index.save();
+		}
+
+		return rom;
 	}
 
-	void RomPool::addRom(const std::string& _name, const RomData& _data)
+	synthLib::RomData::Ptr RomPool::addRom(const std::string& _name, const std::vector<uint8_t>& _data)
 	{
-		std::scoped_lock lock(m_mutex);
-
 		const auto hash = baseLib::MD5(_data);
-		if(m_roms.find(hash) != m_roms.end())
-			return;
 
-		if(baseLib::filesystem::writeFile(getRootPath() + _name + '_' + hash.toString() + ".bin", _data))
-			m_roms.insert({hash, _data});
+		{
+			std::scoped_lock lock(m_mutex);
+
+			if(m_files.find(hash) == m_files.end())
+			{
+				const auto file = getRootPath() + hash.toString() + ".bin";
+
+				if(!baseLib::filesystem::writeFile(file, _data))
+				{
+					LOGNET(networkLib::LogLevel::Error, "Failed to write ROM " << _name << " to " << file);
+					return {};
+				}
+
+				// we just hashed the data, no need to do it again when the file is mapped
+				synthLib::RomIndex::Entry entry;
+
+				if(baseLib::filesystem::getFileInfo(entry.fileInfo, file))
+				{
+					auto& index = synthLib::RomIndex::instance();
+					entry.hash = hash;
+					index.set(file, entry);
+					index.save();
+				}
+
+				m_files.insert({hash, file});
+
+				LOGNET(networkLib::LogLevel::Info, "Stored ROM " << _name << " as " << baseLib::filesystem::getFilenameWithoutPath(file));
+			}
+		}
+
+		return getRom(hash);
 	}
 
 	std::string RomPool::getRootPath() const
@@ -50,23 +168,52 @@ namespace bridgeServer
 		std::vector<std::string> files;
 		baseLib::filesystem::findFiles(files, getRootPath(), {}, 0, 16 * 1024 * 1024);
 
+		std::set<std::string> knownFiles;
+
+		for (const auto& [hash, file] : m_files)
+			knownFiles.insert(file);
+
+		auto& index = synthLib::RomIndex::instance();
+
 		for (const auto& file : files)
 		{
-			std::vector<uint8_t> romData;
+			if(knownFiles.find(file) != knownFiles.end())
+				continue;
 
-			if(!baseLib::filesystem::readFile(romData, file))
+			baseLib::MD5 hash;
+			synthLib::RomIndex::Entry entry;
+
+			if(index.get(entry, file) && entry.hash != baseLib::MD5())
 			{
-				LOGNET(networkLib::LogLevel::Error, "Failed to load file " << file);
-				continue;
+				hash = entry.hash;
+			}
+			else if(!getHashFromFilename(hash, file))
+			{
+				// unknown file, needs to be hashed once. The mapping is released right away
+				const auto rom = synthLib::RomData::fromFile(file);
+
+				if(!rom)
+				{
+					LOGNET(networkLib::LogLevel::Error, "Failed to load file " << file);
+					continue;
+				}
+
+				hash = rom->getHash();
+
+				if(baseLib::filesystem::getFileInfo(entry.fileInfo, file))
+				{
+					entry.hash = hash;
+					index.set(file, entry);
+				}
 			}
 
-			const auto hash = baseLib::MD5(romData);
-
-			if(m_roms.find(hash) != m_roms.end())
+			if(m_files.find(hash) != m_files.end())
 				continue;
 
-			m_roms.insert({hash, std::move(romData)});
-			LOGNET(networkLib::LogLevel::Info, "Loaded ROM " << baseLib::filesystem::getFilenameWithoutPath(file));
+			m_files.insert({hash, file});
+			LOGNET(networkLib::LogLevel::Info, "Indexed ROM " << baseLib::filesystem::getFilenameWithoutPath(file));
 		}
+
+		index.save();
 	}
 }
@@ -3,26 +3,27 @@
 #include <cstdint>
 #include <map>
 #include <mutex>
+#include <set>
 #include <vector>
 #include <string>
 
-namespace baseLib
-{
-	class MD5;
-}
+#include "baseLib/md5.h"
+
+#include "synthLib/romData.h"
 
 namespace bridgeServer
 {
 	struct Config;
-	using RomData = std::vector<uint8_t>;
 
+	// ROMs stored on disk, content-addressed by their MD5 hash. Files are indexed without loading them and are memory
+	// mapped on demand. All sessions using the same ROM share the same immutable image
 	class RomPool
 	{
 	public:
 		RomPool(Config& _config);
 
-		const RomData& getRom(const baseLib::MD5& _hash);
-		void addRom(const std::string& _name, const RomData& _data);
+		synthLib::RomData::Ptr getRom(const baseLib::MD5& _hash);
+		synthLib::RomData::Ptr addRom(const std::string& _name, const std::vector<uint8_t>& _data);
 
 	private:
 		std::string getRootPath() const;
@@ -31,6 +32,7 @@ namespace bridgeServer
 		const Config& m_config;
 
 		std::mutex m_mutex;
-		std::map<baseLib::MD5, RomData> m_roms;
+		std::map<baseLib::MD5, std::string> m_files;
+		std::set<baseLib::MD5> m_verified;	// hashes whose file content has been verified
 	};
 }
@@ -0,0 +1,212 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#include <string>
+
+#include "dsp56kBase/threadtools.h"
+
+#include "networkLib/logging.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace bridgeServer
+{
+	namespace
+	{
+		// smoothing factor for the load and queue delay metrics
+		constexpr float g_metricsSmoothing = 0.05f;
+
+		bool pinCurrentThread(const uint32_t _core)
+		{
+#ifdef _WIN32
+			if(_core >= sizeof(DWORD_PTR) * 8)
+				return false;
+			return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << _core) != 0;
+#elif defined(__linux__)
+			if(_core >= CPU_SETSIZE)
+				return false;
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(_core, &set);
+			return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+			// macOS only supports affinity hints, leave placement to the OS
+			return false;
+#endif
+		}
+	}
+
+	Scheduler::Scheduler(uint32_t _threadCount, const bool _pinThreads, const uint32_t _firstCore)
+	{
+		const auto coreCount = std::max(1u, std::thread::hardware_concurrency());
+
+		// workers run at the highest priority, leave one core to the network threads and the OS
+		if(!_threadCount)
+			_threadCount = std::max(1u, coreCount - 1);
+
+		// pinning more workers than there are cores left would put two workers on the same core
+		const auto pin = _pinThreads && _firstCore < coreCount && _threadCount <= coreCount - _firstCore;
+
+		if(_pinThreads && !pin)
+			LOGNET(networkLib::LogLevel::Warning, "Not pinning " << _threadCount << " worker threads, only " << (_firstCore < coreCount ? coreCount - _firstCore : 0) << " cores available starting at core " << _firstCore);
+
+		LOGNET(networkLib::LogLevel::Info, "Starting " << _threadCount << " worker threads" << (pin ? ", pinned to cores starting at core " + std::to_string(_firstCore) : std::string()));
+
+		m_threads.reserve(_threadCount);
+
+		for(uint32_t i=0; i<_threadCount; ++i)
+		{
+			const auto core = pin ? static_cast<int32_t>(_firstCore + i) : -1;
+			m_threads.emplace_back(new std::thread([this, i, core] { threadFunc(i, core); }));
+		}
+	}
+
+	Scheduler::~Scheduler()
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_exit = true;
+		}
+
+		m_cvWork.notify_all();
+
+		for (const auto& t : m_threads)
+			t->join();
+
+		m_threads.clear();
+	}
+
+	void Scheduler::schedule(Session& _session, const Clock::time_point _deadline)
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+
+			switch (_session.m_state)
+			{
+			case Session::State::Idle:
+				enqueue(_session, _deadline, Clock::now());
+				break;
+			case Session::State::Queued:
+				// the deadline of the oldest job is the one that counts, jobs are processed in order
+				break;
+			case Session::State::Running:
+				// the worker checks for more jobs once it is done with the current one
+				return;
+			}
+		}
+
+		m_cvWork.notify_one();
+	}
+
+	void Scheduler::remove(Session& _session)
+	{
+		std::unique_lock lock(m_mutex);
+
+		m_cvIdle.wait(lock, [&_session] { return _session.m_state != Session::State::Running; });
+
+		m_runQueue.erase(std::remove(m_runQueue.begin(), m_runQueue.end(), &_session), m_runQueue.end());
+
+		_session.m_state = Session::State::Idle;
+	}
+
+	Scheduler::Metrics Scheduler::getMetrics(const Session& _session, const bool _resetPeak)
+	{
+		std::scoped_lock lock(m_mutex);
+
+		auto& m = const_cast<Session&>(_session).m_metrics;
+		const auto res = m;
+
+		if(_resetPeak)
+			m.loadPeak = 0.0f;
+
+		return res;
+	}
+
+	void Scheduler::threadFunc(const uint32_t _index, const int32_t _core)
+	{
+		dsp56k::ThreadTools::setCurrentThreadName("BridgeWorker" + std::to_string(_index));
+		dsp56k::ThreadTools::setCurrentThreadPriority(dsp56k::ThreadPriority::Highest);
+
+		if(_core >= 0 && !pinCurrentThread(static_cast<uint32_t>(_core)))
+			LOGNET(networkLib::LogLevel::Warning, "Failed to pin worker thread " << _index << " to core " << _core);
+
+		std::unique_lock lock(m_mutex);
+
+		while(true)
+		{
+			m_cvWork.wait(lock, [this] { return m_exit || !m_runQueue.empty(); });
+
+			if(m_exit)
+				return;
+
+			// earliest deadline first
+			const auto it = std::min_element(m_runQueue.begin(), m_runQueue.end(), [](const Session* _a, const Session* _b)
+			{
+				return _a->m_deadline < _b->m_deadline;
+			});
+
+			auto& session = **it;
+
+			*it = m_runQueue.back();
+			m_runQueue.pop_back();
+
+			session.m_state = Session::State::Running;
+
+			const auto deadline = session.m_deadline;
+			const auto readyTime = session.m_readyTime;
+
+			lock.unlock();
+
+			const auto tStart = Clock::now();
+			const auto audioSeconds = session.processJob();
+			const auto tEnd = Clock::now();
+
+			lock.lock();
+
+			if(audioSeconds > 0.0f)
+			{
+				const auto processingSeconds = std::chrono::duration<float>(tEnd - tStart).count();
+				const auto queueDelayMs = std::chrono::duration<float, std::milli>(tStart - readyTime).count();
+				const auto load = processingSeconds / audioSeconds;
+
+				auto& m = session.m_metrics;
+
+				++m.jobCount;
+
+				if(tEnd > deadline)
+					++m.deadlineMisses;
+
+				m.processingSeconds += processingSeconds;
+				m.audioSeconds += audioSeconds;
+				m.load += (load - m.load) * g_metricsSmoothing;
+				m.loadPeak = std::max(m.loadPeak, load);
+				m.queueDelayMs += (queueDelayMs - m.queueDelayMs) * g_metricsSmoothing;
+			}
+
+			session.m_state = Session::State::Idle;
+
+			// a job that is added while we check here calls schedule() after we released the lock and is picked up there
+			Clock::time_point nextDeadline;
+
+			if(session.getNextDeadline(nextDeadline))
+				enqueue(session, nextDeadline, tEnd);
+
+			m_cvIdle.notify_all();
+		}
+	}
+
+	void Scheduler::enqueue(Session& _session, const Clock::time_point _deadline, const Clock::time_point _now)
+	{
+		_session.m_state = Session::State::Queued;
+		_session.m_deadline = _deadline;
+		_session.m_readyTime = _now;
+
+		m_runQueue.push_back(&_session);
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bridgeServer
+{
+	// Runs the device processing of all client sessions on a fixed pool of worker threads. Sessions are picked
+	// earliest deadline first and a session is never processed by more than one worker at a time
+	class Scheduler
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		struct Metrics
+		{
+			uint64_t jobCount = 0;
+			uint64_t deadlineMisses = 0;
+			double processingSeconds = 0.0;	// total CPU time spent processing
+			double audioSeconds = 0.0;		// total duration of the processed audio
+			float load = 0.0f;				// processing time relative to the audio duration, smoothed
+			float loadPeak = 0.0f;			// highest load of a single job since the metrics have been reset
+			float queueDelayMs = 0.0f;		// time between the job becoming ready and a worker picking it up, smoothed
+		};
+
+		class Session
+		{
+		public:
+			virtual ~Session() = default;
+
+		protected:
+			// processes the oldest pending job, returns the duration of the processed audio in seconds
+			virtual float processJob() = 0;
+
+			// returns true if there are more jobs pending, _deadline receives the deadline of the oldest one
+			virtual bool getNextDeadline(Clock::time_point& _deadline) = 0;
+
+		private:
+			friend class Scheduler;
+
+			enum class State
+			{
+				Idle,
+				Queued,
+				Running
+			};
+
+			// guarded by the scheduler mutex
+			State m_state = State::Idle;
+			Clock::time_point m_deadline;
+			Clock::time_point m_readyTime;
+			Metrics m_metrics;
+		};
+
+		Scheduler(uint32_t _threadCount, bool _pinThreads, uint32_t _firstCore);
+		~Scheduler();
+
+		Scheduler(const Scheduler&) = delete;
+		Scheduler(Scheduler&&) = delete;
+		Scheduler& operator = (const Scheduler&) = delete;
+		Scheduler& operator = (Scheduler&&) = delete;
+
+		// called by a session when a job has been added, _deadline is the time at which the result needs to be ready
+		void schedule(Session& _session, Clock::time_point _deadline);
+
+		// waits until no worker processes the session anymore and removes it from the run queue
+		void remove(Session& _session);
+
+		Metrics getMetrics(const Session& _session, bool _resetPeak = false);
+
+		size_t getThreadCount() const { return m_threads.size(); }
+
+	private:
+		void threadFunc(uint32_t _index, int32_t _core);
+		void enqueue(Session& _session, Clock::time_point _deadline, Clock::time_point _now);
+
+		std::mutex m_mutex;
+		std::condition_variable m_cvWork;
+		std::condition_variable m_cvIdle;
+
+		// sessions that are waiting for a worker, unordered, the earliest deadline is searched when a worker picks
+		// the next one. Linear search is fine for the number of sessions a single server can handle
+		std::vector<Session*> m_runQueue;
+
+		std::vector<std::unique_ptr<std::thread>> m_threads;
+		bool m_exit = false;
+	};
+}
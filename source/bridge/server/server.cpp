@@ -11,9 +11,13 @@ namespace bridgeServer
 		: m_config(_argc, _argv)
 		, m_plugins(m_config)
 		, m_romPool(m_config)
+		, m_scheduler(m_config.workerThreads, m_config.pinWorkerThreads, m_config.workerFirstCore)
+		, m_udpServer(m_config.portUdpAudio)
 		, m_tcpServer([this](std::unique_ptr<networkLib::TcpStream> _stream){onClientConnected(std::move(_stream));}
 		, bridgeLib::g_tcpServerPort)
+		, m_udpAudioServer(*this, m_config.portUdpAudio)
 		, m_lastDeviceStateUpdate(std::chrono::system_clock::now())
+		, m_lastMetricsLog(m_lastDeviceStateUpdate)
 	{
 	}
 
@@ -21,6 +25,8 @@ namespace bridgeServer
 	{
 		exit(true);
 		m_cvWait.notify_one();
+
+		std::scoped_lock lock(m_mutexClients);
 		m_clients.clear();
 	}
 
@@ -33,6 +39,7 @@ namespace bridgeServer
 
 			cleanupClients();
 			doPeriodicDeviceStateUpdate();
+			logSessionMetrics();
 		}
 	}
 
@@ -40,9 +47,10 @@ namespace bridgeServer
 	{
 		const auto s = _stream->getPtypesStream();
 		const std::string name = std::string(ptypes::iptostring(s->get_ip())) + ":" + std::to_string(s->get_port());
+		const auto ip = static_cast<uint32_t>(static_cast<ptypes::ulong>(s->get_ip()));
 
 		std::scoped_lock lock(m_mutexClients);
-		m_clients.emplace_back(std::make_unique<ClientConnection>(*this, std::move(_stream), name));
+		m_clients.emplace_back(std::make_unique<ClientConnection>(*this, std::move(_stream), name, ip));
 	}
 
 	void Server::onClientException(const ClientConnection&, const networkLib::NetException& _e)
@@ -50,6 +58,20 @@ namespace bridgeServer
 		m_cvWait.notify_one();
 	}
 
+	void Server::onUdpAudio(const bridgeLib::UdpAudioPacket::Header& _header, baseLib::BinaryStream& _in, const uint32_t _ip, const int _port)
+	{
+		std::scoped_lock lock(m_mutexClients);
+
+		for (const auto& c : m_clients)
+		{
+			if(c->getPluginDesc().sessionId != _header.sessionId || !c->isValid())
+				continue;
+
+			if(c->handleUdpAudio(_header, _in, _ip, _port))
+				return;
+		}
+	}
+
 	void Server::exit(const bool _exit)
 	{
 		m_exit = _exit;
@@ -110,4 +132,34 @@ namespace bridgeServer
 		for (const auto& c : m_clients)
 			c->sendDeviceState(synthLib::StateTypeGlobal);
 	}
+
+	void Server::logSessionMetrics()
+	{
+		if(!m_config.metricsLogSeconds)
+			return;
+
+		const auto now = std::chrono::system_clock::now();
+
+		const auto diff = std::chrono::duration_cast<std::chrono::seconds>(now - m_lastMetricsLog);
+
+		if(diff.count() < static_cast<int>(m_config.metricsLogSeconds))
+			return;
+
+		m_lastMetricsLog = now;
+
+		std::scoped_lock lock(m_mutexClients);
+
+		for (const auto& c : m_clients)
+		{
+			const auto m = m_scheduler.getMetrics(*c, true);
+
+			if(!m.jobCount)
+				continue;
+
+			const auto avgLoad = m.audioSeconds > 0.0 ? m.processingSeconds / m.audioSeconds : 0.0;
+
+			LOGNET(networkLib::LogLevel::Info, c->getName() << ": load " << (m.load * 100.0f) << "% (avg " << (avgLoad * 100.0) << "%, peak " << (m.loadPeak * 100.0f) << "%), "
+				<< m.jobCount << " blocks, " << m.deadlineMisses << " deadline misses, queue delay " << m.queueDelayMs << " ms");
+		}
+	}
 }
@@ -9,6 +9,8 @@
 #include "config.h"
 #include "import.h"
 #include "romPool.h"
+#include "scheduler.h"
+#include "udpAudioServer.h"
 #include "udpServer.h"
 #include "networkLib/tcpServer.h"
 
@@ -29,18 +31,26 @@ namespace bridgeServer
 
 		auto& getPlugins() { return m_plugins; }
 		auto& getRomPool() { return m_romPool; }
+		auto& getScheduler() { return m_scheduler; }
+		const auto& getUdpAudioServer() const { return m_udpAudioServer; }
+
+		void onUdpAudio(const bridgeLib::UdpAudioPacket::Header& _header, baseLib::BinaryStream& _in, uint32_t _ip, int _port);
 
 		bridgeLib::DeviceState getCachedDeviceState(const bridgeLib::SessionId& _id);
 
 	private:
 		void cleanupClients();
 		void doPeriodicDeviceStateUpdate();
+		void logSessionMetrics();
 
 		Config m_config;
 
 		Import m_plugins;
 		RomPool m_romPool;
 
+		// processes the devices of m_clients, needs to be destroyed after them
+		Scheduler m_scheduler;
+
 		UdpServer m_udpServer;
 		networkLib::TcpServer m_tcpServer;
 
@@ -48,10 +58,14 @@ namespace bridgeServer
 		std::list<std::unique_ptr<ClientConnection>> m_clients;
 		std::map<bridgeLib::SessionId, bridgeLib::DeviceState> m_cachedDeviceStates;
 
+		// dispatches to m_clients, needs to be destroyed first
+		UdpAudioServer m_udpAudioServer;
+
 		bool m_exit = false;
 
 		std::mutex m_cvWaitMutex;
 		std::condition_variable m_cvWait;
 		std::chrono::system_clock::time_point m_lastDeviceStateUpdate;
+		std::chrono::system_clock::time_point m_lastMetricsLog;
 	};
 }
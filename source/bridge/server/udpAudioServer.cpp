@@ -0,0 +1,73 @@
+#include "udpAudioServer.h"
+
+#include "server.h"
+
+#include "networkLib/logging.h"
+
+#include "ptypes/pinet.h"
+
+namespace bridgeServer
+{
+	UdpAudioServer::UdpAudioServer(Server& _server, const uint32_t _port)
+		: m_server(_server)
+		, m_port(_port)
+		, m_socket(std::make_unique<ptypes::ipmsgserver>())
+	{
+		if(!m_port)
+			return;
+
+		m_socket->bindall(static_cast<int>(m_port));
+		start();
+	}
+
+	UdpAudioServer::~UdpAudioServer()
+	{
+		stop();
+	}
+
+	void UdpAudioServer::send(bridgeLib::UdpAudioPacket& _packet, const uint32_t _ip, const int _port) const
+	{
+		try
+		{
+			m_socket->sendto(reinterpret_cast<const char*>(_packet.data()), static_cast<int>(_packet.size()), ptypes::ipaddress(static_cast<ptypes::ulong>(_ip)), _port);
+		}
+		catch(ptypes::exception* e)  // NOLINT(misc-throw-by-value-catch-by-reference)
+		{
+			// the client conceals the lost packet
+			delete e;
+		}
+	}
+
+	void UdpAudioServer::threadFunc()
+	{
+		LOGNET(networkLib::LogLevel::Info, "UDP audio server started on port " << m_port);
+
+		while(!exit())
+		{
+			try
+			{
+				if(!m_socket->poll(-1, 100))
+					continue;
+
+				const auto count = m_socket->receive(reinterpret_cast<char*>(m_receivePacket.prepareReceive()), static_cast<int>(bridgeLib::UdpAudioPacket::MaxSize));
+
+				if(count <= 0)
+					continue;
+
+				bridgeLib::UdpAudioPacket::Header header;
+
+				if(!m_receivePacket.onReceived(static_cast<uint32_t>(count), header))
+					continue;
+
+				m_server.onUdpAudio(header, m_receivePacket.getStream(), static_cast<uint32_t>(static_cast<ptypes::ulong>(m_socket->get_ip())), m_socket->get_port());
+			}
+			catch(ptypes::exception* e)  // NOLINT(misc-throw-by-value-catch-by-reference)
+			{
+				LOGNET(networkLib::LogLevel::Warning, "UDP audio network exception: " << static_cast<const char*>(e->get_message()));
+				delete e;
+			}
+		}
+
+		LOGNET(networkLib::LogLevel::Info, "UDP audio server terminated");
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "bridgeLib/udpAudioPacket.h"
+
+#include "networkLib/networkThread.h"
+
+namespace ptypes
+{
+	class ipmsgserver;
+}
+
+namespace bridgeServer
+{
+	class Server;
+
+	// Receives audio packets of all clients that use the UDP audio transport and forwards them to their client connection
+	class UdpAudioServer : networkLib::NetworkThread
+	{
+	public:
+		UdpAudioServer(Server& _server, uint32_t _port);
+		~UdpAudioServer();
+
+		UdpAudioServer(const UdpAudioServer&) = delete;
+		UdpAudioServer(UdpAudioServer&&) = delete;
+		UdpAudioServer& operator = (const UdpAudioServer&) = delete;
+		UdpAudioServer& operator = (UdpAudioServer&&) = delete;
+
+		uint32_t getPort() const { return m_port; }
+
+		// thread-safe, called by client connections to send their replies
+		void send(bridgeLib::UdpAudioPacket& _packet, uint32_t _ip, int _port) const;
+
+	protected:
+		void threadFunc() override;
+
+	private:
+		Server& m_server;
+		const uint32_t m_port;
+		std::unique_ptr<ptypes::ipmsgserver> m_socket;
+		bridgeLib::UdpAudioPacket m_receivePacket;
+	};
+}
@@ -7,7 +7,7 @@
 
 namespace bridgeServer
 {
-	UdpServer::UdpServer() : networkLib::UdpServer(bridgeLib::g_udpServerPort)
+	UdpServer::UdpServer(const uint32_t _portUdpAudio) : networkLib::UdpServer(bridgeLib::g_udpServerPort), m_portUdpAudio(_portUdpAudio)
 	{
 	}
 
@@ -57,6 +57,7 @@ namespace bridgeServer
 			si.protocolVersion = bridgeLib::g_protocolVersion;
 			si.portTcp = bridgeLib::g_tcpServerPort;
 			si.portUdp = bridgeLib::g_udpServerPort;
+			si.portUdpAudio = m_portUdpAudio;
 			si.write(w.build(bridgeLib::Command::ServerInfo));
 		}
 		else
@@ -7,8 +7,11 @@ namespace bridgeServer
 	class UdpServer : public networkLib::UdpServer
 	{
 	public:
-		UdpServer();
+		UdpServer(uint32_t _portUdpAudio);
 
 		std::vector<uint8_t> validateRequest(const std::vector<uint8_t>& _request) override;
+
+	private:
+		const uint32_t m_portUdpAudio;
 	};
 }
@@ -0,0 +1,193 @@
+#include "benchmark.h"
+
+#include "cpuTime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "synthLib/device.h"
+#include "synthLib/deviceException.h"
+
+namespace deviceBenchmark
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		constexpr double g_defaultSeconds = 30.0;
+		constexpr double g_releaseTailSeconds = 2.0;
+
+		double percentile(const std::vector<double>& _sorted, const double _p)
+		{
+			if(_sorted.empty())
+				return 0.0;
+			const auto idx = static_cast<size_t>(std::ceil(_p * static_cast<double>(_sorted.size()))) - 1;
+			return _sorted[std::min(idx, _sorted.size() - 1)];
+		}
+	}
+
+	Benchmark::Benchmark(Config _config) : m_config(std::move(_config))
+	{
+		m_result.deviceType = m_config.device.type;
+		m_result.blockSize = m_config.blockSize;
+	}
+
+	Benchmark::~Benchmark() = default;
+
+	bool Benchmark::prepare(std::string& _error)
+	{
+		if(!m_config.midiFile.empty())
+		{
+			MidiFile file;
+			if(!file.load(m_config.midiFile))
+			{
+				_error = "Failed to load midi file " + m_config.midiFile;
+				return false;
+			}
+			m_midiEvents = file.getEvents();
+		}
+
+		const auto t0 = Clock::now();
+
+		try
+		{
+			m_device = DeviceFactory::create(m_config.device, _error);
+		}
+		catch(synthLib::DeviceException& e)
+		{
+			_error = e.what();
+			return false;
+		}
+
+		if(!m_device)
+			return false;
+
+		if(!m_device->isValid())
+		{
+			_error = "Device " + m_config.device.type + " is not valid, ROM missing or unsupported";
+			m_device.reset();
+			return false;
+		}
+
+		m_result.bootSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+		m_result.samplerate = m_device->getSamplerate();
+		m_result.channelCountOut = m_device->getChannelCountOut();
+
+		// every input and output gets a buffer, devices may write to channels that are not reported
+		m_inputBuffers.resize(m_inputs.size());
+		m_outputBuffers.resize(m_outputs.size());
+
+		for(size_t i=0; i<m_inputs.size(); ++i)
+		{
+			m_inputBuffers[i].resize(m_config.blockSize, 0.0f);
+			m_inputs[i] = m_inputBuffers[i].data();
+		}
+
+		for(size_t i=0; i<m_outputs.size(); ++i)
+		{
+			m_outputBuffers[i].resize(m_config.blockSize, 0.0f);
+			m_outputs[i] = m_outputBuffers[i].data();
+		}
+
+		// determine run length
+		auto seconds = m_config.seconds;
+
+		if(seconds <= 0.0)
+		{
+			if(m_midiEvents.empty())
+				seconds = g_defaultSeconds;
+			else
+				seconds = m_midiEvents.back().seconds + g_releaseTailSeconds;
+		}
+
+		if(m_midiEvents.empty())
+			m_midiEvents = MidiFile::createDefaultPattern(seconds);
+
+		const auto sr = static_cast<double>(m_result.samplerate);
+
+		m_midiEventSamples.reserve(m_midiEvents.size());
+		for (const auto& e : m_midiEvents)
+			m_midiEventSamples.push_back(static_cast<uint64_t>(std::llround(e.seconds * sr)));
+
+		m_samplesTotal = static_cast<uint64_t>(std::llround(seconds * sr));
+
+		m_midiIn.reserve(256);
+		m_midiOut.reserve(256);
+
+		// warmup, gives the JIT the chance to translate the hot code paths before we start measuring
+		const auto warmupSamples = static_cast<uint64_t>(std::llround(m_config.warmupSeconds * sr));
+
+		for(uint64_t s=0; s<warmupSamples; s += m_config.blockSize)
+		{
+			m_midiIn.clear();
+			m_device->process(m_inputs, m_outputs, m_config.blockSize, m_midiIn, m_midiOut);
+		}
+
+		return true;
+	}
+
+	const Benchmark::Result& Benchmark::run()
+	{
+		if(!m_device)
+			return m_result;
+
+		const auto blockCount = (m_samplesTotal + m_config.blockSize - 1) / m_config.blockSize;
+
+		std::vector<double> blockTimes;
+		blockTimes.reserve(blockCount);
+
+		m_nextMidiEvent = 0;
+
+		const auto cpuStart = CpuTime::getCurrentThreadSeconds();
+		const auto tStart = Clock::now();
+
+		for(uint64_t b=0; b<blockCount; ++b)
+		{
+			const auto t0 = Clock::now();
+			processBlock(b * m_config.blockSize);
+			const auto t1 = Clock::now();
+
+			blockTimes.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+		}
+
+		const auto tEnd = Clock::now();
+
+		m_result.threadCpuSeconds = CpuTime::getCurrentThreadSeconds() - cpuStart;
+		m_result.blockCount = blockCount;
+		m_result.audioSeconds = static_cast<double>(blockCount * m_config.blockSize) / static_cast<double>(m_result.samplerate);
+		m_result.wallSeconds = std::chrono::duration<double>(tEnd - tStart).count();
+		m_result.realtimeFactor = m_result.wallSeconds > 0.0 ? m_result.audioSeconds / m_result.wallSeconds : 0.0;
+		m_result.blockDeadline = 1000000.0 * static_cast<double>(m_config.blockSize) / static_cast<double>(m_result.samplerate);
+		m_result.blockOverruns = static_cast<uint64_t>(std::count_if(blockTimes.begin(), blockTimes.end(), [this](const double _t)
+		{
+			return _t > m_result.blockDeadline;
+		}));
+
+		std::sort(blockTimes.begin(), blockTimes.end());
+
+		m_result.blockP50 = percentile(blockTimes, 0.5);
+		m_result.blockP99 = percentile(blockTimes, 0.99);
+		m_result.blockMax = blockTimes.empty() ? 0.0 : blockTimes.back();
+
+		return m_result;
+	}
+
+	void Benchmark::processBlock(const uint64_t _blockStart)
+	{
+		m_midiIn.clear();
+
+		const auto blockEnd = _blockStart + m_config.blockSize;
+
+		while(m_nextMidiEvent < m_midiEvents.size() && m_midiEventSamples[m_nextMidiEvent] < blockEnd)
+		{
+			auto& ev = m_midiIn.emplace_back(m_midiEvents[m_nextMidiEvent].event);
+			ev.offset = static_cast<uint32_t>(std::max(m_midiEventSamples[m_nextMidiEvent], _blockStart) - _blockStart);
+			++m_nextMidiEvent;
+		}
+
+		m_result.midiEventsSent += m_midiIn.size();
+
+		m_device->process(m_inputs, m_outputs, m_config.blockSize, m_midiIn, m_midiOut);
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "deviceFactory.h"
+#include "midiFile.h"
+
+#include "synthLib/audioTypes.h"
+
+namespace synthLib
+{
+	class Device;
+}
+
+namespace deviceBenchmark
+{
+	class Benchmark
+	{
+	public:
+		struct Config
+		{
+			DeviceFactory::Params device;
+			uint32_t blockSize = 64;
+			double seconds = 0.0;			// length of the measured run, 0 = length of the midi stream plus release tail
+			double warmupSeconds = 1.0;		// processed after boot but excluded from the statistics
+			std::string midiFile;			// standard midi file to replay, a default note pattern is used if empty
+		};
+
+		struct Result
+		{
+			std::string deviceType;
+			float samplerate = 0.0f;
+			uint32_t blockSize = 0;
+			uint32_t channelCountOut = 0;
+
+			double bootSeconds = 0.0;
+			double audioSeconds = 0.0;
+			double wallSeconds = 0.0;
+			double realtimeFactor = 0.0;	// audio time / wall time, > 1 means faster than real time
+
+			// per-block wall time in microseconds
+			double blockDeadline = 0.0;
+			double blockP50 = 0.0;
+			double blockP99 = 0.0;
+			double blockMax = 0.0;
+			uint64_t blockCount = 0;
+			uint64_t blockOverruns = 0;
+
+			uint64_t midiEventsSent = 0;
+
+			double threadCpuSeconds = 0.0;	// CPU time of the thread that called run(), measured while running
+		};
+
+		explicit Benchmark(Config _config);
+		~Benchmark();
+
+		Benchmark(const Benchmark&) = delete;
+		Benchmark(Benchmark&&) = delete;
+		Benchmark& operator = (const Benchmark&) = delete;
+		Benchmark& operator = (Benchmark&&) = delete;
+
+		// creates and boots the device, then runs the warmup. Returns false and fills _error on failure
+		bool prepare(std::string& _error);
+
+		// replays the midi stream and measures every block
+		const Result& run();
+
+		const Result& getResult() const { return m_result; }
+
+	private:
+		void processBlock(uint64_t _blockStart);
+
+		const Config m_config;
+
+		std::unique_ptr<synthLib::Device> m_device;
+
+		std::vector<MidiFile::Event> m_midiEvents;
+		std::vector<uint64_t> m_midiEventSamples;
+		size_t m_nextMidiEvent = 0;
+
+		std::vector<std::vector<float>> m_inputBuffers;
+		std::vector<std::vector<float>> m_outputBuffers;
+		synthLib::TAudioInputs m_inputs{};
+		synthLib::TAudioOutputs m_outputs{};
+
+		std::vector<synthLib::SMidiEvent> m_midiIn;
+		std::vector<synthLib::SMidiEvent> m_midiOut;
+
+		uint64_t m_samplesTotal = 0;
+
+		Result m_result;
+	};
+}
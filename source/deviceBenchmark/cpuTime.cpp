@@ -0,0 +1,132 @@
+#include "cpuTime.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <fstream>
+#include <sstream>
+
+#include "baseLib/filesystem.h"
+#endif
+
+namespace deviceBenchmark
+{
+	double CpuTime::getProcessSeconds()
+	{
+#ifdef _WIN32
+		FILETIME creationTime, exitTime, kernelTime, userTime;
+		if(!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+			return 0.0;
+
+		auto toSeconds = [](const FILETIME& _ft)
+		{
+			const auto t = (static_cast<uint64_t>(_ft.dwHighDateTime) << 32) | _ft.dwLowDateTime;
+			return static_cast<double>(t) * 100e-9;
+		};
+		return toSeconds(kernelTime) + toSeconds(userTime);
+#else
+		rusage usage{};
+		if(getrusage(RUSAGE_SELF, &usage) != 0)
+			return 0.0;
+
+		auto toSeconds = [](const timeval& _tv)
+		{
+			return static_cast<double>(_tv.tv_sec) + static_cast<double>(_tv.tv_usec) * 1e-6;
+		};
+		return toSeconds(usage.ru_utime) + toSeconds(usage.ru_stime);
+#endif
+	}
+
+	double CpuTime::getCurrentThreadSeconds()
+	{
+#ifdef _WIN32
+		FILETIME creationTime, exitTime, kernelTime, userTime;
+		if(!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+			return 0.0;
+
+		auto toSeconds = [](const FILETIME& _ft)
+		{
+			const auto t = (static_cast<uint64_t>(_ft.dwHighDateTime) << 32) | _ft.dwLowDateTime;
+			return static_cast<double>(t) * 100e-9;
+		};
+		return toSeconds(kernelTime) + toSeconds(userTime);
+#else
+		timespec ts{};
+		if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+			return 0.0;
+
+		return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#endif
+	}
+
+	bool CpuTime::getThreadSeconds(ThreadTimes& _times)
+	{
+		_times.clear();
+
+#ifdef __linux__
+		std::vector<std::string> tasks;
+		if(!baseLib::filesystem::getDirectoryEntries(tasks, "/proc/self/task"))
+			return false;
+
+		const auto ticksPerSecond = static_cast<double>(sysconf(_SC_CLK_TCK));
+
+		for (const auto& task : tasks)
+		{
+			std::ifstream file(task + "/stat");
+			if(!file.is_open())
+				continue;
+
+			std::string line;
+			std::getline(file, line);
+
+			// format: pid (comm) state ppid ..., comm may contain spaces and parenthesis
+			const auto nameBegin = line.find('(');
+			const auto nameEnd = line.rfind(')');
+
+			if(nameBegin == std::string::npos || nameEnd == std::string::npos || nameEnd < nameBegin)
+				continue;
+
+			const auto name = line.substr(nameBegin + 1, nameEnd - nameBegin - 1);
+
+			std::stringstream ss(line.substr(nameEnd + 2));
+
+			// fields after comm start at index 3 (state), utime is field 14 and stime field 15
+			std::string field;
+			uint64_t utime = 0, stime = 0;
+
+			for(uint32_t i=3; i<=15 && (ss >> field); ++i)
+			{
+				if(i == 14)	utime = std::stoull(field);
+				if(i == 15)	stime = std::stoull(field);
+			}
+
+			_times[name] += static_cast<double>(utime + stime) / ticksPerSecond;
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	CpuTime::ThreadTimes CpuTime::diff(const ThreadTimes& _end, const ThreadTimes& _begin)
+	{
+		ThreadTimes res;
+
+		for (const auto& [name, seconds] : _end)
+		{
+			const auto it = _begin.find(name);
+			const auto d = it != _begin.end() ? seconds - it->second : seconds;
+			if(d > 0.0)
+				res.insert({name, d});
+		}
+
+		return res;
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace deviceBenchmark
+{
+	// CPU time accounting. The emulators name their threads (DSP, MC68331, JE8086, ...), so per-thread times grouped by name give the time spent per emulated core
+	class CpuTime
+	{
+	public:
+		using ThreadTimes = std::map<std::string, double>;	// thread name => seconds
+
+		// user + system time of the whole process in seconds
+		static double getProcessSeconds();
+
+		// user + system time of all threads of the process, summed up per thread name. Only supported on Linux, returns false otherwise
+		static bool getThreadSeconds(ThreadTimes& _times);
+
+		// user + system time of the calling thread in seconds. Threads that exit during a measurement are no longer listed by getThreadSeconds()
+		static double getCurrentThreadSeconds();
+
+		static ThreadTimes diff(const ThreadTimes& _end, const ThreadTimes& _begin);
+	};
+}
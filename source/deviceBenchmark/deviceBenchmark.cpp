@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#include "benchmark.h"
+#include "cpuTime.h"
+#include "deviceFactory.h"
+
+#include "baseLib/commandline.h"
+#include "baseLib/filesystem.h"
+
+#include "dsp56kBase/threadtools.h"
+
+using namespace deviceBenchmark;
+
+namespace
+{
+	void printUsage()
+	{
+		std::cout << "Usage: deviceBenchmark -device <type|all> [options]\n"
+			<< "\n"
+			<< "Options:\n"
+			<< "  -device <type>       device to benchmark, 'all' runs every supported device type\n"
+			<< "  -rom <file>          ROM file to use, default is to search the regular ROM locations\n"
+			<< "  -midi <file>         standard midi file to replay, default is a built-in note pattern\n"
+			<< "  -blocksize <n>       block size in samples, default 64\n"
+			<< "  -samplerate <hz>     preferred device samplerate, default is the device default\n"
+			<< "  -seconds <s>         length of the measured run, default is the midi file length or 30s\n"
+			<< "  -warmup <s>          unmeasured warmup after boot, default 1s\n"
+			<< "  -instances <n>       number of device instances that run concurrently, default 1\n"
+			<< "  -csv <file>          append one line of results per device type to the given file\n"
+			<< "\n"
+			<< "Supported device types:";
+
+		for (const auto& type : DeviceFactory::getSupportedTypes())
+			std::cout << ' ' << type;
+
+		std::cout << '\n';
+	}
+
+	void printResult(const Benchmark::Result& _r, const size_t _instance)
+	{
+		std::cout << std::fixed << std::setprecision(2)
+			<< "  instance " << _instance
+			<< ": boot " << _r.bootSeconds << "s"
+			<< ", audio " << _r.audioSeconds << "s in " << _r.wallSeconds << "s"
+			<< ", realtime factor " << _r.realtimeFactor << "x"
+			<< ", block p50 " << _r.blockP50 << "us p99 " << _r.blockP99 << "us max " << _r.blockMax << "us"
+			<< " (deadline " << _r.blockDeadline << "us, " << _r.blockOverruns << "/" << _r.blockCount << " overruns)"
+			<< ", " << _r.midiEventsSent << " midi events\n";
+	}
+
+	bool runDevice(const baseLib::CommandLine& _cmd, const std::string& _type, std::ofstream& _csv)
+	{
+		const auto instanceCount = static_cast<size_t>(std::max(1, _cmd.getInt("instances", 1)));
+
+		Benchmark::Config config;
+
+		config.device.type = _type;
+		config.device.romFile = _cmd.get("rom");
+		config.device.samplerate = _cmd.getFloat("samplerate", 0.0f);
+		config.blockSize = static_cast<uint32_t>(std::max(1, _cmd.getInt("blocksize", 64)));
+		config.seconds = _cmd.getFloat("seconds", 0.0f);
+		config.warmupSeconds = _cmd.getFloat("warmup", 1.0f);
+		config.midiFile = _cmd.get("midi");
+
+		std::cout << "Device " << _type << ", " << instanceCount << " instance(s), block size " << config.blockSize << '\n';
+
+		std::vector<std::unique_ptr<Benchmark>> benchmarks;
+
+		for(size_t i=0; i<instanceCount; ++i)
+		{
+			auto& b = benchmarks.emplace_back(std::make_unique<Benchmark>(config));
+
+			std::string error;
+			if(!b->prepare(error))
+			{
+				std::cout << "  failed to create device: " << error << '\n';
+				return false;
+			}
+		}
+
+		CpuTime::ThreadTimes threadTimesBegin, threadTimesEnd;
+		const auto hasThreadTimes = CpuTime::getThreadSeconds(threadTimesBegin);
+		const auto cpuBegin = CpuTime::getProcessSeconds();
+
+		if(benchmarks.size() == 1)
+		{
+			benchmarks.front()->run();
+		}
+		else
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(benchmarks.size());
+
+			for(size_t i=0; i<benchmarks.size(); ++i)
+			{
+				threads.emplace_back([&b = *benchmarks[i], i]
+				{
+					dsp56k::ThreadTools::setCurrentThreadName("bench" + std::to_string(i));
+					b.run();
+				});
+			}
+
+			for (auto& t : threads)
+				t.join();
+		}
+
+		const auto cpuSeconds = CpuTime::getProcessSeconds() - cpuBegin;
+
+		if(hasThreadTimes)
+			CpuTime::getThreadSeconds(threadTimesEnd);
+
+		const auto& first = benchmarks.front()->getResult();
+
+		std::cout << "  samplerate " << first.samplerate << " Hz, " << first.channelCountOut << " output channels\n";
+
+		double rtfMin = std::numeric_limits<double>::max();
+		double p99Max = 0.0;
+		double blockMax = 0.0;
+		uint64_t overruns = 0;
+
+		for(size_t i=0; i<benchmarks.size(); ++i)
+		{
+			const auto& r = benchmarks[i]->getResult();
+			printResult(r, i);
+
+			rtfMin = std::min(rtfMin, r.realtimeFactor);
+			p99Max = std::max(p99Max, r.blockP99);
+			blockMax = std::max(blockMax, r.blockMax);
+			overruns += r.blockOverruns;
+		}
+
+		std::cout << std::fixed << std::setprecision(3) << "  process CPU time " << cpuSeconds << "s";
+
+		if(first.audioSeconds > 0.0)
+			std::cout << " (" << (cpuSeconds / first.audioSeconds / static_cast<double>(instanceCount)) << " CPU seconds per audio second per instance)";
+
+		std::cout << '\n';
+
+		// benchmark threads have exited already and are not part of the process thread list, they measure themselves
+		const auto hasBenchThreads = benchmarks.size() > 1;
+
+		if(hasThreadTimes || hasBenchThreads)
+		{
+			auto threadTimes = hasThreadTimes ? CpuTime::diff(threadTimesEnd, threadTimesBegin) : CpuTime::ThreadTimes();
+
+			if(hasBenchThreads)
+			{
+				for(size_t i=0; i<benchmarks.size(); ++i)
+					threadTimes["bench" + std::to_string(i)] += benchmarks[i]->getResult().threadCpuSeconds;
+			}
+
+			std::cout << "  CPU time per thread:\n";
+
+			for (const auto& [name, seconds] : threadTimes)
+				std::cout << "    " << std::left << std::setw(20) << name << std::right << ' ' << seconds << "s\n";
+		}
+
+		if(_csv.is_open())
+		{
+			_csv << _type << ',' << instanceCount << ',' << config.blockSize << ',' << first.samplerate << ','
+				<< first.bootSeconds << ',' << rtfMin << ',' << first.blockP50 << ',' << p99Max << ',' << blockMax << ','
+				<< overruns << ',' << cpuSeconds << '\n';
+		}
+
+		return true;
+	}
+}
+
+int main(const int _argc, char* _argv[])
+{
+	const baseLib::CommandLine cmd(_argc, _argv);
+
+	if(!cmd.contains("device"))
+	{
+		printUsage();
+		return -1;
+	}
+
+	dsp56k::ThreadTools::setCurrentThreadName("main");
+
+	std::ofstream csv;
+
+	if(cmd.contains("csv"))
+	{
+		const auto csvFile = cmd.get("csv");
+		const auto writeHeader = !baseLib::filesystem::exists(csvFile);
+
+		csv.open(csvFile, std::ios::app);
+
+		if(!csv.is_open())
+		{
+			std::cout << "Failed to open " << csvFile << " for writing\n";
+			return -1;
+		}
+
+		if(writeHeader)
+			csv << "device,instances,blocksize,samplerate,bootSeconds,realtimeFactorMin,blockP50us,blockP99us,blockMaxus,overruns,cpuSeconds\n";
+	}
+
+	const auto device = cmd.get("device");
+
+	if(device == "all")
+	{
+		// devices without ROM are skipped, the result is only an error if nothing could be run at all
+		bool anySucceeded = false;
+
+		for (const auto& type : DeviceFactory::getSupportedTypes())
+			anySucceeded |= runDevice(cmd, type, csv);
+
+		return anySucceeded ? 0 : -1;
+	}
+
+	return runDevice(cmd, device, csv) ? 0 : -1;
+}
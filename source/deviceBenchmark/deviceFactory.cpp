@@ -0,0 +1,193 @@
+#include "deviceFactory.h"
+
+#include "baseLib/filesystem.h"
+
+#include "synthLib/device.h"
+
+#if BENCHMARK_VIRUS
+#include "virusLib/device.h"
+#include "virusLib/romloader.h"
+#endif
+
+#if BENCHMARK_MQ
+#include "mqLib/device.h"
+#include "mqLib/romloader.h"
+#endif
+
+#if BENCHMARK_XT
+#include "xtLib/xtDevice.h"
+#include "xtLib/xtRomLoader.h"
+#endif
+
+#if BENCHMARK_N2X
+#include "n2xLib/n2xdevice.h"
+#include "n2xLib/n2xromloader.h"
+#endif
+
+#if BENCHMARK_JE8086
+#include "jeLib/device.h"
+#include "jeLib/romloader.h"
+#endif
+
+namespace deviceBenchmark
+{
+	namespace
+	{
+#if BENCHMARK_VIRUS
+		std::unique_ptr<synthLib::Device> createVirus(synthLib::DeviceCreateParams& _p, const DeviceFactory::Params& _params, const virusLib::DeviceModel _model, std::string& _error)
+		{
+			const auto rom = _params.romFile.empty() ? virusLib::ROMLoader::findROM(_model) : virusLib::ROMLoader::findROM(_params.romFile, _model);
+
+			if(!rom.isValid())
+			{
+				_error = "No valid ROM found for Virus model " + virusLib::getModelName(_model);
+				return {};
+			}
+
+			_p.romName = rom.getFilename();
+			_p.romData = rom.getRomFileData()->toVector();
+			_p.customData = static_cast<uint32_t>(rom.getModel());
+
+			return std::make_unique<virusLib::Device>(_p);
+		}
+#endif
+
+		template<typename TRom> bool assignRom(synthLib::DeviceCreateParams& _p, const TRom& _rom, const std::string& _name)
+		{
+			if(!_rom.isValid())
+				return false;
+			_p.romData.assign(_rom.getData().begin(), _rom.getData().end());
+			_p.romName = _name;
+			return true;
+		}
+	}
+
+	std::vector<std::string> DeviceFactory::getSupportedTypes()
+	{
+		std::vector<std::string> types;
+
+#if BENCHMARK_VIRUS
+		types.insert(types.end(), {"virusA", "virusB", "virusC", "virusSnow", "virusTI", "virusTI2"});
+#endif
+#if BENCHMARK_MQ
+		types.insert(types.end(), {"mq", "mqVE"});
+#endif
+#if BENCHMARK_XT
+		types.insert(types.end(), {"xt", "xtVE"});
+#endif
+#if BENCHMARK_N2X
+		types.emplace_back("n2x");
+#endif
+#if BENCHMARK_JE8086
+		types.insert(types.end(), {"je8086", "je8086P"});
+#endif
+		return types;
+	}
+
+	std::unique_ptr<synthLib::Device> DeviceFactory::create(const Params& _params, std::string& _error)
+	{
+		synthLib::DeviceCreateParams p;
+
+		p.preferredSamplerate = _params.samplerate;
+		p.hostSamplerate = _params.samplerate;
+
+		const auto& type = _params.type;
+
+#if BENCHMARK_VIRUS
+		if(type == "virusA")	return createVirus(p, _params, virusLib::DeviceModel::A, _error);
+		if(type == "virusB")	return createVirus(p, _params, virusLib::DeviceModel::B, _error);
+		if(type == "virusC")	return createVirus(p, _params, virusLib::DeviceModel::C, _error);
+		if(type == "virusSnow")	return createVirus(p, _params, virusLib::DeviceModel::Snow, _error);
+		if(type == "virusTI")	return createVirus(p, _params, virusLib::DeviceModel::TI, _error);
+		if(type == "virusTI2")	return createVirus(p, _params, virusLib::DeviceModel::TI2, _error);
+#endif
+
+#if BENCHMARK_MQ
+		if(type == "mq" || type == "mqVE")
+		{
+			const auto rom = _params.romFile.empty() ? mqLib::RomLoader::findROM() : mqLib::ROM(_params.romFile);
+
+			if(!assignRom(p, rom, rom.getFilename()))
+			{
+				_error = "No valid microQ ROM found";
+				return {};
+			}
+
+			if(type == "mqVE")
+				p.customData |= 1;
+
+			return std::make_unique<mqLib::Device>(p);
+		}
+#endif
+
+#if BENCHMARK_XT
+		if(type == "xt" || type == "xtVE")
+		{
+			if(_params.romFile.empty())
+			{
+				const auto rom = xt::RomLoader::findROM();
+
+				if(!assignRom(p, rom, rom.getFilename()))
+				{
+					_error = "No valid XT ROM found";
+					return {};
+				}
+			}
+			else if(baseLib::filesystem::readFile(p.romData, _params.romFile))
+			{
+				p.romName = _params.romFile;
+			}
+			else
+			{
+				_error = "Failed to read XT ROM " + _params.romFile;
+				return {};
+			}
+
+			if(type == "xtVE")
+				p.customData |= 1;
+
+			return std::make_unique<xt::Device>(p);
+		}
+#endif
+
+#if BENCHMARK_N2X
+		if(type == "n2x")
+		{
+			const auto rom = _params.romFile.empty() ? n2x::RomLoader::findROM() : n2x::Rom(_params.romFile);
+
+			if(!rom.isValid())
+			{
+				_error = "No valid N2x ROM found";
+				return {};
+			}
+
+			p.romData.assign(rom.data().begin(), rom.data().end());
+			p.romName = rom.getFilename();
+
+			return std::make_unique<n2x::Device>(p);
+		}
+#endif
+
+#if BENCHMARK_JE8086
+		if(type == "je8086" || type == "je8086P")
+		{
+			const auto rom = _params.romFile.empty() ? jeLib::RomLoader::findROM() : jeLib::Rom(_params.romFile);
+
+			if(!assignRom(p, rom, rom.getName()))
+			{
+				_error = "No valid JE-8086 ROM found";
+				return {};
+			}
+
+			// parallel ASIC processing
+			if(type == "je8086P")
+				p.customData |= 1;
+
+			return std::make_unique<jeLib::Device>(p);
+		}
+#endif
+
+		_error = "Unknown device type '" + type + "'";
+		return {};
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace synthLib
+{
+	class Device;
+}
+
+namespace deviceBenchmark
+{
+	class DeviceFactory
+	{
+	public:
+		struct Params
+		{
+			std::string type;			// one of getSupportedTypes()
+			std::string romFile;		// optional, if empty, the regular ROM search paths are used
+			float samplerate = 0.0f;	// preferred device samplerate, 0 = device default
+		};
+
+		static std::vector<std::string> getSupportedTypes();
+
+		// throws synthLib::DeviceException or returns nullptr if the device could not be created
+		static std::unique_ptr<synthLib::Device> create(const Params& _params, std::string& _error);
+	};
+}
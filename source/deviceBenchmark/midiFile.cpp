@@ -0,0 +1,261 @@
+#include "midiFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "baseLib/filesystem.h"
+
+#include "synthLib/midiBufferParser.h"
+
+namespace deviceBenchmark
+{
+	namespace
+	{
+		uint32_t readBE(const uint8_t* _data, const size_t _count)
+		{
+			uint32_t res = 0;
+			for(size_t i=0; i<_count; ++i)
+				res = (res << 8) | _data[i];
+			return res;
+		}
+
+		bool readVarLen(uint32_t& _result, size_t& _pos, const uint8_t* _data, const size_t _size)
+		{
+			_result = 0;
+
+			for(uint32_t i=0; i<4; ++i)
+			{
+				if(_pos >= _size)
+					return false;
+
+				const auto b = _data[_pos++];
+				_result = (_result << 7) | (b & 0x7f);
+
+				if(!(b & 0x80))
+					return true;
+			}
+			return false;
+		}
+	}
+
+	bool MidiFile::load(const std::string& _filename)
+	{
+		std::vector<uint8_t> data;
+		if(!baseLib::filesystem::readFile(data, _filename))
+			return false;
+		return load(data);
+	}
+
+	bool MidiFile::load(const std::vector<uint8_t>& _data)
+	{
+		m_events.clear();
+
+		if(_data.size() < 14 || memcmp(_data.data(), "MThd", 4) != 0)
+			return false;
+
+		const auto headerLen = readBE(&_data[4], 4);
+		if(headerLen < 6)
+			return false;
+
+		const auto trackCount = readBE(&_data[10], 2);
+		const auto division = readBE(&_data[12], 2);
+
+		std::vector<TickEvent> tickEvents;
+		std::vector<TempoChange> tempoChanges;
+
+		size_t pos = 8 + headerLen;
+
+		for(uint32_t t=0; t<trackCount && pos + 8 <= _data.size(); ++t)
+		{
+			const auto chunkLen = readBE(&_data[pos+4], 4);
+			const auto isTrack = memcmp(&_data[pos], "MTrk", 4) == 0;
+
+			pos += 8;
+
+			if(pos + chunkLen > _data.size())
+				return false;
+
+			if(isTrack && !parseTrack(&_data[pos], chunkLen, tickEvents, tempoChanges))
+				return false;
+
+			pos += chunkLen;
+		}
+
+		// merge all tracks, keep the file order for events that share the same tick
+		std::stable_sort(tickEvents.begin(), tickEvents.end(), [](const TickEvent& _a, const TickEvent& _b)
+		{
+			if(_a.tick != _b.tick)
+				return _a.tick < _b.tick;
+			return _a.order < _b.order;
+		});
+
+		std::stable_sort(tempoChanges.begin(), tempoChanges.end(), [](const TempoChange& _a, const TempoChange& _b)
+		{
+			return _a.tick < _b.tick;
+		});
+
+		// convert ticks to seconds
+		const bool smpte = (division & 0x8000) != 0;
+
+		double secondsPerTick;
+
+		if(smpte)
+		{
+			const auto fps = static_cast<double>(256 - (division >> 8));
+			const auto ticksPerFrame = static_cast<double>(division & 0xff);
+			secondsPerTick = 1.0 / (fps * std::max(1.0, ticksPerFrame));
+		}
+		else
+		{
+			secondsPerTick = 0.5 / static_cast<double>(std::max(1u, division));
+		}
+
+		size_t tempoIndex = 0;
+		uint64_t lastTick = 0;
+		double seconds = 0.0;
+
+		m_events.reserve(tickEvents.size());
+
+		for (auto& e : tickEvents)
+		{
+			while(!smpte && tempoIndex < tempoChanges.size() && tempoChanges[tempoIndex].tick <= e.tick)
+			{
+				const auto& tc = tempoChanges[tempoIndex++];
+				seconds += static_cast<double>(tc.tick - lastTick) * secondsPerTick;
+				lastTick = tc.tick;
+				secondsPerTick = static_cast<double>(tc.microsecondsPerQuarter) / (1000000.0 * static_cast<double>(std::max(1u, division)));
+			}
+
+			seconds += static_cast<double>(e.tick - lastTick) * secondsPerTick;
+			lastTick = e.tick;
+
+			m_events.push_back({seconds, std::move(e.event)});
+		}
+
+		return true;
+	}
+
+	bool MidiFile::parseTrack(const uint8_t* _data, const size_t _size, std::vector<TickEvent>& _events, std::vector<TempoChange>& _tempoChanges)
+	{
+		size_t pos = 0;
+		uint64_t tick = 0;
+		uint8_t runningStatus = 0;
+
+		while(pos < _size)
+		{
+			uint32_t delta;
+			if(!readVarLen(delta, pos, _data, _size))
+				return false;
+
+			tick += delta;
+
+			if(pos >= _size)
+				return false;
+
+			uint8_t status = _data[pos];
+
+			if(status == 0xff)
+			{
+				// meta event
+				if(pos + 2 > _size)
+					return false;
+
+				const auto type = _data[pos+1];
+				pos += 2;
+
+				uint32_t len;
+				if(!readVarLen(len, pos, _data, _size) || pos + len > _size)
+					return false;
+
+				if(type == 0x51 && len == 3)
+					_tempoChanges.push_back({tick, readBE(&_data[pos], 3)});
+				else if(type == 0x2f)
+					return true;
+
+				pos += len;
+				continue;
+			}
+
+			if(status == synthLib::M_STARTOFSYSEX || status == synthLib::M_ENDOFSYSEX)
+			{
+				++pos;
+
+				uint32_t len;
+				if(!readVarLen(len, pos, _data, _size) || pos + len > _size)
+					return false;
+
+				TickEvent e{tick, static_cast<uint32_t>(_events.size()), synthLib::SMidiEvent(synthLib::MidiEventSource::Host)};
+
+				// F7 escapes carry raw bytes, F0 sysex omits the start byte in the file
+				if(status == synthLib::M_STARTOFSYSEX)
+					e.event.sysex.push_back(synthLib::M_STARTOFSYSEX);
+
+				e.event.sysex.insert(e.event.sysex.end(), _data + pos, _data + pos + len);
+				pos += len;
+
+				if(!e.event.sysex.empty())
+					_events.push_back(std::move(e));
+				continue;
+			}
+
+			if(status & 0x80)
+			{
+				runningStatus = status;
+				++pos;
+			}
+			else
+			{
+				if(!runningStatus)
+					return false;
+				status = runningStatus;
+			}
+
+			const auto len = synthLib::MidiBufferParser::lengthFromStatusByte(status);
+
+			if(pos + len - 1 > _size)
+				return false;
+
+			TickEvent e{tick, static_cast<uint32_t>(_events.size()), synthLib::SMidiEvent(synthLib::MidiEventSource::Host, status)};
+
+			if(len > 1)	e.event.b = _data[pos];
+			if(len > 2)	e.event.c = _data[pos+1];
+
+			pos += len - 1;
+
+			_events.push_back(std::move(e));
+		}
+		return true;
+	}
+
+	std::vector<MidiFile::Event> MidiFile::createDefaultPattern(const double _durationSeconds)
+	{
+		// a four-note chord progression, retriggered every half second, gives a stable polyphonic load
+		constexpr uint8_t chords[4][4] =
+		{
+			{synthLib::Note_C3, synthLib::Note_E3, synthLib::Note_G3, synthLib::Note_B3},
+			{synthLib::Note_A2, synthLib::Note_C3, synthLib::Note_E3, synthLib::Note_G3},
+			{synthLib::Note_F2, synthLib::Note_A2, synthLib::Note_C3, synthLib::Note_E3},
+			{synthLib::Note_G2, synthLib::Note_B2, synthLib::Note_D3, synthLib::Note_F3}
+		};
+
+		constexpr double stepLength = 0.5;
+		constexpr double noteLength = 0.4;
+
+		std::vector<Event> events;
+
+		uint32_t step = 0;
+
+		for(double t = 0.0; t + stepLength <= _durationSeconds; t += stepLength, ++step)
+		{
+			const auto& chord = chords[(step >> 1) & 3];
+
+			for (const auto note : chord)
+				events.push_back({t, synthLib::SMidiEvent(synthLib::MidiEventSource::Host, synthLib::M_NOTEON, note, 100)});
+
+			for (const auto note : chord)
+				events.push_back({t + noteLength, synthLib::SMidiEvent(synthLib::MidiEventSource::Host, synthLib::M_NOTEOFF, note, 64)});
+		}
+
+		return events;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "synthLib/midiTypes.h"
+
+namespace deviceBenchmark
+{
+	// Minimal standard midi file (format 0 and 1) reader that flattens all tracks into a single stream of events with absolute timestamps
+	class MidiFile
+	{
+	public:
+		struct Event
+		{
+			double seconds = 0.0;
+			synthLib::SMidiEvent event;
+		};
+
+		bool load(const std::string& _filename);
+		bool load(const std::vector<uint8_t>& _data);
+
+		const auto& getEvents() const { return m_events; }
+		double getDurationSeconds() const { return m_events.empty() ? 0.0 : m_events.back().seconds; }
+
+		// creates a deterministic pattern of notes on midi channel 1 that can be used if no midi file is given
+		static std::vector<Event> createDefaultPattern(double _durationSeconds);
+
+	private:
+		struct TickEvent
+		{
+			uint64_t tick = 0;
+			uint32_t order = 0;
+			synthLib::SMidiEvent event;
+		};
+
+		struct TempoChange
+		{
+			uint64_t tick = 0;
+			uint32_t microsecondsPerQuarter = 500000;
+		};
+
+		bool parseTrack(const uint8_t* _data, size_t _size, std::vector<TickEvent>& _events, std::vector<TempoChange>& _tempoChanges);
+
+		std::vector<Event> m_events;
+	};
+}
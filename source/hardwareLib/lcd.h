@@ -5,6 +5,11 @@
 #include <functional>
 #include <optional>
 
+namespace baseLib
+{
+	class BinaryStream;
+}
+
 namespace hwLib
 {
 	// 2*20 characters display simulation (20*2)
@@ -31,6 +36,10 @@ namespace hwLib
 		{
 			m_cgRamChangeCallback = _callback;
 		}
+
+		// change callbacks are not invoked on load
+		void saveState(baseLib::BinaryStream& _s) const;
+		void loadState(baseLib::BinaryStream& _s);
 	private:
 		enum class CursorShiftMode
 		{
@@ -705,9 +705,9 @@ namespace jucePluginEditorLib
 
 				sr.customCompareFunc = [packet, expectedValue, defIndices, _offsetMin, _offsetMax](const pluginLib::patchDB::Patch& _patch) -> bool
 				{
-					if (_patch.sysex.empty())
+					if (_patch.getSysex().empty())
 						return false;
-					const auto v = packet->getParameterValue(_patch.sysex, defIndices);
+					const auto v = packet->getParameterValue(_patch.getSysex(), defIndices);
 					if (v >= expectedValue + _offsetMin && v <= expectedValue + _offsetMax)
 						return true;
 					return false;
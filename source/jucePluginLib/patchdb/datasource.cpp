@@ -174,7 +174,7 @@ namespace pluginLib::patchDB
 		_outStream.write(midiBankNumber);
 	}
 
-	bool DataSource::read(baseLib::BinaryStream& _inStream)
+	bool DataSource::read(baseLib::BinaryStream& _inStream, const SysexStorePtr& _sysexStore)
 	{
 		auto [in, version] = _inStream.tryReadChunk(chunks::g_datasource, 1, 2);
 		if(!in)
@@ -190,7 +190,7 @@ namespace pluginLib::patchDB
 		for(uint32_t i=0; i<numPatches; ++i)
 		{
 			const auto patch = std::make_shared<Patch>();
-			if(!patch->read(in))
+			if(!patch->read(in, _sysexStore))
 				return false;
 
 			DB::assign(patch, patch->modifications);
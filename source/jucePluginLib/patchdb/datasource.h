@@ -117,7 +117,7 @@ namespace pluginLib::patchDB
 		std::string toString() const;
 
 		void write(baseLib::BinaryStream& _outStream) const;
-		bool read(baseLib::BinaryStream& _inStream);
+		bool read(baseLib::BinaryStream& _inStream, const SysexStorePtr& _sysexStore);
 	};
 
 	struct DataSourceNode final : DataSource, std::enable_shared_from_this<DataSourceNode>
@@ -1,5 +1,6 @@
 #include "db.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "datasource.h"
@@ -26,6 +27,7 @@ namespace pluginLib::patchDB
 	DB::DB(juce::File _dir)
 	: m_settingsDir(std::move(_dir))
 	, m_loader("PatchLoader", false, dsp56k::ThreadPriority::Lowest)
+	, m_parser("PatchParser", false, dsp56k::ThreadPriority::Lowest, std::max(1u, std::thread::hardware_concurrency()))
 	{
 		m_settingsDir.createDirectory();
 	}
@@ -51,11 +53,11 @@ namespace pluginLib::patchDB
 	bool DB::writePatchesToFile(const juce::File& _file, const std::vector<PatchPtr>& _patches)
 	{
 		std::vector<uint8_t> sysexBuffer;
-		sysexBuffer.reserve(_patches.front()->sysex.size() * _patches.size());
+		sysexBuffer.reserve(_patches.front()->sysex.getSize() * _patches.size());
 
 		for (const auto& patch : _patches)
 		{
-			const auto patchSysex = patch->sysex;
+			const auto patchSysex = patch->getSysex();
 
 			if(!patchSysex.empty())
 				sysexBuffer.insert(sysexBuffer.end(), patchSysex.begin(), patchSysex.end());
@@ -657,11 +659,11 @@ namespace pluginLib::patchDB
 			return false;
 		if (_patch->getName().empty())
 			return false;
-		if (_patch->sysex.empty())
+		if (_patch->getSysex().empty())
 			return false;
-		if (_patch->sysex.front() != 0xf0)
+		if (_patch->getSysex().front() != 0xf0)
 			return false;
-		if (_patch->sysex.back() != 0xf7)
+		if (_patch->getSysex().back() != 0xf7)
 			return false;
 		return true;
 	}
@@ -854,6 +856,18 @@ namespace pluginLib::patchDB
 		std::vector<std::string> files;
 		baseLib::filesystem::findFiles(files, _folder->name, {}, 0, 0);
 
+		// directory entries are returned in no particular order
+		std::sort(files.begin(), files.end());
+
+		// the outermost folder owns the load, files of subfolders are parsed as part of it
+		std::unique_ptr<FolderLoad> load;
+
+		if(!m_folderLoad)
+		{
+			load = std::make_unique<FolderLoad>(m_parser);
+			m_folderLoad = load.get();
+		}
+
 		for (const auto& file : files)
 		{
 			const auto child = std::make_shared<DataSourceNode>();
@@ -862,11 +876,31 @@ namespace pluginLib::patchDB
 			child->origin = DataSourceOrigin::Autogenerated;
 
 			if(baseLib::filesystem::isDirectory(file))
+			{
 				child->type = SourceType::Folder;
+				addDataSource(child);
+			}
 			else
+			{
 				child->type = SourceType::File;
 
-			addDataSource(child);
+				auto& entry = m_folderLoad->files.emplace_back(child, std::vector<PatchPtr>());
+
+				m_folderLoad->jobs.add([this, &entry]
+				{
+					createPatches(entry.second, *entry.first);
+				});
+			}
+		}
+
+		if(load)
+		{
+			load->jobs.wait();
+			m_folderLoad = nullptr;
+
+			// add in the order in which the files have been found to get the same result as with sequential loading
+			for (auto& [ds, patches] : load->files)
+				addDataSource(ds, &patches);
 		}
 
 		return !files.empty();
@@ -880,6 +914,7 @@ namespace pluginLib::patchDB
 	void DB::startLoaderThread(const juce::File& _migrateFromDir/* = {}*/)
 	{
 		m_loader.start();
+		m_parser.start();
 
 		runOnLoaderThread([this, _migrateFromDir]
 		{
@@ -930,7 +965,9 @@ namespace pluginLib::patchDB
 
 	void DB::stopLoaderThread()
 	{
+		// the loader may wait for parser jobs, stop it first
 		m_loader.destroy();
+		m_parser.destroy();
 	}
 
 	void DB::runOnLoaderThread(std::function<void()>&& _func)
@@ -948,6 +985,11 @@ namespace pluginLib::patchDB
 	}
 
 	void DB::addDataSource(const DataSourceNodePtr& _ds)
+	{
+		addDataSource(_ds, nullptr);
+	}
+
+	void DB::addDataSource(const DataSourceNodePtr& _ds, std::vector<PatchPtr>* _patches)
 	{
 		if (m_loader.destroyed())
 			return;
@@ -1028,35 +1070,47 @@ namespace pluginLib::patchDB
 		if (ds->origin == DataSourceOrigin::Manual)
 			addDsToList();
 
-		DataList data;
+		std::vector<PatchPtr> patches;
+
+		if(_patches)
+			std::swap(patches, *_patches);
+		else
+			createPatches(patches, *ds);
+
+		if (patches.empty())
+			return;
 
-		if(loadData(data, ds) && !data.empty())
+		for (const auto& patch : patches)
 		{
-			std::vector<PatchPtr> patches;
-			patches.reserve(data.size());
+			patch->source = ds->weak_from_this();
+			ds->patches.insert(patch);
+		}
 
-			const std::string defaultName = data.size() == 1 ? baseLib::filesystem::stripExtension(baseLib::filesystem::getFilenameWithoutPath(ds->name)) : "";
+		addDsToList();
+		loadPatchModifications(ds, patches);
+		addPatches(patches);
+	}
 
-			for (uint32_t p = 0; p < data.size(); ++p)
-			{
-				if (const auto patch = initializePatch(std::move(data[p]), defaultName))
-				{
-					patch->source = ds->weak_from_this();
+	void DB::createPatches(std::vector<PatchPtr>& _patches, const DataSource& _ds)
+	{
+		DataList data;
 
-					if(isValid(patch))
-					{
-						patch->program = p;
-						patches.push_back(patch);
-						ds->patches.insert(patch);
-					}
-				}
-			}
+		if(!loadData(data, _ds) || data.empty())
+			return;
+
+		_patches.reserve(data.size());
 
-			if (!patches.empty())
+		const std::string defaultName = data.size() == 1 ? baseLib::filesystem::stripExtension(baseLib::filesystem::getFilenameWithoutPath(_ds.name)) : "";
+
+		for (uint32_t p = 0; p < data.size(); ++p)
+		{
+			if (const auto patch = initializePatch(std::move(data[p]), defaultName))
 			{
-				addDsToList();
-				loadPatchModifications(ds, patches);
-				addPatches(patches);
+				if(isValid(patch))
+				{
+					patch->program = p;
+					_patches.push_back(patch);
+				}
 			}
 		}
 	}
@@ -1191,7 +1245,7 @@ namespace pluginLib::patchDB
 				{
 					if(patch->hash == reqPatch->hash)
 						results.insert(patch);
-					else if(patch->sysex.size() == reqPatch->sysex.size() && patch->getName() == reqPatch->getName())
+					else if(patch->sysex.getSize() == reqPatch->sysex.getSize() && patch->getName() == reqPatch->getName())
 					{
 						// if patches are not 100% identical, they might still be the same patch as unknown/unused data in dumps might have different values
 						if(equals(patch, reqPatch))
@@ -1213,65 +1267,50 @@ namespace pluginLib::patchDB
 			return true;
 		}
 
-		auto searchInDs = [&](const DataSourceNodePtr& _ds)
 		{
-			if(!_search.request.sourceNode && _search.getSourceType() != SourceType::Invalid)
+			std::shared_lock lockSearches(m_searchesMutex);
+			const auto it = m_cancelledSearches.find(_search.handle);
+			if(it != m_cancelledSearches.end())
 			{
-				if(_ds->type != _search.request.sourceType)
-					return true;
-			}
+				m_cancelledSearches.erase(it);
+				lockSearches.unlock();
 
-			bool isCancelled;
-			{
-				std::shared_lock lockSearches(m_searchesMutex);
-				const auto it = m_cancelledSearches.find(_search.handle);
-				isCancelled = it != m_cancelledSearches.end();
-				if(isCancelled)
-					m_cancelledSearches.erase(it);
-			}
-
-			if(isCancelled)
-			{
 				_search.state = SearchState::Cancelled;
 				std::unique_lock lockUi(m_uiMutex);
 				m_dirty.searches.insert(_search.handle);
 				return false;
 			}
+		}
+
+		SearchResult results;
 
-			for (const auto& patchPtr : _ds->patches)
+		if(_search.request.sourceNode && (_search.getSourceType() == SourceType::File || _search.getSourceType() == SourceType::LocalStorage))
+		{
+			std::vector<DataSourceNodePtr> sources;
 			{
-				const auto* patch = patchPtr.get();
-				assert(patch);
+				std::shared_lock lockDs(m_dataSourcesMutex);
+				const auto& it = m_dataSources.find(*_search.request.sourceNode);
 
-				if(_search.request.match(*patch))
+				if(it == m_dataSources.end())
 				{
-					std::unique_lock searchLock(_search.resultsMutex);
-					_search.results.insert(patchPtr);
+					_search.setCompleted();
+					return false;
 				}
-			}
-			return true;
-		};
-
-		if(_search.request.sourceNode && (_search.getSourceType() == SourceType::File || _search.getSourceType() == SourceType::LocalStorage))
-		{
-			const auto& it = m_dataSources.find(*_search.request.sourceNode);
 
-			if(it == m_dataSources.end())
-			{
-				_search.setCompleted();
-				return false;
+				sources.push_back(it->second);
 			}
 
-			if(!searchInDs(it->second))
-				return false;
+			m_searchIndex.search(results, _search.request, &sources);
 		}
 		else
 		{
-			for (const auto& it : m_dataSources)
-			{
-				if(!searchInDs(it.second))
-					return false;
-			}
+			m_searchIndex.search(results, _search.request, nullptr);
+		}
+
+		if(!results.empty())
+		{
+			std::unique_lock searchLock(_search.resultsMutex);
+			_search.results.insert(results.begin(), results.end());
 		}
 
 		_search.setCompleted();
@@ -1286,6 +1325,8 @@ namespace pluginLib::patchDB
 
 	void DB::updateSearches(const std::vector<PatchPtr>& _patches)
 	{
+		m_searchIndex.update(_patches);
+
 		std::shared_lock lockSearches(m_searchesMutex);
 
 		std::set<SearchHandle> dirtySearches;
@@ -1299,7 +1340,7 @@ namespace pluginLib::patchDB
 
 			for (const auto& patch : _patches)
 			{
-				const auto match = search->request.match(*patch);
+				const auto match = m_searchIndex.match(search->request, patch);
 
 				bool countChanged;
 
@@ -1344,6 +1385,8 @@ namespace pluginLib::patchDB
 	{
 		bool res = false;
 
+		m_searchIndex.remove(_keys);
+
 		std::shared_lock lockSearches(m_searchesMutex);
 
 		for (auto& itSearches : m_searches)
@@ -1940,8 +1983,21 @@ namespace pluginLib::patchDB
 			if(!stream)
 				return false;
 
-			std::unique_lock lockDS(m_dataSourcesMutex);
-			std::unique_lock lockP(m_patchesMutex);
+			// everything is read into temporary containers first, the db is only locked to swap them in
+			SysexStorePtr sysexStore;
+
+			if(auto s = stream.tryReadChunk(chunks::g_patchManagerSysexStore, 1))
+			{
+				const auto id = s.read<uint64_t>();
+				const auto size = s.read<uint64_t>();
+
+				sysexStore = std::make_shared<SysexStore>(m_settingsDir.getFullPathName().toStdString());
+
+				if(!sysexStore->open(id, size))
+					return false;
+			}
+			else
+				return false;
 
 			std::map<DataSource, DataSourceNodePtr> resultDataSources;
 			std::unordered_map<TagType, std::set<Tag>> resultTags;
@@ -1958,7 +2014,7 @@ namespace pluginLib::patchDB
 				for(uint32_t i=0; i<numDatasources; ++i)
 				{
 					DataSource& ds = dataSources.emplace_back();
-					if(!ds.read(s))
+					if(!ds.read(s, sysexStore))
 						return false;
 				}
 
@@ -2067,6 +2123,17 @@ namespace pluginLib::patchDB
 			{
 				const auto count = s.read<uint32_t>();
 
+				std::multimap<PatchKey, PatchPtr> patchesByKey;
+
+				if(count)
+				{
+					for (const auto& it : resultDataSources)
+					{
+						for (const auto& patch : it.second->patches)
+							patchesByKey.insert({PatchKey(*patch), patch});
+					}
+				}
+
 				for(uint32_t i=0; i<count; ++i)
 				{
 					auto key = PatchKey::fromString(s.readString());
@@ -2081,25 +2148,25 @@ namespace pluginLib::patchDB
 
 					resultPatchModifications.insert({key, mods});
 
-					for (const auto& it : resultDataSources)
-					{
-						for (const auto& patch : it.second->patches)
-						{
-							if(*patch != key)
-								continue;
+					const auto range = patchesByKey.equal_range(key);
 
-							assign(patch, mods);
-						}
-					}
+					for(auto it = range.first; it != range.second; ++it)
+						assign(it->second, mods);
 				}
 			}
 			else
 				return false;
 
-			m_dataSources = resultDataSources;
-			m_tags = resultTags;
-			m_tagColors = resultTagColors;
-			m_patchModifications = resultPatchModifications;
+			{
+				std::unique_lock lockDS(m_dataSourcesMutex);
+				std::unique_lock lockP(m_patchesMutex);
+
+				m_dataSources = resultDataSources;
+				m_tags = resultTags;
+				m_tagColors = resultTagColors;
+				m_patchModifications = resultPatchModifications;
+				m_sysexStore = sysexStore;
+			}
 
 			for (const auto& it: resultDataSources)
 			{
@@ -2137,7 +2204,29 @@ namespace pluginLib::patchDB
 			std::shared_lock lockDS(m_dataSourcesMutex);
 			std::shared_lock lockP(m_patchesMutex);
 
+			// patch data is not part of the cache file. Data of patches that are not in the sysex store yet is appended
+			std::vector<PatchPtr> patches;
+
+			for (const auto& it : m_dataSources)
+				patches.insert(patches.end(), it.second->patches.begin(), it.second->patches.end());
+
+			if(!m_sysexStore)
+				m_sysexStore = std::make_shared<SysexStore>(m_settingsDir.getFullPathName().toStdString());
+
+			if(!m_sysexStore->write(patches))
+			{
+				// the existing cache is shared with other instances and still references valid data, keep it
+				LOG("Failed to write patch data to sysex store, cache not saved");
+				return;
+			}
+
 			baseLib::ChunkWriter cw(outStream, chunks::g_patchManager, chunkVersions::g_patchManager);
+			{
+				baseLib::ChunkWriter cwSx(outStream, chunks::g_patchManagerSysexStore, 1);
+
+				outStream.write(m_sysexStore->getId());
+				outStream.write(m_sysexStore->getSize());
+			}
 			{
 				baseLib::ChunkWriter cwDS(outStream, chunks::g_patchManagerDataSources, 1);
 
@@ -2243,7 +2332,10 @@ namespace pluginLib::patchDB
 		std::vector<uint8_t> buffer;
 		outStream.toVector(buffer);
 
-		cacheFile.replaceWithData(buffer.data(), buffer.size());
+		if(!cacheFile.replaceWithData(buffer.data(), buffer.size()))
+			return;
+
+		m_sysexStore->removeUnusedFiles();
 
 		m_cacheDirty = false;
 	}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <deque>
 #include <functional>
 #include <map>
 #include <list>
@@ -8,6 +9,7 @@
 #include "patch.h"
 #include "patchdbtypes.h"
 #include "search.h"
+#include "searchIndex.h"
 
 #include "jobqueue.h"
 
@@ -124,6 +126,8 @@ namespace pluginLib::patchDB
 
 	private:
 		void addDataSource(const DataSourceNodePtr& _ds);
+		void addDataSource(const DataSourceNodePtr& _ds, std::vector<PatchPtr>* _patches);
+		void createPatches(std::vector<PatchPtr>& _patches, const DataSource& _ds);
 
 		bool addPatches(const std::vector<PatchPtr>& _patches);
 		bool removePatch(const PatchPtr& _patch);
@@ -175,6 +179,18 @@ namespace pluginLib::patchDB
 		// loader
 		JobQueue m_loader;
 
+		// files of a folder are loaded and parsed in parallel and are added to the db in order once all are done
+		struct FolderLoad
+		{
+			explicit FolderLoad(JobQueue& _parser) : jobs(_parser) {}
+
+			JobGroup jobs;
+			std::deque<std::pair<DataSourceNodePtr, std::vector<PatchPtr>>> files;
+		};
+
+		JobQueue m_parser;
+		FolderLoad* m_folderLoad = nullptr;	// only accessed by the loader thread
+
 		// ui
 		std::mutex m_uiMutex;
 		std::list<std::function<void()>> m_uiFuncs;
@@ -188,12 +204,14 @@ namespace pluginLib::patchDB
 		std::unordered_map<TagType, std::set<Tag>> m_tags;
 		std::unordered_map<TagType, std::unordered_map<Tag, uint32_t>> m_tagColors;
 		std::map<PatchKey, PatchModificationsPtr> m_patchModifications;
+		SysexStorePtr m_sysexStore;	// holds the patch data of patches loaded from the cache
 
 		// search
 		std::shared_mutex m_searchesMutex;
 		std::unordered_map<uint32_t, std::shared_ptr<Search>> m_searches;
 		std::unordered_set<SearchHandle> m_cancelledSearches;
 		uint32_t m_nextSearchHandle = 0;
+		SearchIndex m_searchIndex;
 
 		// state
 		bool m_loading = true;
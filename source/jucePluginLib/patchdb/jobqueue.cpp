@@ -95,16 +95,21 @@ namespace pluginLib::patchDB
 
 	void JobQueue::threadFunc()
 	{
-		while (!m_destroy)
+		while (true)
 		{
 			std::unique_lock lock(m_mutexFuncs);
 
-			m_cv.wait(lock, [this] {return !m_funcs.empty();});
-
-			const auto func = m_funcs.front();
+			m_cv.wait(lock, [this] {return !m_funcs.empty() || m_destroy;});
 
 			if (m_destroy)
+			{
+				// wake the other threads of this queue, they would wait for another job forever otherwise
+				lock.unlock();
+				m_cv.notify_all();
 				return;
+			}
+
+			const auto func = std::move(m_funcs.front());
 
 			++m_numRunning;
 			m_funcs.pop_front();
@@ -160,10 +165,8 @@ namespace pluginLib::patchDB
 		std::unique_lock lockCounts(m_mutexCounts);
 		++m_countCompleted;
 
+		// notify while holding the lock, the group may be destroyed as soon as wait() returns
 		if (m_countCompleted == m_countEnqueued)
-		{
-			lockCounts.unlock();
-			m_completedCv.notify_one();
-		}
+			m_completedCv.notify_all();
 	}
 }
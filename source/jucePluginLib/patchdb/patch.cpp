@@ -40,12 +40,12 @@ namespace pluginLib::patchDB
 		name = _patch.name;
 		tags = _patch.tags;
 		hash = _patch.hash;
-		sysex = _patch.sysex;
+		sysex.set(_patch.getSysex());
 	}
 
 	void Patch::write(baseLib::BinaryStream& _s) const
 	{
-		baseLib::ChunkWriter chunkWriter(_s, chunks::g_patch, 2);
+		baseLib::ChunkWriter chunkWriter(_s, chunks::g_patch, 3);
 
 		_s.write(name);
 		_s.write(bank);
@@ -63,12 +63,15 @@ namespace pluginLib::patchDB
 		tags.write(_s);
 
 		_s.write(hash);
-		_s.write(sysex);
+
+		// the data itself is stored in the sysex store
+		_s.write(sysex.getOffset());
+		_s.write(sysex.getSize());
 	}
 
-	bool Patch::read(baseLib::BinaryStream& _in)
+	bool Patch::read(baseLib::BinaryStream& _in, const SysexStorePtr& _sysexStore)
 	{
-		auto in = _in.tryReadChunk(chunks::g_patch, 2);
+		auto in = _in.tryReadChunk(chunks::g_patch, 3);
 		if(!in)
 			return false;
 
@@ -89,7 +92,11 @@ namespace pluginLib::patchDB
 			return false;
 
 		hash = in.read<PatchHash>();
-		in.read(sysex);
+
+		const auto offset = in.read<uint64_t>();
+		const auto size = in.read<uint32_t>();
+
+		sysex.setStored(_sysexStore, offset, size);
 
 		return true;
 	}
@@ -8,6 +8,7 @@
 #include "datasource.h"
 #include "tags.h"
 #include "patchdbtypes.h"
+#include "sysexstore.h"
 
 #include "synthLib/midiTypes.h"
 
@@ -36,7 +37,7 @@ namespace pluginLib::patchDB
 		void replaceData(const Patch& _patch);
 
 		void write(baseLib::BinaryStream& _s) const;
-		bool read(baseLib::BinaryStream& _in);
+		bool read(baseLib::BinaryStream& _in, const SysexStorePtr& _sysexStore);
 
 		bool operator == (const PatchKey& _key) const;
 		bool operator != (const PatchKey& _key) const
@@ -59,13 +60,16 @@ namespace pluginLib::patchDB
 		TypedTags tags;
 
 		PatchHash hash;
-		synthLib::SysexBuffer sysex;
+		PatchSysex sysex;
 
 		std::shared_ptr<PatchModifications> modifications;
 
 		const TypedTags& getTags() const;
 		const Tags& getTags(TagType _type) const;
 		const std::string& getName() const;
+
+		const Data& getSysex() const { return sysex.get(); }
+		void setSysex(Data&& _sysex) { sysex.set(std::move(_sysex)); }
 	};
 
 	struct PatchKey
@@ -48,6 +48,9 @@ namespace pluginLib::patchDB
 	struct PatchModifications;
 	using PatchModificationsPtr = std::shared_ptr<PatchModifications>;
 
+	class SysexStore;
+	using SysexStorePtr = std::shared_ptr<SysexStore>;
+
 	using Data = synthLib::SysexBuffer;
 	using DataList = synthLib::SysexBufferList;
 
@@ -90,6 +93,7 @@ namespace pluginLib::patchDB
 		constexpr char g_patchManagerTagColors[] = "PmTC";
 		constexpr char g_patchManagerTags[] = "PmTs";
 		constexpr char g_patchManagerPatchModifications[] = "PMds";
+		constexpr char g_patchManagerSysexStore[] = "PmSx";
 
 		constexpr char g_patchModification[] = "PMod";
 		constexpr char g_datasource[] = "DatS";
@@ -100,6 +104,6 @@ namespace pluginLib::patchDB
 
 	namespace chunkVersions
 	{
-		constexpr uint32_t g_patchManager = 3;
+		constexpr uint32_t g_patchManager = 4;
 	}
 }
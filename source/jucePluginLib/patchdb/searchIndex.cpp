@@ -0,0 +1,462 @@
+#include "searchIndex.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "patch.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace pluginLib::patchDB
+{
+	// ___________________________________
+	// Bitmap
+	//
+
+	void SearchIndex::Bitmap::set(const uint32_t _index)
+	{
+		const auto w = _index >> 6;
+		if(w >= m_bits.size())
+			m_bits.resize(w + 1, 0);
+		m_bits[w] |= 1ull << (_index & 63);
+	}
+
+	void SearchIndex::Bitmap::reset(const uint32_t _index)
+	{
+		const auto w = _index >> 6;
+		if(w < m_bits.size())
+			m_bits[w] &= ~(1ull << (_index & 63));
+	}
+
+	bool SearchIndex::Bitmap::test(const uint32_t _index) const
+	{
+		const auto w = _index >> 6;
+		return w < m_bits.size() && (m_bits[w] & (1ull << (_index & 63)));
+	}
+
+	bool SearchIndex::Bitmap::empty() const
+	{
+		return std::all_of(m_bits.begin(), m_bits.end(), [](const uint64_t _w) { return _w == 0; });
+	}
+
+	void SearchIndex::Bitmap::merge(const Bitmap& _other)
+	{
+		if(m_bits.size() < _other.m_bits.size())
+			m_bits.resize(_other.m_bits.size(), 0);
+
+		for(size_t i=0; i<_other.m_bits.size(); ++i)
+			m_bits[i] |= _other.m_bits[i];
+	}
+
+	void SearchIndex::Bitmap::intersect(const Bitmap& _other)
+	{
+		if(m_bits.size() > _other.m_bits.size())
+			m_bits.resize(_other.m_bits.size());
+
+		for(size_t i=0; i<m_bits.size(); ++i)
+			m_bits[i] &= _other.m_bits[i];
+	}
+
+	void SearchIndex::Bitmap::subtract(const Bitmap& _other)
+	{
+		const auto count = std::min(m_bits.size(), _other.m_bits.size());
+
+		for(size_t i=0; i<count; ++i)
+			m_bits[i] &= ~_other.m_bits[i];
+	}
+
+	uint32_t SearchIndex::Bitmap::countTrailingZeros(const uint64_t _v)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, _v);
+		return index;
+#else
+		return static_cast<uint32_t>(__builtin_ctzll(_v));
+#endif
+	}
+
+	// ___________________________________
+	// SearchIndex
+	//
+
+	void SearchIndex::update(const std::vector<PatchPtr>& _patches)
+	{
+		std::unique_lock lock(m_mutex);
+
+		for (const auto& patch : _patches)
+			add(patch);
+	}
+
+	void SearchIndex::remove(const std::vector<PatchPtr>& _patches)
+	{
+		std::unique_lock lock(m_mutex);
+
+		for (const auto& patch : _patches)
+		{
+			const auto it = m_ids.find(patch.get());
+
+			if(it == m_ids.end())
+				continue;
+
+			const auto id = it->second;
+
+			unindex(id);
+
+			m_entries[id] = {};
+			m_freeIds.push_back(id);
+			m_ids.erase(it);
+		}
+	}
+
+	void SearchIndex::search(SearchResult& _results, const SearchRequest& _request, const std::vector<DataSourceNodePtr>* _sources) const
+	{
+		std::shared_lock lock(m_mutex);
+
+		Bitmap candidates;
+
+		if(_sources)
+		{
+			for (const auto& ds : *_sources)
+			{
+				const auto it = m_sources.find(ds.get());
+				if(it != m_sources.end())
+					candidates.merge(it->second);
+			}
+		}
+		else if(_request.sourceNode || _request.sourceType != SourceType::Invalid)
+		{
+			for (const auto& [source, patches] : m_sources)
+			{
+				if(_request.sourceNode ? matchSource(source, _request.sourceNode) : source->type == _request.sourceType)
+					candidates.merge(patches);
+			}
+		}
+		else
+		{
+			candidates.assign(m_valid);
+		}
+
+		for (const auto& [type, tags] : _request.tags.get())
+		{
+			const auto itType = m_tags.find(type);
+
+			for (const auto& tag : tags.getAdded())
+			{
+				if(itType == m_tags.end())
+					return;
+
+				const auto it = itType->second.find(tag);
+
+				if(it == itType->second.end())
+					return;
+
+				candidates.intersect(it->second);
+			}
+
+			if(itType == m_tags.end())
+				continue;
+
+			for (const auto& tag : tags.getRemoved())
+			{
+				const auto it = itType->second.find(tag);
+
+				if(it != itType->second.end())
+					candidates.subtract(it->second);
+			}
+		}
+
+		for (const auto& type : _request.anyTagOfType)
+		{
+			const auto it = m_tagTypes.find(type);
+
+			if(it == m_tagTypes.end())
+				return;
+
+			candidates.intersect(it->second);
+		}
+
+		for (const auto& type : _request.noTagOfType)
+		{
+			const auto it = m_tagTypes.find(type);
+
+			if(it != m_tagTypes.end())
+				candidates.subtract(it->second);
+		}
+
+		auto addResult = [&](const uint32_t _id)
+		{
+			const auto& e = m_entries[_id];
+
+			if(!e.patch)
+				return;
+
+			if(!_request.name.empty() && e.name.find(_request.name) == std::string::npos)
+				return;
+
+			if(_request.customCompareFunc && !_request.customCompareFunc(*e.patch))
+				return;
+
+			_results.insert(e.patch);
+		};
+
+		if(_request.name.size() >= 3)
+		{
+			// only patches that have the rarest trigram of the search string can match
+			const std::vector<uint32_t>* rarest = nullptr;
+
+			for(size_t i=0; i+3 <= _request.name.size(); ++i)
+			{
+				const auto it = m_trigrams.find(trigram(&_request.name[i]));
+
+				if(it == m_trigrams.end())
+					return;
+
+				if(!rarest || it->second.size() < rarest->size())
+					rarest = &it->second;
+			}
+
+			for (const auto id : *rarest)
+			{
+				if(candidates.test(id))
+					addResult(id);
+			}
+		}
+		else
+		{
+			candidates.forEach(addResult);
+		}
+	}
+
+	bool SearchIndex::match(const SearchRequest& _request, const PatchPtr& _patch) const
+	{
+		std::shared_lock lock(m_mutex);
+
+		const auto it = m_ids.find(_patch.get());
+
+		if(it == m_ids.end())
+			return _request.match(*_patch);
+
+		return matchEntry(_request, m_entries[it->second]);
+	}
+
+	size_t SearchIndex::size() const
+	{
+		std::shared_lock lock(m_mutex);
+		return m_ids.size();
+	}
+
+	void SearchIndex::add(const PatchPtr& _patch)
+	{
+		const auto it = m_ids.find(_patch.get());
+
+		uint32_t id;
+
+		if(it != m_ids.end())
+		{
+			id = it->second;
+			unindex(id);
+		}
+		else
+		{
+			if(!m_freeIds.empty())
+			{
+				id = m_freeIds.back();
+				m_freeIds.pop_back();
+			}
+			else
+			{
+				id = static_cast<uint32_t>(m_entries.size());
+				m_entries.emplace_back();
+			}
+
+			m_ids.insert({_patch.get(), id});
+		}
+
+		m_entries[id].patch = _patch;
+
+		index(id);
+	}
+
+	void SearchIndex::unindex(const uint32_t _id)
+	{
+		auto& e = m_entries[_id];
+
+		m_valid.reset(_id);
+
+		for (const auto& [type, tag] : e.tags)
+		{
+			auto& tags = m_tags[type];
+			const auto it = tags.find(tag);
+
+			if(it == tags.end())
+				continue;
+
+			it->second.reset(_id);
+
+			if(it->second.empty())
+				tags.erase(it);
+		}
+
+		for (const auto& type : e.tagTypes)
+			m_tagTypes[type].reset(_id);
+
+		const auto itSource = m_sources.find(e.source);
+
+		if(itSource != m_sources.end())
+		{
+			itSource->second.reset(_id);
+
+			// data sources may be destroyed once all of their patches are gone, do not keep dangling keys
+			if(itSource->second.empty())
+				m_sources.erase(itSource);
+		}
+
+		if(e.name.size() >= 3)
+			m_staleTrigramCount += e.name.size() - 2;
+
+		e.name.clear();
+		e.source = nullptr;
+		e.tags.clear();
+		e.tagTypes.clear();
+	}
+
+	void SearchIndex::index(const uint32_t _id)
+	{
+		auto& e = m_entries[_id];
+		const auto& patch = *e.patch;
+
+		m_valid.set(_id);
+
+		e.name = lowercase(patch.getName());
+		e.source = patch.source.lock().get();
+
+		for (const auto& [type, tags] : patch.getTags().get())
+		{
+			if(!tags.empty())
+			{
+				e.tagTypes.push_back(type);
+				m_tagTypes[type].set(_id);
+			}
+
+			for (const auto& tag : tags.getAdded())
+			{
+				e.tags.emplace_back(type, tag);
+				m_tags[type][tag].set(_id);
+			}
+		}
+
+		if(e.source)
+			m_sources[e.source].set(_id);
+
+		addTrigrams(_id, e.name);
+
+		if(m_staleTrigramCount > m_trigramCount)
+			rebuildTrigrams();
+	}
+
+	void SearchIndex::addTrigrams(const uint32_t _id, const std::string& _name)
+	{
+		for(size_t i=0; i+3 <= _name.size(); ++i)
+		{
+			auto& list = m_trigrams[trigram(&_name[i])];
+
+			// a name may contain the same trigram more than once
+			if(list.empty() || list.back() != _id)
+				list.push_back(_id);
+		}
+
+		if(_name.size() >= 3)
+			m_trigramCount += _name.size() - 2;
+	}
+
+	void SearchIndex::rebuildTrigrams()
+	{
+		m_trigrams.clear();
+		m_trigramCount = 0;
+		m_staleTrigramCount = 0;
+
+		for(uint32_t id=0; id<static_cast<uint32_t>(m_entries.size()); ++id)
+		{
+			if(m_entries[id].patch)
+				addTrigrams(id, m_entries[id].name);
+		}
+	}
+
+	bool SearchIndex::matchEntry(const SearchRequest& _request, const Entry& _entry) const
+	{
+		if(_request.sourceNode)
+		{
+			if(!matchSource(_entry.source, _request.sourceNode))
+				return false;
+		}
+		else if(_request.sourceType != SourceType::Invalid)
+		{
+			if(!_entry.source || _entry.source->type != _request.sourceType)
+				return false;
+		}
+
+		if(!_request.name.empty() && _entry.name.find(_request.name) == std::string::npos)
+			return false;
+
+		const auto& patch = *_entry.patch;
+
+		for (const auto& [type, tags] : _request.tags.get())
+		{
+			const auto& patchTags = patch.getTags(type);
+
+			for (const auto& tag : tags.getAdded())
+			{
+				if(!patchTags.containsAdded(tag))
+					return false;
+			}
+
+			for (const auto& tag : tags.getRemoved())
+			{
+				if(patchTags.containsAdded(tag))
+					return false;
+			}
+		}
+
+		for (const auto& type : _request.anyTagOfType)
+		{
+			if(patch.getTags(type).empty())
+				return false;
+		}
+
+		for (const auto& type : _request.noTagOfType)
+		{
+			if(!patch.getTags(type).empty())
+				return false;
+		}
+
+		return !_request.customCompareFunc || _request.customCompareFunc(patch);
+	}
+
+	bool SearchIndex::matchSource(const DataSourceNode* _source, const DataSourceNodePtr& _search)
+	{
+		while(_source)
+		{
+			if(_source == _search.get())
+				return true;
+
+			_source = _source->getParent().get();
+		}
+		return false;
+	}
+
+	uint32_t SearchIndex::trigram(const char* _c)
+	{
+		return static_cast<uint32_t>(static_cast<uint8_t>(_c[0])) << 16 | static_cast<uint32_t>(static_cast<uint8_t>(_c[1])) << 8 | static_cast<uint8_t>(_c[2]);
+	}
+
+	std::string SearchIndex::lowercase(const std::string& _src)
+	{
+		std::string str(_src);
+		for (char& i : str)
+			i = static_cast<char>(tolower(i));
+		return str;
+	}
+}
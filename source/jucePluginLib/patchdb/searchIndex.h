@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "search.h"
+
+namespace pluginLib::patchDB
+{
+	// Inverted index over all patches of the database. Maps name trigrams, tags and data sources to the patches that
+	// have them so that a search only needs to look at patches that can possibly match
+	class SearchIndex
+	{
+	public:
+		void update(const std::vector<PatchPtr>& _patches);
+		void remove(const std::vector<PatchPtr>& _patches);
+
+		// evaluates the request for all indexed patches. If _sources is not null, only patches of these data sources are
+		// considered, otherwise the source node or source type of the request is used. Requests for a patch (request.patch)
+		// are not handled here
+		void search(SearchResult& _results, const SearchRequest& _request, const std::vector<DataSourceNodePtr>* _sources) const;
+
+		// same as SearchRequest::match but uses the indexed data of the patch
+		bool match(const SearchRequest& _request, const PatchPtr& _patch) const;
+
+		size_t size() const;
+
+	private:
+		class Bitmap
+		{
+		public:
+			void set(uint32_t _index);
+			void reset(uint32_t _index);
+			bool test(uint32_t _index) const;
+			bool empty() const;
+
+			void assign(const Bitmap& _other) { m_bits = _other.m_bits; }
+			void merge(const Bitmap& _other);
+			void intersect(const Bitmap& _other);
+			void subtract(const Bitmap& _other);
+			void clear() { m_bits.clear(); }
+
+			template<typename TFunc> void forEach(TFunc _func) const
+			{
+				for(size_t w=0; w<m_bits.size(); ++w)
+				{
+					auto bits = m_bits[w];
+
+					while(bits)
+					{
+						const auto bit = countTrailingZeros(bits);
+						_func(static_cast<uint32_t>(w * 64 + bit));
+						bits &= bits - 1;
+					}
+				}
+			}
+
+		private:
+			static uint32_t countTrailingZeros(uint64_t _v);
+
+			std::vector<uint64_t> m_bits;
+		};
+
+		struct Entry
+		{
+			PatchPtr patch;
+			std::string name;	// lowercase
+			const DataSourceNode* source = nullptr;
+			std::vector<std::pair<TagType, Tag>> tags;
+			std::vector<TagType> tagTypes;	// types that the patch has any tags of
+		};
+
+		void add(const PatchPtr& _patch);
+		void unindex(uint32_t _id);
+		void index(uint32_t _id);
+		void addTrigrams(uint32_t _id, const std::string& _name);
+		void rebuildTrigrams();
+
+		bool matchEntry(const SearchRequest& _request, const Entry& _entry) const;
+		static bool matchSource(const DataSourceNode* _source, const DataSourceNodePtr& _search);
+
+		static uint32_t trigram(const char* _c);
+		static std::string lowercase(const std::string& _src);
+
+		mutable std::shared_mutex m_mutex;
+
+		std::vector<Entry> m_entries;
+		std::unordered_map<const Patch*, uint32_t> m_ids;
+		std::vector<uint32_t> m_freeIds;
+
+		Bitmap m_valid;
+		std::map<TagType, std::map<Tag, Bitmap>> m_tags;
+		std::map<TagType, Bitmap> m_tagTypes;
+		std::unordered_map<const DataSourceNode*, Bitmap> m_sources;
+
+		// posting lists are not cleaned up when a patch is removed or renamed, matches are verified against the name.
+		// The lists are rebuilt once the number of stale entries exceeds the number of valid ones
+		std::unordered_map<uint32_t, std::vector<uint32_t>> m_trigrams;
+		size_t m_trigramCount = 0;
+		size_t m_staleTrigramCount = 0;
+	};
+}
@@ -0,0 +1,342 @@
+#include "sysexstore.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "patch.h"
+
+#include "baseLib/filesystem.h"
+
+#include "dsp56kBase/logging.h"
+
+namespace pluginLib::patchDB
+{
+	namespace
+	{
+		constexpr char g_magic[] = "PMsx";
+		constexpr uint32_t g_version = 1;
+
+		constexpr char g_filePrefix[] = "patchmanagerdb.";
+		constexpr char g_fileExtension[] = ".sysex";
+
+		// rewrite the store if it is mostly unreferenced data, but not for a few bytes
+		constexpr uint64_t g_minCompactSize = 1024 * 1024;
+
+		// Stores of other plugin instances may still be in use. A store that is in use by an instance that saves
+		// its cache has been written to recently, only stores that have not been touched for a while are removed
+		constexpr int64_t g_minUnusedAgeSeconds = 7 * 24 * 60 * 60;
+
+		uint64_t createId()
+		{
+			std::random_device rd;
+			const auto time = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+			const auto id = (static_cast<uint64_t>(rd()) << 32 | rd()) ^ time;
+			return id ? id : 1;
+		}
+	}
+
+	// ___________________________________
+	// PatchSysex
+	//
+
+	PatchSysex::PatchSysex(const PatchSysex& _other) : m_store(_other.m_store), m_offset(_other.m_offset), m_size(_other.m_size)
+	{
+		if(_other.m_loaded.load(std::memory_order_acquire))
+			m_data = _other.m_data;
+		else
+			m_loaded.store(false, std::memory_order_relaxed);
+	}
+
+	const Data& PatchSysex::get() const
+	{
+		if(m_loaded.load(std::memory_order_acquire))
+			return m_data;
+
+		std::scoped_lock lock(m_store->m_mutex);
+
+		if(!m_loaded.load(std::memory_order_relaxed))
+		{
+			if(!m_store->read(m_data, m_offset, m_size))
+			{
+				LOG("Failed to read patch data at offset " << m_offset << " from sysex store");
+				m_data.clear();
+			}
+			m_loaded.store(true, std::memory_order_release);
+		}
+
+		return m_data;
+	}
+
+	void PatchSysex::set(Data&& _data)
+	{
+		m_data = std::move(_data);
+		m_loaded.store(true, std::memory_order_release);
+		m_store.reset();
+		m_offset = 0;
+		m_size = static_cast<uint32_t>(m_data.size());
+	}
+
+	void PatchSysex::set(const Data& _data)
+	{
+		set(Data(_data));
+	}
+
+	void PatchSysex::setStored(const SysexStorePtr& _store, const uint64_t _offset, const uint32_t _size)
+	{
+		m_data.clear();
+		m_loaded.store(false, std::memory_order_release);
+		m_store = _store;
+		m_offset = _offset;
+		m_size = _size;
+	}
+
+	void PatchSysex::relocate(const SysexStorePtr& _store, const uint64_t _offset)
+	{
+		m_store = _store;
+		m_offset = _offset;
+	}
+
+	// ___________________________________
+	// SysexStore
+	//
+
+	SysexStore::SysexStore(const std::string& _folder) : m_folder(baseLib::filesystem::validatePath(_folder))
+	{
+	}
+
+	bool SysexStore::open(const uint64_t _id, const uint64_t _size)
+	{
+		std::scoped_lock lock(m_mutex);
+
+		if(!m_file.open(getFilename(_id)))
+			return false;
+
+		if(m_file.size() < HeaderSize || m_file.size() < _size || _size < HeaderSize)
+		{
+			m_file.close();
+			return false;
+		}
+
+		uint32_t version;
+		uint64_t id;
+
+		::memcpy(&version, m_file.data() + 4, sizeof(version));
+		::memcpy(&id, m_file.data() + 8, sizeof(id));
+
+		if(::memcmp(m_file.data(), g_magic, 4) != 0 || version != g_version || id != _id)
+		{
+			m_file.close();
+			return false;
+		}
+
+		m_id = _id;
+		m_size = _size;
+
+		return true;
+	}
+
+	bool SysexStore::write(const std::vector<PatchPtr>& _patches)
+	{
+		if(!m_id)
+			return compact(_patches);
+
+		uint64_t referencedSize = 0;
+
+		for (const auto& patch : _patches)
+		{
+			if(patch->sysex.isStoredIn(this))
+				referencedSize += patch->sysex.getSize();
+		}
+
+		const auto storedSize = m_size - HeaderSize;
+		const auto unreferencedSize = storedSize > referencedSize ? storedSize - referencedSize : 0;
+
+		if(unreferencedSize > g_minCompactSize && unreferencedSize > referencedSize)
+			return compact(_patches);
+
+		// appending fails if the file is opened by another instance on platforms that do not allow shared write access
+		return append(_patches) || compact(_patches);
+	}
+
+	void SysexStore::removeUnusedFiles() const
+	{
+		std::vector<std::string> files;
+		baseLib::filesystem::getDirectoryEntries(files, m_folder);
+
+		const auto current = baseLib::filesystem::getFilenameWithoutPath(getFilename(m_id));
+		const auto now = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+		for (const auto& file : files)
+		{
+			const auto name = baseLib::filesystem::getFilenameWithoutPath(file);
+
+			if(name == current || name.rfind(g_filePrefix, 0) != 0 || !baseLib::filesystem::hasExtension(name, g_fileExtension))
+				continue;
+
+			baseLib::filesystem::FileInfo info;
+
+			if(!baseLib::filesystem::getFileInfo(info, file) || now - info.modificationTime < g_minUnusedAgeSeconds)
+				continue;
+
+			baseLib::filesystem::remove(file);
+		}
+	}
+
+	bool SysexStore::read(Data& _data, const uint64_t _offset, const uint32_t _size) const
+	{
+		if(_offset < HeaderSize || _offset + _size > m_size || _offset + _size > m_file.size())
+			return false;
+
+		const auto* src = m_file.data() + _offset;
+		_data.assign(src, src + _size);
+
+		return true;
+	}
+
+	bool SysexStore::append(const std::vector<PatchPtr>& _patches)
+	{
+		std::vector<uint8_t> buffer;
+		std::vector<std::pair<Patch*, uint64_t>> appended;	// patch => offset in buffer
+
+		for (const auto& patch : _patches)
+		{
+			if(patch->sysex.isStoredIn(this))
+				continue;
+
+			const auto& data = patch->getSysex();
+
+			appended.emplace_back(patch.get(), buffer.size());
+			buffer.insert(buffer.end(), data.begin(), data.end());
+		}
+
+		if(appended.empty())
+			return true;
+
+		std::scoped_lock lock(m_mutex);
+
+		const auto filename = getFilename(m_id);
+
+		// The current mapping stays valid until the grown file has been mapped again. If anything fails, the store
+		// keeps working with what it has
+		auto* f = baseLib::filesystem::openFile(filename, "r+b");
+
+		if(!f)
+			return false;
+
+		// data is always appended at the end of the file. If a previous write has not been completed, the data
+		// written back then is not referenced and will be dropped by the next compaction
+		fseek(f, 0, SEEK_END);
+		const auto base = static_cast<uint64_t>(ftell(f));
+
+		const auto written = buffer.empty() || fwrite(buffer.data(), 1, buffer.size(), f) == buffer.size();
+		fclose(f);
+
+		if(!written)
+			return false;
+
+		baseLib::MappedFile file;
+
+		if(!file.open(filename) || file.size() < base + buffer.size())
+			return false;
+
+		m_file = std::move(file);
+		m_size = base + buffer.size();
+
+		const auto self = shared_from_this();
+
+		for (const auto& [patch, offset] : appended)
+			patch->sysex.relocate(self, base + offset);
+
+		return true;
+	}
+
+	bool SysexStore::compact(const std::vector<PatchPtr>& _patches)
+	{
+		std::vector<uint8_t> buffer;
+		std::vector<uint64_t> offsets;
+		offsets.reserve(_patches.size());
+
+		std::scoped_lock lock(m_mutex);
+
+		for (const auto& patch : _patches)
+		{
+			offsets.push_back(HeaderSize + buffer.size());
+
+			const auto& s = patch->sysex;
+
+			if(s.isStoredIn(this))
+			{
+				// copy from the mapping, there is no need to load the data into the patch
+				if(s.getOffset() + s.getSize() > m_file.size())
+					return false;
+
+				const auto* src = m_file.data() + s.getOffset();
+				buffer.insert(buffer.end(), src, src + s.getSize());
+			}
+			else
+			{
+				const auto& data = s.get();
+				buffer.insert(buffer.end(), data.begin(), data.end());
+			}
+		}
+
+		const auto id = createId();
+		const auto filename = getFilename(id);
+
+		if(!writeFile(filename, id, buffer))
+		{
+			baseLib::filesystem::remove(filename);
+			return false;
+		}
+
+		baseLib::MappedFile file;
+
+		if(!file.open(filename))
+			return false;
+
+		m_file = std::move(file);
+		m_id = id;
+		m_size = HeaderSize + buffer.size();
+
+		const auto self = shared_from_this();
+
+		for(size_t i=0; i<_patches.size(); ++i)
+			_patches[i]->sysex.relocate(self, offsets[i]);
+
+		LOG("Created patch sysex store " << filename << ", " << m_size << " bytes");
+
+		return true;
+	}
+
+	std::string SysexStore::getFilename(const uint64_t _id) const
+	{
+		char id[17];
+		snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(_id));
+		return m_folder + g_filePrefix + id + g_fileExtension;
+	}
+
+	bool SysexStore::writeFile(const std::string& _filename, const uint64_t _id, const std::vector<uint8_t>& _data)
+	{
+		std::vector<uint8_t> header(HeaderSize);
+
+		::memcpy(header.data(), g_magic, 4);
+		::memcpy(header.data() + 4, &g_version, sizeof(g_version));
+		::memcpy(header.data() + 8, &_id, sizeof(_id));
+
+		auto* f = baseLib::filesystem::openFile(_filename, "wb");
+
+		if(!f)
+			return false;
+
+		auto success = fwrite(header.data(), 1, header.size(), f) == header.size();
+
+		if(success && !_data.empty())
+			success = fwrite(_data.data(), 1, _data.size(), f) == _data.size();
+
+		fclose(f);
+
+		return success;
+	}
+}
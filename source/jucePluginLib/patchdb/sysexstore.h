@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "patchdbtypes.h"
+
+#include "baseLib/mappedFile.h"
+
+namespace pluginLib::patchDB
+{
+	// Sysex data of a patch. Patches that are loaded from the cache do not hold their data, it is read from the sysex
+	// store on first access
+	class PatchSysex
+	{
+	public:
+		PatchSysex() = default;
+		PatchSysex(const PatchSysex& _other);
+
+		PatchSysex& operator = (const PatchSysex&) = delete;
+
+		const Data& get() const;
+
+		void set(Data&& _data);
+		void set(const Data& _data);
+
+		// the data is located in _store at the given offset and is read on first access
+		void setStored(const SysexStorePtr& _store, uint64_t _offset, uint32_t _size);
+
+		bool isStoredIn(const SysexStore* _store) const { return m_store.get() == _store; }
+
+		uint64_t getOffset() const { return m_offset; }
+		uint32_t getSize() const { return m_size; }	// does not require the data to be loaded
+
+	private:
+		friend class SysexStore;
+
+		// called by the store once the data has been written, data that is already loaded is kept
+		void relocate(const SysexStorePtr& _store, uint64_t _offset);
+
+		mutable Data m_data;
+		mutable std::atomic<bool> m_loaded{true};
+
+		SysexStorePtr m_store;
+		uint64_t m_offset = 0;
+		uint32_t m_size = 0;
+	};
+
+	// Append-only file that holds the sysex data of all cached patches, addressed by offset. The file is memory mapped,
+	// only the data of patches that are accessed is ever read.
+	// Other plugin instances may have mapped the same file, which is why a store file is never truncated or rewritten.
+	// Compacting the store creates a new file with a new id
+	class SysexStore : public std::enable_shared_from_this<SysexStore>
+	{
+	public:
+		static constexpr uint32_t HeaderSize = 16;
+
+		explicit SysexStore(const std::string& _folder);
+
+		// maps an existing store. Fails if the file does not exist anymore or has not been completely written
+		bool open(uint64_t _id, uint64_t _size);
+
+		// makes sure that the data of all patches is part of the store. Data of new patches is appended. If the store
+		// mostly consists of data that is no longer referenced or cannot be appended to, a new file is created that
+		// only contains the data of the given patches
+		bool write(const std::vector<PatchPtr>& _patches);
+
+		// deletes the files of other stores in the folder that have not been written to for a long time. Fails silently
+		// for files that are still in use
+		void removeUnusedFiles() const;
+
+		uint64_t getId() const { return m_id; }
+		uint64_t getSize() const { return m_size; }
+
+	private:
+		friend class PatchSysex;
+
+		bool read(Data& _data, uint64_t _offset, uint32_t _size) const;
+
+		bool append(const std::vector<PatchPtr>& _patches);
+		bool compact(const std::vector<PatchPtr>& _patches);
+
+		std::string getFilename(uint64_t _id) const;
+		static bool writeFile(const std::string& _filename, uint64_t _id, const std::vector<uint8_t>& _data);
+
+		const std::string m_folder;
+
+		mutable std::mutex m_mutex;
+		baseLib::MappedFile m_file;
+
+		uint64_t m_id = 0;
+		uint64_t m_size = 0;
+	};
+}
@@ -65,6 +65,11 @@ namespace pluginLib
 	}
 
 	void Processor::addMidiEvent(const synthLib::SMidiEvent& _ev)
+	{
+		routeMidiEvent(_ev, false);
+	}
+
+	void Processor::routeMidiEvent(const synthLib::SMidiEvent& _ev, const bool _isAudioThread)
 	{
 		audioCaptureCheckArm(_ev);
 
@@ -90,7 +95,12 @@ namespace pluginLib
 		if (m_midiRoutingMatrix.enabled(_ev, synthLib::MidiEventSource::Editor))
 			getController().enqueueMidiMessages({_ev});
 		if (m_midiRoutingMatrix.enabled(_ev, synthLib::MidiEventSource::Device))
-			getPlugin().addMidiEvent(_ev);
+		{
+			if (_isAudioThread)
+				getPlugin().addMidiEventFromAudioThread(synthLib::SMidiEvent(_ev));
+			else
+				getPlugin().addMidiEvent(_ev);
+		}
 		if (m_midiRoutingMatrix.enabled(_ev, synthLib::MidiEventSource::Physical))
 			m_midiPorts.send(_ev);
 	}
@@ -229,7 +239,7 @@ namespace pluginLib
 
 		m_plugin.reset(new synthLib::Plugin(m_device.get(), [this](synthLib::Device* _device)
 		{
-			return onDeviceInvalid(_device);
+			onDeviceInvalid(_device);
 		}));
 
 		return *m_plugin;
@@ -808,7 +818,7 @@ namespace pluginLib
 
 			ev.offset = std::max(0, metadata.samplePosition);
 
-			addMidiEvent(ev);
+			routeMidiEvent(ev, true);
 		}
 
 		midiMessages.clear();
@@ -846,7 +856,7 @@ namespace pluginLib
 
 	    for (auto& e : m_midiOut)
 	    {
-		    addMidiEvent(e);
+		    routeMidiEvent(e, true);
 
 			if (!getMidiRoutingMatrix().enabled(e, synthLib::MidiEventSource::Host))
 			    continue;
@@ -1126,40 +1136,44 @@ namespace pluginLib
 		return 0.0f;
 	}
 
-	synthLib::Device* Processor::onDeviceInvalid(synthLib::Device* _device)
+	void Processor::onDeviceInvalid(synthLib::Device* _device)
 	{
-		if(dynamic_cast<bridgeClient::RemoteDevice*>(_device))
+		// called by the audio thread, which outputs silence until the device has been replaced. Creating a new device
+		// takes a while, it is done on the message thread
+		juce::MessageManager::callAsync([this, _device]
 		{
-			try
+			// replaced in the meantime
+			if(m_device.get() != _device)
+				return;
+
+			if(dynamic_cast<bridgeClient::RemoteDevice*>(_device))
 			{
-				// attempt one reconnect
-				auto* newDevice = createRemoteDevice();
-				if(newDevice && newDevice->isValid())
+				try
 				{
-					m_device.reset(newDevice);
-					return newDevice;
+					// attempt one reconnect
+					std::unique_ptr<synthLib::Device> newDevice(createRemoteDevice());
+
+					if(newDevice && newDevice->isValid())
+					{
+						getPlugin().setDevice(newDevice.get());
+						(void)m_device.release();
+						m_device = std::move(newDevice);
+						return;
+					}
 				}
-			}
-			catch (synthLib::DeviceException& e)
-			{
-				juce::MessageManager::callAsync([e]
+				catch (synthLib::DeviceException& e)
 				{
 					genericUI::MessageBox::showOk(genericUI::MessageBox::Icon::Warning,
 						"Device creation failed:",
 						std::string("The connection to the remote server has been lost and a reconnect failed. Processing mode has been switched to local processing\n\n") + 
 						e.what() + "\n\n");
-				});
+				}
 			}
-		}
 
-		setDeviceType(DeviceType::Local);
+			setDeviceType(DeviceType::Local);
 
-		juce::MessageManager::callAsync([this]
-		{
 			getController().onStateLoaded();
 		});
-
-		return m_device.get();
 	}
 
 	bool Processor::rebootDevice()
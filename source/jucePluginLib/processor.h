@@ -68,6 +68,7 @@ namespace pluginLib
 		Processor(const BusesProperties& _busesProperties, Properties _properties);
 		~Processor() override;
 
+		// thread-safe, not to be used by the audio thread
 		void addMidiEvent(const synthLib::SMidiEvent& _ev);
 
 		void handleIncomingMidiMessage(juce::MidiInput* _source, const juce::MidiMessage& _message);
@@ -181,6 +182,9 @@ namespace pluginLib
 		void destroyController();
 
 	private:
+		// events from the audio thread take a lock-free path into the plugin
+		void routeMidiEvent(const synthLib::SMidiEvent& _ev, bool _isAudioThread);
+
 		void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override;
 		void releaseResources() override;
 
@@ -240,7 +244,7 @@ namespace pluginLib
 
 		synthLib::DeviceError getDeviceError() const { return m_deviceError; }
 
-		synthLib::Device* onDeviceInvalid(synthLib::Device* _device);
+		void onDeviceInvalid(synthLib::Device* _device);
 
 	protected:
 		synthLib::DeviceError m_deviceError = synthLib::DeviceError::None;
@@ -948,7 +948,7 @@ namespace juceRmlUi
 				return;
 			}
 
-			repaint();
+			renderSoftware();
 		}
 		else if (m_openGLContext)
 			m_openGLContext->triggerRepaint();
@@ -1034,6 +1034,38 @@ namespace juceRmlUi
 		return _size;
 	}
 
+	void RmlComponent::renderSoftware()
+	{
+		auto* r = dynamic_cast<RendererJuce*>(m_renderInterface.get());
+
+		if (!r)
+		{
+			m_renderDone = true;
+			return;
+		}
+
+		r->beginFrame(getRenderSize());
+
+		m_renderProxy->executeRenderFunctions();
+
+		const auto& dirtyRects = r->endFrame();
+
+		// nothing changed, there is no need to wait for a paint call
+		if (dirtyRects.empty())
+		{
+			m_renderDone = true;
+			return;
+		}
+
+		const auto scale = getOpenGLRenderingScale();
+
+		for (const auto& rect : dirtyRects)
+		{
+			const auto area = juce::Rectangle<float>(static_cast<float>(rect.Left()), static_cast<float>(rect.Top()), static_cast<float>(rect.Width()), static_cast<float>(rect.Height())) / scale;
+			repaint(area.getSmallestIntegerContainer());
+		}
+	}
+
 	void RmlComponent::paint(juce::Graphics& _g)
 	{
 		if (m_openGLContext)
@@ -1054,13 +1086,7 @@ namespace juceRmlUi
 		const auto clipOrigin = _g.getClipBounds().getPosition();
 		const bool useDirectPath = img.isValid() && clipOrigin.isOrigin();
 
-		const auto size = getRenderSize();
-
-		r->beginFrame(_g, size);
-
-		m_renderProxy->executeRenderFunctions();
-
-		r->endFrame(useDirectPath ? img : juce::Image(), getOpenGLRenderingScale());
+		r->present(_g, useDirectPath ? img : juce::Image(), getOpenGLRenderingScale());
 
 		m_renderDone = true;
 	}
@@ -155,6 +155,7 @@ namespace juceRmlUi
 		void destroyRmlContext();
 		void updateRmlContextDimensions();
 		void startNextFrameTimer();
+		void renderSoftware();
 
 		Rml::Vector2i getRenderSize() const;
 
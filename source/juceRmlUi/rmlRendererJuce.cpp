@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <functional>
 
 #include "baseLib/endian.h"
 
@@ -43,6 +45,7 @@ namespace juceRmlUi
 
 		struct Geometry
 		{
+			uint64_t id = 0;	// unique for the lifetime of the renderer, handles are reused
 			Rml::Rectanglef bounds;
 			Rml::Rectanglef uvBounds;
 			std::vector<Quad> quads;
@@ -124,6 +127,7 @@ namespace juceRmlUi
 			static constexpr int PadW = 4;	// minimum 1 and up to N bytes of padding to ensure we have pixel groups of width N, required for some SIMD ops
 			static constexpr int PadH = 1;
 
+			uint64_t id = 0;	// changes whenever new content is generated, pooled images are reused
 			int width = 0;
 			int paddedWidth = 0;
 			int height = 0;
@@ -190,6 +194,50 @@ namespace juceRmlUi
 			std::unique_ptr<Image> m_nextMip;
 		};
 
+		struct DrawCall
+		{
+			const Geometry* geometry;
+			Image* texture;
+			Rml::Vector2f translation;
+			Rml::Rectanglei clip;
+		};
+
+		// identifies a draw call across frames
+		struct DrawKey
+		{
+			uint64_t geometry;
+			uint64_t texture;
+			Rml::Vector2f translation;
+			int clipLeft, clipTop, clipRight, clipBottom;
+
+			bool operator == (const DrawKey& _k) const noexcept
+			{
+				return geometry == _k.geometry && texture == _k.texture &&
+					translation.x == _k.translation.x && translation.y == _k.translation.y &&
+					clipLeft == _k.clipLeft && clipTop == _k.clipTop && clipRight == _k.clipRight && clipBottom == _k.clipBottom;
+			}
+		};
+
+		struct DrawKeyHash
+		{
+			size_t operator()(const DrawKey& _k) const noexcept
+			{
+				auto h = _k.geometry * 0x9e3779b97f4a7c15ull;
+				h ^= _k.texture + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+				h ^= static_cast<uint64_t>(std::hash<float>()(_k.translation.x)) + (h << 6) + (h >> 2);
+				h ^= static_cast<uint64_t>(std::hash<float>()(_k.translation.y)) + (h << 6) + (h >> 2);
+				h ^= static_cast<uint64_t>(static_cast<uint32_t>(_k.clipLeft) | static_cast<uint64_t>(static_cast<uint32_t>(_k.clipTop)) << 32) + (h << 6) + (h >> 2);
+				h ^= static_cast<uint64_t>(static_cast<uint32_t>(_k.clipRight) | static_cast<uint64_t>(static_cast<uint32_t>(_k.clipBottom)) << 32) + (h << 6) + (h >> 2);
+				return static_cast<size_t>(h);
+			}
+		};
+
+		struct DrawRecord
+		{
+			DrawKey key;
+			Rml::Rectanglei bounds;	// area of the render target that the draw call may touch, invalid if none
+		};
+
 		static_assert(Image::padWidth(7) == 8);
 		static_assert(Image::padWidth(8) == 12);
 		static_assert(Image::padWidth(9) == 12);
@@ -211,42 +259,143 @@ namespace juceRmlUi
 		Colors toShort(const Colorb& _c) noexcept { return Colors{ toShort(_c.r), toShort(_c.g), toShort(_c.b), toShort(_c.a)}; }
 		Colorb toByte(const Colori& _c) noexcept { return Colorb{ toByte(_c.r), toByte(_c.g), toByte(_c.b), toByte(_c.a) }; }
 
-		template<bool HasAlphaBlend, bool HasColor>
-		void blit(Image& _dst, const int _dstX, const int _dstY, const Image& _src, const int _srcX, const int _srcY, const int _srcW, const int _srcH, const Colorb& _color) noexcept
+#if HAVE_SSE
+		// The SIMD helpers below process RGBA8 pixels as 16 bit channels, two pixels per register. They produce the same
+		// results as the scalar code, including the wrap around of channels that exceed 255 if the source is not premultiplied
+
+		__m128i toShortVec(const Colorb& _c) noexcept
 		{
-			const auto* src = _src.getColorPointer(_srcX, _srcY);
+			return _mm_setr_epi16(_c.r, _c.g, _c.b, _c.a, _c.r, _c.g, _c.b, _c.a);
+		}
 
-			auto* dst = _dst.getColorPointer(_dstX, _dstY);
+		// (_a * _b) >> 8 per channel
+		__m128i mul16(const __m128i _a, const __m128i _b) noexcept
+		{
+			return _mm_srli_epi16(_mm_mullo_epi16(_a, _b), 8);
+		}
 
-			for (int y = 0; y < _srcH; ++y)
+		// _src + (_dst * (255 - _src.a)) >> 8 per channel, expects premultiplied alpha in _src
+		__m128i blend16(const __m128i _src, const __m128i _dst) noexcept
+		{
+			const auto alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			const auto invAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+			return _mm_and_si128(_mm_add_epi16(_src, mul16(_dst, invAlpha)), _mm_set1_epi16(0xff));
+		}
+#endif
+
+		// copies a row of pixels multiplied with _color, optionally alpha blended onto the existing ones
+		template<bool HasAlphaBlend>
+		void blitRow(Colorb* _dst, const Colorb* _src, const int _count, const Colorb& _color) noexcept
+		{
+			int x = 0;
+#if HAVE_SSE
+			const auto zero = _mm_setzero_si128();
+			const auto col = toShortVec(_color);
+
+			// process 4 pixels at a time
+			for (; x <= _count - 4; x += 4)
 			{
-				if constexpr (HasColor || HasAlphaBlend)
+				const auto s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_src + x));
+
+				auto lo = mul16(_mm_unpacklo_epi8(s, zero), col);
+				auto hi = mul16(_mm_unpackhi_epi8(s, zero), col);
+
+				if constexpr (HasAlphaBlend)
 				{
-					src = _src.getColorPointer(_srcX, _srcY + y);
-					dst = _dst.getColorPointer(_dstX, _dstY + y);
+					const auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_dst + x));
 
-					for (int x = 0; x < _srcW; ++x, ++src, ++dst)
-					{
-						if constexpr (HasAlphaBlend)
-						{
-							auto existing = toInt(*dst);
-							const auto srcCol = toInt(*src * _color);
-							const auto invAlpha = 255 - srcCol.a;
-							auto newDst = srcCol + ((existing * invAlpha) >> 8);
-							*dst = toByte(newDst);
-						}
-						else
-						{
-							*dst = *src * _color;
-						}
-					}
+					lo = blend16(lo, _mm_unpacklo_epi8(d, zero));
+					hi = blend16(hi, _mm_unpackhi_epi8(d, zero));
+				}
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + x), _mm_packus_epi16(lo, hi));
+			}
+#endif
+			for (; x < _count; ++x)
+			{
+				if constexpr (HasAlphaBlend)
+				{
+					auto existing = toInt(_dst[x]);
+					const auto srcCol = toInt(_src[x] * _color);
+					const auto invAlpha = 255 - srcCol.a;
+					auto newDst = srcCol + ((existing * invAlpha) >> 8);
+					_dst[x] = toByte(newDst);
 				}
 				else
 				{
-					memcpy(dst, src, _srcW * sizeof(Colorb));
-					src += _src.paddedWidth;
-					dst += _dst.paddedWidth;
+					_dst[x] = _src[x] * _color;
+				}
+			}
+		}
+
+		// fills a row of pixels with _color, optionally alpha blended onto the existing ones. _color has premultiplied alpha
+		template<bool AlphaBlend>
+		void fillRow(Colorb* _dst, const int _count, const Colorb& _color) noexcept
+		{
+			int x = 0;
+
+			uint32_t fill;
+			memcpy(&fill, &_color, sizeof(fill));
+
+			if constexpr (AlphaBlend)
+			{
+				const auto invAlpha = 255 - _color.a;
+#if HAVE_SSE
+				const auto zero = _mm_setzero_si128();
+				const auto invAlphaVec = _mm_set1_epi16(static_cast<int16_t>(invAlpha));
+				const auto fillVec = _mm_set1_epi32(static_cast<int>(fill));
+
+				// process 4 pixels at a time
+				for (; x <= _count - 4; x += 4)
+				{
+					const auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_dst + x));
+
+					const auto lo = mul16(_mm_unpacklo_epi8(d, zero), invAlphaVec);
+					const auto hi = mul16(_mm_unpackhi_epi8(d, zero), invAlphaVec);
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + x), _mm_add_epi8(fillVec, _mm_packus_epi16(lo, hi)));
+				}
+#endif
+				for (; x < _count; ++x)
+				{
+					const auto existing = toInt(_dst[x]);
+					_dst[x] = _color + toByte((existing * invAlpha) >> 8);
+				}
+			}
+			else
+			{
+#if HAVE_SSE
+				const auto fillVec = _mm_set1_epi32(static_cast<int>(fill));
+
+				for (; x <= _count - 16; x += 16)
+				{
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + x     ), fillVec);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + x +  4), fillVec);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + x +  8), fillVec);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + x + 12), fillVec);
 				}
+				for (; x <= _count - 4; x += 4)
+				{
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + x), fillVec);
+				}
+#endif
+				for (; x < _count; ++x)
+					_dst[x] = _color;
+			}
+		}
+
+		template<bool HasAlphaBlend, bool HasColor>
+		void blit(Image& _dst, const int _dstX, const int _dstY, const Image& _src, const int _srcX, const int _srcY, const int _srcW, const int _srcH, const Colorb& _color) noexcept
+		{
+			for (int y = 0; y < _srcH; ++y)
+			{
+				const auto* src = _src.getColorPointer(_srcX, _srcY + y);
+				auto* dst = _dst.getColorPointer(_dstX, _dstY + y);
+
+				if constexpr (HasColor || HasAlphaBlend)
+					blitRow<HasAlphaBlend>(dst, src, _srcW, _color);
+				else
+					memcpy(dst, src, _srcW * sizeof(Colorb));
 			}
 		}
 
@@ -283,35 +432,43 @@ namespace juceRmlUi
 			}
 		}
 
+		// _clip is the part of the destination rectangle that is written. The source position is derived from the
+		// unclipped rectangles so that a quad that is rendered in parts looks exactly like one that is rendered at once
 		template<bool AlphaBlend, bool Color>
 		void blit(
 			Image& _dst, const Image& _src,
 			const int _srcX, const int _srcY, const int _srcW, const int _srcH,
-			const int _dstX, const int _dstY, const int _dstW, const int _dstH, const Colorb& _color) noexcept
+			const int _dstX, const int _dstY, const int _dstW, const int _dstH,
+			const Rml::Rectanglei& _clip, const Colorb& _color) noexcept
 		{
 			static constexpr int scaleBits = 18;	// use 14.18 fixed point for the filtering code
 			static constexpr int scaleMask = (1 << scaleBits) - 1;
 
-			int srcY = _srcY << scaleBits;
-
 			const int srcXStep = (_srcW << scaleBits) / _dstW;
 			const int srcYStep = (_srcH << scaleBits) / _dstH;
 
+			const int xBegin = _clip.Left() - _dstX;
+			const int xEnd = _clip.Right() - _dstX;
+			const int yBegin = _clip.Top() - _dstY;
+			const int yEnd = _clip.Bottom() - _dstY;
+
+			int srcY = (_srcY << scaleBits) + static_cast<int>(static_cast<int64_t>(yBegin) * srcYStep);
+
 			auto col = toInt(_color);
 			++col.a;	// adjust for multiplication with right shift later to ensure result is opaque for max alpha, i.e. 255 * (255+1) >> 8 = 255
 
 			auto col16 = toShort(_color);
 
-			for (int y=0; y<_dstH; ++y)
+			for (int y=yBegin; y<yEnd; ++y)
 			{
 				const int srcYi = srcY >> scaleBits;
 				const int fracY = srcY - (srcYi << scaleBits);
 
-				int srcX = _srcX << scaleBits;
+				int srcX = (_srcX << scaleBits) + static_cast<int>(static_cast<int64_t>(xBegin) * srcXStep);
 
-				auto* dst = _dst.getColorPointer(_dstX, _dstY + y);
+				auto* dst = _dst.getColorPointer(_dstX + xBegin, _dstY + y);
 
-				int x=0;
+				int x=xBegin;
 
 				auto* src = _src.getColorPointer(0, srcYi);
 
@@ -333,7 +490,7 @@ namespace juceRmlUi
 					12, 13, 12, 15
 				);
 
-				for (; x < _dstW - 1; x += 2)
+				for (; x < xEnd - 1; x += 2)
 				{
 					// bilinear filtering executed for 2 pixels in parallel, doing 2x2 texel fetches i.e. 8 texels per iteration
 
@@ -422,7 +579,7 @@ namespace juceRmlUi
 					// apply color
 					if constexpr (Color)
 					{
-						__m128i colVec = _mm_set1_epi64x(*reinterpret_cast<int64_t*>(&col16));
+						const __m128i colVec = _mm_setr_epi16(col16.r, col16.g, col16.b, col16.a, col16.r, col16.g, col16.b, col16.a);
 						c = _mm_srli_epi16(_mm_mullo_epi16(c, colVec), 8);
 					}
 
@@ -446,7 +603,7 @@ namespace juceRmlUi
 					dst += 2;
 				}
 #endif
-				for (; x<_dstW; ++x)
+				for (; x<xEnd; ++x)
 				{
 					// bilinear filtering
 					const int srcXi = srcX >> scaleBits;
@@ -504,16 +661,18 @@ namespace juceRmlUi
 			Image& _dst, const Image& _src,
 			const int _srcX, const int _srcY, const int _srcW, const int _srcH,
 			const int _dstX, const int _dstY, const int _dstW, const int _dstH, 
-			const Colorb& _color
+			const Rml::Rectanglei& _clip, const Colorb& _color
 			) noexcept
 		{
 			if constexpr (HasScale)
 			{
-				blit<HasAlphaBlend, HasColor>(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _color);
+				blit<HasAlphaBlend, HasColor>(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _clip, _color);
 			}
 			else
 			{
-				blit<HasAlphaBlend, HasColor>(_dst, _dstX, _dstY, _src, _srcX, _srcY, _dstW, _dstH, _color);
+				const auto offX = _clip.Left() - _dstX;
+				const auto offY = _clip.Top() - _dstY;
+				blit<HasAlphaBlend, HasColor>(_dst, _clip.Left(), _clip.Top(), _src, _srcX + offX, _srcY + offY, _clip.Width(), _clip.Height(), _color);
 			}
 		}
 
@@ -522,12 +681,12 @@ namespace juceRmlUi
 			Image& _dst, const Image& _src,
 			const int _srcX, const int _srcY, const int _srcW, const int _srcH,
 			const int _dstX, const int _dstY, const int _dstW, const int _dstH, 
-			const Colorb& _color, 
+			const Rml::Rectanglei& _clip, const Colorb& _color, 
 			bool hasColor
 			) noexcept
 		{
-			if (hasColor) blit<HasScale, HasAlphaBlend, true >(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _color);
-			else          blit<HasScale, HasAlphaBlend, false>(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _color);
+			if (hasColor) blit<HasScale, HasAlphaBlend, true >(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _clip, _color);
+			else          blit<HasScale, HasAlphaBlend, false>(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _clip, _color);
 		}
 
 		template<bool HasScale>
@@ -535,85 +694,34 @@ namespace juceRmlUi
 			Image& _dst, const Image& _src,
 			const int _srcX, const int _srcY, const int _srcW, const int _srcH,
 			const int _dstX, const int _dstY, const int _dstW, const int _dstH, 
-			const Colorb& _color, 
+			const Rml::Rectanglei& _clip, const Colorb& _color, 
 			bool hasAlphablend, bool hasColor
 			) noexcept
 		{
-			if (hasAlphablend) blit<HasScale, true >(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _color, hasColor);
-			else               blit<HasScale, false>(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _color, hasColor);
+			if (hasAlphablend) blit<HasScale, true >(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _clip, _color, hasColor);
+			else               blit<HasScale, false>(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _clip, _color, hasColor);
 		}
 
 		void blit(
 			Image& _dst, const Image& _src,
 			const int _srcX, const int _srcY, const int _srcW, const int _srcH,
 			const int _dstX, const int _dstY, const int _dstW, const int _dstH, 
-			const Colorb& _color, const bool _hasScale, bool _hasAlphablend, bool _hasColor) noexcept
+			const Rml::Rectanglei& _clip, const Colorb& _color, const bool _hasScale, bool _hasAlphablend, bool _hasColor) noexcept
 		{
-			if (_hasScale) blit<true>(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _color, _hasAlphablend, _hasColor);
-			else          blit<false>(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _color, _hasAlphablend, _hasColor);
+			if (_hasScale) blit<true>(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _clip, _color, _hasAlphablend, _hasColor);
+			else          blit<false>(_dst, _src, _srcX, _srcY, _srcW, _srcH, _dstX, _dstY, _dstW, _dstH, _clip, _color, _hasAlphablend, _hasColor);
 		}
 
 		template<bool AlphaBlend>
 		void fill(Image& _dst,
 			const int _dstX, const int _dstY, const int _dstW, const int _dstH, const Colorb& _color) noexcept
 		{
-			const auto invAlpha = 255 - _color.a;
-
-			const uint32_t fill = *reinterpret_cast<const uint32_t*>(&_color);
-#if HAVE_SSE
-			const __m128i fillVec = _mm_set1_epi32(static_cast<int>(fill));
-#endif
-
 			for (int y=0; y<_dstH; ++y)
-			{
-				if constexpr (AlphaBlend)
-				{
-					auto* dst = _dst.getColorPointer(_dstX, _dstY + y);
-
-					for (int x=0; x<_dstW; ++x)
-					{
-						// alpha blend
-						Colori existingC = toInt(*dst);
-						Colorb newDst = _color + toByte(((existingC * invAlpha) >> 8));
-						*dst++ = newDst;
-					}
-				}
-				else if constexpr (!AlphaBlend)
-				{
-					auto* dst = reinterpret_cast<uint32_t*>(_dst.getColorPointer(_dstX, _dstY + y));
-
-					int x=0;
-#if HAVE_SSE
-					for (; x<=_dstW - 16; x += 16)
-					{
-						_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), fillVec); dst += 4;
-						_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), fillVec); dst += 4;
-						_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), fillVec); dst += 4;
-						_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), fillVec); dst += 4;
-					}
-					for (; x<=_dstW - 4; x += 4)
-					{
-						_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), fillVec);
-						dst += 4;
-					}
-#else
-					for (; x<_dstW - 4; x += 4)
-					{
-						*dst++ = fill;
-						*dst++ = fill;
-						*dst++ = fill;
-						*dst++ = fill;
-					}
-#endif
-
-					for (;x<_dstW; ++x)
-						*dst++ = fill;
-				}
-			}
+				fillRow<AlphaBlend>(_dst.getColorPointer(_dstX, _dstY + y), _dstW, _color);
 		}
 
 		template<bool AlphaBlend>
-		void fillScanline(Image& _dst, const int _yi, float _x0, float _x1, const Colorb& _color, const int _invAlpha, const Rml::Rectanglei& _clip) noexcept
+		void fillScanline(Image& _dst, const int _yi, float _x0, float _x1, const Colorb& _color, const Rml::Rectanglei& _clip) noexcept
 		{
 			if (_x0 > _x1)
 				std::swap(_x0, _x1);
@@ -625,23 +733,8 @@ namespace juceRmlUi
 			const auto xStart = std::max(xi0, _clip.Left());
 			const auto xEnd = std::min(xi1, _clip.Right());
 
-			auto* dst = _dst.getColorPointer(xStart, _yi);
-
-			for (int x = xStart; x < xEnd; ++x)
-			{
-				if constexpr (AlphaBlend)
-				{
-					auto existing = toInt(*dst);
-					auto blended = toInt(_color) + ((existing * _invAlpha) >> 8);
-					*dst = toByte(blended);
-				}
-				else
-				{
-					*dst = _color;
-				}
-				
-				++dst;
-			}
+			if (xStart < xEnd)
+				fillRow<AlphaBlend>(_dst.getColorPointer(xStart, _yi), xEnd - xStart, _color);
 		}
 
 		template<bool AlphaBlend>
@@ -679,8 +772,6 @@ namespace juceRmlUi
 				return;
 			}
 
-			const auto invAlpha = 255 - _color.a;
-
 			// Clamp Y coordinates to clip region before loops to avoid per-scanline checks
 			const auto yStart = std::max(_clip.Top(), static_cast<int>(_p0.y));
 			const auto yMid = std::clamp(static_cast<int>(_p1.y), _clip.Top(), _clip.Bottom() - 1);
@@ -703,7 +794,7 @@ namespace juceRmlUi
 				const auto x0 = _p0.x + (_p2.x - _p0.x) * alpha;
 				const auto x1 = _p0.x + (_p1.x - _p0.x) * beta;
 
-				fillScanline<AlphaBlend>(_dst, yi, x0, x1, _color, invAlpha, _clip);
+				fillScanline<AlphaBlend>(_dst, yi, x0, x1, _color, _clip);
 			}
 
 			// Render lower part (from p1 to p2)
@@ -719,7 +810,7 @@ namespace juceRmlUi
 				const auto x0 = _p0.x + (_p2.x - _p0.x) * alpha;
 				const auto x1 = _p1.x + (_p2.x - _p1.x) * beta;
 
-				fillScanline<AlphaBlend>(_dst, yi, x0, x1, _color, invAlpha, _clip);
+				fillScanline<AlphaBlend>(_dst, yi, x0, x1, _color, _clip);
 			}
 		}
 	}
@@ -741,6 +832,9 @@ namespace juceRmlUi
 
 	RendererJuce::~RendererJuce()
 	{
+		m_drawCalls.clear();
+		releaseDeferred();
+
 		m_renderImage.reset();
 		m_renderTargetPool.clear();
 	}
@@ -769,6 +863,7 @@ namespace juceRmlUi
 	Rml::CompiledGeometryHandle RendererJuce::CompileGeometry(const Rml::Span<const Rml::Vertex> _vertices, const Rml::Span<const int> _indices)
 	{
 		auto* g = new Geometry();
+		g->id = m_nextId++;
 
 		Rml::Vector2f posMin(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
 		Rml::Vector2f posMax(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
@@ -953,7 +1048,11 @@ namespace juceRmlUi
 	void RendererJuce::ReleaseGeometry(Rml::CompiledGeometryHandle _geometry)
 	{
 		auto* p = reinterpret_cast<Geometry*>(_geometry);
-		delete p;
+
+		if (p && !m_drawCalls.empty())
+			m_releasedGeometries.push_back(p);
+		else
+			delete p;
 	}
 
 	void RendererJuce::RenderGeometry(Rml::CompiledGeometryHandle _geometry, Rml::Vector2f _translation, Rml::TextureHandle _texture)
@@ -961,7 +1060,7 @@ namespace juceRmlUi
 		if (!m_renderTarget)
 			return;
 
-		auto* p = reinterpret_cast<Geometry*>(_geometry);
+		const auto* p = reinterpret_cast<Geometry*>(_geometry);
 		if (!p)
 			return;
 
@@ -972,102 +1071,81 @@ namespace juceRmlUi
 		if (m_scissorEnabled)
 			clip = clip.Intersect(m_scissorRegion);
 
-		for (const auto& quad : p->quads)
-		{
-			int dstX = roundToInt(quad.position.Left() + _translation.x);
-			int dstY = roundToInt(quad.position.Top() + _translation.y);
-			int dstW = roundToInt(quad.position.Width());
-			int dstH = roundToInt(quad.position.Height());
-
-			// skip if outside clip
-			if (dstX >= clip.Right())
-				continue;
-			if (dstY >= clip.Bottom())
-				continue;
-			if (dstX + dstW <= clip.Left())
-				continue;
-			if (dstY + dstH <= clip.Top())
-				continue;
-
-			float uvX = quad.uv.Left();
-			float uvY = quad.uv.Top();
-			float uvW = quad.uv.Width();
-			float uvH = quad.uv.Height();
-
-			// clip quad and adjust UVs accordingly
-			if (dstX < clip.Left())
-			{
-				const auto d = clip.Left() - dstX;
-				uvX += quad.uvPerPixel.x * static_cast<float>(d);
-				uvW -= quad.uvPerPixel.x * static_cast<float>(d);
-				dstX = clip.Left();
-				dstW -= d;
-			}
+		if (m_immediate)
+			renderGeometry(*p, _translation, img, clip);
+		else
+			m_drawCalls.push_back(DrawCall{p, img, _translation, clip});
+	}
 
-			if (dstY < clip.Top())
-			{
-				const auto d = clip.Top() - dstY;
-				uvY += quad.uvPerPixel.y * static_cast<float>(d);
-				uvH -= quad.uvPerPixel.y * static_cast<float>(d);
-				dstY = clip.Top();
-				dstH -= d;
-			}
+	void RendererJuce::renderGeometry(const Geometry& _geometry, const Rml::Vector2f _translation, Image* _texture, const Rml::Rectanglei& _clip)
+	{
+		if (!_clip.Valid() || _clip.Width() <= 0 || _clip.Height() <= 0)
+			return;
 
-			if (dstX + dstW > clip.Right())
-			{
-				uvW -= quad.uvPerPixel.x * static_cast<float>((dstX + dstW) - clip.Right());
-				dstW = clip.Right() - dstX;
-			}
+		for (const auto& quad : _geometry.quads)
+		{
+			const int dstX = roundToInt(quad.position.Left() + _translation.x);
+			const int dstY = roundToInt(quad.position.Top() + _translation.y);
+			const int dstW = roundToInt(quad.position.Width());
+			const int dstH = roundToInt(quad.position.Height());
+
+			// clip quad
+			const auto x0 = std::max(dstX, _clip.Left());
+			const auto y0 = std::max(dstY, _clip.Top());
+			const auto x1 = std::min(dstX + dstW, _clip.Right());
+			const auto y1 = std::min(dstY + dstH, _clip.Bottom());
+
+			if (x0 >= x1 || y0 >= y1)
+				continue;
 
-			if (dstY + dstH > clip.Bottom())
-			{
-				uvH -= quad.uvPerPixel.y * static_cast<float>((dstY + dstH) - clip.Bottom());
-				dstH = clip.Bottom() - dstY;
-			}
+			const auto quadClip = Rml::Rectanglei::FromCorners(Rml::Vector2i(x0, y0), Rml::Vector2i(x1, y1));
 
 			const auto hasColor = quad.hasColor;
 			Colorb col { quad.color.red, quad.color.green, quad.color.blue, quad.color.alpha };
 
-			if (img)
+			if (auto* img = _texture)
 			{
 				// define source rectangle in texture
-				int srcW = roundToInt(uvW * static_cast<float>(img->width));
-				int srcH = roundToInt(uvH * static_cast<float>(img->height));
+				int srcW = roundToInt(quad.uv.Width() * static_cast<float>(img->width));
+				int srcH = roundToInt(quad.uv.Height() * static_cast<float>(img->height));
 
 				// select a mipmap level to prevent that we scale down to less than 50% to reduce aliasing
 				while (srcW > 1 && srcH > 1 && (srcW > (dstW << 1) || srcH > (dstH << 1)))
 				{
+					auto* mip = img->getMip();
+					if (!mip)
+						break;
 					srcW >>= 1;
 					srcH >>= 1;
-					img = img->getMip();
+					img = mip;
 				}
 
-				const auto srcX = roundToInt(uvX * static_cast<float>(img->width));
-				const auto srcY = roundToInt(uvY * static_cast<float>(img->height));
+				const auto srcX = roundToInt(quad.uv.Left() * static_cast<float>(img->width));
+				const auto srcY = roundToInt(quad.uv.Top() * static_cast<float>(img->height));
 
-				srcW = roundToInt(uvW * static_cast<float>(img->width));
-				srcH = roundToInt(uvH * static_cast<float>(img->height));
+				srcW = roundToInt(quad.uv.Width() * static_cast<float>(img->width));
+				srcH = roundToInt(quad.uv.Height() * static_cast<float>(img->height));
 
 				// use templated blitting function based on used features
 				const auto hasScale = (srcW != dstW) || (srcH != dstH);
 				const auto hasAlphaBlend = img->hasAlpha || col.a < 255;
 
-				blit(*m_renderTarget, *img, srcX, srcY, srcW, srcH, dstX, dstY, dstW, dstH, col, hasScale, hasAlphaBlend, hasColor);
+				blit(*m_renderTarget, *img, srcX, srcY, srcW, srcH, dstX, dstY, dstW, dstH, quadClip, col, hasScale, hasAlphaBlend, hasColor);
 			}
 			else
 			{
 				// fill with solid color
 				if (col.a < 255)
-					fill<true>(*m_renderTarget, dstX, dstY, dstW, dstH, col);
+					fill<true>(*m_renderTarget, x0, y0, x1 - x0, y1 - y0, col);
 				else
-					fill<false>(*m_renderTarget, dstX, dstY, dstW, dstH, col);
+					fill<false>(*m_renderTarget, x0, y0, x1 - x0, y1 - y0, col);
 			}
 		}
 
 		// Render triangles (only solid color for now, no texture support)
-		for (const auto& tri : p->triangles)
+		for (const auto& tri : _geometry.triangles)
 		{
-			if (img)
+			if (_texture)
 				continue; // Skip textured triangles for now
 
 			// Apply translation to triangle vertices
@@ -1081,9 +1159,9 @@ namespace juceRmlUi
 
 			// Render the triangle
 			if (col.a < 255)
-				fillTriangle<true>(*m_renderTarget, p0, p1, p2, col, clip);
+				fillTriangle<true>(*m_renderTarget, p0, p1, p2, col, _clip);
 			else
-				fillTriangle<false>(*m_renderTarget, p0, p1, p2, col, clip);
+				fillTriangle<false>(*m_renderTarget, p0, p1, p2, col, _clip);
 		}
 	}
 
@@ -1110,6 +1188,8 @@ namespace juceRmlUi
 		if (!img)
 			img = new Image();
 
+		img->id = m_nextId++;
+
 		const auto srcH = _sourceDimensions.y;
 		const auto srcW = _sourceDimensions.x;
 
@@ -1194,6 +1274,13 @@ namespace juceRmlUi
 			return;
 
 		auto* img = reinterpret_cast<Image*>(_texture);
+
+		if (!m_drawCalls.empty())
+		{
+			m_releasedTextures.push_back(img);
+			return;
+		}
+
 		img->clearMip();
 		m_imagePool[img->getSizeKey()].emplace_back(img);
 	}
@@ -1203,6 +1290,8 @@ namespace juceRmlUi
 		if (!m_renderTarget)
 			return {};
 
+		flushDrawCalls();
+
 		const auto width = m_renderTarget->width;
 		const auto height = m_renderTarget->height;
 
@@ -1236,6 +1325,8 @@ namespace juceRmlUi
 		if (m_renderTargetStack.size() <= 1)
 			return;
 
+		flushDrawCalls();
+
 		auto* layer = m_renderTargetStack.back();
 		m_renderTargetStack.pop_back();
 
@@ -1250,6 +1341,8 @@ namespace juceRmlUi
 		if (!m_renderTarget)
 			return {};
 
+		flushDrawCalls();
+
 		int texWidth, texHeight, srcX, srcY;
 
 		if (m_scissorEnabled)
@@ -1272,6 +1365,7 @@ namespace juceRmlUi
 
 		// Create a new image to hold the texture copy
 		auto* texture = new Image();
+		texture->id = m_nextId++;
 		texture->width = texWidth;
 		texture->paddedWidth = Image::padWidth(texWidth);
 		texture->height = texHeight;
@@ -1292,6 +1386,8 @@ namespace juceRmlUi
 
 	void RendererJuce::CompositeLayers(const Rml::LayerHandle _source, const Rml::LayerHandle _destination, const Rml::BlendMode _blendMode, const Rml::Span<const Rml::CompiledFilterHandle> _filters)
 	{
+		flushDrawCalls();
+
 		const auto* source = reinterpret_cast<const Image*>(_source);
 		auto* destination = reinterpret_cast<Image*>(_destination);
 
@@ -1389,32 +1485,16 @@ namespace juceRmlUi
 		RenderInterface::SetTransform(transform);
 	}
 
-	void RendererJuce::pushClip()
-	{
-		if (m_pushed)
-			m_graphics->restoreState();
-
-		m_graphics->saveState();
-		m_pushed = true;
-
-		m_graphics->reduceClipRegion(juce::Rectangle(
-			m_scissorRegion.Left(),
-			m_scissorRegion.Top(),
-			m_scissorRegion.Width(),
-			m_scissorRegion.Height()
-		));
-	}
-
-	void RendererJuce::beginFrame(juce::Graphics& _g, const Rml::Vector2i _size)
+	void RendererJuce::beginFrame(const Rml::Vector2i _size)
 	{
-		m_graphics = &_g;
-		m_graphics->setImageResamplingQuality(juce::Graphics::mediumResamplingQuality);
-
 		const auto width = _size.x;
 		const auto height = _size.y;
 
 		m_scissorRegion = Rml::Rectanglei::FromPositionSize(Rml::Vector2i(0,0), Rml::Vector2i(width, height));
 
+		m_drawCalls.clear();
+		m_immediate = false;
+
 		// Release all additional layers (keep base layer at index 0)
 		while (m_renderTargetStack.size() > 1)
 		{
@@ -1447,12 +1527,204 @@ namespace juceRmlUi
 
 			// Push new base render target onto stack
 			m_renderTargetStack.push_back(m_renderTarget);
+
+			// the content of the new render target is undefined
+			m_prevDrawRecordsValid = false;
 		}
 
 		// At this point, stack should have exactly one item (the base render target)
 		assert(m_renderTargetStack.size() == 1 && m_renderTargetStack[0] == m_renderTarget);
 	}
 
+	const std::vector<Rml::Rectanglei>& RendererJuce::endFrame()
+	{
+		m_dirtyRects.clear();
+
+		if (!m_renderTarget)
+			return m_dirtyRects;
+
+		const auto fullArea = Rml::Rectanglei::FromSize(Rml::Vector2i(m_renderTarget->width, m_renderTarget->height));
+
+		if (m_immediate)
+		{
+			// the frame has been rendered completely, there is nothing to compare the next frame with
+			m_prevDrawRecordsValid = false;
+			m_dirtyRects.push_back(fullArea);
+			return m_dirtyRects;
+		}
+
+		findDirtyRects();
+
+		for (const auto& rect : m_dirtyRects)
+		{
+			// rendering is done from scratch so that a region that is rendered again looks exactly like before
+			fill<false>(*m_renderTarget, rect.Left(), rect.Top(), rect.Width(), rect.Height(), Colorb{0,0,0,0});
+
+			for (size_t i=0; i<m_drawCalls.size(); ++i)
+			{
+				const auto& bounds = m_drawRecords[i].bounds;
+
+				if (!bounds.Valid() || bounds.Right() <= rect.Left() || bounds.Left() >= rect.Right() || bounds.Bottom() <= rect.Top() || bounds.Top() >= rect.Bottom())
+					continue;
+
+				const auto& dc = m_drawCalls[i];
+				renderGeometry(*dc.geometry, dc.translation, dc.texture, dc.clip.Intersect(rect));
+			}
+		}
+
+		std::swap(m_prevDrawRecords, m_drawRecords);
+		m_prevDrawRecordsValid = true;
+
+		m_drawCalls.clear();
+		releaseDeferred();
+
+		return m_dirtyRects;
+	}
+
+	void RendererJuce::flushDrawCalls()
+	{
+		if (m_immediate)
+			return;
+
+		m_immediate = true;
+
+		if (!m_renderTarget)
+			return;
+
+		// draw calls are only recorded as long as no layer has been pushed, the current target is the base one
+		fill<false>(*m_renderTarget, 0, 0, m_renderTarget->width, m_renderTarget->height, Colorb{0,0,0,0});
+
+		for (const auto& dc : m_drawCalls)
+			renderGeometry(*dc.geometry, dc.translation, dc.texture, dc.clip);
+
+		m_drawCalls.clear();
+		releaseDeferred();
+	}
+
+	void RendererJuce::findDirtyRects()
+	{
+		const auto fullArea = Rml::Rectanglei::FromSize(Rml::Vector2i(m_renderTarget->width, m_renderTarget->height));
+
+		m_drawRecords.clear();
+		m_drawRecords.reserve(m_drawCalls.size());
+
+		for (const auto& dc : m_drawCalls)
+		{
+			const auto& b = dc.geometry->bounds;
+
+			// geometry is rounded to integer pixels when it is rasterized, leave some margin
+			const auto bounds = Rml::Rectanglei::FromCorners(
+				Rml::Vector2i(static_cast<int>(std::floor(b.Left() + dc.translation.x)) - 1, static_cast<int>(std::floor(b.Top() + dc.translation.y)) - 1),
+				Rml::Vector2i(static_cast<int>(std::ceil(b.Right() + dc.translation.x)) + 1, static_cast<int>(std::ceil(b.Bottom() + dc.translation.y)) + 1)
+			).Intersect(dc.clip);
+
+			m_drawRecords.push_back(DrawRecord{
+				DrawKey{dc.geometry->id, dc.texture ? dc.texture->id : 0, dc.translation, dc.clip.Left(), dc.clip.Top(), dc.clip.Right(), dc.clip.Bottom()},
+				bounds
+			});
+		}
+
+		if (!m_prevDrawRecordsValid)
+		{
+			m_dirtyRects.push_back(fullArea);
+			return;
+		}
+
+		// Match the draw calls of this frame with the ones of the previous frame. A pixel does not change if all draw
+		// calls that touch it exist in both frames and are executed in the same order. Draw calls that have been added,
+		// removed or moved relative to others make their area dirty
+		struct Match
+		{
+			std::vector<uint32_t> indices;
+			size_t next = 0;
+		};
+
+		std::unordered_map<DrawKey, Match, DrawKeyHash> prev;
+		prev.reserve(m_prevDrawRecords.size());
+
+		for (uint32_t i=0; i<static_cast<uint32_t>(m_prevDrawRecords.size()); ++i)
+			prev[m_prevDrawRecords[i].key].indices.push_back(i);
+
+		std::vector<bool> matched(m_prevDrawRecords.size(), false);
+		int64_t lastMatched = -1;
+
+		for (const auto& record : m_drawRecords)
+		{
+			const auto it = prev.find(record.key);
+
+			if (it == prev.end() || it->second.next >= it->second.indices.size())
+			{
+				addDirtyRect(record.bounds);
+				continue;
+			}
+
+			const auto index = it->second.indices[it->second.next++];
+			matched[index] = true;
+
+			if (static_cast<int64_t>(index) < lastMatched)
+				addDirtyRect(record.bounds);
+			else
+				lastMatched = index;
+		}
+
+		for (size_t i=0; i<m_prevDrawRecords.size(); ++i)
+		{
+			if (!matched[i])
+				addDirtyRect(m_prevDrawRecords[i].bounds);
+		}
+	}
+
+	void RendererJuce::addDirtyRect(const Rml::Rectanglei& _rect)
+	{
+		// more rectangles than this are combined into a single one
+		constexpr size_t maxDirtyRects = 16;
+
+		if (!_rect.Valid() || _rect.Width() <= 0 || _rect.Height() <= 0)
+			return;
+
+		auto rect = _rect;
+
+		// merge with all rectangles that touch or overlap the new one
+		for (size_t i=0; i<m_dirtyRects.size();)
+		{
+			const auto& r = m_dirtyRects[i];
+
+			if (r.Right() < rect.Left() || r.Left() > rect.Right() || r.Bottom() < rect.Top() || r.Top() > rect.Bottom())
+			{
+				++i;
+				continue;
+			}
+
+			rect = rect.Join(r);
+			m_dirtyRects.erase(m_dirtyRects.begin() + static_cast<ptrdiff_t>(i));
+			i = 0;
+		}
+
+		m_dirtyRects.push_back(rect);
+
+		if (m_dirtyRects.size() <= maxDirtyRects)
+			return;
+
+		for (const auto& r : m_dirtyRects)
+			rect = rect.Join(r);
+
+		m_dirtyRects.clear();
+		m_dirtyRects.push_back(rect);
+	}
+
+	void RendererJuce::releaseDeferred()
+	{
+		for (auto* geometry : m_releasedGeometries)
+			delete geometry;
+
+		m_releasedGeometries.clear();
+
+		for (auto* img : m_releasedTextures)
+			ReleaseTexture(reinterpret_cast<Rml::TextureHandle>(img));
+
+		m_releasedTextures.clear();
+	}
+
 	namespace
 	{
 		template<typename T>
@@ -1470,6 +1742,9 @@ namespace juceRmlUi
 			return -1;
 		}
 
+		// The helpers below copy the area at _x,_y of the source to the origin of the target bitmap, which is expected to
+		// cover the same area of the target image
+
 		// default implementation that is slow but safe
 		template<typename PixelDataType>
 		void copyToBitmap(const juce::Image::BitmapData& _dst, const Image& _src, int _x, int _y, int _width, int _height)
@@ -1480,7 +1755,7 @@ namespace juceRmlUi
 			{
 				const auto* src = _src.getColorPointer(_x, y);
 
-				auto* dst = _dst.getPixelPointer(_x, y);
+				auto* dst = _dst.getPixelPointer(0, y - _y);
 
 				for (int x=0; x<_width; ++x, dst += _dst.pixelStride)
 				{
@@ -1501,7 +1776,7 @@ namespace juceRmlUi
 			{
 				const auto* src = _src.getColorPointer(_x, y);
 
-				auto* dst = _dst.getPixelPointer(_x, y);
+				auto* dst = _dst.getPixelPointer(0, y - _y);
 #if HAVE_SSE
 				// use SSE to speed up RGBA->ARGB or RGBA->BGRA conversion
 				auto shuffleMask = []
@@ -1560,50 +1835,64 @@ namespace juceRmlUi
 		static_assert(getAlphaComponentIndex<juce::PixelRGB>() != -1);
 		static_assert(getAlphaComponentIndex<juce::PixelARGB>() != -1);
 
-		void copyToBitmap(const juce::Image::BitmapData& _dst, const Image& _src)
+		void copyToBitmap(const juce::Image::BitmapData& _dst, const Image& _src, const int _x, const int _y)
 		{
-			const auto w = std::min(_src.width, _dst.width);
-			const auto h = std::min(_src.height, _dst.height);
+			const auto w = std::min(_src.width - _x, _dst.width);
+			const auto h = std::min(_src.height - _y, _dst.height);
+
+			if (w <= 0 || h <= 0)
+				return;
 
 			if (_dst.pixelStride == 4)
 			{
 				if (_dst.pixelFormat == juce::Image::ARGB)
-					copyToBitmap4<juce::PixelARGB>(_dst, _src, 0, 0, w, h);
+					copyToBitmap4<juce::PixelARGB>(_dst, _src, _x, _y, w, h);
 				else if (_dst.pixelFormat == juce::Image::RGB)
-					copyToBitmap4<juce::PixelRGB>(_dst, _src, 0, 0, w, h);
+					copyToBitmap4<juce::PixelRGB>(_dst, _src, _x, _y, w, h);
 			}
 			else if (_dst.pixelFormat == juce::Image::RGB)
-				copyToBitmap<juce::PixelRGB>(_dst, _src, 0, 0, w, h);
+				copyToBitmap<juce::PixelRGB>(_dst, _src, _x, _y, w, h);
 			else if (_dst.pixelFormat == juce::Image::ARGB)
-				copyToBitmap<juce::PixelARGB>(_dst, _src, 0, 0, w, h);
+				copyToBitmap<juce::PixelARGB>(_dst, _src, _x, _y, w, h);
 		}
 	}
 
-	void RendererJuce::endFrame(const juce::Image& _renderTarget, const float _renderScale/* = 1.0f*/)
+	void RendererJuce::present(juce::Graphics& _g, const juce::Image& _target, const float _renderScale/* = 1.0f*/)
 	{
-		// copy render target to juce::Image
-		{
-			const juce::Image::BitmapData dstBitmapData(_renderTarget.isNull() ? *m_renderImage : _renderTarget, juce::Image::BitmapData::writeOnly);
+		if (!m_renderTarget || !m_renderImage)
+			return;
 
-			if (_renderTarget.isNull())
-			{
-				copyToBitmap(dstBitmapData, *m_renderTarget);
+		_g.setImageResamplingQuality(juce::Graphics::mediumResamplingQuality);
 
-				auto& context = m_graphics->getInternalContext();
+		// only the area that juce wants to have repainted is copied
+		const auto area = (_g.getClipBounds().toFloat() * _renderScale).getSmallestIntegerContainer()
+			.getIntersection({0, 0, m_renderTarget->width, m_renderTarget->height});
 
-				// The render image may be larger than the component's logical bounds (when
-				// rendered at a DPI scale > 1). Scale down by the render scale so the image
-				// maps to logical coordinates correctly.
-				const auto transform = _renderScale != 1.0f ? juce::AffineTransform::scale(1.0f / _renderScale) : juce::AffineTransform();
+		if (area.isEmpty())
+			return;
 
-				context.drawImage(*m_renderImage, transform);
-			}
-			else
+		if (!_target.isNull())
+		{
+			const auto targetArea = area.getIntersection(_target.getBounds());
+
+			if (!targetArea.isEmpty())
 			{
-				copyToBitmap(dstBitmapData, *m_renderTarget);
+				const juce::Image::BitmapData dstBitmapData(_target, targetArea.getX(), targetArea.getY(), targetArea.getWidth(), targetArea.getHeight(), juce::Image::BitmapData::writeOnly);
+				copyToBitmap(dstBitmapData, *m_renderTarget, targetArea.getX(), targetArea.getY());
 			}
+			return;
 		}
 
-		m_graphics = nullptr;
+		{
+			const juce::Image::BitmapData dstBitmapData(*m_renderImage, area.getX(), area.getY(), area.getWidth(), area.getHeight(), juce::Image::BitmapData::writeOnly);
+			copyToBitmap(dstBitmapData, *m_renderTarget, area.getX(), area.getY());
+		}
+
+		// The render image may be larger than the component's logical bounds (when
+		// rendered at a DPI scale > 1). Scale down by the render scale so the image
+		// maps to logical coordinates correctly.
+		const auto transform = _renderScale != 1.0f ? juce::AffineTransform::scale(1.0f / _renderScale) : juce::AffineTransform();
+
+		_g.getInternalContext().drawImage(*m_renderImage, transform);
 	}
 }
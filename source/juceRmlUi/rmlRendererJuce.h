@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "RmlUi/Core/RenderInterface.h"
 
 #if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
@@ -27,6 +32,9 @@ namespace juceRmlUi
 	namespace rendererJuce
 	{
 		struct Image;
+		struct Geometry;
+		struct DrawCall;
+		struct DrawRecord;
 	}
 
 	class RendererJuce : public Rml::RenderInterface
@@ -43,8 +51,13 @@ namespace juceRmlUi
 		RendererJuce& operator=(const RendererJuce&) = delete;
 		RendererJuce& operator=(RendererJuce&&) = delete;
 
-		void beginFrame(juce::Graphics& _g, Rml::Vector2i _size);
-		void endFrame(const juce::Image& _renderTarget, float _renderScale = 1.0f);
+		// Geometry is recorded between beginFrame and endFrame. endFrame compares it with the previous frame and only
+		// rasterizes the regions that changed. The result is empty if the frame is identical to the previous one
+		void beginFrame(Rml::Vector2i _size);
+		const std::vector<Rml::Rectanglei>& endFrame();
+
+		// draws the clip region of _g. If _target is valid, the pixels are copied to it directly
+		void present(juce::Graphics& _g, const juce::Image& _target, float _renderScale = 1.0f);
 
 		Rml::CompiledGeometryHandle	CompileGeometry(Rml::Span<const Rml::Vertex> _vertices, Rml::Span<const int> _indices) override;
 		void ReleaseGeometry(Rml::CompiledGeometryHandle _geometry) override;
@@ -67,7 +80,12 @@ namespace juceRmlUi
 		static constexpr bool isX64() { return IS_X64; }
 
 	private:
-		void pushClip();
+		void renderGeometry(const rendererJuce::Geometry& _geometry, Rml::Vector2f _translation, rendererJuce::Image* _texture, const Rml::Rectanglei& _clip);
+
+		void flushDrawCalls();
+		void findDirtyRects();
+		void addDirtyRect(const Rml::Rectanglei& _rect);
+		void releaseDeferred();
 
 		rendererJuce::Image* allocateRenderTarget(int _width, int _height);
 		void releaseRenderTarget(rendererJuce::Image* _img);
@@ -75,8 +93,6 @@ namespace juceRmlUi
 		bool m_scissorEnabled = false;
 		Rml::Rectanglei m_scissorRegion;
 
-		juce::Graphics* m_graphics = nullptr;
-
 		rendererJuce::Image* m_renderTarget = nullptr;
 		std::vector<rendererJuce::Image*> m_renderTargetStack;
 		std::vector<std::unique_ptr<rendererJuce::Image>> m_renderTargetPool;
@@ -84,7 +100,22 @@ namespace juceRmlUi
 
 		std::unordered_map<uint64_t, std::vector<std::unique_ptr<rendererJuce::Image>>> m_imagePool;
 
-		bool m_pushed = false;
 		Rml::Matrix4f m_transform;
+
+		// geometry of the current frame. Layers require the geometry to be rendered in order, the first layer operation
+		// renders everything recorded so far and switches to immediate rendering until the frame ends
+		std::vector<rendererJuce::DrawCall> m_drawCalls;
+		bool m_immediate = false;
+
+		std::vector<rendererJuce::DrawRecord> m_prevDrawRecords;
+		std::vector<rendererJuce::DrawRecord> m_drawRecords;
+		bool m_prevDrawRecordsValid = false;
+		std::vector<Rml::Rectanglei> m_dirtyRects;
+
+		// resources that are released while draw calls still reference them are released at the end of the frame
+		std::vector<rendererJuce::Geometry*> m_releasedGeometries;
+		std::vector<rendererJuce::Image*> m_releasedTextures;
+
+		uint64_t m_nextId = 1;
 	};
 }
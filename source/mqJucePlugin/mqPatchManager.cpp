@@ -49,7 +49,7 @@ namespace mqJucePlugin
 
 		auto p = std::make_shared<pluginLib::patchDB::Patch>();
 
-		p->sysex = std::move(_sysex);
+		p->setSysex(std::move(_sysex));
 		p->name = m_controller.getSingleName(parameters);
 
 		auto category = m_controller.getCategory(parameters);
@@ -67,10 +67,10 @@ namespace mqJucePlugin
 
 	pluginLib::patchDB::Data PatchManager::applyModifications(const pluginLib::patchDB::PatchPtr& _patch, const pluginLib::FileType& _fileType, pluginLib::ExportType _exportType) const
 	{
-		auto result = _patch->sysex;
+		auto result = _patch->getSysex();
 
-		if (_patch->sysex.size() != std::tuple_size_v<mqLib::State::Single> && 
-			_patch->sysex.size() != std::tuple_size_v<mqLib::State::SingleQ>)
+		if (_patch->getSysex().size() != std::tuple_size_v<mqLib::State::Single> && 
+			_patch->getSysex().size() != std::tuple_size_v<mqLib::State::SingleQ>)
 			return result;
 
 		if (!_patch->getName().empty())
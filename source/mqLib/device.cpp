@@ -9,7 +9,7 @@ namespace mqLib
 {
 	Device::Device(const synthLib::DeviceCreateParams& _params)
 		: wLib::Device(_params)
-		, m_mq(BootMode::Default, _params.romData, _params.romName, (_params.customData & 1) != 0)
+		, m_mq(BootMode::Default, _params.getRomData(), _params.romName, (_params.customData & 1) != 0)
 		, m_state(m_mq)
 		, m_sysexRemote(m_mq)
 	{
@@ -86,7 +86,7 @@ namespace mqLib
 			for (auto& response : responses)
 			{
 				auto& r = _midiOut.emplace_back(synthLib::MidiEventSource::Device);
-				std::swap(response, r.sysex);
+				r.sysex = std::move(response);
 			}
 		}
 
@@ -126,7 +126,7 @@ namespace mqLib
 		for (auto& response : responses)
 		{
 			auto& r = _response.emplace_back(synthLib::MidiEventSource::Device);
-			std::swap(response, r.sysex);
+			r.sysex = std::move(response);
 		}
 
 		// do not forward to device if our cache was able to reply. It might have sent something to the device already on its own if a cache miss occured
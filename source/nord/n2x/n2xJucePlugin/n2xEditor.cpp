@@ -184,7 +184,7 @@ namespace n2xJucePlugin
 
 	void Editor::onPatchActivated(const pluginLib::patchDB::PatchPtr& _patch, const uint32_t _part)
 	{
-		const auto isMulti = _patch->sysex.size() == n2x::g_multiDumpSize;
+		const auto isMulti = _patch->getSysex().size() == n2x::g_multiDumpSize;
 
 		const auto name = _patch->getName();
 
@@ -85,11 +85,11 @@ namespace n2xJucePlugin
 		}
 
 		p->name = getPatchName(_sysex, _defaultPatchName);
-		p->sysex = std::move(_sysex);
+		p->setSysex(std::move(_sysex));
 		p->program = program;
 		p->bank = bank;
 
-		const juce::MD5 md5(p->sysex.data() + n2x::g_sysexHeaderSize, p->sysex.size() - n2x::g_sysexContainerSize);
+		const juce::MD5 md5(p->getSysex().data() + n2x::g_sysexHeaderSize, p->getSysex().size() - n2x::g_sysexContainerSize);
 		static_assert(sizeof(juce::MD5) >= sizeof(pluginLib::patchDB::PatchHash));
 		memcpy(p->hash.data(), md5.getChecksumDataArray(), std::size(p->hash));
 
@@ -98,7 +98,7 @@ namespace n2xJucePlugin
 
 	pluginLib::patchDB::Data PatchManager::applyModifications(const pluginLib::patchDB::PatchPtr& _patch, const pluginLib::FileType& _fileType, pluginLib::ExportType _exportType) const
 	{
-		auto d = n2x::State::stripPatchName(_patch->sysex);
+		auto d = n2x::State::stripPatchName(_patch->getSysex());
 
 		d[n2x::SysexIndex::IdxMsgType] = static_cast<uint8_t>(_patch->bank);
 		d[n2x::SysexIndex::IdxMsgSpec] = static_cast<uint8_t>(_patch->program);
@@ -127,7 +127,7 @@ namespace n2xJucePlugin
 
 	bool PatchManager::activatePatch(const pluginLib::patchDB::PatchPtr& _patch, const uint32_t _part)
 	{
-		if(!m_controller.activatePatch(_patch->sysex, _part))
+		if(!m_controller.activatePatch(_patch->getSysex(), _part))
 			return false;
 
 		m_editor.onPatchActivated(_patch, _part);
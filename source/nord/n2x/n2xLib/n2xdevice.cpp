@@ -7,7 +7,7 @@ namespace n2x
 {
 	Device::Device(const synthLib::DeviceCreateParams& _params)
 		: synthLib::Device(_params)
-		, m_hardware(_params.romData, _params.romName)
+		, m_hardware(_params.getRomData(), _params.romName)
 		, m_state(&m_hardware, &getMidiTranslator())
 		, m_midiParser(synthLib::MidiEventSource::Device)
 	{
@@ -6,6 +6,8 @@
 #include <assert.h>
 #include <array>
 
+#include "baseLib/binarystream.h"
+
 template <int32_t N> static constexpr int32_t se(int32_t x) { x <<= (32 - N); return x >> (32 - N); }
 
 template<int lg2eram_size>
@@ -27,11 +29,15 @@ public:
 	inline int32_t operator+=(int32_t v) { return acc = se<30>(acc + v); }
 	
 	inline int32_t rawFull() const { return acc; }
+	inline void setState(int32_t v) { acc = se<30>(v); for (int i = 0; i < delay; i++) hist[i] = acc; }
 	inline int32_t getPipelineSat24() const { return std::clamp(hist[head], -0x800000, 0x7fffff); }
 	inline int32_t getPipelineRaw24() const { return se<24>(hist[head]); }
 	inline int32_t getPipelineRawFull() const { return hist[head]; }
 	
 	inline void storePipeline() { hist[head++] = acc; if (head == delay) head = 0; }
+
+	void saveState(baseLib::BinaryStream& _s) const { _s.write(acc); _s.write(hist); _s.write(head); }
+	void loadState(baseLib::BinaryStream& _s) { _s.read(acc); _s.read(hist); _s.read(head); head %= delay; }
 protected:
 	static constexpr int delay {3}; // delay
 	int32_t acc {0}, hist[delay] = {}, head {0};
@@ -98,6 +104,26 @@ public:
 		}
 	}
 
+	void saveState(baseLib::BinaryStream& _s) const {
+		_s.write(eram);
+		_s.write(eramReadLatch); _s.write(eramWriteLatch); _s.write(eramVarOffset);
+		_s.write(eramPos); _s.write(eramEffectiveAddr); _s.write(eramImmOffsetAccNext); _s.write(eramHighOffset);
+		_s.write(eramWriteLatchNext);
+		_s.write(eramPCCommit); _s.write(eramPCStartNext);
+		_s.write(eramModeCurrent); _s.write(eramModeNext);
+		_s.write(eramActiveCurrent); _s.write(eramActiveNext);
+	}
+
+	void loadState(baseLib::BinaryStream& _s) {
+		_s.read(eram);
+		_s.read(eramReadLatch); _s.read(eramWriteLatch); _s.read(eramVarOffset);
+		_s.read(eramPos); _s.read(eramEffectiveAddr); _s.read(eramImmOffsetAccNext); _s.read(eramHighOffset);
+		_s.read(eramWriteLatchNext);
+		_s.read(eramPCCommit); _s.read(eramPCStartNext);
+		_s.read(eramModeCurrent); _s.read(eramModeNext);
+		_s.read(eramActiveCurrent); _s.read(eramActiveNext);
+	}
+
 	int32_t eramReadLatch = 0, eramWriteLatch = 0, eramVarOffset = 0;
 protected:
 	static constexpr int64_t ERAM_COMMIT_STAGE = 10, ERAM_MASK_FULL = (1 << 19) - 1;
@@ -132,6 +158,16 @@ struct SharedState {
 		memset(mulcoeffs, 0, sizeof(mulcoeffs));
 		eram.reset();
 	}
+
+	void saveState(baseLib::BinaryStream& _s) const {
+		_s.write(gram); _s.write(readback_regs); _s.write(mulcoeffs);
+		eram.saveState(_s);
+	}
+
+	void loadState(baseLib::BinaryStream& _s) {
+		_s.read(gram); _s.read(readback_regs); _s.read(mulcoeffs);
+		eram.loadState(_s);
+	}
 };
 
 template<int lg2eram_size>
@@ -144,6 +180,19 @@ public:
 
 	void setup(const uint32_t *_pram, SharedState<lg2eram_size> *_shared) { pram = _pram; shared = _shared; }
 
+	// program memory and shared state are owned by the ESP, which saves them itself
+	void saveState(baseLib::BinaryStream& _s) const {
+		_s.write(iram); _s.write(last_mulInputA_24); _s.write(last_mulInputB_24); _s.write(skipfield);
+		_s.write(lastMul30); _s.write(pc); _s.write(iramPos); _s.write(pcjumpat); _s.write(pcjumpto);
+		accA.saveState(_s); accB.saveState(_s);
+	}
+
+	void loadState(baseLib::BinaryStream& _s) {
+		_s.read(iram); _s.read(last_mulInputA_24); _s.read(last_mulInputB_24); _s.read(skipfield);
+		_s.read(lastMul30); _s.read(pc); _s.read(iramPos); _s.read(pcjumpat); _s.read(pcjumpto);
+		accA.loadState(_s); accB.loadState(_s);
+	}
+
 	void writeGRAM(int32_t val, uint32_t offset) {shared->gram[(offset + iramPos) & IRAM_MASK] = val;}
 	int32_t readGRAM(uint32_t offset) const {return shared->gram[(offset + iramPos) & IRAM_MASK];}
 
@@ -371,6 +420,23 @@ public:
 		shared.reset();
 	}
 
+	void saveState(baseLib::BinaryStream& _s) const {
+		_s.write(intmem); _s.write(if_mode); _s.write(addr_sel); _s.write(program_writing_word);
+		core0.saveState(_s);
+		core1.saveState(_s);
+		shared.saveState(_s);
+		opt.saveState(_s);
+	}
+
+	// the program is recompiled on the next sample, the interpreter runs until it is available
+	void loadState(baseLib::BinaryStream& _s) {
+		_s.read(intmem); _s.read(if_mode); _s.read(addr_sel); _s.read(program_writing_word);
+		core0.loadState(_s);
+		core1.loadState(_s);
+		shared.loadState(_s);
+		opt.loadState(_s);
+	}
+
 	// Interface with hardware / other chips etc.
 	void writeGRAM(int32_t val, uint8_t offset) {core0.writeGRAM(val, offset);}
 	int32_t readGRAM(uint8_t offset) const {return core0.readGRAM(offset);}
@@ -11,6 +11,8 @@ namespace esp
 	class EspJitBase
 	{
 	public:
+		static constexpr uint32_t MaxMacGroupSize = 4;
+
 		EspJitBase();
 
 		virtual void jitEnter() = 0;
@@ -21,6 +23,10 @@ namespace esp
 		virtual void eramComputeAddr(uint32_t immOffset, bool highOffset, bool shouldUseVarOffset) = 0;
 
 		virtual void emitOp(uint32_t pc, const ESPOptInstr& instr, bool lastMul30) = 0;
+
+		// Emits consecutive MACs that do not depend on each other at once. Returns false if not supported by the
+		// backend or the host CPU, the MACs are emitted one by one via emitOp() then
+		virtual bool emitMacGroup(uint32_t /*pc*/, const ESPOptInstr* /*instrs*/, uint32_t /*count*/) { return false; }
 	};
 
 	struct JitInputData
@@ -0,0 +1,32 @@
+#include "esp_jit_cache.h"
+
+#include "esp_jit_types.h"
+
+#if JIT_X64
+#include "esp_jit_x64.h"
+#endif
+
+namespace esp
+{
+	JitCache::JitCache() : DataCache("EJIT", ".espjit", MaxEntries, MaxStorageSize)
+	{
+	}
+
+	JitCache& JitCache::instance()
+	{
+		static JitCache cache;
+		return cache;
+	}
+
+	uint32_t JitCache::getTarget()
+	{
+		// packed MACs are only emitted if the host CPU supports them
+#if JIT_X64 && defined(_MSC_VER)
+		return EspJitX64::supportsMacGroups() ? 4 : 1;
+#elif JIT_X64
+		return EspJitX64::supportsMacGroups() ? 5 : 2;
+#else
+		return 3;
+#endif
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "baseLib/dataCache.h"
+
+namespace esp
+{
+	// Machine code generated for ESP core programs, keyed by a hash of everything the code generation depends on.
+	// The generated code addresses ESP memory only relative to its arguments, which means that it can be shared
+	// between ESP instances of the same type and can be persisted to disk
+	class JitCache : public baseLib::DataCache
+	{
+	public:
+		using Code = Data;
+
+		// increase whenever the generated code changes for the same input
+		static constexpr uint32_t Version = 3;
+
+		static constexpr size_t MaxEntries = 64;
+		static constexpr uint64_t MaxStorageSize = 64ull * 1024 * 1024;
+
+		static JitCache& instance();
+
+		// identifies the JIT backend, calling convention and used CPU features, needs to be part of the key
+		static uint32_t getTarget();
+
+	private:
+		JitCache();
+	};
+}
@@ -0,0 +1,65 @@
+#include "esp_jit_thread.h"
+
+#include "dsp56kBase/threadtools.h"
+
+namespace esp
+{
+	JitThread::JitThread() : m_thread([this] { threadFunc(); })
+	{
+	}
+
+	JitThread::~JitThread()
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_exit = true;
+		}
+
+		m_cv.notify_one();
+		m_thread.join();
+	}
+
+	void JitThread::add(const void* _owner, Job&& _job)
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+
+			for (auto& [owner, job] : m_jobs)
+			{
+				if (owner != _owner)
+					continue;
+				job = std::move(_job);
+				return;
+			}
+
+			m_jobs.emplace_back(_owner, std::move(_job));
+		}
+
+		m_cv.notify_one();
+	}
+
+	void JitThread::threadFunc()
+	{
+		dsp56k::ThreadTools::setCurrentThreadName("ESP JIT");
+
+		while (true)
+		{
+			Job job;
+
+			{
+				std::unique_lock lock(m_mutex);
+
+				m_cv.wait(lock, [this] { return m_exit || !m_jobs.empty(); });
+
+				// pending jobs are dropped on exit, their owners are about to be destroyed
+				if (m_exit)
+					return;
+
+				job = std::move(m_jobs.front().second);
+				m_jobs.pop_front();
+			}
+
+			job();
+		}
+	}
+}
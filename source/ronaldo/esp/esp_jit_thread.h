@@ -0,0 +1,38 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace esp
+{
+	// Runs JIT compilations in the background so that program changes do not stall the audio thread
+	class JitThread
+	{
+	public:
+		using Job = std::function<void()>;
+
+		JitThread();
+		~JitThread();
+
+		JitThread(const JitThread&) = delete;
+		JitThread(JitThread&&) = delete;
+		JitThread& operator = (const JitThread&) = delete;
+		JitThread& operator = (JitThread&&) = delete;
+
+		// a job of the same owner that has not been started yet is replaced, it would be outdated anyway
+		void add(const void* _owner, Job&& _job);
+
+	private:
+		void threadFunc();
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::deque<std::pair<const void*, Job>> m_jobs;
+		bool m_exit = false;
+
+		std::thread m_thread;
+	};
+}
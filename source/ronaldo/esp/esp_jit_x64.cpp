@@ -5,6 +5,7 @@
 #include "esp_jit_x64_types.h"
 #include "esp.hpp"
 
+#include "asmjit/core/cpuinfo.h"
 #include "asmjit/x86/x86builder.h"
 
 namespace esp
@@ -447,6 +448,88 @@ namespace esp
 		}
 	}
 
+	bool EspJitX64::supportsMacGroups()
+	{
+		static const bool hasAvx2 = asmjit::CpuInfo::host().features().x86().hasAVX2();
+		return hasAvx2;
+	}
+
+	bool EspJitX64::emitMacGroup(const uint32_t pc, const ESPOptInstr* instrs, const uint32_t count)
+	{
+		if (!supportsMacGroups())
+			return false;
+
+		assert(count > 1 && count <= MaxMacGroupSize);
+
+		// gather mulInputA_24 of all MACs into xmm0
+		{
+			auto iramPos = m_pool.get(m_data.iramPos, Access::Read);
+			auto temp = m_pool.getTemp();
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const auto& instr = instrs[i];
+
+				if (instr.useImm)
+				{
+					m_asm.mov(temp.r32(), instr.imm);
+					if (i == 0)	m_asm.vmovd(xmm0, temp.r32());
+					else		m_asm.vpinsrd(xmm0, xmm0, temp.r32(), i);
+				}
+				else
+				{
+					// const uint32_t mempos = ((uint32_t)instr.mem + iramPos) & IRAM_MASK;
+					m_asm.lea(temp, ptr(iramPos, static_cast<int32_t>(instr.mem)));
+					m_asm.and_(temp, 0xff);
+					if (i == 0)	m_asm.vmovd(xmm0, iramPtr(temp));
+					else		m_asm.vpinsrd(xmm0, xmm0, iramPtr(temp), i);
+				}
+			}
+		}
+
+		// last_mulInputA_24 = mulInputA_24 of the last MAC;
+		{
+			auto last_mulInputA_24 = m_pool.get(m_data.last_mulInputA_24, Access::Write);
+			m_asm.vpextrd(last_mulInputA_24.r32(), xmm0, count - 1);
+		}
+
+		// se<24>(mulInputA_24)
+		m_asm.vpslld(xmm0, xmm0, 8);
+		m_asm.vpsrad(xmm0, xmm0, 8);
+
+		// result = mulInputA_24 * mulInputB_24, fits into 32 bits as the coefficient has eight bits only
+		m_asm.vpmovsxbd(xmm1, ptr(g_regBasePtr, m_pool.getPointerOffset(&m_data.coreData->coefs[pc]), 4));
+		m_asm.vpmulld(xmm0, xmm0, xmm1);
+
+		// result >>= instr.shiftAmount;
+		m_asm.vpmovsxbd(xmm1, ptr(g_regBasePtr, m_pool.getPointerOffset(&m_data.coreData->shiftAmounts[pc]), 4));
+		m_asm.vpsravd(xmm0, xmm0, xmm1);
+
+		// accumulate in program order, a MAC may add to the result of the previous one
+		auto result = m_pool.getTemp();
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const auto& access = instrs[i].m_access;
+
+			m_asm.vpextrd(result.r32(), xmm0, i);
+			m_asm.movsxd(result, result.r32());
+
+			if (!access.clr)
+			{
+				// result += *srcAcc;
+				auto acc = m_pool.get(&m_data.coreData->accs[access.srcReg], Access::Read);
+				m_asm.add(result, acc);
+			}
+
+			// *destAcc = result;
+			auto acc = m_pool.get(&m_data.coreData->accs[access.destReg], Access::Write);
+			m_asm.mov(acc, result);
+		}
+
+		return true;
+	}
+
 	Mem EspJitX64::iramPtr(const Gpq& offset) const
 	{
 		return ptr(g_regBasePtr, offset, 2, m_pool.getPointerOffset(m_data.iram), 4);
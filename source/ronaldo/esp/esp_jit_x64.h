@@ -22,6 +22,10 @@ namespace esp
 
 		void checkUninit(const asmjit::x86::Gpq& reg) const;
 		void emitOp(uint32_t pc, const ESPOptInstr& instr, bool lastMul30);
+		bool emitMacGroup(uint32_t pc, const ESPOptInstr* instrs, uint32_t count) override;
+
+		// packed MACs need AVX2 for the per-lane shift
+		static bool supportsMacGroups();
 
 	private:
 		asmjit::x86::Mem iramPtr(const asmjit::x86::Gpq& offset) const;
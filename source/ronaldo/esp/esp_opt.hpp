@@ -5,16 +5,22 @@
 #include "esp_jit_x64.h"
 #include "esp_jit_arm64.h"
 #include "esp_jit_types.h"
+#include "esp_jit_cache.h"
+#include "esp_jit_thread.h"
+
+#include <atomic>
+#include <mutex>
 
 constexpr int PRAM_SIZE = 768;
+constexpr int PRAM_PADDING = 4; // packed MACs load the coefs and shift amounts of four instructions at once
 
 struct CoreData {
   int32_t *hostRegPtr;
   int32_t *eramPtr;
   int64_t accs[6];
   int32_t mulcoeffs[8];
-  int8_t coefs[PRAM_SIZE];
-  int8_t shiftAmounts[PRAM_SIZE];
+  int8_t coefs[PRAM_SIZE + PRAM_PADDING];
+  int8_t shiftAmounts[PRAM_SIZE + PRAM_PADDING];
 };
 
 enum { kNone = 0, kSavesA = 1, kSavesB = 2 };
@@ -193,22 +199,26 @@ public:
     if (runCore0) m_rt.release(runCore0);
     if (runCore1) m_rt.release(runCore1);
 
-    eramEmitter.init(esp);
-    coreEmitter0.init(esp, &esp->core0);
-    coreEmitter1.init(esp, &esp->core1);
-
-    updateCoef(esp);
+    updateCoef(esp->core0.pram, esp->core1.pram);
+    m_mulcoefWrites0 = getMulcoefWrites(esp->core0.pram);
+    m_mulcoefWrites1 = getMulcoefWrites(esp->core1.pram);
 
     // logger.log("#### CORE 0 ####\n");
-    genCore(esp, 0, &coreEmitter0, &runCore0);
+    genCore(esp, 0, esp->core0.pram, &coreEmitter0, &runCore0);
     
     // logger.log("\n\n\n#### CORE 1 ####\n");
-    genCore(esp, 1, &coreEmitter1, &runCore1, true);
+    genCore(esp, 1, esp->core1.pram, &coreEmitter1, &runCore1, true);
 
     // fflush(logger._file);
     // printf("JITed ESP cores\n");
   }
-  
+
+  // If set, programs are compiled on the given thread and the interpreter runs until the new program is available
+  void setCompileThread(esp::JitThread* _thread)
+  {
+	  m_compileThread = _thread;
+  }
+
   void setProgramDirty()
   {
 	  m_programDirty = 3;
@@ -219,37 +229,80 @@ public:
       if (m_programDirty > 0)
       {
           if (--m_programDirty == 0)
-              genProgram(m_esp);
+          {
+              if (m_compileThread)
+                  genProgramAsync();
+              else
+                  genProgram(m_esp);
+          }
 	  }
+
+      if (m_compiling && m_asyncReadyVersion.load(std::memory_order_acquire) == m_asyncRequestedVersion)
+          swapAsyncProgram();
   }
 
+  // Coefficient-only write (if_mode 0x55), coef and shift live in the lower 10 bits of each program word.
+  // While a compile is pending, apply them to its snapshot so that they are not lost when the program is taken
   void updateCoef(ESP<lg2eram_size>* esp)
   {
+    if (!m_compiling || m_asyncPram.empty())
+    {
+      updateCoef(esp->core0.pram, esp->core1.pram);
+      return;
+    }
+
     for (size_t i = 0; i < PRAM_SIZE; i++) {
-      uint32_t instr = esp->core0.pram[i];
-      uint32_t op = (instr >> 16) & 0x7c;
-      int8_t coef = se<8>(instr & 0xff);
-      uint32_t shift = (instr >> 8) & 3;
-      uint32_t shiftAmount = (0x3567 >> (shift << 2)) & 0xf;
-      if (op == 0x20 || op == 0x24) shiftAmount = (shift & 1) ? 6 : 7;
-      data_core0.coefs[i] = coef;
-      data_core0.shiftAmounts[i] = shiftAmount;
+      m_asyncPram[i] = (m_asyncPram[i] & ~0x3ffu) | (esp->core0.pram[i] & 0x3ff);
+      m_asyncPram[i + PRAM_SIZE] = (m_asyncPram[i + PRAM_SIZE] & ~0x3ffu) | (esp->core1.pram[i] & 0x3ff);
     }
+  }
 
+  // coefs and shift amounts have to match the program that is running, pass the pram that has been compiled
+  void updateCoef(const uint32_t* pram0, const uint32_t* pram1)
+  {
+    updateCoef(data_core0, pram0);
+    updateCoef(data_core1, pram1);
+  }
+
+  static void updateCoef(CoreData& coreData, const uint32_t* pram)
+  {
     for (size_t i = 0; i < PRAM_SIZE; i++) {
-      uint32_t instr = esp->core1.pram[i];
+      uint32_t instr = pram[i];
       uint32_t op = (instr >> 16) & 0x7c;
       int8_t coef = se<8>(instr & 0xff);
       uint32_t shift = (instr >> 8) & 3;
       uint32_t shiftAmount = (0x3567 >> (shift << 2)) & 0xf;
       if (op == 0x20 || op == 0x24) shiftAmount = (shift & 1) ? 6 : 7;
-      data_core1.coefs[i] = coef;
-      data_core1.shiftAmounts[i] = shiftAmount;
+      coreData.coefs[i] = coef;
+      coreData.shiftAmounts[i] = shiftAmount;
     }
   }
 
+  // accumulators and coefficients of the jitted code. Everything else in CoreData is derived from the ESP program
+  void saveState(baseLib::BinaryStream& _s) const
+  {
+    _s.write(data_core0.accs); _s.write(data_core0.mulcoeffs);
+    _s.write(data_core1.accs); _s.write(data_core1.mulcoeffs);
+  }
+
+  void loadState(baseLib::BinaryStream& _s)
+  {
+    _s.read(data_core0.accs); _s.read(data_core0.mulcoeffs);
+    _s.read(data_core1.accs); _s.read(data_core1.mulcoeffs);
+
+    updateCoef(m_esp->core0.pram, m_esp->core1.pram);
+    m_programDirty = 1;
+  }
+
   inline void callOptimized(ESP<lg2eram_size>* esp)
   {
+    if (m_compiling)
+    {
+      for (size_t i = 0; i < PRAM_SIZE; i++)
+        esp->step_cores();
+      return;
+    }
+
     if (runCore0) runCore0(data_core0.coefs, esp->core0.iram, esp->shared.gram, &data_core0, esp->shared.eram.eramPos, esp->core0.iramPos, 0, 0);
     if (runCore1) runCore1(data_core1.coefs, esp->core1.iram, esp->shared.gram, &data_core1, esp->shared.eram.eramPos, esp->core1.iramPos, 0, 0);
   }
@@ -265,22 +318,143 @@ private:
   typedef void(*RunCore)(int8_t* coefsPtr, int32_t *iramPtr, int32_t *gramPtr, CoreData *varPtr, uint32_t eramPos, uint32_t iramPos, int64_t unused1, int64_t unused2);
   RunCore runCore0 = nullptr, runCore1 = nullptr;
 
-  // State used by jitted code
-  CoreData data_core0{0};
-  CoreData data_core1{0};
+  // Background compilation. Once a compile thread is set, m_rt is only modified on that thread
+  esp::JitThread* m_compileThread = nullptr;
+  bool m_compiling = false;
+  uint32_t m_asyncRequestedVersion = 0;
+  std::atomic<uint32_t> m_asyncReadyVersion{0};
+  std::atomic<uint32_t> m_asyncTakenVersion{0};
+  uint32_t m_asyncVersion = 0;							// compile thread only
+  RunCore m_asyncCore0 = nullptr, m_asyncCore1 = nullptr;	// written by the compile thread, read once m_asyncReadyVersion matches
+  std::mutex m_retiredMutex;
+  std::vector<RunCore> m_retired;							// replaced programs, released by the next compile job that runs
+  std::vector<uint32_t> m_asyncPram;						// program of the latest request, coefs are derived from it once it is taken
+
+  // mulcoeffs written by the running programs, the jitted cores keep a copy each while the interpreter shares them
+  uint8_t m_mulcoefWrites0 = 0, m_mulcoefWrites1 = 0;
+
+  static uint8_t getMulcoefWrites(const uint32_t* pram)
+  {
+    uint8_t mask = 0;
+    for (size_t i = 0; i < PRAM_SIZE; i++) {
+      const uint32_t instr = pram[i];
+      const uint32_t op = (instr >> 16) & 0x7c;
+      const uint32_t mem = (instr >> 10) & 0xff;
+      if (op == 0x34 && mem >= 0xa0 && mem < 0xb0)
+        mask |= 1 << ((mem >> 1) & 7);
+    }
+    return mask;
+  }
 
-  void genCore(ESP<lg2eram_size>* esp, uint32_t core, CoreEmitter* emitter, RunCore *dest, bool withEram = false)
+  // The jitted code starts each sample with A in accs[0] and B in accs[3], the other registers are renamed
+  // copies within the program. Hand the state over when switching between interpreter and jitted code so that
+  // the audio continues without a jump
+  void handOverToInterpreter()
   {
-    // TODO: do we need a new CodeHolder each time?
-    asmjit::CodeHolder code;
-    code.init(m_rt.environment());
+    if (!runCore0 && !runCore1)
+      return;
 
-  	logger.addFlags(asmjit::FormatFlags::kHexImms | /*asmjit::FormatFlags::kHexOffsets |*/ asmjit::FormatFlags::kMachineCode);
+    m_esp->core0.accA.setState(static_cast<int32_t>(data_core0.accs[0]));
+    m_esp->core0.accB.setState(static_cast<int32_t>(data_core0.accs[3]));
+    m_esp->core1.accA.setState(static_cast<int32_t>(data_core1.accs[0]));
+    m_esp->core1.accB.setState(static_cast<int32_t>(data_core1.accs[3]));
 
-//	code.setLogger(&logger);
-    
-    esp::Builder m_asm(&code);
+    // core 1 runs after core 0, its writes are the most recent ones
+    auto& mulcoeffs = m_esp->shared.mulcoeffs;
+    for (int i = 0; i < 8; ++i)
+    {
+      if (m_mulcoefWrites1 & (1 << i))
+        mulcoeffs[i] = data_core1.mulcoeffs[i];
+      else if (m_mulcoefWrites0 & (1 << i))
+        mulcoeffs[i] = data_core0.mulcoeffs[i];
+    }
+  }
 
+  void handOverToJit()
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      data_core0.accs[i] = m_esp->core0.accA.rawFull();
+      data_core0.accs[i + 3] = m_esp->core0.accB.rawFull();
+      data_core1.accs[i] = m_esp->core1.accA.rawFull();
+      data_core1.accs[i + 3] = m_esp->core1.accB.rawFull();
+    }
+
+    memcpy(data_core0.mulcoeffs, m_esp->shared.mulcoeffs, sizeof(data_core0.mulcoeffs));
+    memcpy(data_core1.mulcoeffs, m_esp->shared.mulcoeffs, sizeof(data_core1.mulcoeffs));
+  }
+
+  void genProgramAsync()
+  {
+    // the uC may continue to write program memory while we compile, work on a copy
+    std::vector<uint32_t> pram(m_esp->core0.pram, m_esp->core0.pram + PRAM_SIZE);
+    pram.insert(pram.end(), m_esp->core1.pram, m_esp->core1.pram + PRAM_SIZE);
+    m_asyncPram = pram;
+
+    if (!m_compiling)
+      handOverToInterpreter();
+
+    m_compiling = true;
+
+    const auto version = ++m_asyncRequestedVersion;
+
+    // retired programs are not handed to the job, a job that is replaced before it runs would take them with it
+    m_compileThread->add(this, [this, version, pram = std::move(pram)]
+    {
+      std::vector<RunCore> retired;
+      {
+        std::scoped_lock lock(m_retiredMutex);
+        retired.swap(m_retired);
+      }
+
+      for (auto* r : retired)
+        m_rt.release(r);
+
+      // a previous result that has been superseded before it was taken
+      if (m_asyncVersion && m_asyncVersion != m_asyncTakenVersion.load(std::memory_order_acquire))
+      {
+        if (m_asyncCore0) m_rt.release(m_asyncCore0);
+        if (m_asyncCore1) m_rt.release(m_asyncCore1);
+      }
+
+      m_asyncCore0 = m_asyncCore1 = nullptr;
+
+      genCore(m_esp, 0, &pram[0], &coreEmitter0, &m_asyncCore0);
+      genCore(m_esp, 1, &pram[PRAM_SIZE], &coreEmitter1, &m_asyncCore1, true);
+
+      m_asyncVersion = version;
+      m_asyncReadyVersion.store(version, std::memory_order_release);
+    });
+  }
+
+  void swapAsyncProgram()
+  {
+    {
+      std::scoped_lock lock(m_retiredMutex);
+      if (runCore0) m_retired.push_back(runCore0);
+      if (runCore1) m_retired.push_back(runCore1);
+    }
+
+    runCore0 = m_asyncCore0;
+    runCore1 = m_asyncCore1;
+
+    m_asyncTakenVersion.store(m_asyncRequestedVersion, std::memory_order_release);
+
+    updateCoef(&m_asyncPram[0], &m_asyncPram[PRAM_SIZE]);
+    m_mulcoefWrites0 = getMulcoefWrites(&m_asyncPram[0]);
+    m_mulcoefWrites1 = getMulcoefWrites(&m_asyncPram[PRAM_SIZE]);
+
+    handOverToJit();
+
+    m_compiling = false;
+  }
+
+  // State used by jitted code
+  CoreData data_core0{0};
+  CoreData data_core1{0};
+
+  void genCore(ESP<lg2eram_size>* esp, uint32_t core, const uint32_t* pram, CoreEmitter* emitter, RunCore *dest, bool withEram = false)
+  {
 	CoreData& coreData = core ? data_core1 : data_core0;
 	ESPCore<lg2eram_size>& espCore = core ? esp->core1 : esp->core0;
 
@@ -301,6 +475,38 @@ private:
 	jitData.last_mulInputA_24 = &espCore.last_mulInputA_24;
 	jitData.last_mulInputB_24 = &espCore.last_mulInputB_24;
 
+	// the same program has been generated before, by us or by another instance
+	const auto cacheKey = createCacheKey(jitData, core, pram);
+
+	esp::JitCache::Code cachedCode;
+
+	if (esp::JitCache::instance().get(cachedCode, cacheKey))
+	{
+		asmjit::CodeHolder code;
+		code.init(m_rt.environment());
+
+		esp::Builder m_asm(&code);
+		m_asm.embed(cachedCode.data(), cachedCode.size());
+		m_asm.finalize();
+
+		addCode(dest, code);
+		return;
+	}
+
+	if (withEram)
+		eramEmitter.init(pram);
+	emitter->init(pram);
+
+    // TODO: do we need a new CodeHolder each time?
+    asmjit::CodeHolder code;
+    code.init(m_rt.environment());
+
+  	logger.addFlags(asmjit::FormatFlags::kHexImms | /*asmjit::FormatFlags::kHexOffsets |*/ asmjit::FormatFlags::kMachineCode);
+
+//	code.setLogger(&logger);
+    
+    esp::Builder m_asm(&code);
+
 	esp::EspJit jit(m_asm, jitData);
 
     // m_asm.addDiagnosticOptions(asmjit::DiagnosticOptions::kValidateAssembler);
@@ -321,7 +527,19 @@ private:
 	jit.jitExit();
 
     m_asm.finalize();
-    
+
+	// code that needs relocation cannot be moved to another address
+	if (code.relocEntries().empty())
+	{
+		const auto& buffer = code.textSection()->buffer();
+		esp::JitCache::instance().add(cacheKey, esp::JitCache::Code(buffer.data(), buffer.data() + buffer.size()));
+	}
+
+	addCode(dest, code);
+  }
+
+  void addCode(RunCore* dest, asmjit::CodeHolder& code)
+  {
     const auto err = m_rt.add(dest, &code);
     if (err)
     {
@@ -333,12 +551,32 @@ private:
     }
   }
 
+  // Everything the generated code depends on: the program and the location of the data it accesses relative to the core data
+  static esp::JitCache::Key createCacheKey(const esp::JitInputData& jitData, uint32_t core, const uint32_t* pram)
+  {
+    const auto* base = reinterpret_cast<const uint8_t*>(jitData.coreData);
+    const auto offset = [base](const void* ptr) { return static_cast<uint32_t>(static_cast<const uint8_t*>(ptr) - base); };
+
+    std::vector<uint32_t> key
+    {
+      esp::JitCache::Version, esp::JitCache::getTarget(), static_cast<uint32_t>(lg2eram_size), core,
+      offset(jitData.iram), offset(jitData.gram), offset(jitData.eramPos), offset(jitData.iramPos),
+      offset(jitData.eramEffectiveAddr), offset(jitData.eramWriteLatchNext), offset(jitData.eramReadLatch),
+      offset(jitData.eramWriteLatch), offset(jitData.eramVarOffset), offset(jitData.last_mulInputA_24), offset(jitData.last_mulInputB_24),
+      offset(jitData.coreData->eramPtr), offset(jitData.coreData->hostRegPtr)
+    };
+
+    key.insert(key.end(), pram, pram + PRAM_SIZE);
+
+    return esp::JitCache::Key(reinterpret_cast<const uint8_t*>(key.data()), static_cast<uint32_t>(key.size() * sizeof(uint32_t)));
+  }
+
   class ERAMEmitter
   {
   public:
-    void init(ESP<lg2eram_size>* _esp)
+    void init(const uint32_t* _pram)
     {
-      esp = _esp;
+      pram = _pram;
 
       eramPCCommit = 0, eramPCStartNext = 0;
       eramModeCurrent = 0, eramModeNext = 0;
@@ -351,8 +589,7 @@ private:
     {
       if (lg2eram_size == 0) return;
 
-      uint32_t *decode = (uint32_t*)(&esp->intmem[0x1000]);
-      uint32_t eramCtrl = (decode[pc] >> 23) & 0x1f;
+      uint32_t eramCtrl = (pram[pc] >> 23) & 0x1f;
       int stage1 = pc - eramPCStartNext;
 
       // Transaction start
@@ -423,7 +660,7 @@ private:
     bool eramActiveCurrent = false, eramActiveNext = false;
     bool highOffset = false;
 
-    ESP<lg2eram_size>* esp;
+    const uint32_t* pram = nullptr;
     static constexpr int64_t ERAM_COMMIT_STAGE = 10, ERAM_MASK_FULL = (1 << 19) - 1;
 		enum {eram_size = 1 << lg2eram_size, ERAM_MASK = eram_size - 1};
   };
@@ -432,20 +669,29 @@ private:
   class CoreEmitter
   {
   public:
-    void init(ESP<lg2eram_size>* _esp, ESPCore<lg2eram_size>* _core)
+    void init(const uint32_t* _pram)
     {
-      esp = _esp;
-      core = _core;
+      pram = _pram;
+      macGroupEnd = 0;
 
       pre_optimize();
     }
 
     void emit(int pc, esp::EspJit& _jit, esp::Builder& m_asm)
     {
+		if (pc < macGroupEnd) return; // already emitted as part of a group
+
 		const ESPOptInstr &instr = pram_opt[pc];
 
     	if (instr.opType == kNop) return;
 
+		if (macGroupSize[pc] > 1 && _jit.emitMacGroup(pc, &pram_opt[pc], macGroupSize[pc]))
+		{
+			macGroupEnd = pc + macGroupSize[pc];
+			lastMul30 = false;
+			return;
+		}
+
 		_jit.emitOp(pc, instr, lastMul30);
 
 		lastMul30 = (instr.op == 0x30);
@@ -470,7 +716,7 @@ private:
 		void pre_optimize()
 		{
 			for (int i = 0; i < PRAM_SIZE; i++)
-				pram_opt[i] = ESPOptInstr(core->pram[i]);
+				pram_opt[i] = ESPOptInstr(pram[i]);
 
 			// Decided limitations: We will not support op 0x34, mem & 0xcc == 0xc0 (these are the jump operations)
 			for (int pc = 0; pc < PRAM_SIZE; pc++) assert((pram_opt[pc].op != 0xd || (pram_opt[pc].mem & 0xcc) != 0xc0) && "Jumps!"); // jumps. bail.
@@ -589,12 +835,38 @@ private:
 					skipfieldNeg |= 0x3c0;
 				}
 			}
+
+			// Group consecutive plain MACs. They only read iram and write accumulators, so their products can be computed
+			// at once. The accumulators are updated in program order afterwards. ERAM transactions that the emitter puts in
+			// between do not touch anything a plain MAC reads or writes
+			for (int pc = 0; pc < PRAM_SIZE;)
+			{
+				int count = 0;
+				while (pc + count < PRAM_SIZE && count < static_cast<int>(esp::EspJitBase::MaxMacGroupSize) && isPlainMac(pram_opt[pc + count]))
+					++count;
+
+				macGroupSize[pc] = static_cast<uint8_t>(count);
+				for (int i = 1; i < count; ++i)
+					macGroupSize[pc + i] = 0;
+
+				pc += count ? count : 1;
+			}
+		}
+
+		static bool isPlainMac(const ESPOptInstr& o)
+		{
+			if (o.opType != kMAC || o.m_access.nop || o.m_access.nomac || o.m_access.save)
+				return false;
+			if (o.m_access.srcReg == -1 || o.m_access.destReg == -1)
+				return false;
+			return o.op == 0x00 || o.op == 0x04 || o.op == 0x10 || o.op == 0x14;
 		}
 
-    ESP<lg2eram_size>* esp;
-    ESPCore<lg2eram_size>* core;
+    const uint32_t* pram = nullptr;
 
     ESPOptInstr pram_opt[PRAM_SIZE] {};
+    uint8_t macGroupSize[PRAM_SIZE] {};	// number of MACs in the group that starts at pc
+    int macGroupEnd = 0;
   };
   CoreEmitter coreEmitter0, coreEmitter1;
 };
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <type_traits>
+
+#include "baseLib/binarystream.h"
 
 typedef unsigned char uint8;
 typedef signed char int8;
@@ -44,14 +49,33 @@ static volatile bool g_dasm = true;
 
 class h8state {
 public:
-	uint8 memory[1<<24] {};
+	// The 16MB address space is split into 4k pages. A page is either plain memory, belongs to a single device or, if devices
+	// and memory share a page, has a per-byte device table. Memory for a page is only allocated once it is written to
+	static constexpr uint32 PageShift = 12;
+	static constexpr uint32 PageSize = 1 << PageShift;
+	static constexpr uint32 PageMask = PageSize - 1;
+	static constexpr uint32 PageCount = (1 << 24) >> PageShift;
+
+	struct Page
+	{
+		uint8* ram {nullptr};					// fast read path, only set if the page is plain memory
+		uint8* wram {nullptr};					// fast write path, as ram but cleared while the page holds decoded instructions
+		H8SDevice* device {nullptr};			// set if the whole page is mapped to one device
+		std::unique_ptr<H8SDevice*[]> devices;	// per-byte devices for shared pages, nullptr entries are memory
+		std::unique_ptr<uint8[]> storage;		// backing memory
+		bool code {false};						// instructions of this page have been decoded and cached
+		uint32 codeVersion {0};					// incremented whenever cached instructions of this page become invalid
+	};
+
 	h8reg regs[8] {};
-	uint8 *pc {0};		// program counter. pc is ALWAYS a multiple of 2. All instructions are 2bytes
+	uint32 pc {0};		// program counter. pc is ALWAYS a multiple of 2. All instructions are 2bytes
 	uint8 ccr {128};
 	uint8 exr {0};
-	H8SDevice* maps[1<<24] {};
+	Page pages[PageCount] {};
 	unsigned long long  cycles {0};
 	unsigned long long pending_irqs {0};
+	unsigned long long stepCycles {0};	// cycle count at the start of the current instruction
+	unsigned long long runUntil {0};	// run() executes instructions until cycles reach this value
 	
 	enum
 	{
@@ -77,7 +101,7 @@ public:
 	const char *getRegName16(int r)	const {const char *names[16]={"R0","R1","R2","R3","R4","R5","R6","R7","E0","E1","E2","E3","E4","E5","E6","E7"};return names[r&15];}
 	const char *getRegName32(int r)	const {const char *names[8]={"ER0","ER1","ER2","ER3","ER4","ER5","ER6","ER7"};return names[r&7];}
 	
-	uint32 addr(uint8 *p) {return (uint32)(p-memory);}
+	uint32 addr(uint32 p) {return p;}
 	
 	void boot()
 	{
@@ -86,7 +110,7 @@ public:
 		ccr = 128; exr = 0;
 	}
 	
-	uint8 *fail(uint8 *pc)
+	uint32 fail(uint32 pc)
 	{
 		printf("INVALID INSTRUCTION AT %s\n",printAddr(addr(pc)));
 		assert(false);
@@ -96,19 +120,108 @@ public:
 	void memmap(H8SDevice *dev,int start,int len = 1)
 	{
 		dev->setState(this);
-		for (int i=0;i<len;i++) maps[start+i]=dev;
+
+		while (len > 0)
+		{
+			Page& p = pages[(start >> PageShift) & (PageCount - 1)];
+			const int offset = start & PageMask;
+			const int count = len < (int)PageSize - offset ? len : (int)PageSize - offset;
+
+			p.ram = p.wram = nullptr;
+			invalidateCode(p);
+
+			if (count == (int)PageSize)
+			{
+				p.devices.reset();
+				p.device = dev;
+			}
+			else
+			{
+				if (!p.devices)
+				{
+					p.devices.reset(new H8SDevice*[PageSize]);
+					for (uint32 i=0;i<PageSize;i++) p.devices[i] = p.device;
+					p.device = nullptr;
+				}
+				for (int i=0;i<count;i++) p.devices[offset+i]=dev;
+			}
+
+			start += count;
+			len -= count;
+		}
 	}
 	
 	void loadmem(const uint8* data,uint32_t size,uint32_t address)
 	{
-		memcpy(memory + address,data,size);
+		while (size > 0)
+		{
+			const uint32 offset = address & PageMask;
+			const uint32 count = size < PageSize - offset ? size : PageSize - offset;
+			Page& p = pages[(address >> PageShift) & (PageCount - 1)];
+			invalidateCode(p);
+			memcpy(pageMemory(p) + offset, data, count);
+			data += count;
+			address += count;
+			size -= count;
+		}
 	}
 	
 	void readMemory(uint8* to, int from, int len)
 	{
-		memcpy(to, memory + from, len);
+		while (len > 0)
+		{
+			const Page& p = pages[(from >> PageShift) & (PageCount - 1)];
+			const int offset = from & PageMask;
+			const int count = len < (int)PageSize - offset ? len : (int)PageSize - offset;
+			if (p.storage)	memcpy(to, p.storage.get() + offset, count);
+			else			memset(to, 0, count);
+			to += count;
+			from += count;
+			len -= count;
+		}
 	}
 	
+	// cpu registers, timing counters and the contents of all allocated pages. Device mappings are not part of the state,
+	// the devices save their own state
+	void saveState(baseLib::BinaryStream& _s) const
+	{
+		for (const auto& r : regs) _s.write(r.er);
+		_s.write(pc); _s.write(ccr); _s.write(exr);
+		_s.write(cycles); _s.write(pending_irqs); _s.write(stepCycles);
+		_s.write(lastread); _s.write(lastwrite);
+
+		uint32 count = 0;
+		for (const auto& p : pages) if (p.storage) ++count;
+		_s.write(count);
+
+		for (uint32 i=0;i<PageCount;i++)
+		{
+			if (!pages[i].storage) continue;
+			_s.write(i);
+			_s.write(pages[i].storage.get(), PageSize);
+		}
+	}
+
+	void loadState(baseLib::BinaryStream& _s)
+	{
+		for (auto& r : regs) _s.read(r.er);
+		_s.read(pc); _s.read(ccr); _s.read(exr);
+		_s.read(cycles); _s.read(pending_irqs); _s.read(stepCycles);
+		_s.read(lastread); _s.read(lastwrite);
+		runUntil = 0;
+
+		const auto count = _s.read<uint32>();
+
+		uint8 page[PageSize];
+
+		for (uint32 i=0;i<count;i++)
+		{
+			const auto index = _s.read<uint32>() & (PageCount - 1);
+			_s.read(page);
+			loadmem(page, PageSize, index << PageShift);
+		}
+	}
+
 	void interrupt(int which)
 	{
 		if (which >= 12 && which < 18) {
@@ -118,14 +231,14 @@ public:
 		pending_irqs |= (1ULL << which);
 	}
 	
-	int getPC() const {return pcoff(pc);}
-	uint8 *makepc(int address) {return address+memory;}
-	int pcoff(uint8* pc) const {return (int)(pc - memory);}
+	int getPC() const {return (int)pc;}
+	uint32 makepc(int address) {return (uint32)address;}
 	
 	// memory accesses should use these
-	int32 read32(uint8 *from) {return read32((int)(from-memory));}
-	int16 read16(uint8 *from) {return read16((int)(from-memory));}
-	int8 read8(uint8 *from) {return read8((int)(from-memory));}
+	// instruction fetches from pc are signed
+	int32 read32(uint32 from) {return (int32)read32((int)from);}
+	int16 read16(uint32 from) {return (int16)read16((int)from);}
+	int8 read8(uint32 from) {return read8((int)from);}
 	
 	void write32(int32 val,int to) {write16(val>>16,to);write16(val&0xffff,to+2);}
 	uint32 read32(int from) {uint32 s=read16(from)&0xffff;s=(s<<16)|(read16(from+2)&0xffff);return s;}
@@ -135,14 +248,16 @@ public:
 	void write8(int8 byte,int to) {
 		to&=0xffffff;
 		clockMem(to, lastwrite);
-		if (maps[to]) maps[to]->write(to, byte);
-		else memory[to]=byte;
+		Page& p = pages[to >> PageShift];
+		if (p.wram) p.wram[to & PageMask]=byte;
+		else writeSlow(p, to, byte);
 	}
 	int8 read8(int from) {
 		from&=0xffffff;
 		clockMem(from, lastread);
-		if (maps[from]) return maps[from]->read(from);
-		return memory[from];
+		const Page& p = pages[from >> PageShift];
+		if (p.ram) return p.ram[from & PageMask];
+		return readSlow(p, from);
 	}
 	
 	void pushL(uint32 val)	{uint32 sp=getSP()-4;write32(val,sp);setSP(sp);}
@@ -150,18 +265,18 @@ public:
 	void pushW(uint16 val)	{uint16 sp=getSP()-2;write16(val,sp);setSP(sp);}
 	uint16 popW() 			{uint16 sp=getSP();setSP(sp+2);return read16(sp);}
 	
-	void pushPC(uint8 *pc,bool andccr=false)
+	void pushPC(uint32 pc,bool andccr=false)
 	{
-		uint32 p=(uint32)((pc-memory)&0xffffff);
+		uint32 p=pc&0xffffff;
 		if (andccr) pushL(p | (ccr <<24)); else pushL(p);
 	}
-	uint8 *popPC(bool andccr=false) {
+	uint32 popPC(bool andccr=false) {
 		uint32 p = popL();
 		if (andccr) ccr = p>>24;
-		return (p & 0xffffff) + memory;
+		return p & 0xffffff;
 	}
 	
-	uint8 *loadPCFrom(uint32 addr) {return (read32(addr)&0xFFFFFF)+memory;}
+	uint32 loadPCFrom(uint32 addr) {return read32(addr)&0xFFFFFF;}
 	
 	void clockI(int I) {cycles += I;}
 	void clockMem(int addr, int& last)
@@ -189,6 +304,10 @@ public:
 	}
 	
 	unsigned long long getCycles() const {return cycles;}
+	unsigned long long getStepCycles() const {return stepCycles;}
+	
+	// called by devices if an access changes when their next event happens, run() returns after the current instruction
+	void stopRun() {runUntil = 0;}
 	
 	double real_time_in_sec() const {double d = static_cast<double>(cycles); return d / (16.0e6);}
 	
@@ -259,6 +378,49 @@ protected:
 	
 	void ccrflags_set(int bit,int value) {ccr&=~bit;if (value)ccr|=bit;}
 
+	uint8* pageMemory(Page& p)
+	{
+		if (!p.storage)
+		{
+			p.storage.reset(new uint8[PageSize]());
+			if (!p.device && !p.devices) p.ram = p.wram = p.storage.get();
+		}
+		return p.storage.get();
+	}
+
+	int8 readSlow(const Page& p, int from)
+	{
+		if (p.device) return p.device->read(from);
+		if (p.devices && p.devices[from & PageMask]) return p.devices[from & PageMask]->read(from);
+		return p.storage ? p.storage[from & PageMask] : 0;
+	}
+
+	void writeSlow(Page& p, int to, int8 byte)
+	{
+		if (p.device) p.device->write(to, byte);
+		else if (p.devices && p.devices[to & PageMask]) p.devices[to & PageMask]->write(to, byte);
+		else
+		{
+			invalidateCode(p);
+			pageMemory(p)[to & PageMask]=byte;
+		}
+	}
+
+	// writes to a page with decoded instructions take the slow path so that they invalidate the decoded instructions
+	void markCode(Page& p)
+	{
+		p.code = true;
+		p.wram = nullptr;
+	}
+
+	void invalidateCode(Page& p)
+	{
+		if (!p.code) return;
+		p.code = false;
+		p.wram = p.ram;
+		++p.codeVersion;
+	}
+
 	int lastread {-1}, lastwrite {-1};
 };
 
@@ -268,9 +430,22 @@ class H8S : public h8state
 public:
 	void step()
 	{
+		stepCycles = cycles;
 		pc = handle_instr(pc);
 	}
-	uint8 *handle_instr(uint8 *_pc)
+	// executes instructions until the cycle counter reaches _untilCycles or a device calls stopRun(). At least one
+	// instruction is executed. Devices are not ticked in between, the caller is expected to stop at their next event
+	void run(unsigned long long _untilCycles)
+	{
+		runUntil = _untilCycles;
+		do
+		{
+			stepCycles = cycles;
+			pc = handle_instr(pc);
+		}
+		while (cycles < runUntil);
+	}
+	uint32 handle_instr(uint32 _pc)
 	{
 		pc = _pc;
 		if (execute && pending_irqs)
@@ -294,168 +469,245 @@ public:
 		}
 		if (disassemble && g_dasm) for (int i = 0; i < indent; i++) printf(" ");
 		if (((long long)pc)&1) pc--;	// ALWAYS mask off the bottom bit when loading short or int.
-		uint8 firstbyte=read8(pc);pc++;
-		switch((firstbyte>>4)&15)
+		if constexpr (UseDecodeCache)
 		{
-		case 0: return handle_instr_0(firstbyte,pc);
-		case 1: return handle_instr_1(firstbyte,pc);
-		case 2: return handle_movba(firstbyte,pc);
-		case 3: return handle_movba(firstbyte,pc);
-		case 4: return handle_bcc(firstbyte,pc);
-		case 5: return handle_instr_5(firstbyte,pc);
-		case 6: return handle_instr_6(firstbyte,pc);
-		case 7:	return handle_instr_7(firstbyte,pc);
-		case 8: return handle_addi(firstbyte,pc);
-		case 9:	return handle_addxi(firstbyte,pc);
-		case 10:return handle_cmpi(firstbyte,pc);
-		case 11:return handle_subxi(firstbyte,pc);
-		case 12:return handle_ori(firstbyte,pc);
-		case 13:return handle_xori(firstbyte,pc);
-		case 14:return handle_andi(firstbyte,pc);
-		case 15:return handle_movbi(firstbyte,pc);
-		}
-		return 0;
+			if (const Decoded* cached = findDecoded(pc))
+			{
+				// account for the opcode fetches that the decoder would have done
+				for (uint32 i=0;i<cached->len;i++) clockMem(pc+i, lastread);
+				return cached->fn(*this,*cached,pc+cached->len);
+			}
+		}
+		Decoded dec;
+		const uint32 start=pc;
+		pc=decode(dec,pc);
+		dec.len=(uint8)(pc-start);
+		if constexpr (UseDecodeCache) storeDecoded(start,dec);
+		return dec.fn(*this,dec,pc);
 	}
 protected:
-	uint8 *handle_instr_0(uint8 op,uint8 *pc)
+	// The decoder walks the opcode tree once per instruction and records the leaf handler plus the opcode bytes it
+	// consumed. The emulator caches the result per pc, the leaf handlers fetch their remaining operands themselves
+	static constexpr bool UseDecodeCache = execute && !disassemble;
+	static constexpr uint32 MaxCodeInvalidations = 64;	// pages that are written to more often than this are not cached anymore
+
+	struct Decoded
+	{
+		uint32 (*fn)(H8S&,const Decoded&,uint32) {nullptr};
+		uint8 op {0};
+		uint8 b {0};
+		int8 imm {0};
+		uint8 len {0};	// number of bytes consumed by the decoder, the leaf handler continues at pc + len
+	};
+
+	struct CodePage
+	{
+		std::unique_ptr<Decoded[]> entries;	// one entry per instruction word
+		uint32 version {0};					// Page::codeVersion at the time the entries were decoded
+	};
+
+	CodePage codePages[UseDecodeCache ? PageCount : 1];
+
+	const Decoded* findDecoded(uint32 _pc) const
+	{
+		if (_pc >= (1<<24)) return nullptr;
+		const CodePage& c = codePages[_pc >> PageShift];
+		if (!c.entries || c.version != pages[_pc >> PageShift].codeVersion) return nullptr;
+		const Decoded& d = c.entries[(_pc & PageMask) >> 1];
+		return d.fn ? &d : nullptr;
+	}
+
+	void storeDecoded(uint32 _pc,const Decoded& _dec)
+	{
+		if (_pc >= (1<<24) || (_pc & PageMask) + _dec.len > PageSize) return;
+		Page& p = pages[_pc >> PageShift];
+		if (!p.ram || p.codeVersion >= MaxCodeInvalidations) return;
+		CodePage& c = codePages[_pc >> PageShift];
+		if (!c.entries) c.entries.reset(new Decoded[PageSize/2]());
+		else if (c.version != p.codeVersion) std::fill_n(c.entries.get(), PageSize/2, Decoded());
+		c.version = p.codeVersion;
+		c.entries[(_pc & PageMask) >> 1] = _dec;
+		markCode(p);
+	}
+
+	template<auto F> static uint32 call(H8S& s,const Decoded& d,uint32 pc)
+	{
+		if constexpr (std::is_invocable_v<decltype(F),H8S&,uint8,uint8,uint32,int>)	return (s.*F)(d.op,d.b,pc,d.imm);
+		else if constexpr (std::is_invocable_v<decltype(F),H8S&,uint8,uint8,uint32>)	return (s.*F)(d.op,d.b,pc);
+		else																			return (s.*F)(d.op,pc);
+	}
+	static uint32 callInvalid(H8S& s,const Decoded& d,uint32 pc) {return s.fail(pc-d.len);}
+
+	template<auto F> uint32 leaf(Decoded& dec,uint32 pc,uint8 op,uint8 b=0,int imm=0)
+	{
+		dec.fn=&H8S::call<F>;dec.op=op;dec.b=b;dec.imm=(int8)imm;
+		return pc;
+	}
+	uint32 invalid(Decoded& dec,uint32 pc) {dec.fn=&H8S::callInvalid;return pc;}
+
+	uint32 decode(Decoded& dec,uint32 pc)
+	{
+		uint8 firstbyte=read8(pc);pc++;
+		switch((firstbyte>>4)&15)
+		{
+		case 0: return decode_0(dec,firstbyte,pc);
+		case 1: return decode_1(dec,firstbyte,pc);
+		case 2: return leaf<&H8S::handle_movba>(dec,pc,firstbyte);
+		case 3: return leaf<&H8S::handle_movba>(dec,pc,firstbyte);
+		case 4: return leaf<&H8S::handle_bcc>(dec,pc,firstbyte);
+		case 5: return decode_5(dec,firstbyte,pc);
+		case 6: return decode_6(dec,firstbyte,pc);
+		case 7:	return decode_7(dec,firstbyte,pc);
+		case 8: return leaf<&H8S::handle_addi>(dec,pc,firstbyte);
+		case 9:	return leaf<&H8S::handle_addxi>(dec,pc,firstbyte);
+		case 10:return leaf<&H8S::handle_cmpi>(dec,pc,firstbyte);
+		case 11:return leaf<&H8S::handle_subxi>(dec,pc,firstbyte);
+		case 12:return leaf<&H8S::handle_ori>(dec,pc,firstbyte);
+		case 13:return leaf<&H8S::handle_xori>(dec,pc,firstbyte);
+		case 14:return leaf<&H8S::handle_andi>(dec,pc,firstbyte);
+		case 15:return leaf<&H8S::handle_movbi>(dec,pc,firstbyte);
+		}
+		return invalid(dec,pc);
+	}
+	uint32 decode_0(Decoded& dec,uint8 op,uint32 pc)
 	{
 		switch (op&15)
 		{
-		case 0:	return handle_nop(op,pc);
-		case 1:	return handle_instr_01(op,pc);
-		case 2:	return handle_stcr(op,pc);
-		case 3:	return handle_ldcr(op,pc);
-		case 4:	return handle_orc(op,pc);
-		case 5:	return handle_xorc(op,pc);
-		case 6:	return handle_andc(op,pc);
-		case 7:	return handle_ldci(op,pc);
-		case 8: return handle_addr(op,pc);
-		case 9: return handle_addrw(op,pc);
-		case 10:return handle_instr_0a(op,pc);
-		case 11:return handle_instr_0b(op,pc);
-		case 12:return handle_movr(op,pc);
-		case 13:return handle_movrw(op,pc);
-		case 14:return handle_addxr(op,pc);
-		case 15:return handle_instr_0f(op,pc);
-		}
-		return 0;
-	}
-	uint8 *handle_instr_1(uint8 op,uint8 *pc)
+		case 0:	return leaf<&H8S::handle_nop>(dec,pc,op);
+		case 1:	return decode_01(dec,op,pc);
+		case 2:	return leaf<&H8S::handle_stcr>(dec,pc,op);
+		case 3:	return leaf<&H8S::handle_ldcr>(dec,pc,op);
+		case 4:	return leaf<&H8S::handle_orc>(dec,pc,op);
+		case 5:	return leaf<&H8S::handle_xorc>(dec,pc,op);
+		case 6:	return leaf<&H8S::handle_andc>(dec,pc,op);
+		case 7:	return leaf<&H8S::handle_ldci>(dec,pc,op);
+		case 8: return leaf<&H8S::handle_addr>(dec,pc,op);
+		case 9: return leaf<&H8S::handle_addrw>(dec,pc,op);
+		case 10:return decode_0a(dec,op,pc);
+		case 11:return decode_0b(dec,op,pc);
+		case 12:return leaf<&H8S::handle_movr>(dec,pc,op);
+		case 13:return leaf<&H8S::handle_movrw>(dec,pc,op);
+		case 14:return leaf<&H8S::handle_addxr>(dec,pc,op);
+		case 15:return decode_0f(dec,op,pc);
+		}
+		return invalid(dec,pc);
+	}
+	uint32 decode_1(Decoded& dec,uint8 op,uint32 pc)
 	{
 		switch (op&15)
 		{
-		case 0:	return handle_instr_10(op,pc);
-		case 1:	return handle_instr_11(op,pc);
-		case 2:	return handle_instr_12(op,pc);
-		case 3:	return handle_instr_13(op,pc);
-		case 4:	return handle_orr(op,pc);
-		case 5:	return handle_xorr(op,pc);
-		case 6:	return handle_andr(op,pc);
-		case 7:	return handle_instr_17(op,pc);
-		case 8:	return handle_subr(op,pc);
-		case 9:	return handle_subrw(op,pc);
-		case 10:return handle_instr_1a(op,pc);
-		case 11:return handle_instr_1b(op,pc);
-		case 12:return handle_cmpr(op,pc);
-		case 13:return handle_cmprw(op,pc);
-		case 14:return handle_subxr(op,pc);
-		case 15:return handle_instr_1f(op,pc);
-		}
-		return 0;
-	}
-	uint8 *handle_instr_5(uint8 op,uint8 *pc)
+		case 0:	return decode_10(dec,op,pc);
+		case 1:	return decode_11(dec,op,pc);
+		case 2:	return decode_12(dec,op,pc);
+		case 3:	return decode_13(dec,op,pc);
+		case 4:	return leaf<&H8S::handle_orr>(dec,pc,op);
+		case 5:	return leaf<&H8S::handle_xorr>(dec,pc,op);
+		case 6:	return leaf<&H8S::handle_andr>(dec,pc,op);
+		case 7:	return decode_17(dec,op,pc);
+		case 8:	return leaf<&H8S::handle_subr>(dec,pc,op);
+		case 9:	return leaf<&H8S::handle_subrw>(dec,pc,op);
+		case 10:return decode_1a(dec,op,pc);
+		case 11:return decode_1b(dec,op,pc);
+		case 12:return leaf<&H8S::handle_cmpr>(dec,pc,op);
+		case 13:return leaf<&H8S::handle_cmprw>(dec,pc,op);
+		case 14:return leaf<&H8S::handle_subxr>(dec,pc,op);
+		case 15:return decode_1f(dec,op,pc);
+		}
+		return invalid(dec,pc);
+	}
+	uint32 decode_5(Decoded& dec,uint8 op,uint32 pc)
 	{
 		switch (op&15)
 		{
-		case 0:	return handle_mulxu(op,pc);
-		case 1:	return handle_divxu(op,pc);
-		case 2:	return handle_mulxuw(op,pc);
-		case 3:	return handle_divxuw(op,pc);
-		case 4:	return handle_rts(op,pc);
-		case 5: return handle_bsr(op,pc);
-		case 6:	return handle_rte(op,pc);
-		case 7: return handle_trapa(op,pc);
-		case 8:	return handle_bccw(op,pc);
-		case 9:	return handle_jmpae(op,pc);
-		case 10:return handle_jmpimm(op,pc);
-		case 11:return handle_jmpaa(op,pc);
-		case 12:return handle_bsrw(op,pc);
-		case 13:return handle_jsrae(op,pc);
-		case 14:return handle_jsrimm(op,pc);
-		case 15:return handle_jsraa(op,pc);
-		}
-		return 0;
-	}
-	uint8 *handle_instr_6(uint8 op,uint8 *pc)
+		case 0:	return leaf<&H8S::handle_mulxu>(dec,pc,op);
+		case 1:	return leaf<&H8S::handle_divxu>(dec,pc,op);
+		case 2:	return leaf<&H8S::handle_mulxuw>(dec,pc,op);
+		case 3:	return leaf<&H8S::handle_divxuw>(dec,pc,op);
+		case 4:	return leaf<&H8S::handle_rts>(dec,pc,op);
+		case 5: return leaf<&H8S::handle_bsr>(dec,pc,op);
+		case 6:	return leaf<&H8S::handle_rte>(dec,pc,op);
+		case 7: return leaf<&H8S::handle_trapa>(dec,pc,op);
+		case 8:	return leaf<&H8S::handle_bccw>(dec,pc,op);
+		case 9:	return leaf<&H8S::handle_jmpae>(dec,pc,op);
+		case 10:return leaf<&H8S::handle_jmpimm>(dec,pc,op);
+		case 11:return leaf<&H8S::handle_jmpaa>(dec,pc,op);
+		case 12:return leaf<&H8S::handle_bsrw>(dec,pc,op);
+		case 13:return leaf<&H8S::handle_jsrae>(dec,pc,op);
+		case 14:return leaf<&H8S::handle_jsrimm>(dec,pc,op);
+		case 15:return leaf<&H8S::handle_jsraa>(dec,pc,op);
+		}
+		return invalid(dec,pc);
+	}
+	uint32 decode_6(Decoded& dec,uint8 op,uint32 pc)
 	{
 		switch (op&15)
 		{
-		case 0: return handle_bsetr(op,pc);
-		case 1: return handle_bnotr(op,pc);
-		case 2: return handle_bclrr(op,pc);
-		case 3: return handle_btstr(op,pc);
-		case 4:	return handle_orrw(op,pc);
-		case 5:	return handle_xorrw(op,pc);
-		case 6:	return handle_andrw(op,pc);
-		case 7:	return handle_bsti(op,pc);
-		case 8: return handle_movbae(op,pc);
-		case 9:	return handle_movwae(op,pc);
-		case 10:return handle_instr_6a(op,pc);
-		case 11:return handle_movwaa(op,pc);
-		case 12:return handle_movbaep(op,pc);
-		case 13:return handle_movwaep(op,pc);
-		case 14:return handle_movbaeo(op,pc);
-		case 15:return handle_movwaeo(op,pc);
-		}
-		return 0;
-	}
-	uint8 *handle_instr_7(uint8 op,uint8 *pc)
+		case 0: return leaf<&H8S::handle_bsetr>(dec,pc,op);
+		case 1: return leaf<&H8S::handle_bnotr>(dec,pc,op);
+		case 2: return leaf<&H8S::handle_bclrr>(dec,pc,op);
+		case 3: return leaf<&H8S::handle_btstr>(dec,pc,op);
+		case 4:	return leaf<&H8S::handle_orrw>(dec,pc,op);
+		case 5:	return leaf<&H8S::handle_xorrw>(dec,pc,op);
+		case 6:	return leaf<&H8S::handle_andrw>(dec,pc,op);
+		case 7:	return leaf<&H8S::handle_bsti>(dec,pc,op);
+		case 8: return leaf<&H8S::handle_movbae>(dec,pc,op);
+		case 9:	return leaf<&H8S::handle_movwae>(dec,pc,op);
+		case 10:return decode_6a(dec,op,pc);
+		case 11:return leaf<&H8S::handle_movwaa>(dec,pc,op);
+		case 12:return leaf<&H8S::handle_movbaep>(dec,pc,op);
+		case 13:return leaf<&H8S::handle_movwaep>(dec,pc,op);
+		case 14:return leaf<&H8S::handle_movbaeo>(dec,pc,op);
+		case 15:return leaf<&H8S::handle_movwaeo>(dec,pc,op);
+		}
+		return invalid(dec,pc);
+	}
+	uint32 decode_7(Decoded& dec,uint8 op,uint32 pc)
 	{
 		switch (op&15)
 		{
-		case 0: return handle_bseti(op,pc);
-		case 1: return handle_bnoti(op,pc);
-		case 2: return handle_bclri(op,pc);
-		case 3: return handle_btsti(op,pc);
-		case 4:	return handle_bor(op,pc);
-		case 5:	return handle_bxor(op,pc);
-		case 6: return handle_band(op,pc);
-		case 7: return handle_bld(op,pc);
-		case 8: return handle_movbwaed(op,pc);
-		case 9:	return handle_instr_79(op,pc);
-		case 10:return handle_instr_7a(op,pc);
-		case 11:return handle_eepmov(op,pc);
-		case 12:return handle_bitstuff_1(op,pc);
-		case 13:return handle_bitstuff_1(op,pc);
-		case 14:return handle_bitstuff_1(op,pc);
-		case 15:return handle_bitstuff_1(op,pc);
-		}
-		return 0;
-	}
-	uint8 *handle_instr_01(uint8 op,uint8 *pc)
+		case 0: return leaf<&H8S::handle_bseti>(dec,pc,op);
+		case 1: return leaf<&H8S::handle_bnoti>(dec,pc,op);
+		case 2: return leaf<&H8S::handle_bclri>(dec,pc,op);
+		case 3: return leaf<&H8S::handle_btsti>(dec,pc,op);
+		case 4:	return leaf<&H8S::handle_bor>(dec,pc,op);
+		case 5:	return leaf<&H8S::handle_bxor>(dec,pc,op);
+		case 6: return leaf<&H8S::handle_band>(dec,pc,op);
+		case 7: return leaf<&H8S::handle_bld>(dec,pc,op);
+		case 8: return leaf<&H8S::handle_movbwaed>(dec,pc,op);
+		case 9:	return decode_79(dec,op,pc);
+		case 10:return decode_7a(dec,op,pc);
+		case 11:return leaf<&H8S::handle_eepmov>(dec,pc,op);
+		case 12:return leaf<&H8S::handle_bitstuff_1>(dec,pc,op);
+		case 13:return leaf<&H8S::handle_bitstuff_1>(dec,pc,op);
+		case 14:return leaf<&H8S::handle_bitstuff_1>(dec,pc,op);
+		case 15:return leaf<&H8S::handle_bitstuff_1>(dec,pc,op);
+		}
+		return invalid(dec,pc);
+	}
+	uint32 decode_01(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		switch ((b>>4)&15)
 		{
-		case 0:	return handle_movl(op,b,pc);
-		case 1:	return handle_ldmstm(op,b,pc);
-		case 2:	return handle_ldmstm(op,b,pc);
-		case 3:	return handle_ldmstm(op,b,pc);
-		case 4:	return handle_ldcstc(op,b,pc);
-		case 8: return handle_sleep(op,b,pc);
-		case 12:return handle_instr_01c(op,b,pc);
-		case 13:return handle_instr_01d(op,b,pc);
-		case 14:return handle_tas(op,b,pc);
-		case 15:return handle_instr_01f(op,b,pc);
-		default:return fail(pc-2);	// 0x6 is MAC instruction, 0xA is CLRMAC instruction.
+		case 0:	return leaf<&H8S::handle_movl>(dec,pc,op,b);
+		case 1:	return leaf<&H8S::handle_ldmstm>(dec,pc,op,b);
+		case 2:	return leaf<&H8S::handle_ldmstm>(dec,pc,op,b);
+		case 3:	return leaf<&H8S::handle_ldmstm>(dec,pc,op,b);
+		case 4:	return leaf<&H8S::handle_ldcstc>(dec,pc,op,b);
+		case 8: return leaf<&H8S::handle_sleep>(dec,pc,op,b);
+		case 12:return decode_01c(dec,op,b,pc);
+		case 13:return decode_01d(dec,op,b,pc);
+		case 14:return leaf<&H8S::handle_tas>(dec,pc,op,b);
+		case 15:return decode_01f(dec,op,b,pc);
+		default:return invalid(dec,pc);	// 0x6 is MAC instruction, 0xA is CLRMAC instruction.
 		}
 	}
-	uint8 *handle_instr_0a(uint8 op,uint8 *pc)
+	uint32 decode_0a(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		switch ((b>>4)&15)
 		{
-		case 0:	return handle_incb(op,b,pc);
+		case 0:	return leaf<&H8S::handle_incb>(dec,pc,op,b);
 		case 8:
 		case 9:
 		case 10:
@@ -463,31 +715,31 @@ protected:
 		case 12:
 		case 13:
 		case 14:
-		case 15:return handle_addl(op,b,pc);
-		default:return fail(pc-2);
+		case 15:return leaf<&H8S::handle_addl>(dec,pc,op,b);
+		default:return invalid(dec,pc);
 		}
 	}
-	uint8 *handle_instr_0b(uint8 op,uint8 *pc)
+	uint32 decode_0b(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		switch ((b>>4)&15)
 		{
-		case 0:	return handle_addsi(op,b,pc,1);
-		case 5: return handle_incwi(op,b,pc,1);
-		case 7: return handle_incli(op,b,pc,1);
-		case 8:	return handle_addsi(op,b,pc,2);
-		case 9:	return handle_addsi(op,b,pc,4);
-		case 13:return handle_incwi(op,b,pc,2);
-		case 15:return handle_incli(op,b,pc,2);
-		default:return fail(pc-2);
+		case 0:	return leaf<&H8S::handle_addsi>(dec,pc,op,b,1);
+		case 5: return leaf<&H8S::handle_incwi>(dec,pc,op,b,1);
+		case 7: return leaf<&H8S::handle_incli>(dec,pc,op,b,1);
+		case 8:	return leaf<&H8S::handle_addsi>(dec,pc,op,b,2);
+		case 9:	return leaf<&H8S::handle_addsi>(dec,pc,op,b,4);
+		case 13:return leaf<&H8S::handle_incwi>(dec,pc,op,b,2);
+		case 15:return leaf<&H8S::handle_incli>(dec,pc,op,b,2);
+		default:return invalid(dec,pc);
 		}
 	}
-	uint8 *handle_instr_0f(uint8 op,uint8 *pc)
+	uint32 decode_0f(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		switch ((b>>4)&15)
 		{
-		case 0:	return handle_daa(op,b,pc);
+		case 0:	return leaf<&H8S::handle_daa>(dec,pc,op,b);
 		case 8:
 		case 9:
 		case 10:
@@ -495,179 +747,177 @@ protected:
 		case 12:
 		case 13:
 		case 14:
-		case 15:return handle_movrl(op,b,pc);
-		default:return fail(pc-2);
+		case 15:return leaf<&H8S::handle_movrl>(dec,pc,op,b);
+		default:return invalid(dec,pc);
 		}
 	}
-	uint8 *handle_instr_10(uint8 op,uint8 *pc)
+	uint32 decode_10(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
-		int top=(b>>4)&7; if (top==2 || top==6) return fail(pc-2);
-		if (b&128) 	return handle_shal(op, b, pc);
-		else		return handle_shll(op, b, pc);
+		int top=(b>>4)&7; if (top==2 || top==6) return invalid(dec,pc);
+		if (b&128) 	return leaf<&H8S::handle_shal>(dec,pc,op,b);
+		else		return leaf<&H8S::handle_shll>(dec,pc,op,b);
 	}
-	uint8 *handle_instr_11(uint8 op,uint8 *pc)
+	uint32 decode_11(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
-		int top=(b>>4)&7; if (top==2 || top==6) return fail(pc-2);
-		if (b&128) 	return handle_shar(op, b, pc);
-		else		return handle_shlr(op, b, pc);
+		int top=(b>>4)&7; if (top==2 || top==6) return invalid(dec,pc);
+		if (b&128) 	return leaf<&H8S::handle_shar>(dec,pc,op,b);
+		else		return leaf<&H8S::handle_shlr>(dec,pc,op,b);
 	}
-	uint8 *handle_instr_12(uint8 op,uint8 *pc)
+	uint32 decode_12(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
-		int top=(b>>4)&7; if (top==2 || top==6) return fail(pc-2);
-		if (b&128) 	return handle_rotl(op, b, pc);
-		else		return handle_rotxl(op, b, pc);
+		int top=(b>>4)&7; if (top==2 || top==6) return invalid(dec,pc);
+		if (b&128) 	return leaf<&H8S::handle_rotl>(dec,pc,op,b);
+		else		return leaf<&H8S::handle_rotxl>(dec,pc,op,b);
 	}
-	uint8 *handle_instr_13(uint8 op,uint8 *pc)
+	uint32 decode_13(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
-		int top=(b>>4)&7; if (top==2 || top==6) return fail(pc-2);
-		if (b&128) 	return handle_rotr(op, b, pc);
-		else		return handle_rotxr(op, b, pc);
+		int top=(b>>4)&7; if (top==2 || top==6) return invalid(dec,pc);
+		if (b&128) 	return leaf<&H8S::handle_rotr>(dec,pc,op,b);
+		else		return leaf<&H8S::handle_rotxr>(dec,pc,op,b);
 	}
-	uint8 *handle_instr_17(uint8 op,uint8 *pc)
+	uint32 decode_17(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		switch ((b>>4)&15)
 		{
 		case 0:
 		case 1:
-		case 3:	return handle_not(op, b, pc);
+		case 3:	return leaf<&H8S::handle_not>(dec,pc,op,b);
 		case 5:
-		case 7:	return handle_extu(op, b, pc);
+		case 7:	return leaf<&H8S::handle_extu>(dec,pc,op,b);
 		case 8:
 		case 9:
-		case 11:return handle_neg(op, b, pc);
+		case 11:return leaf<&H8S::handle_neg>(dec,pc,op,b);
 		case 13:
-		case 15:return handle_exts(op, b, pc);
-		default:return fail(pc-2);
+		case 15:return leaf<&H8S::handle_exts>(dec,pc,op,b);
+		default:return invalid(dec,pc);
 		}
 	}
-	uint8 *handle_instr_1a(uint8 op,uint8 *pc)
+	uint32 decode_1a(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
-		if (b&0x80) return handle_subl(op, b, pc);
-		if (!(b&0xf0)) return handle_decb(op, b, pc);
-		return fail(pc-2);
+		if (b&0x80) return leaf<&H8S::handle_subl>(dec,pc,op,b);
+		if (!(b&0xf0)) return leaf<&H8S::handle_decb>(dec,pc,op,b);
+		return invalid(dec,pc);
 	}
-	uint8 *handle_instr_1b(uint8 op,uint8 *pc)
+	uint32 decode_1b(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		switch ((b>>4)&15)
 		{
-		case 0:	return handle_subsi(op, b, pc, 1);
-		case 5:	return handle_decwi(op, b, pc, 1);
-		case 7:	return handle_decli(op, b, pc, 1);
-		case 8:	return handle_subsi(op, b, pc, 2);
-		case 9:	return handle_subsi(op, b, pc, 4);
-		case 13:return handle_decwi(op, b, pc, 2);
-		case 15:return handle_decli(op, b, pc, 2);
-		default:return fail(pc-2);
+		case 0:	return leaf<&H8S::handle_subsi>(dec,pc,op,b,1);
+		case 5:	return leaf<&H8S::handle_decwi>(dec,pc,op,b,1);
+		case 7:	return leaf<&H8S::handle_decli>(dec,pc,op,b,1);
+		case 8:	return leaf<&H8S::handle_subsi>(dec,pc,op,b,2);
+		case 9:	return leaf<&H8S::handle_subsi>(dec,pc,op,b,4);
+		case 13:return leaf<&H8S::handle_decwi>(dec,pc,op,b,2);
+		case 15:return leaf<&H8S::handle_decli>(dec,pc,op,b,2);
+		default:return invalid(dec,pc);
 		}
 	}
-	uint8 *handle_instr_1f(uint8 op,uint8 *pc)
+	uint32 decode_1f(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
-		if (b&0x80) return handle_cmpl(op, b, pc);
-		if (!(b&0xf0)) return handle_das(op, b, pc);
-		return fail(pc-2);
+		if (b&0x80) return leaf<&H8S::handle_cmpl>(dec,pc,op,b);
+		if (!(b&0xf0)) return leaf<&H8S::handle_das>(dec,pc,op,b);
+		return invalid(dec,pc);
 	}
-	uint8 *handle_instr_6a(uint8 op,uint8 *pc)
+	uint32 decode_6a(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		switch ((b>>4)&15)
 		{
-		case 0:	return handle_movbaa(op, b, pc);
-		case 1:	return handle_bitstuff_2(op, b, pc);
-		case 2:	return handle_movbaa(op, b, pc);
-		case 3:	return handle_bitstuff_2(op, b, pc);
-		case 4:	return fail(pc-2);	// MOVFPE instruction
-		case 8:	return handle_movbaa(op, b, pc);
-		case 10:return handle_movbaa(op, b, pc);
-		case 12:return fail(pc-2);	// MOVTPE instruction
-		default:return fail(pc-2);
+		case 0:	return leaf<&H8S::handle_movbaa>(dec,pc,op,b);
+		case 1:	return leaf<&H8S::handle_bitstuff_2>(dec,pc,op,b);
+		case 2:	return leaf<&H8S::handle_movbaa>(dec,pc,op,b);
+		case 3:	return leaf<&H8S::handle_bitstuff_2>(dec,pc,op,b);
+		case 4:	return invalid(dec,pc);	// MOVFPE instruction
+		case 8:	return leaf<&H8S::handle_movbaa>(dec,pc,op,b);
+		case 10:return leaf<&H8S::handle_movbaa>(dec,pc,op,b);
+		case 12:return invalid(dec,pc);	// MOVTPE instruction
+		default:return invalid(dec,pc);
 		}
 	}
-	uint8 *handle_instr_79(uint8 op,uint8 *pc)
+	uint32 decode_79(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		switch ((b>>4)&15)
 		{
-		case 0:	return handle_movwi(op, b, pc);
-		case 1:	return handle_addwi(op, b, pc);
-		case 2: return handle_cmpwi(op, b, pc);
-		case 3: return handle_subwi(op, b, pc);
-		case 4: return handle_orwi(op, b, pc);
-		case 5:	return handle_xorwi(op, b, pc);
-		case 6:	return handle_andwi(op, b, pc);
-		default:return fail(pc-2);
+		case 0:	return leaf<&H8S::handle_movwi>(dec,pc,op,b);
+		case 1:	return leaf<&H8S::handle_addwi>(dec,pc,op,b);
+		case 2: return leaf<&H8S::handle_cmpwi>(dec,pc,op,b);
+		case 3: return leaf<&H8S::handle_subwi>(dec,pc,op,b);
+		case 4: return leaf<&H8S::handle_orwi>(dec,pc,op,b);
+		case 5:	return leaf<&H8S::handle_xorwi>(dec,pc,op,b);
+		case 6:	return leaf<&H8S::handle_andwi>(dec,pc,op,b);
+		default:return invalid(dec,pc);
 		}
 	}
-	uint8 *handle_instr_7a(uint8 op,uint8 *pc)
+	uint32 decode_7a(Decoded& dec,uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		switch ((b>>4)&15)
 		{
-		case 0:	return handle_movli(op, b, pc);
-		case 1:	return handle_addli(op, b, pc);
-		case 2: return handle_cmpli(op, b, pc);
-		case 3: return handle_subli(op, b, pc);
-		case 4: return handle_orli(op, b, pc);
-		case 5:	return handle_xorli(op, b, pc);
-		case 6:	return handle_andli(op, b, pc);
-		default:return fail(pc-2);
+		case 0:	return leaf<&H8S::handle_movli>(dec,pc,op,b);
+		case 1:	return leaf<&H8S::handle_addli>(dec,pc,op,b);
+		case 2: return leaf<&H8S::handle_cmpli>(dec,pc,op,b);
+		case 3: return leaf<&H8S::handle_subli>(dec,pc,op,b);
+		case 4: return leaf<&H8S::handle_orli>(dec,pc,op,b);
+		case 5:	return leaf<&H8S::handle_xorli>(dec,pc,op,b);
+		case 6:	return leaf<&H8S::handle_andli>(dec,pc,op,b);
+		default:return invalid(dec,pc);
 		}
 	}
-	uint8 *handle_instr_01c(uint8 op, uint8 b, uint8 *pc)
+	uint32 decode_01c(Decoded& dec,uint8 op,uint8 b,uint32 pc)
 	{
-		if (b&15) return fail(pc-2);
+		if (b&15) return invalid(dec,pc);
 		int c=read8(pc);pc++;
 		int d=read8(pc);pc++;
-		if (((c>>4)&15)!=5) return fail(pc-4);
+		if (((c>>4)&15)!=5) return invalid(dec,pc);
 		switch (c&15)
 		{
-		case 0:	return handle_mulxs(d, pc);
-		case 2:	return handle_mulxsw(d, pc);
-		return fail(pc-4);
+		case 0:	return leaf<&H8S::handle_mulxs>(dec,pc,d);
+		case 2:	return leaf<&H8S::handle_mulxsw>(dec,pc,d);
 		}
-		return 0;
+		return invalid(dec,pc);
 	}
-	uint8 *handle_instr_01d(uint8 op, uint8 b, uint8 *pc)
+	uint32 decode_01d(Decoded& dec,uint8 op,uint8 b,uint32 pc)
 	{
-		if (b&15) return fail(pc-2);
+		if (b&15) return invalid(dec,pc);
 		int c=read8(pc);pc++;
 		int d=read8(pc);pc++;
-		if (((c>>4)&15)!=5) return fail(pc-4);
+		if (((c>>4)&15)!=5) return invalid(dec,pc);
 		switch (c&15)
 		{
-		case 1:	return handle_divxs(d, pc);
-		case 3:	return handle_divxsw(d, pc);
-		return fail(pc-4);
+		case 1:	return leaf<&H8S::handle_divxs>(dec,pc,d);
+		case 3:	return leaf<&H8S::handle_divxsw>(dec,pc,d);
 		}
-		return 0;
+		return invalid(dec,pc);
 	}
-	uint8 *handle_instr_01f(uint8 op, uint8 b, uint8 *pc)
+	uint32 decode_01f(Decoded& dec,uint8 op,uint8 b,uint32 pc)
 	{
-		if (b&15) return fail(pc-2);
+		if (b&15) return invalid(dec,pc);
 		int c=read8(pc);pc++;
 		int d=read8(pc);pc++;
-		if (((c>>4)&15)!=6) return fail(pc-4);
-		if (d&0x88) return fail(pc-4);
+		if (((c>>4)&15)!=6) return invalid(dec,pc);
+		if (d&0x88) return invalid(dec,pc);
 		switch (c&15)
 		{
-		case 4:	return handle_orrl(d, pc);
-		case 5: return handle_xorrl(d, pc);
-		case 6: return handle_andrl(d, pc);
-		default:return fail(pc-4);
+		case 4:	return leaf<&H8S::handle_orrl>(dec,pc,d);
+		case 5: return leaf<&H8S::handle_xorrl>(dec,pc,d);
+		case 6: return leaf<&H8S::handle_andrl>(dec,pc,d);
+		default:return invalid(dec,pc);
 		}
-		return 0;
+		return invalid(dec,pc);
 	}
 
 
 	//////// MOV.B @immediate,Reg
-	uint8 *handle_movba(uint8 op,uint8 *pc)
+	uint32 handle_movba(uint8 op,uint32 pc)
 	{
 		int rd=op&15,imm=((read8(pc))&255)+0xFFFF00;pc++;op=(op>>4)&15;
 		if (disassemble)
@@ -682,9 +932,9 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_movbaa(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_movbaa(uint8 op,uint8 b,uint32 pc)
 	{
-		uint8 *startpc=pc-2;int rd=b&15,regsrc=(b&0x80)?1:0,size=(b&0x20)?1:0;
+		uint32 startpc=pc-2;int rd=b&15,regsrc=(b&0x80)?1:0,size=(b&0x20)?1:0;
 		int imm=0;if (size) {imm=read32(pc);pc+=4;} else {imm=se16(read16(pc));pc+=2;}
 		if (disassemble)
 		{
@@ -698,7 +948,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_movbae(uint8 op,uint8 *pc)
+	uint32 handle_movbae(uint8 op,uint32 pc)
 	{
 		int r=read8(pc);pc++;int er=(r>>4)&7,d=(r>>7)&1;r&=15;
 		if (disassemble)
@@ -712,7 +962,7 @@ protected:
 		ccrflags_val(reg8(r));
 		return pc;
 	}
-	uint8 *handle_movwae(uint8 op,uint8 *pc)
+	uint32 handle_movwae(uint8 op,uint32 pc)
 	{
 		int r=read8(pc);pc++;int er=(r>>4)&7,d=(r>>7)&1;r&=15;
 		if (disassemble)
@@ -726,9 +976,9 @@ protected:
 		ccrflags_val(reg16(r));
 		return pc;
 	}
-	uint8 *handle_movwaa(uint8 op,uint8 *pc)
+	uint32 handle_movwaa(uint8 op,uint32 pc)
 	{
-		uint8 *ipc=pc-1;int r=read8(pc);pc++;int sub=(r>>4)&15;r&=15;int d=sub&8;
+		uint32 ipc=pc-1;int r=read8(pc);pc++;int sub=(r>>4)&15;r&=15;int d=sub&8;
 		int offset=read16(pc);pc+=2;
 		if (sub&5)	return fail(pc);	// valid values are 0,2,8,10
 		if (sub&2) {offset=(offset<<16)|(read16(pc) & 0xffff);pc+=2;} else offset=se16(offset);
@@ -742,7 +992,7 @@ protected:
 		ccrflags_val(reg16(r));
 		return pc;
 	}
-	uint8 *handle_movbaep(uint8 op,uint8 *pc)
+	uint32 handle_movbaep(uint8 op,uint32 pc)
 	{
 		int r=read8(pc);pc++;int e=(r>>4)&7,d=(r>>7)&1;r&=15;
 		if (disassemble)
@@ -757,7 +1007,7 @@ protected:
 		clockI(2);
 		return pc;
 	}
-	uint8 *handle_movwaep(uint8 op,uint8 *pc)
+	uint32 handle_movwaep(uint8 op,uint32 pc)
 	{
 		int r=read8(pc);pc++;int e=(r>>4)&7,d=(r>>7)&1;r&=15;
 		if (disassemble)
@@ -773,7 +1023,7 @@ protected:
 		ccrflags_val(reg16(r));
 		return pc;
 	}
-	uint8 *handle_movbaeo(uint8 op,uint8 *pc)
+	uint32 handle_movbaeo(uint8 op,uint32 pc)
 	{
 		int r=read8(pc);pc++;int e=(r>>4)&7,d=(r>>7)&1;r&=15;int offset=read16(pc);pc+=2;
 		if (disassemble)
@@ -787,7 +1037,7 @@ protected:
 		ccrflags_val(reg8(r));
 		return pc;
 	}
-	uint8 *handle_movwaeo(uint8 op,uint8 *pc)
+	uint32 handle_movwaeo(uint8 op,uint32 pc)
 	{
 		int r=read8(pc);pc++;int e=(r>>4)&7,d=(r>>7)&1;r&=15;int offset=read16(pc);pc+=2;
 		if (disassemble)
@@ -801,7 +1051,7 @@ protected:
 		ccrflags_val(reg16(r));
 		return pc;
 	}
-	uint8 *handle_movbwaed(uint8 op,uint8 *pc)
+	uint32 handle_movbwaed(uint8 op,uint32 pc)
 	{
 		int r=read8(pc);pc++;int e=(r>>4);
 		if (r&0x8f)	return fail(pc-2);
@@ -837,9 +1087,9 @@ protected:
 		return pc;
 	}
 	
-	uint8* handle_movl(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_movl(uint8 op,uint8 b,uint32 pc)
 	{
-		uint8 *pcstart=pc-2;
+		uint32 pcstart=pc-2;
 		if (b) return fail(pcstart);
 		uint8 c=read8(pc);pc++;
 		if ((c&0xe8)!=0x68) return fail(pcstart);
@@ -907,7 +1157,7 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_movrl(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_movrl(uint8 op,uint8 b,uint32 pc)
 	{
 		if (b&0x8) return fail(pc-2);
 		int rd=(b&7),rs=(b>>4)&7;
@@ -917,7 +1167,7 @@ protected:
 	}
 	
 	//////// LDM/STM
-	uint8* handle_ldmstm(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_ldmstm(uint8 op,uint8 b,uint32 pc)
 	{
 		if (b&7) return fail(pc-2);	// must be zero
 		int c=read8(pc);pc++;
@@ -936,9 +1186,9 @@ protected:
 		return pc;
 	}
 	
-	uint8* handle_ldcstc(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_ldcstc(uint8 op,uint8 b,uint32 pc)
 	{
-		uint8 *pcstart=pc-2;
+		uint32 pcstart=pc-2;
 		if ((b&0xfe)!=0x40) return fail(pcstart);
 		int isexr=(b&1);	// if not exr then ccr
 		uint8 &cr=isexr?exr:ccr;
@@ -1031,7 +1281,7 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_tas(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_tas(uint8 op,uint8 b,uint32 pc)
 	{
 		if (b&0xf) return fail(pc-2);
 		int c=read8(pc);pc++;
@@ -1045,14 +1295,14 @@ protected:
 	}
 	
 	//////// REGISTER OPS
-	uint8 *handle_movr(uint8 op,uint8 *pc)
+	uint32 handle_movr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"MOV.B","%s,%s",getRegName8(rs),getRegName8(rd));
 		if (execute) {int8 &src=reg8(rs), &dst=reg8(rd);	ccrflags_val(src);	dst=src; }
 		return pc;
 	}
-	uint8 *handle_movrw(uint8 op,uint8 *pc)
+	uint32 handle_movrw(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"MOV.W","%s,%s",getRegName16(rs),getRegName16(rd));
@@ -1060,7 +1310,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_orr(uint8 op,uint8 *pc)
+	uint32 handle_orr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"OR.B","%s,%s",getRegName8(rs),getRegName8(rd));
@@ -1068,14 +1318,14 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_orrw(uint8 op,uint8 *pc)
+	uint32 handle_orrw(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"OR.W","%s,%s",getRegName16(rs),getRegName16(rd));
 		if (execute) {int16 &src=reg16(rs),&dst=reg16(rd);	dst|=src;	ccrflags_val(dst); }
 		return pc;
 	}
-	uint8 *handle_orrl(uint8 d,uint8 *pc)
+	uint32 handle_orrl(uint8 d,uint32 pc)
 	{
 		int rs=(d>>4)&15,rd=(d)&15;
 		if (disassemble)	dasm(pc-4,"OR.L","%s,%s",getRegName32(rs),getRegName32(rd));
@@ -1083,7 +1333,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_xorr(uint8 op,uint8 *pc)
+	uint32 handle_xorr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"XOR.B","%s,%s",getRegName8(rs),getRegName8(rd));
@@ -1091,14 +1341,14 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_xorrw(uint8 op,uint8 *pc)
+	uint32 handle_xorrw(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"XOR.W","%s,%s",getRegName16(rs),getRegName16(rd));
 		if (execute) {int16 &src=reg16(rs),&dst=reg16(rd);	dst^=src;	ccrflags_val(dst); }
 		return pc;
 	}
-	uint8 *handle_xorrl(uint8 d,uint8 *pc)
+	uint32 handle_xorrl(uint8 d,uint32 pc)
 	{
 		int rs=(d>>4)&15,rd=(d)&15;
 		if (disassemble)	dasm(pc-4,"XOR.L","%s,%s",getRegName32(rs),getRegName32(rd));
@@ -1106,7 +1356,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_andr(uint8 op,uint8 *pc)
+	uint32 handle_andr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"AND.B","%s,%s",getRegName8(rs),getRegName8(rd));
@@ -1114,14 +1364,14 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_andrw(uint8 op,uint8 *pc)
+	uint32 handle_andrw(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"AND.W","%s,%s",getRegName16(rs),getRegName16(rd));
 		if (execute) {int16 &src=reg16(rs),&dst=reg16(rd);	dst&=src;	ccrflags_val(dst); }
 		return pc;
 	}
-	uint8 *handle_andrl(uint8 d,uint8 *pc)
+	uint32 handle_andrl(uint8 d,uint32 pc)
 	{
 		int rs=(d>>4)&15,rd=(d)&15;
 		if (disassemble)	dasm(pc-4,"AND.L","%s,%s",getRegName32(rs),getRegName32(rd));
@@ -1129,14 +1379,14 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_incb(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_incb(uint8 op,uint8 b,uint32 pc)
 	{
 		int r=b&0xf;
 		if (disassemble) dasm(pc-2,"INC.B","%s",getRegName8(r));
 		if (execute) {int v = reg8(r)+1; ccrflags_val(v); ccrflags_set(ccr_v, (~reg8(r) & v) & 0x80); reg8(r) = v;}
 		return pc;
 	}
-	uint8 *handle_decb(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_decb(uint8 op,uint8 b,uint32 pc)
 	{
 		int r=b&0xf;
 		if (disassemble) dasm(pc-2,"DEC.B","%s",getRegName8(r));
@@ -1144,14 +1394,14 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_incwi(uint8 op,uint8 b,uint8 *pc,int imm)
+	uint32 handle_incwi(uint8 op,uint8 b,uint32 pc,int imm)
 	{
 		int r=b&0xf;
 		if (disassemble) dasm(pc-2,"INC.W","#%d,%s",imm,getRegName16(r));
 		if (execute) {int v = reg16(r)+imm; ccrflags_val(v); ccrflags_set(ccr_v, (~reg16(r) & v) & 0x8000); reg16(r) = v;}
 		return pc;
 	}
-	uint8 *handle_decwi(uint8 op,uint8 b,uint8 *pc,int imm)
+	uint32 handle_decwi(uint8 op,uint8 b,uint32 pc,int imm)
 	{
 		int r=b&0xf;
 		if (disassemble) dasm(pc-2,"DEC.W","#%d,%s",imm,getRegName16(r));
@@ -1159,7 +1409,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_incli(uint8 op,uint8 b,uint8 *pc,int imm)
+	uint32 handle_incli(uint8 op,uint8 b,uint32 pc,int imm)
 	{
 		if (b&0x8) return fail(pc-2);
 		int r=b&0xf;
@@ -1167,7 +1417,7 @@ protected:
 		if (execute) {int v = reg32(r)+imm; ccrflags_val(v); ccrflags_set(ccr_v, (~reg32(r) & v) & 0x80000000); reg32(r) = v;}
 		return pc;
 	}
-	uint8 *handle_decli(uint8 op,uint8 b,uint8 *pc,int imm)
+	uint32 handle_decli(uint8 op,uint8 b,uint32 pc,int imm)
 	{
 		if (b&0x8) return fail(pc-2);
 		int r=b&0xf;
@@ -1177,7 +1427,7 @@ protected:
 
 	}
 	
-	uint8 *handle_addr(uint8 op,uint8 *pc)
+	uint32 handle_addr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"ADD.B","%s,%s",getRegName8(rs),getRegName8(rd));
@@ -1185,7 +1435,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_addxr(uint8 op,uint8 *pc)
+	uint32 handle_addxr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"ADDX.B","%s,%s",getRegName8(rs),getRegName8(rd));
@@ -1193,7 +1443,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_addrw(uint8 op,uint8 *pc)
+	uint32 handle_addrw(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"ADD.W","%s,%s",getRegName16(rs),getRegName16(rd));
@@ -1201,7 +1451,7 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_addsi(uint8 op,uint8 b,uint8 *pc,int imm)
+	uint32 handle_addsi(uint8 op,uint8 b,uint32 pc,int imm)
 	{
 		if (b&0x8) return fail(pc-2);
 		int rd=(b&7);
@@ -1210,7 +1460,7 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_subsi(uint8 op,uint8 b,uint8 *pc,int imm)
+	uint32 handle_subsi(uint8 op,uint8 b,uint32 pc,int imm)
 	{
 		if (b&0x8) return fail(pc-2);
 		int rd=(b&7);
@@ -1219,7 +1469,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_addl(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_addl(uint8 op,uint8 b,uint32 pc)
 	{
 		if (b&0x8) return fail(pc-2);
 		int rs=(b>>4)&7,rd=(b&7);
@@ -1228,7 +1478,7 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_subr(uint8 op,uint8 *pc)
+	uint32 handle_subr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"SUB.B","%s,%s",getRegName8(rs),getRegName8(rd));
@@ -1236,7 +1486,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_subxr(uint8 op,uint8 *pc)
+	uint32 handle_subxr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"SUBX.B","%s,%s",getRegName8(rs),getRegName8(rd));
@@ -1244,14 +1494,14 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_subrw(uint8 op,uint8 *pc)
+	uint32 handle_subrw(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"SUB.W","%s,%s",getRegName16(rs),getRegName16(rd));
 		if (execute) reg16(rd)=sub16(reg16(rd),reg16(rs));
 		return pc;
 	}
-	uint8 *handle_subl(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_subl(uint8 op,uint8 b,uint32 pc)
 	{
 		if (b&8) return fail(pc-2);
 		int rd=b&7,rs=(b>>4)&7;
@@ -1259,7 +1509,7 @@ protected:
 		if (execute)		reg32(rd)=sub32(reg32(rd),reg32(rs));
 		return pc;
 	}
-	uint8 *handle_cmpl(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_cmpl(uint8 op,uint8 b,uint32 pc)
 	{
 		if (b&8) return fail(pc-2);
 		int rd=b&7,rs=(b>>4)&7;
@@ -1268,14 +1518,14 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_cmpr(uint8 op,uint8 *pc)
+	uint32 handle_cmpr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"CMP.B","%s,%s",getRegName8(rs),getRegName8(rd));
 		if (execute) sub8(reg8(rd),reg8(rs));
 		return pc;
 	}
-	uint8 *handle_cmprw(uint8 op,uint8 *pc)
+	uint32 handle_cmprw(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"CMP.W","%s,%s",getRegName16(rs),getRegName16(rd));
@@ -1283,21 +1533,21 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_mulxu(uint8 op,uint8 *pc)
+	uint32 handle_mulxu(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"MULXU.B","%s,%s",getRegName8(rs),getRegName16(rd));
 		if (execute) {int a=(reg8(rs)&255),b=(reg16(rd)&255);int16 &d=reg16(rd);d=a*b; clockI(12);}
 		return pc;
 	}
-	uint8 *handle_mulxs(uint8 d,uint8 *pc)
+	uint32 handle_mulxs(uint8 d,uint32 pc)
 	{
 		int rs=(d>>4)&15,rd=(d)&15;
 		if (disassemble)	dasm(pc-4,"MULXS.B","%s,%s",getRegName8(rs),getRegName16(rd));
 		if (execute) {int a=reg8(rs),b=se8(reg16(rd));int16 &d=reg16(rd);d=a*b;ccrflags_set(ccr_n,d<0);ccrflags_set(ccr_z,!d); clockI(12);}
 		return pc;
 	}
-	uint8 *handle_divxu(uint8 op,uint8 *pc)
+	uint32 handle_divxu(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (rd&8) printf("UNDEFINED BEHAVIOUR. Attempting to divide E register\n");
@@ -1314,7 +1564,7 @@ protected:
 		}
 		return pc;
 	}
-	uint8 *handle_divxs(uint8 d,uint8 *pc)
+	uint32 handle_divxs(uint8 d,uint32 pc)
 	{
 		int rs=(d>>4)&15,rd=(d)&15;
 		if (rd&8) printf("UNDEFINED BEHAVIOUR. Attempting to divide E register\n");
@@ -1333,7 +1583,7 @@ protected:
 		return pc;
 	}
 		
-	uint8 *handle_mulxuw(uint8 op,uint8 *pc)
+	uint32 handle_mulxuw(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (rd&8) return fail(pc-2);
@@ -1341,7 +1591,7 @@ protected:
 		if (execute) {uint32 a=(reg16(rs)&65535),b=(reg32(rd)&65535);reg32(rd)=a*b; clockI(20);}
 		return pc;
 	}
-	uint8 *handle_mulxsw(uint8 d,uint8 *pc)
+	uint32 handle_mulxsw(uint8 d,uint32 pc)
 	{
 		int rs=(d>>4)&15,rd=(d)&15;
 		if (rd&8) return fail(pc-4);
@@ -1349,7 +1599,7 @@ protected:
 		if (execute) {int a=reg16(rs),b=se16(reg32(rd));int32 &d=reg32(rd);d=a*b;ccrflags_set(ccr_n,d<0);ccrflags_set(ccr_z,!d); clockI(20);}
 		return pc;
 	}
-	uint8 *handle_divxuw(uint8 op,uint8 *pc)
+	uint32 handle_divxuw(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (rd&8) return fail(pc-2);
@@ -1366,7 +1616,7 @@ protected:
 		}
 		return pc;
 	}
-	uint8 *handle_divxsw(uint8 d,uint8 *pc)
+	uint32 handle_divxsw(uint8 d,uint32 pc)
 	{
 		int rs=(d>>4)&15,rd=(d)&15;
 		if (rd&8) return fail(pc-4);
@@ -1386,7 +1636,7 @@ protected:
 	}
 	
 	//////// Shifts
-	uint8 *handle_shal(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_shal(uint8 op, uint8 b, uint32 pc)
 	{
 		int shift=(b&64)?2:1, size=((b>>4)&3)+1, r=(b&15);	// size=1,2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1410,7 +1660,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_shll(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_shll(uint8 op, uint8 b, uint32 pc)
 	{
 		int shift=(b&64)?2:1, size=((b>>4)&3)+1, r=(b&15);	// size=1,2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1430,7 +1680,7 @@ protected:
 		if (size==1) reg8(r)=v&0xff; else if (size==2) reg16(r)=v&0xffff; else if (size==4) reg32(r)=v;
 		return pc;
 	}
-	uint8 *handle_shar(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_shar(uint8 op, uint8 b, uint32 pc)
 	{
 		int shift=(b&64)?2:1, size=((b>>4)&3)+1, r=(b&15);	// size=1,2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1450,7 +1700,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_shlr(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_shlr(uint8 op, uint8 b, uint32 pc)
 	{
 		int shift=(b&64)?2:1, size=((b>>4)&3)+1, r=(b&15);	// size=1,2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1470,7 +1720,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_rotl(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_rotl(uint8 op, uint8 b, uint32 pc)
 	{
 		int shift=(b&64)?2:1, size=((b>>4)&3)+1, r=(b&15);	// size=1,2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1491,7 +1741,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_rotxl(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_rotxl(uint8 op, uint8 b, uint32 pc)
 	{
 		int shift=(b&64)?2:1, size=((b>>4)&3)+1, r=(b&15);	// size=1,2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1514,7 +1764,7 @@ protected:
 		if (size==1) reg8(r)=v&0xff; else if (size==2) reg16(r)=v&0xffff; else if (size==4) reg32(r)=v;
 		return pc;
 	}
-	uint8 *handle_rotr(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_rotr(uint8 op, uint8 b, uint32 pc)
 	{
 		int shift=(b&64)?2:1, size=((b>>4)&3)+1, r=(b&15);	// size=1,2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1536,7 +1786,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_rotxr(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_rotxr(uint8 op, uint8 b, uint32 pc)
 	{
 		int shift=(b&64)?2:1, size=((b>>4)&3)+1, r=(b&15);	// size=1,2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1562,14 +1812,14 @@ protected:
 	}
 	
 	//////// BITWISE OPS
-	uint8 *handle_bsetr(uint8 op,uint8 *pc)
+	uint32 handle_bsetr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"BSET","%s,%s",getRegName8(rs),getRegName8(rd));
 		if (execute)		reg8(rd)|=1<<(reg8(rs)&7);
 		return pc;
 	}
-	uint8 *handle_bseti(uint8 op,uint8 *pc)
+	uint32 handle_bseti(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int imm=(regs>>4)&15,rd=(regs)&15;
 		if (imm&8) return fail(pc-2);
@@ -1578,14 +1828,14 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_bnotr(uint8 op,uint8 *pc)
+	uint32 handle_bnotr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"BNOT","%s,%s",getRegName8(rs),getRegName8(rd));
 		if (execute)		reg8(rd)^=1<<(reg8(rs)&7);
 		return pc;
 	}
-	uint8 *handle_bnoti(uint8 op,uint8 *pc)
+	uint32 handle_bnoti(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int imm=(regs>>4)&15,rd=(regs)&15;
 		if (imm&8) return fail(pc-2);
@@ -1594,14 +1844,14 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_bclrr(uint8 op,uint8 *pc)
+	uint32 handle_bclrr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"BCLR","%s,%s",getRegName8(rs),getRegName8(rd));
 		if (execute)		reg8(rd)&=~(1<<(reg8(rs)&7));
 		return pc;
 	}
-	uint8 *handle_bclri(uint8 op,uint8 *pc)
+	uint32 handle_bclri(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int imm=(regs>>4)&15,rd=(regs)&15;
 		if (imm&8) return fail(pc-2);
@@ -1610,14 +1860,14 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_btstr(uint8 op,uint8 *pc)
+	uint32 handle_btstr(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int rs=(regs>>4)&15,rd=(regs)&15;
 		if (disassemble)	dasm(pc-2,"BTST","%s,%s",getRegName8(rs),getRegName8(rd));
 		if (execute)		ccrflags_set(ccr_z,!(reg8(rd)&(1<<(reg8(rs)&7))));
 		return pc;
 	}
-	uint8 *handle_btsti(uint8 op,uint8 *pc)
+	uint32 handle_btsti(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int imm=(regs>>4)&15,rd=(regs)&15;
 		if (imm&8) return fail(pc-2);
@@ -1626,7 +1876,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_bsti(uint8 op,uint8 *pc)
+	uint32 handle_bsti(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int imm=(regs>>4)&7,rd=(regs)&15,n=(regs>>7)&1;
 		if (disassemble)	dasm(pc-2,n?"BIST":"BST","#%d,%s",imm,getRegName8(rd));
@@ -1634,28 +1884,28 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_bor(uint8 op,uint8 *pc)
+	uint32 handle_bor(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int imm=(regs>>4)&7,rd=(regs)&15,n=(regs>>7)&1;
 		if (disassemble)	dasm(pc-2,n?"BIOR":"BOR","#%d,%s",imm,getRegName8(rd));
 		if (execute)		ccrflags_set(ccr_c,(ccr&1) | (((reg8(rd)>>imm)&1)^n));
 		return pc;
 	}
-	uint8 *handle_bxor(uint8 op,uint8 *pc)
+	uint32 handle_bxor(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int imm=(regs>>4)&7,rd=(regs)&15,n=(regs>>7)&1;
 		if (disassemble)	dasm(pc-2,n?"BIXOR":"BXOR","#%d,%s",imm,getRegName8(rd));
 		if (execute)		ccrflags_set(ccr_c,(ccr&1) ^ (((reg8(rd)>>imm)&1)^n));
 		return pc;
 	}
-	uint8 *handle_band(uint8 op,uint8 *pc)
+	uint32 handle_band(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int imm=(regs>>4)&7,rd=(regs)&15,n=(regs>>7)&1;
 		if (disassemble)	dasm(pc-2,n?"BIAND":"BAND","#%d,%s",imm,getRegName8(rd));
 		if (execute)		ccrflags_set(ccr_c,(ccr&1) & (((reg8(rd)>>imm)&1)^n));
 		return pc;
 	}
-	uint8 *handle_bld(uint8 op,uint8 *pc)
+	uint32 handle_bld(uint8 op,uint32 pc)
 	{
 		int regs=read8(pc);pc++;	int imm=(regs>>4)&7,rd=(regs)&15,n=(regs>>7)&1;
 		if (disassemble)	dasm(pc-2,n?"BILD":"BLD","#%d,%s",imm,getRegName8(rd));
@@ -1663,7 +1913,7 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_not(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_not(uint8 op, uint8 b, uint32 pc)
 	{
 		int size=((b>>4)&3)+1, r=(b&15);	// size=1,2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1681,7 +1931,7 @@ protected:
 		}
 		return pc;
 	}
-	uint8 *handle_neg(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_neg(uint8 op, uint8 b, uint32 pc)
 	{
 		int size=((b>>4)&3)+1, r=(b&15);	// size=1,2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1699,7 +1949,7 @@ protected:
 		}
 		return pc;
 	}
-	uint8 *handle_extu(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_extu(uint8 op, uint8 b, uint32 pc)
 	{
 		int size=((b>>4)&3)+1, r=(b&15);	// size=2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1715,7 +1965,7 @@ protected:
 		}
 		return pc;
 	}
-	uint8 *handle_exts(uint8 op, uint8 b, uint8 *pc)
+	uint32 handle_exts(uint8 op, uint8 b, uint32 pc)
 	{
 		int size=((b>>4)&3)+1, r=(b&15);	// size=2,4
 		if (size==4 && (r&8)) return fail(pc-2);
@@ -1732,7 +1982,7 @@ protected:
 		return pc;
 	}
 	
-	uint8 *inner_bitstuff_aa(int c,int d,int aa,int type,uint8 *startpc,uint8 *pc)
+	uint32 inner_bitstuff_aa(int c,int d,int aa,int type,uint32 startpc,uint32 pc)
 	{
 		int rn=(d>>4),imm=(d>>4)&7,inv=(d&0x80)?1:0;	// Only some of these are valid/used depending on op.
 
@@ -1807,7 +2057,7 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_bitstuff_1(uint8 op,uint8 *pc)	// to get here, op==0x7c, 0x7d, 0x7e, 0x7f
+	uint32 handle_bitstuff_1(uint8 op,uint32 pc)	// to get here, op==0x7c, 0x7d, 0x7e, 0x7f
 	{
 		int b=read8(pc);pc++;
 		int c=read8(pc);pc++;
@@ -1895,9 +2145,9 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_bitstuff_2(uint8 op,uint8 b,uint8 *pc)	// op=6a, b=0x1? or 0x3?
+	uint32 handle_bitstuff_2(uint8 op,uint8 b,uint32 pc)	// op=6a, b=0x1? or 0x3?
 	{
-		uint8 *startpc=pc-2;
+		uint32 startpc=pc-2;
 		int aa=0;
 		if ((b&0xf0)==0x10)	{aa=se16(read16(pc));pc+=2;} else {aa=read32(pc);pc+=4;};
 		int c=read8(pc);pc++;
@@ -1906,56 +2156,56 @@ protected:
 	}
 
 	//////// IMMEDIATE OPS
-	uint8 *handle_cmpi(uint8 op,uint8 *pc)
+	uint32 handle_cmpi(uint8 op,uint32 pc)
 	{
 		int rd=op&15,imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"CMP.B","#0x%x,%s",imm,getRegName8(rd));
 		if (execute) sub8(reg8(rd),imm);
 		return pc;
 	}
-	uint8 *handle_addi(uint8 op,uint8 *pc)
+	uint32 handle_addi(uint8 op,uint32 pc)
 	{
 		int rd=op&15,imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"ADD.B","#0x%x,%s",imm,getRegName8(rd));
 		if (execute) reg8(rd)=add8(reg8(rd),imm);
 		return pc;
 	}
-	uint8 *handle_addxi(uint8 op,uint8 *pc)
+	uint32 handle_addxi(uint8 op,uint32 pc)
 	{
 		int rd=op&15,imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"ADDX.B","#0x%x,%s",imm,getRegName8(rd));
 		if (execute) reg8(rd)=add8(reg8(rd),imm,ccr,1);
 		return pc;
 	}
-	uint8 *handle_subxi(uint8 op,uint8 *pc)
+	uint32 handle_subxi(uint8 op,uint32 pc)
 	{
 		int rd=op&15,imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"SUBX.B","#0x%x,%s",imm,getRegName8(rd));
 		if (execute) reg8(rd)=sub8(reg8(rd),imm,ccr,1);
 		return pc;
 	}
-	uint8 *handle_ori(uint8 op,uint8 *pc)
+	uint32 handle_ori(uint8 op,uint32 pc)
 	{
 		int rd=op&15,imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"OR.B","#0x%x,%s",imm,getRegName8(rd));
 		if (execute) {int8 &r=reg8(rd);	r|=imm;	ccrflags_val(r);}
 		return pc;
 	}
-	uint8 *handle_xori(uint8 op,uint8 *pc)
+	uint32 handle_xori(uint8 op,uint32 pc)
 	{
 		int rd=op&15,imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"XOR.B","#0x%x,%s",imm,getRegName8(rd));
 		if (execute) {int8 &r=reg8(rd);	r^=imm;	ccrflags_val(r);}
 		return pc;
 	}
-	uint8 *handle_andi(uint8 op,uint8 *pc)
+	uint32 handle_andi(uint8 op,uint32 pc)
 	{
 		int rd=op&15,imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"AND.B","#0x%x,%s",imm,getRegName8(rd));
 		if (execute) {int8 &r=reg8(rd);	r&=imm;	ccrflags_val(r);}
 		return pc;
 	}
-	uint8 *handle_movbi(uint8 op,uint8 *pc)
+	uint32 handle_movbi(uint8 op,uint32 pc)
 	{
 		int rd=op&15,imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"MOV.B","#0x%x,%s",imm,getRegName8(rd));
@@ -1963,49 +2213,49 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_cmpwi(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_cmpwi(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read16(pc);pc+=2;
 		if (disassemble) dasm(pc-4,"CMP.W","#0x%x,%s",imm,getRegName16(rd));
 		if (execute) sub16(reg16(rd),imm);
 		return pc;
 	}
-	uint8 *handle_addwi(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_addwi(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read16(pc);pc+=2;
 		if (disassemble) dasm(pc-4,"ADD.W","#0x%x,%s",imm,getRegName16(rd));
 		if (execute) reg16(rd)=add16(reg16(rd),imm);
 		return pc;
 	}
-	uint8 *handle_subwi(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_subwi(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read16(pc);pc+=2;
 		if (disassemble) dasm(pc-4,"SUB.W","#0x%x,%s",imm,getRegName16(rd));
 		if (execute) reg16(rd)=sub16(reg16(rd),imm);
 		return pc;
 	}
-	uint8 *handle_orwi(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_orwi(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read16(pc);pc+=2;
 		if (disassemble) dasm(pc-4,"OR.W","#0x%x,%s",imm,getRegName16(rd));
 		if (execute) {int16 &r=reg16(rd);	r|=imm;	ccrflags_val(r);}
 		return pc;
 	}
-	uint8 *handle_xorwi(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_xorwi(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read16(pc);pc+=2;
 		if (disassemble) dasm(pc-4,"XOR.W","#0x%x,%s",imm,getRegName16(rd));
 		if (execute) {int16 &r=reg16(rd);	r^=imm;	ccrflags_val(r);}
 		return pc;
 	}
-	uint8 *handle_andwi(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_andwi(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read16(pc)&0xffff;pc+=2;
 		if (disassemble) dasm(pc-4,"AND.W","#0x%x,%s",imm,getRegName16(rd));
 		if (execute) {int16 &r=reg16(rd);	r&=imm;	ccrflags_val(r);}
 		return pc;
 	}
-	uint8 *handle_movwi(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_movwi(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read16(pc)&0xffff;pc+=2;
 		if (disassemble) dasm(pc-4,"MOV.W","#0x%x,%s",imm,getRegName16(rd));
@@ -2013,49 +2263,49 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_cmpli(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_cmpli(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read32(pc);pc+=4;if (rd&8) return fail(pc-6);
 		if (disassemble) dasm(pc-6,"CMP.L","#0x%x,%s",imm,getRegName32(rd));
 		if (execute) sub32(reg32(rd),imm);
 		return pc;
 	}
-	uint8 *handle_addli(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_addli(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read32(pc);pc+=4;if (rd&8) return fail(pc-6);
 		if (disassemble) dasm(pc-6,"ADD.L","#0x%x,%s",imm,getRegName32(rd));
 		if (execute) reg32(rd)=add32(reg32(rd),imm);
 		return pc;
 	}
-	uint8 *handle_subli(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_subli(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read32(pc);pc+=4;if (rd&8) return fail(pc-6);
 		if (disassemble) dasm(pc-6,"SUB.L","#0x%x,%s",imm,getRegName32(rd));
 		if (execute) reg32(rd)=sub32(reg32(rd),imm);
 		return pc;
 	}
-	uint8 *handle_orli(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_orli(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read32(pc);pc+=4;if (rd&8) return fail(pc-6);
 		if (disassemble) dasm(pc-6,"OR.L","#0x%x,%s",imm,getRegName32(rd));
 		if (execute) {int32 &r=reg32(rd);	r|=imm;	ccrflags_val(r); }
 		return pc;
 	}
-	uint8 *handle_xorli(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_xorli(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read32(pc);pc+=4;if (rd&8) return fail(pc-6);
 		if (disassemble) dasm(pc-6,"XOR.L","#0x%x,%s",imm,getRegName32(rd));
 		if (execute) {int32 &r=reg32(rd);	r^=imm;	ccrflags_val(r); }
 		return pc;
 	}
-	uint8 *handle_andli(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_andli(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read32(pc);pc+=4;if (rd&8) return fail(pc-6);
 		if (disassemble) dasm(pc-6,"AND.L","#0x%x,%s",imm,getRegName32(rd));
 		if (execute) {int32 &r=reg32(rd);	r&=imm;	ccrflags_val(r); }
 		return pc;
 	}
-	uint8 *handle_movli(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_movli(uint8 op,uint8 b,uint32 pc)
 	{
 		int rd=b&15,imm=read32(pc);pc+=4;if (rd&8) return fail(pc-6);
 		if (disassemble) dasm(pc-6,"MOV.L","#0x%08x,%s",imm,getRegName32(rd));
@@ -2064,7 +2314,7 @@ protected:
 	}
 		
 	
-	uint8 *handle_daa(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_daa(uint8 op,uint8 b,uint32 pc)
 	{
 		int r=b&0xf;
 		if (disassemble) dasm(pc-2,"DAA","%s",getRegName8(r));
@@ -2078,7 +2328,7 @@ protected:
 		if (toadd>6) ccrflags_set(ccr_c,1);
 		return pc;
 	}
-	uint8 *handle_das(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_das(uint8 op,uint8 b,uint32 pc)
 	{
 		int r=b&0xf;
 		if (disassemble) dasm(pc-2,"DAS","%s",getRegName8(r));
@@ -2092,7 +2342,7 @@ protected:
 	}
 
 	///////// CCR OPS
-	uint8 *handle_stcr(uint8 op,uint8 *pc)
+	uint32 handle_stcr(uint8 op,uint32 pc)
 	{
 		int rd=read8(pc);pc++;
 		if ((rd>>4)>1) return fail(pc-2);
@@ -2100,7 +2350,7 @@ protected:
 		if (execute) {int8 &r=reg8(rd);	r=(rd&0xf0)?exr:ccr;}
 		return pc;
 	}
-	uint8 *handle_ldcr(uint8 op,uint8 *pc)
+	uint32 handle_ldcr(uint8 op,uint32 pc)
 	{
 		int rd=read8(pc);pc++;
 		if ((rd>>4)>1) return fail(pc-2);
@@ -2108,28 +2358,28 @@ protected:
 		if (execute) {const int8 &r=reg8(rd);if (rd&0xf0) exr=r; else ccr=r; }
 		return pc;
 	}
-	uint8 *handle_orc(uint8 op,uint8 *pc)
+	uint32 handle_orc(uint8 op,uint32 pc)
 	{
 		int imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"ORC","#0x%02X,CCR",imm&255);
 		if (execute) ccr|=imm;
 		return pc;
 	}
-	uint8 *handle_xorc(uint8 op,uint8 *pc)
+	uint32 handle_xorc(uint8 op,uint32 pc)
 	{
 		int imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"XORC","#0x%02X,CCR",imm&255);
 		if (execute) ccr^=imm;
 		return pc;
 	}
-	uint8 *handle_andc(uint8 op,uint8 *pc)
+	uint32 handle_andc(uint8 op,uint32 pc)
 	{
 		int imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"ANDC","#0x%02X,CCR",imm&255);
 		if (execute) ccr&=imm;
 		return pc;
 	}
-	uint8 *handle_ldci(uint8 op,uint8 *pc)
+	uint32 handle_ldci(uint8 op,uint32 pc)
 	{
 		int imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"LDC","#0x%02X,CCR",imm&255);
@@ -2138,7 +2388,7 @@ protected:
 	}
 	
 	//////// BCC
-	uint8 *inner_bcc(uint8 *startpc,uint8 *pc,int cc,int imm)
+	uint32 inner_bcc(uint32 startpc,uint32 pc,int cc,int imm)
 	{
 		const char *ccs[16]={"BRA","BRN","BHI","BLS","BCC","BCS","BNE","BEQ","BVC","BVS","BPL","BMI","BGE","BLT","BGT","BLE"};
 		if (disassemble) dasm(startpc,ccs[cc],"%s",printAddr(addr(pc+imm)));
@@ -2161,12 +2411,12 @@ protected:
 		if (test==(cc&1)) pc+=imm;	// if it matches, we're set.
 		return pc;
 	}
-	uint8 *handle_bcc(uint8 op,uint8 *pc)
+	uint32 handle_bcc(uint8 op,uint32 pc)
 	{
 		int cc=op&15,imm=read8(pc);pc++;
 		return inner_bcc(pc-2,pc,cc,imm);
 	}
-	uint8 *handle_bccw(uint8 op,uint8 *pc)
+	uint32 handle_bccw(uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		if (b&0xf) return fail(pc-2);
@@ -2176,7 +2426,7 @@ protected:
 	}
 
 	
-	uint8 *handle_rts(uint8 op,uint8 *pc)
+	uint32 handle_rts(uint8 op,uint32 pc)
 	{
 		int test=read8(pc);pc++;
 		if (test!=0x70) return fail(pc-2);
@@ -2185,7 +2435,7 @@ protected:
 		return pc;
 	}
 
-	uint8 *handle_rte(uint8 op,uint8 *pc)
+	uint32 handle_rte(uint8 op,uint32 pc)
 	{
 		int test=read8(pc);pc++;
 		if (test!=0x70) return fail(pc-2);
@@ -2194,7 +2444,7 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_bsr(uint8 op,uint8 *pc)
+	uint32 handle_bsr(uint8 op,uint32 pc)
 	{
 		int imm=read8(pc);pc++;
 		if (disassemble) dasm(pc-2,"BSR","%s",printAddr(addr(pc+imm)));
@@ -2204,7 +2454,7 @@ protected:
 		return pc+imm;
 	}
 
-	uint8 *handle_bsrw(uint8 op,uint8 *pc)
+	uint32 handle_bsrw(uint8 op,uint32 pc)
 	{
 		int imm=read8(pc);pc++;
 		if (imm) return fail(pc-2);
@@ -2217,7 +2467,7 @@ protected:
 		return pc+imm;
 	}
 	
-	uint8 *handle_trapa(uint8 op,uint8 *pc)
+	uint32 handle_trapa(uint8 op,uint32 pc)
 	{
 		int imm=read8(pc);pc++;
 		if (imm&0xCF) return fail(pc-2);
@@ -2232,22 +2482,22 @@ protected:
 		return loadPCFrom(32+(imm>>2));	// Offset for TRAP calls is 0x20 + 4 * trap number.
 	}
 	
-	uint8 *handle_jmpae(uint8 op,uint8 *pc)
+	uint32 handle_jmpae(uint8 op,uint32 pc)
 	{
 		int er=read8(pc);pc++;
 		if (er&0x8f) return fail(pc-2);
 		if (disassemble) dasm(pc-2,"JMP","@%s",getRegName32(er>>4));
-		if (execute) return (reg32(er>>4)&0xffffff)+memory;
+		if (execute) return (reg32(er>>4)&0xffffff);
 		return pc;
 	}
-	uint8 *handle_jmpimm(uint8 op,uint8 *pc)
+	uint32 handle_jmpimm(uint8 op,uint32 pc)
 	{
 		int addr=(read16(pc) << 8) | (read8(pc+2) & 0xff);pc+=3;
 		if (disassemble) dasm(pc-4,"JMP","%s",printAddr(addr));
-		if (execute) {clockI(2); return memory+addr;}
+		if (execute) {clockI(2); return addr;}
 		return pc;
 	}
-	uint8 *handle_jmpaa(uint8 op,uint8 *pc)
+	uint32 handle_jmpaa(uint8 op,uint32 pc)
 	{
 		int imm=(read8(pc))&255;pc++;
 		if (disassemble) dasm(pc-2,"JMP","@@0x%02x",imm);
@@ -2256,7 +2506,7 @@ protected:
 		return loadPCFrom(imm&~1);	// MASK THIS OFF! It's valid, but ignored.
 	}
 
-	uint8 *handle_jsrae(uint8 op,uint8 *pc)
+	uint32 handle_jsrae(uint8 op,uint32 pc)
 	{
 		int er=read8(pc);pc++;
 		if (er&0x8f) return fail(pc-2);
@@ -2264,9 +2514,9 @@ protected:
 		if (!execute) return pc;
 		pushPC(pc);
 		indent++;
-		return (reg32(er>>4)&0xffffff)+memory;
+		return (reg32(er>>4)&0xffffff);
 	}
-	uint8 *handle_jsrimm(uint8 op,uint8 *pc)
+	uint32 handle_jsrimm(uint8 op,uint32 pc)
 	{
 		int addr=(read16(pc) << 8) | (read8(pc+2) & 0xff);pc+=3;
 		if (disassemble) dasm(pc-4,"JSR","%s",printAddr(addr));
@@ -2274,9 +2524,9 @@ protected:
 		pushPC(pc);
 		indent++;
 		clockI(2);
-		return memory+addr;
+		return addr;
 	}
-	uint8 *handle_jsraa(uint8 op,uint8 *pc)
+	uint32 handle_jsraa(uint8 op,uint32 pc)
 	{
 		int imm=(read8(pc))&255;pc++;
 		if (disassemble) dasm(pc-2,"JSR","@@0x%02x",imm);
@@ -2287,7 +2537,7 @@ protected:
 	}
 
 	
-	uint8 *handle_eepmov(uint8 op,uint8 *pc)
+	uint32 handle_eepmov(uint8 op,uint32 pc)
 	{
 		int r=read8(pc);pc++;int w=0;
 		if (r==0x5c) w=0; else if (r==0xd4) w=1; else return fail(pc-2);
@@ -2309,7 +2559,7 @@ protected:
 	}
 	
 	//////// NOP
-	uint8 *handle_nop(uint8 op,uint8 *pc)
+	uint32 handle_nop(uint8 op,uint32 pc)
 	{
 		int b=read8(pc);pc++;
 		if (b) return fail(pc-2);
@@ -2317,7 +2567,7 @@ protected:
 		return pc;
 	}
 	
-	uint8 *handle_sleep(uint8 op,uint8 b,uint8 *pc)
+	uint32 handle_sleep(uint8 op,uint8 b,uint32 pc)
 	{
 		if (disassemble) dasm(pc-2,"SLEEP","");
 		if (execute) pc-=2;
@@ -2325,7 +2575,7 @@ protected:
 	}
 
 	//////// END OF OPS
-	void dasm(uint8 *pc,const char *op,const char *params,...)
+	void dasm(uint32 pc,const char *op,const char *params,...)
 	{
 		if(!g_dasm)
 			return;
@@ -1,7 +1,9 @@
 #pragma once
 #include "h8s.hpp"
+#include <algorithm>
 #include <functional>
 #include <queue>
+#include <vector>
 
 // CatchAll logs unconditionally to alert you to bad read/writes.
 class CatchAllDevice : public H8SDevice
@@ -20,16 +22,15 @@ public:
 	void tick_extclock(int which) {
 		channels[which].gra++;
 	}
-	void tick()
+	void tick() {tick(state->cycles);}
+	void tick(unsigned long long _cycles)
 	{
 		for (int i = 0; i < 5; i++)
 		{
-			if (!(tstr & (1 << i))) continue;	// skip halted channels
-			if (tmdr & (1 << i)) continue;		// skip pwm channels
+			if (!isCounting(i)) continue;
 			class channel& c = channels[i];
-			if (c.tcr & 4) continue;			// skip externally clocked channels
 			int shift = (c.tcr & 3);
-			unsigned int inc = (unsigned int)((state->cycles >> shift) - (lastCycles >> shift));	// how many cycles have passed?
+			unsigned int inc = (unsigned int)((_cycles >> shift) - (lastCycles >> shift));	// how many cycles have passed?
 			for (int j = 0; j < inc; j++)
 			{
 				uint16 nt = c.tcnt + 1;
@@ -53,10 +54,28 @@ public:
 				c.tcnt = nt;
 			}
 		}
-		lastCycles = state->cycles;
+		lastCycles = _cycles;
+	}
+	// cycle count at which the next compare match or overflow of any running channel happens
+	unsigned long long getNextEventCycles() const
+	{
+		unsigned long long next = ~0ull;
+		for (int i = 0; i < 5; i++)
+		{
+			if (!isCounting(i)) continue;
+			const class channel& c = channels[i];
+			const int shift = (c.tcr & 3);
+			// number of increments until tcnt hits gra, grb or overflows, whichever comes first
+			unsigned int inc = std::min((uint16)(c.gra - c.tcnt), (uint16)(c.grb - c.tcnt));
+			inc = std::min(inc, (unsigned int)(uint16)(0 - c.tcnt));
+			const unsigned long long t = ((lastCycles >> shift) + inc + 1) << shift;
+			if (t < next) next = t;
+		}
+		return next;
 	}
 	virtual uint8_t read(uint32_t address) {
 		if (address<0xffff60 || address >= 0xffffa0) return 0;
+		sync();
 		address -= 0xffff60;
 		switch (address)
 		{
@@ -94,6 +113,8 @@ public:
 		
 	virtual void write(uint32_t address, uint8_t value) {
 		if (address<0xffff60 || address >= 0xffffa0) return;
+		sync();
+		state->stopRun();
 		address -= 0xffff60;
 		switch (address)
 		{
@@ -128,7 +149,33 @@ public:
 		}
 	}
 
+	void saveState(baseLib::BinaryStream& _s) const
+	{
+		_s.write(lastCycles); _s.write(space);
+		_s.write(tstr); _s.write(tsnc); _s.write(tmdr); _s.write(tfcr);
+		_s.write(channels);
+	}
+	void loadState(baseLib::BinaryStream& _s)
+	{
+		_s.read(lastCycles); _s.read(space);
+		_s.read(tstr); _s.read(tsnc); _s.read(tmdr); _s.read(tfcr);
+		_s.read(channels);
+	}
+
 private:	// 0x9f -> 0x60
+	// when run in batches, counters are only updated at events. Catch up to the start of the accessing instruction
+	void sync()
+	{
+		if (state->getStepCycles() > lastCycles) tick(state->getStepCycles());
+	}
+
+	bool isCounting(int i) const
+	{
+		if (!(tstr & (1 << i))) return false;	// skip halted channels
+		if (tmdr & (1 << i)) return false;		// skip pwm channels
+		return !(channels[i].tcr & 4);			// skip externally clocked channels
+	}
+
 	unsigned long long lastCycles {0};
 	int8 space[64] {};
 	uint8 tstr {0xc0}, tsnc {0xc0}, tmdr {0x80}, tfcr {0xc0};	// timer start, timer sync, timer mode reg, timer function control
@@ -206,6 +253,8 @@ public:
 	}
 	virtual void write(uint32_t address, uint8_t value) {
 		address &= 7;
+		tickTransmit(state->getStepCycles());
+		state->stopRun();
 		switch (address)
 		{
 			case 2:
@@ -233,20 +282,7 @@ public:
 	void provideMIDI(const uint8 *data, size_t len) {for (size_t i = 0; i < len; i++) tosend.push(data[i]);}
 	void tick()
 	{
-		if (txrtimer)
-		{
-			unsigned long long cycles = state->getCycles();
-			int diff = (int)(cycles - lastcycles);
-			lastcycles = cycles;
-			txrtimer -= diff;
-			if (txrtimer <= 0)
-			{
-				txrtimer = clocktime;
-				if (scr & 128) state->interrupt(54 + irqoff);
-				if (scr & 4) state->interrupt(55 + irqoff);
-				ssr |= 128 | 4;
-			}
-		}
+		tickTransmit(state->getCycles());
 		if (!tosend.empty() && !(ssr & 64))
 		{
 			ssr |= 64;
@@ -255,7 +291,47 @@ public:
 			state->interrupt(53 + irqoff);
 		}
 	}
+	// cycle count at which tick() has something to do next. 0 if a received byte is waiting to be delivered
+	unsigned long long getNextEventCycles() const
+	{
+		if (!tosend.empty() && !(ssr & 64)) return 0;
+		if (txrtimer) return lastcycles + txrtimer;
+		return ~0ull;
+	}
+	void saveState(baseLib::BinaryStream& _s) const
+	{
+		std::queue<uint8> q = tosend;
+		std::vector<uint8> pending;
+		for (; !q.empty(); q.pop()) pending.push_back(q.front());
+		_s.write(pending);
+		_s.write(data); _s.write(scr); _s.write(txr); _s.write(rdr); _s.write(ssr);
+		_s.write(lastcycles); _s.write(txrtimer);
+	}
+	void loadState(baseLib::BinaryStream& _s)
+	{
+		std::vector<uint8> pending;
+		_s.read(pending);
+		tosend = {};
+		for (const auto b : pending) tosend.push(b);
+		_s.read(data); _s.read(scr); _s.read(txr); _s.read(rdr); _s.read(ssr);
+		_s.read(lastcycles); _s.read(txrtimer);
+	}
 protected:
+	void tickTransmit(unsigned long long cycles)
+	{
+		if (!txrtimer) return;
+		int diff = (int)(cycles - lastcycles);
+		lastcycles = cycles;
+		txrtimer -= diff;
+		if (txrtimer <= 0)
+		{
+			txrtimer = clocktime;
+			if (scr & 128) state->interrupt(54 + irqoff);
+			if (scr & 4) state->interrupt(55 + irqoff);
+			ssr |= 128 | 4;
+		}
+	}
+
 	static constexpr int clocktime = (16000000 / 31250) * 10;	// 5120 clocks to send a midi byte.
 	std::queue<uint8> tosend;
 	int8 data[8], scr {0}, txr {-1}, rdr {0}, ssr {-128};
@@ -373,6 +449,8 @@ public:
 	HWRegs() {}
 	virtual uint8_t read(uint32_t address) { return data[address&255]; }
 	virtual void write(uint32_t address, uint8_t value) { data[address&255] = value; }
+	void saveState(baseLib::BinaryStream& _s) const { _s.write(data); }
+	void loadState(baseLib::BinaryStream& _s) { _s.read(data); }
 protected:
 	int8 data[256];
 };
@@ -160,7 +160,7 @@ namespace jeJucePlugin
 
 		auto p = std::make_shared<pluginLib::patchDB::Patch>();
 		p->name = *name;
-		p->sysex = std::move(_sysex);
+		p->setSysex(std::move(_sysex));
 		p->program = prog;
 		p->bank = bank;
 
@@ -177,10 +177,10 @@ namespace jeJucePlugin
 	pluginLib::patchDB::Data PatchManager::applyModifications(const pluginLib::patchDB::PatchPtr& _patch, const pluginLib::FileType& _fileType, pluginLib::ExportType _exportType) const
 	{
 		std::vector<pluginLib::SysEx> dumps;
-		synthLib::MidiToSysex::splitMultipleSysex(dumps, _patch->sysex);
+		synthLib::MidiToSysex::splitMultipleSysex(dumps, _patch->getSysex());
 
 		if (dumps.empty())
-			return _patch->sysex;
+			return _patch->getSysex();
 
 		// apply mods to the first dump only, the rest should be identical
 		auto& s = dumps.front();
@@ -189,7 +189,7 @@ namespace jeJucePlugin
 		const auto area = jeLib::State::getAddressArea(addr);
 
 		if (area != jeLib::AddressArea::UserPatch && area != jeLib::AddressArea::UserPerformance)
-			return _patch->sysex;
+			return _patch->getSysex();
 
 		auto bank = _patch->program / 64;
 		const auto program = _patch->program - bank * 64;
@@ -238,7 +238,7 @@ namespace jeJucePlugin
 
 		m_controller.sendLockedParameters(static_cast<uint8_t>(_part));
 
-		const auto area = jeLib::State::getAddressArea(_patch->sysex);
+		const auto area = jeLib::State::getAddressArea(_patch->getSysex());
 
 		if (area == jeLib::AddressArea::UserPerformance)
 		{
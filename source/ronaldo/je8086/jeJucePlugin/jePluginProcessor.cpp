@@ -43,6 +43,8 @@ namespace jeJucePlugin
 		getController();
 		const auto latencyBlocks = getConfig().getIntValue("latencyBlocks", static_cast<int>(getPlugin().getLatencyBlocks()));
 		Processor::setLatencyBlocks(latencyBlocks);
+
+		m_parallelAsics = getConfig().getBoolValue("parallelAsics", false);
 	}
 
 	AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
@@ -70,6 +72,9 @@ namespace jeJucePlugin
 		params.romName = rom.getName();
 		params.homePath = getDataFolder();
 
+		if (m_parallelAsics)
+			params.customData |= 1;
+
 		auto* d = new jeLib::Device(params);
 		if(!d->isValid())
 			throw synthLib::DeviceException(synthLib::DeviceError::FirmwareMissing, errorMsg);
@@ -80,6 +85,9 @@ namespace jeJucePlugin
 	{
 		Processor::getRemoteDeviceParams(_params);
 
+		if (m_parallelAsics)
+			_params.customData |= 1;
+
 		auto rom = jeLib::RomLoader::findROM();
 
 		if (rom.isValid())
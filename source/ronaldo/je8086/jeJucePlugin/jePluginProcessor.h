@@ -25,6 +25,7 @@ namespace jeJucePlugin
     private:
 		std::vector<jeLib::Rom> m_roms;
 		size_t m_selectedRom = 0;
+		bool m_parallelAsics = false;
 
 		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioPluginAudioProcessor)
 	};
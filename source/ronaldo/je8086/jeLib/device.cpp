@@ -2,8 +2,13 @@
 
 #include "je8086.h"
 #include "jeThread.h"
+#include "synthLib/bootSnapshotCache.h"
 #include "synthLib/midiToSysex.h"
 
+#include "baseLib/filesystem.h"
+
+#include "esp/esp_jit_cache.h"
+
 namespace
 {
 	inline float dspWordToFloat(const uint32_t _d)
@@ -22,14 +27,27 @@ namespace jeLib
 	Device::Device(const synthLib::DeviceCreateParams& _params) : synthLib::Device(_params)
 	{
 		const auto ramDataFilename = _params.homePath.empty() ? "ram_dump.bin" : _params.homePath + "/roms/ram_dump.bin";
-		m_je8086.reset(new Je8086(_params.romData, ramDataFilename));
+
+		if (!_params.homePath.empty())
+		{
+			esp::JitCache::instance().setStorageFolder(_params.homePath + "/espjit/");
+			synthLib::BootSnapshotCache::instance().setStorageFolder(_params.homePath + "/bootsnapshots/");
+		}
+
+		const auto romData = _params.getRomData();
+
+		m_je8086.reset(new Je8086(romData, ramDataFilename));
 
 		if (m_je8086->hasDoneFactoryReset())
 		{
 			m_je8086.reset();
-			m_je8086.reset(new Je8086(_params.romData, ramDataFilename));
+			m_je8086.reset(new Je8086(romData, ramDataFilename));
 		}
 
+		m_je8086->setParallelAsics((_params.customData & 1) != 0);
+
+		boot(_params, romData, ramDataFilename);
+
 		m_thread.reset(new JeThread(*m_je8086));
 
 		m_paramChangedListener.set(m_sysexRemote.evParamChanged, [this](const uint8_t _page, const uint8_t _index, const int32_t& _value)
@@ -46,6 +64,46 @@ namespace jeLib
 		createMasterVolumeMessage(m_midiOut);
 	}
 
+	void Device::boot(const synthLib::DeviceCreateParams& _params, const std::vector<uint8_t>& _romData, const std::string& _ramDataFilename)
+	{
+		// everything the boot depends on
+		std::vector<uint8_t> keyData(_romData);
+
+		std::vector<uint8_t> ram;
+		baseLib::filesystem::readFile(ram, _ramDataFilename);
+		keyData.insert(keyData.end(), ram.begin(), ram.end());
+
+		for (const auto c : std::string("JE-8086"))
+			keyData.push_back(static_cast<uint8_t>(c));
+		keyData.push_back(static_cast<uint8_t>(Je8086::StateVersion));
+
+		const synthLib::BootSnapshotCache::Key key(keyData);
+
+		auto& cache = synthLib::BootSnapshotCache::instance();
+
+		synthLib::BootSnapshotCache::Snapshot snapshot;
+
+		if (cache.get(snapshot, key))
+		{
+			if (m_je8086->loadState(snapshot))
+				return;
+
+			// a partially restored instance is unusable, start over with a fresh one
+			cache.remove(key);
+
+			m_je8086.reset();
+			m_je8086.reset(new Je8086(_romData, _ramDataFilename));
+			m_je8086->setParallelAsics((_params.customData & 1) != 0);
+		}
+
+		m_je8086->setBootCallback([this, key]
+		{
+			synthLib::BootSnapshotCache::Snapshot s;
+			m_je8086->saveState(s);
+			synthLib::BootSnapshotCache::instance().add(key, s);
+		});
+	}
+
 	Device::~Device()
 	{
 		m_thread.reset();
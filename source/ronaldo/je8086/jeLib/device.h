@@ -52,6 +52,10 @@ namespace jeLib
 		void processAudio(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, size_t _samples) override;
 		bool sendMidi(const synthLib::SMidiEvent& _ev, std::vector<synthLib::SMidiEvent>& _response) override;
 
+		// restores the state after boot from the boot snapshot cache. If there is none, the firmware boots while
+		// the device is running and the state is added to the cache once the boot has finished
+		void boot(const synthLib::DeviceCreateParams& _params, const std::vector<uint8_t>& _romData, const std::string& _ramDataFilename);
+
 		void onParamChanged(uint8_t _page, uint8_t _index, int32_t _value);
 
 		void createMasterVolumeMessage(std::vector<synthLib::SMidiEvent>& _messages) const;
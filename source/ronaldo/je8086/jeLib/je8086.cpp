@@ -1,5 +1,9 @@
 #include "je8086.h"
 
+#include <algorithm>
+#include <stdexcept>
+
+#include "baseLib/binarystream.h"
 #include "baseLib/filesystem.h"
 
 #include "synthLib/deviceException.h"
@@ -78,22 +82,131 @@ namespace jeLib
 		}
 	}
 
+	namespace
+	{
+		constexpr uint64_t g_midiInStartCycles = 12776184;
+
+		// Convert from uC cycles to DSP steps. (this is (clockrate / 2) / (uc clock = 16000000), simplified)
+		constexpr uint64_t g_dspStepsMul = 1323;
+		constexpr uint64_t g_dspStepsDiv = 625;
+	}
+
 	void Je8086::step()
 	{
-		uint64_t now = emu.getCycles();
+		processMidiIn();
+		emu.step();
+		tickDevices();
+		checkBooted();
+	}
+
+	void Je8086::runForCycles(const uint64_t _cycles)
+	{
+		const auto end = emu.getCycles() + _cycles;
+
+		while (emu.getCycles() < end)
+			runToNextEvent(end);
+	}
+
+	void Je8086::runUntilSamples(const size_t _count)
+	{
+		while (m_sampleBuffer.size() < _count)
+			runToNextEvent(~0ull);
+	}
 
-		if (now > 12776184)// && !((++ctr) & 0x3fff))
+	void Je8086::processMidiIn()
+	{
+		if (emu.getCycles() > g_midiInStartCycles)
 		{
 			for (auto& m : m_midiInEvents)
 				m_midiInRateLimiter.write(std::move(m));
 			m_midiInEvents.clear();
 		}
+	}
 
-		emu.step();
+	void Je8086::tickDevices()
+	{
 		timers.tick();
 		midi.tick();
 
-		asics.runForCycles(emu.getCycles() * 1323 / 625); // Convert from uC cycles to DSP steps. (this is (clockrate / 2) / (uc clock = 16000000), simplified)
+		asics.runForCycles(emu.getCycles() * g_dspStepsMul / g_dspStepsDiv);
+	}
+
+	void Je8086::runToNextEvent(const uint64_t _maxCycles)
+	{
+		processMidiIn();
+		emu.run(std::min(_maxCycles, getNextEventCycles()));
+		tickDevices();
+		checkBooted();
+	}
+
+	uint64_t Je8086::getNextEventCycles() const
+	{
+		uint64_t next = std::min<uint64_t>(timers.getNextEventCycles(), midi.getNextEventCycles());
+
+		// first uC cycle that converts to the DSP step of the next sample
+		next = std::min<uint64_t>(next, (asics.getNextSampleStep() * g_dspStepsDiv + g_dspStepsMul - 1) / g_dspStepsMul);
+
+		if (!m_midiInEvents.empty() && emu.getCycles() <= g_midiInStartCycles)
+			next = std::min<uint64_t>(next, g_midiInStartCycles + 1);
+
+		return next;
+	}
+
+	void Je8086::checkBooted()
+	{
+		if (!m_bootCallback || emu.getCycles() <= g_midiInStartCycles)
+			return;
+
+		const auto callback = std::move(m_bootCallback);
+		m_bootCallback = nullptr;
+		callback();
+	}
+
+	void Je8086::saveState(std::vector<uint8_t>& _state) const
+	{
+		baseLib::BinaryStream s;
+
+		emu.saveState(s);
+		asics.saveState(s);
+		lcd.saveState(s);
+		ports.saveState(s);
+		faders.saveState(s);
+		hwregs.saveState(s);
+		midi.saveState(s);
+		timers.saveState(s);
+		s.write(ctr);
+
+		s.toVector(_state);
+	}
+
+	bool Je8086::loadState(const std::vector<uint8_t>& _state)
+	{
+		try
+		{
+			baseLib::BinaryStream s(_state);
+
+			emu.loadState(s);
+			asics.loadState(s);
+			lcd.loadState(s);
+			ports.loadState(s);
+			faders.loadState(s);
+			hwregs.loadState(s);
+			midi.loadState(s);
+			timers.loadState(s);
+			s.read(ctr);
+		}
+		catch (std::range_error&)
+		{
+			return false;
+		}
+
+		m_sampleBuffer.clear();
+
+		// the LCD does not report changes on load, inform the UI about the restored display contents
+		onLcdDdRamChanged();
+		onLcdCgRamChanged();
+
+		return true;
 	}
 
 	void Je8086::setButton(const devices::SwitchType _type, const bool _pressed)
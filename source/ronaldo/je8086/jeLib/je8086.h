@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include <h8s/h8sdevices.hpp>
 
 #include "je8086devices.h"
@@ -16,6 +18,9 @@ namespace jeLib
 		using SampleFrame = std::pair<int32_t, int32_t>; // left, right
 		using SampleBuffer = std::vector<SampleFrame>;
 
+		// increase whenever the layout of saveState() changes
+		static constexpr uint32_t StateVersion = 1;
+
 		Je8086(const std::vector<uint8_t>& _romData, const std::string& _ramDataFilename);
 		~Je8086() = default;
 
@@ -25,10 +30,26 @@ namespace jeLib
 		const auto& getSampleBuffer() const { return m_sampleBuffer; }
 		void clearSampleBuffer() { m_sampleBuffer.clear(); }
 
+		// executes a single instruction and ticks all devices afterwards
 		void step();
 
+		// execute instruction runs until the next device event instead of ticking all devices after every instruction.
+		// The result is the same as calling step() repeatedly
+		void runForCycles(uint64_t _cycles);
+		void runUntilSamples(size_t _count);
+
 		bool hasDoneFactoryReset() const { return m_factoryreset; }
 
+		// called once on the emulation thread as soon as the firmware has booted and accepts MIDI, before any MIDI is forwarded to it
+		void setBootCallback(std::function<void()> _callback) { m_bootCallback = std::move(_callback); }
+
+		// Emulation state of the uC, ASICs and peripherals. Intended to be restored into a freshly constructed
+		// instance that has been created with the same ROM and RAM data
+		void saveState(std::vector<uint8_t>& _state) const;
+		bool loadState(const std::vector<uint8_t>& _state);
+
+		void setParallelAsics(const bool _parallel) { asics.setParallel(_parallel); }
+
 		void setButton(devices::SwitchType _type, bool _pressed);
 
 	private:
@@ -40,6 +61,12 @@ namespace jeLib
 
 		void runfactoryreset(const std::string& _ramDataFilename);
 
+		void processMidiIn();
+		void tickDevices();
+		void runToNextEvent(uint64_t _maxCycles);
+		uint64_t getNextEventCycles() const;
+		void checkBooted();
+
 		H8SEmulator emu;
 		devices::MultiAsic asics;
 		Lcd lcd;
@@ -59,5 +86,6 @@ namespace jeLib
 		SampleBuffer m_sampleBuffer;
 		synthLib::MidiRateLimiter m_midiInRateLimiter;
 		std::vector<synthLib::SMidiEvent> m_midiOutEvents;
+		std::function<void()> m_bootCallback;
 	};
 }
@@ -1,5 +1,154 @@
 #include "je8086devices.h"
 
+#include <chrono>
+#include <string>
+
+#include "dsp56kBase/threadtools.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 namespace jeLib
 {
+	namespace devices
+	{
+		namespace
+		{
+			// Within a block the next sample is only a few microseconds away, waiting threads spin for a short while
+			// before they go to sleep. In between blocks they sleep and do not take CPU time from anyone else
+			constexpr auto g_spinTime = std::chrono::microseconds(50);
+			constexpr uint32_t g_spinClockInterval = 64;	// pauses between reading the clock
+
+			void pause()
+			{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+				_mm_pause();
+#else
+				std::this_thread::yield();
+#endif
+			}
+
+			// returns false if the condition is not met within the spin time
+			template<typename T> bool spinWait(const T& _condition)
+			{
+				const auto end = std::chrono::steady_clock::now() + g_spinTime;
+
+				for (uint32_t i=1; ; ++i)
+				{
+					if (_condition())
+						return true;
+
+					pause();
+
+					if ((i % g_spinClockInterval) == 0 && std::chrono::steady_clock::now() >= end)
+						return false;
+				}
+			}
+		}
+
+		MultiAsic::MultiAsic()
+		{
+			asic0.opt.setCompileThread(&m_jitThread);
+			asic1.opt.setCompileThread(&m_jitThread);
+			asic2.opt.setCompileThread(&m_jitThread);
+			asic3.opt.setCompileThread(&m_jitThread);
+		}
+
+		MultiAsic::~MultiAsic()
+		{
+			stopWorkers();
+		}
+
+		void MultiAsic::setParallel(const bool _parallel)
+		{
+			if (_parallel == isParallel())
+				return;
+
+			if (!_parallel)
+			{
+				stopWorkers();
+				return;
+			}
+
+			// the workers spin while waiting for the next sample, this is only beneficial if every ASIC has a core of its own
+			if (std::thread::hardware_concurrency() < 4)
+				return;
+
+			m_exitWorkers = false;
+
+			const auto sample = m_sample.load();
+
+			for (uint32_t i=1; i<4; ++i)
+				m_workers.emplace_back([this, i, sample] { workerFunc(i, sample); });
+		}
+
+		void MultiAsic::processAsicsParallel()
+		{
+			m_workersDone.store(0, std::memory_order_relaxed);
+			m_sample.fetch_add(1);
+
+			if (m_sleepingWorkers.load())
+			{
+				std::lock_guard lock(m_workerMutex);
+				m_workerCv.notify_all();
+			}
+
+			processAsic(0);
+
+			const auto workersDone = [this] { return m_workersDone.load(std::memory_order_acquire) >= m_workers.size(); };
+
+			// a worker only takes longer than the spin time if it has been preempted
+			if (!spinWait(workersDone))
+			{
+				while (!workersDone())
+					std::this_thread::yield();
+			}
+		}
+
+		void MultiAsic::workerFunc(const uint32_t _asic, uint32_t _sample)
+		{
+			dsp56k::ThreadTools::setCurrentThreadName("JE8086 ASIC" + std::to_string(_asic));
+			dsp56k::ThreadTools::setCurrentThreadPriority(dsp56k::ThreadPriority::Highest);
+
+			while (waitForSample(_sample))
+			{
+				// the main thread waits for all workers before it starts the next sample
+				++_sample;
+
+				processAsic(_asic);
+
+				m_workersDone.fetch_add(1, std::memory_order_release);
+			}
+		}
+
+		bool MultiAsic::waitForSample(const uint32_t _sample)
+		{
+			if (spinWait([&] { return m_sample.load(std::memory_order_acquire) != _sample; }))
+				return true;
+
+			std::unique_lock lock(m_workerMutex);
+
+			++m_sleepingWorkers;
+			m_workerCv.wait(lock, [&] { return m_exitWorkers || m_sample.load() != _sample; });
+			--m_sleepingWorkers;
+
+			return !m_exitWorkers;
+		}
+
+		void MultiAsic::stopWorkers()
+		{
+			{
+				std::lock_guard lock(m_workerMutex);
+				m_exitWorkers = true;
+			}
+
+			m_workerCv.notify_all();
+
+			for (auto& worker : m_workers)
+				worker.join();
+
+			m_workers.clear();
+		}
+	}
 }
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <h8s/h8s.hpp>
 
 #include "esp/esp.hpp"
@@ -111,6 +117,19 @@ namespace jeLib
 		class MultiAsic : public H8SDevice
 		{
 		public:
+			MultiAsic();
+			MultiAsic(const MultiAsic&) = delete;
+			MultiAsic(MultiAsic&&) = delete;
+			~MultiAsic() override;
+
+			MultiAsic& operator=(const MultiAsic&) = delete;
+			MultiAsic& operator=(MultiAsic&&) = delete;
+
+			// Runs asic1-3 on worker threads while asic0 runs on the calling thread. Within a sample, every ASIC only
+			// consumes what the previous one produced in the previous sample, the output is identical to sequential processing
+			void setParallel(bool _parallel);
+			bool isParallel() const { return !m_workers.empty(); }
+
 			void setPostSample(const std::function<void(int32_t, int32_t)>& _postSample) { postSample = _postSample; }
 
 			void dump() {
@@ -138,6 +157,22 @@ namespace jeLib
 				else asic3.writeuC(_address, _value);
 			}
 			
+			// must not be called while a sample is processed, the workers are idle in between
+			void saveState(baseLib::BinaryStream& _s) const
+			{
+				asic0.saveState(_s); asic1.saveState(_s); asic2.saveState(_s); asic3.saveState(_s);
+				_s.write(lastCycles); _s.write(cyclesResidual); _s.write(cycles_this_sample);
+			}
+
+			void loadState(baseLib::BinaryStream& _s)
+			{
+				asic0.loadState(_s); asic1.loadState(_s); asic2.loadState(_s); asic3.loadState(_s);
+				_s.read(lastCycles); _s.read(cyclesResidual); _s.read(cycles_this_sample);
+			}
+
+			// DSP step count at which runForCycles() produces the next sample
+			uint64_t getNextSampleStep() const { return lastCycles + stepsPerFS - cyclesResidual; }
+
 			void runForCycles(uint64_t cycles) {
 				uint64_t diff = cycles + cyclesResidual - lastCycles;
 				lastCycles = cycles;
@@ -153,15 +188,17 @@ namespace jeLib
 					// for (size_t j = 0; j < (768/2); j++) asic3.step_cores();
 
 					// JIT version
-					asic0.opt.genProgramIfDirty();
-					asic1.opt.genProgramIfDirty();
-					asic2.opt.genProgramIfDirty();
-					asic3.opt.genProgramIfDirty();
-
-					asic0.opt.callOptimized(&asic0);
-					asic1.opt.callOptimized(&asic1);
-					asic2.opt.callOptimized(&asic2);
-					asic3.opt.callOptimized(&asic3);
+					if (isParallel())
+					{
+						processAsicsParallel();
+					}
+					else
+					{
+						processAsic(0);
+						processAsic(1);
+						processAsic(2);
+						processAsic(3);
+					}
 
 					// Last DSP audio output
 					postSample(asic3.readGRAM(0xe8), asic3.readGRAM(0xec));
@@ -181,13 +218,40 @@ namespace jeLib
 				}
 			}
 		protected:
+			void processAsic(const uint32_t _index)
+			{
+				switch (_index)
+				{
+				case 0:	asic0.opt.genProgramIfDirty(); asic0.opt.callOptimized(&asic0); break;
+				case 1:	asic1.opt.genProgramIfDirty(); asic1.opt.callOptimized(&asic1); break;
+				case 2:	asic2.opt.genProgramIfDirty(); asic2.opt.callOptimized(&asic2); break;
+				default:asic3.opt.genProgramIfDirty(); asic3.opt.callOptimized(&asic3); break;
+				}
+			}
+
+			void processAsicsParallel();
+			void workerFunc(uint32_t _asic, uint32_t _sample);
+			bool waitForSample(uint32_t _sample);
+			void stopWorkers();
+
 			ESP<17> asic0;
 			ESP<0> asic1, asic2;
 			ESP<19> asic3; // should really be 18, but it works only with 19
+
+			// compiles ESP programs in the background, declared after the ASICs as it needs to stop before they are destroyed
+			esp::JitThread m_jitThread;
 			enum {stepsPerFS = 384};
 			std::function<void(int32_t, int32_t)> postSample;
 			uint64_t lastCycles = 0, cyclesResidual = 0;
 			uint32_t cycles_this_sample {0};
+
+			std::vector<std::thread> m_workers;
+			std::atomic<uint32_t> m_sample {0};				// incremented to start the workers on the next sample
+			std::atomic<uint32_t> m_workersDone {0};
+			std::atomic<uint32_t> m_sleepingWorkers {0};
+			std::mutex m_workerMutex;
+			std::condition_variable m_workerCv;
+			bool m_exitWorkers = false;
 		};
 
 		class Port : public H8SDevice
@@ -250,6 +314,17 @@ namespace jeLib
 			static int getLedId(const uint32_t _index) {return lits[_index];}
 
 			bool getLed(const uint32_t _i) const { const int w = getLedId(_i); return (leds[w >> 3] & (1 << (w & 7))); }
+
+			void saveState(baseLib::BinaryStream& _s) const
+			{
+				_s.write(data); _s.write(leds); _s.write(latch); _s.write(latchA);
+				_s.write(portAstate); _s.write(portBDDR); _s.write(portBDR);
+			}
+			void loadState(baseLib::BinaryStream& _s)
+			{
+				_s.read(data); _s.read(leds); _s.read(latch); _s.read(latchA);
+				_s.read(portAstate); _s.read(portBDDR); _s.read(portBDR);
+			}
 		protected:
 			static int lits[];
 			static const char* const litnames[66];
@@ -302,6 +377,14 @@ namespace jeLib
 				// e.g. cutoff = VR12, so n = 12 + 15 = 27. See datasheet.
 				values[which] = value;
 			}
+			void saveState(baseLib::BinaryStream& _s) const
+			{
+				_s.write(scanning); _s.write(p6dr); _s.write(adcsr); _s.write(values);
+			}
+			void loadState(baseLib::BinaryStream& _s)
+			{
+				_s.read(scanning); _s.read(p6dr); _s.read(adcsr); _s.read(values);
+			}
 		protected:
 			int8 scanning {0}, p6dr {0}, adcsr {0};
 			int values[64] {};
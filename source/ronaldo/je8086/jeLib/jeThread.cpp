@@ -1,5 +1,7 @@
 #include "jeThread.h"
 
+#include <algorithm>
+
 #include "je8086.h"
 
 #include "dsp56kBase/threadtools.h"
@@ -115,8 +117,13 @@ namespace jeLib
 			_job.midiEvents.clear();
 		}
 
-		for (uint32_t i=0; i<_job.samplesToProcess; ++i)
+		uint32_t remaining = _job.samplesToProcess;
+
+		while (remaining)
 		{
+			// forward all midi events that are due and process as many samples as possible until the next one
+			auto count = remaining;
+
 			for(auto it = m_tempMidiIn.begin(); it != m_tempMidiIn.end();)
 			{
 				auto& e = *it;
@@ -128,17 +135,20 @@ namespace jeLib
 				}
 				else
 				{
+					count = std::min(count, static_cast<uint32_t>(e.first - m_processedSampleOffset));
 					++it;
 				}
 			}
 
-			while (m_je8086.getSampleBuffer().empty())
-				m_je8086.step();
+			m_je8086.runUntilSamples(count);
 
-			m_audioOut.push_back(m_je8086.getSampleBuffer().front());
+			const auto& samples = m_je8086.getSampleBuffer();
+			for (uint32_t i=0; i<count; ++i)
+				m_audioOut.push_back(samples[i]);
 			m_je8086.clearSampleBuffer();
 
-			++m_processedSampleOffset;
+			m_processedSampleOffset += count;
+			remaining -= count;
 
 			m_je8086.readMidiOut(m_tempMidiOut);
 
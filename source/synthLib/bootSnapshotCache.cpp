@@ -0,0 +1,14 @@
+#include "bootSnapshotCache.h"
+
+namespace synthLib
+{
+	BootSnapshotCache::BootSnapshotCache() : DataCache("BSNP", ".bootsnapshot", MaxEntries, MaxStorageSize)
+	{
+	}
+
+	BootSnapshotCache& BootSnapshotCache::instance()
+	{
+		static BootSnapshotCache cache;
+		return cache;
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "baseLib/dataCache.h"
+
+namespace synthLib
+{
+	// Serialized emulation state of a device taken right after its firmware has booted. The key is a hash of everything
+	// the boot depends on (ROM, persisted RAM, device model, state format version). New device instances restore the
+	// snapshot instead of running the boot again
+	class BootSnapshotCache : public baseLib::DataCache
+	{
+	public:
+		using Snapshot = Data;
+
+		static constexpr size_t MaxEntries = 8;
+
+		// every change of the persisted RAM creates a new snapshot of several megabytes
+		static constexpr uint64_t MaxStorageSize = 256ull * 1024 * 1024;
+
+		static BootSnapshotCache& instance();
+
+	private:
+		BootSnapshotCache();
+	};
+}
@@ -8,6 +8,20 @@
 
 namespace synthLib
 {
+	RomData::Ptr DeviceCreateParams::getRom() const
+	{
+		if(rom || romData.empty())
+			return rom;
+
+		auto data = romData;
+		return RomData::fromData(std::move(data));
+	}
+
+	std::vector<uint8_t> DeviceCreateParams::getRomData() const
+	{
+		return rom ? rom->toVector() : romData;
+	}
+
 	Device::Device(const DeviceCreateParams& _params) : m_createParams(_params)  // NOLINT(modernize-pass-by-value) dll transition, do not mess with the input data
 	{
 	}
@@ -32,15 +46,15 @@ namespace synthLib
 		process(in, out, _numSamples, midi, midi);
 	}
 
-	void Device::process(const TAudioInputs& _inputs, const TAudioOutputs& _outputs, const size_t _size, const std::vector<SMidiEvent>& _midiIn, std::vector<SMidiEvent>& _midiOut)
+	void Device::process(const TAudioInputs& _inputs, const TAudioOutputs& _outputs, const size_t _size, std::vector<SMidiEvent>& _midiIn, std::vector<SMidiEvent>& _midiOut)
 	{
 		_midiOut.clear();
 
-		for (const auto& ev : _midiIn)
+		for (auto& ev : _midiIn)
 		{
 			m_translatorOut.clear();
 
-			m_midiTranslator.process(m_translatorOut, ev);
+			m_midiTranslator.process(m_translatorOut, std::move(ev));
 
 			for(auto & e : m_translatorOut)
 				sendMidi(e, _midiOut);
@@ -10,6 +10,7 @@
 #include "midiTypes.h"
 #include "buildconfig.h"
 #include "midiTranslator.h"
+#include "romData.h"
 
 #include "baseLib/compilerdefs.h"
 #include "baseLib/md5.h"
@@ -22,9 +23,13 @@ namespace synthLib
 		float hostSamplerate = 0.0f;
 		std::string romName;
 		std::vector<uint8_t> romData;
+		RomData::Ptr rom;	// shared image, used instead of romData if set
 		baseLib::MD5 romHash;
 		uint32_t customData = 0;
 		std::string homePath;
+
+		RomData::Ptr getRom() const;
+		std::vector<uint8_t> getRomData() const;
 	};
 
 	class Device
@@ -39,7 +44,8 @@ namespace synthLib
 		Device& operator = (const Device&) = delete;
 		Device& operator = (Device&&) = delete;
 
-		virtual void process(const TAudioInputs& _inputs, const TAudioOutputs& _outputs, size_t _size, const std::vector<SMidiEvent>& _midiIn, std::vector<SMidiEvent>& _midiOut);
+		// events are moved out of _midiIn
+		virtual void process(const TAudioInputs& _inputs, const TAudioOutputs& _outputs, size_t _size, std::vector<SMidiEvent>& _midiIn, std::vector<SMidiEvent>& _midiOut);
 
 		void setExtraLatencySamples(uint32_t _size);
 		uint32_t getExtraLatencySamples() const { return m_extraLatency; }
@@ -146,24 +146,53 @@
 #include "mameResamplers.h"
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#   define MAME_RESAMPLER_SIMD 1
+#   include <xmmintrin.h>
+#elif defined(__aarch64__) || defined(__ARM_ARCH_8) || defined(_M_ARM64)
+#   define MAME_RESAMPLER_SIMD 1
+#   include "baseLib/sse2neon.h"
+#else
+#   define MAME_RESAMPLER_SIMD 0
+#endif
+
 namespace synthLib
 {
     namespace
     {
         constexpr double kPi = 3.14159265358979323846;
+        constexpr uint32_t kSimdWidth = 4;
 
-        static float sample_at(const std::deque<float>& src, const int64_t srcBase, const int64_t index)
+        // count needs to be a multiple of kSimdWidth
+        float dotProduct(const float* a, const float* b, const uint32_t count)
         {
-            if (index < srcBase)
-                return 0.0f;
-
-            const int64_t off = index - srcBase;
-            if (off < 0 || static_cast<size_t>(off) >= src.size())
-                return 0.0f;
+            assert((count % kSimdWidth) == 0);
+#if MAME_RESAMPLER_SIMD
+            __m128 acc0 = _mm_setzero_ps();
+            __m128 acc1 = _mm_setzero_ps();
 
-            return src[static_cast<size_t>(off)];
+            uint32_t i = 0;
+            for (; i + 2 * kSimdWidth <= count; i += 2 * kSimdWidth)
+            {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + kSimdWidth), _mm_loadu_ps(b + i + kSimdWidth)));
+            }
+            if (i < count)
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+
+            acc0 = _mm_add_ps(acc0, acc1);
+            acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+            acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 0x55));
+            return _mm_cvtss_f32(acc0);
+#else
+            float acc = 0.0f;
+            for (uint32_t i = 0; i != count; ++i)
+                acc += a[i] * b[i];
+            return acc;
+#endif
         }
     }
 
@@ -186,6 +215,7 @@ namespace synthLib
         m_fsm = ft / gcd;
 
         m_orderPerLane = std::clamp(static_cast<uint32_t>(fs * latency * 2), 2u, maxOrderPerLane);
+        m_orderPadded = (m_orderPerLane + kSimdWidth - 1) / kSimdWidth * kSimdWidth;
 
         m_phaseShift = 0;
         while (((m_fsm - 1) >> m_phaseShift) >= maxLanes)
@@ -193,22 +223,75 @@ namespace synthLib
 
         m_phases = ((m_fsm - 1) >> m_phaseShift) + 1;
 
+        m_delta = m_ftm % m_fsm;
+        m_skip = m_ftm / m_fsm;
+
+        // the filter only depends on these, all instances with the same parameters share one table
+        const CoefficientKey key{fs, ft, m_orderPerLane, m_phaseShift};
+
+        auto& cache = getCoefficientCache();
+
+        {
+            std::scoped_lock lock(cache.mutex);
+            const auto it = cache.tables.find(key);
+            if (it != cache.tables.end())
+                m_coefficients = it->second.lock();
+        }
+
+        if (m_coefficients)
+            return;
+
+        auto coefficients = createCoefficients();
+
+        std::scoped_lock lock(cache.mutex);
+
+        // another instance might have been faster
+        auto& entry = cache.tables[key];
+        m_coefficients = entry.lock();
+        if (m_coefficients)
+            return;
+
+        m_coefficients = std::move(coefficients);
+        entry = m_coefficients;
+
+        // keep the most recent tables alive even if unused, switching back and forth between samplerates is common
+        cache.recent.push_front(m_coefficients);
+        if (cache.recent.size() > CoefficientCache::RecentCount)
+            cache.recent.pop_back();
+
+        for (auto it = cache.tables.begin(); it != cache.tables.end();)
+        {
+            if (it->second.expired())
+                it = cache.tables.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    MameResamplerHq::CoefficientCache& MameResamplerHq::getCoefficientCache()
+    {
+        static CoefficientCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const std::vector<float>> MameResamplerHq::createCoefficients() const
+    {
         uint32_t filterLength = m_orderPerLane * m_phases;
         if ((filterLength & 1) == 0)
             --filterLength;
         const uint32_t hlen = std::max(1u, filterLength / 2);
 
-        m_coefficients.resize(m_phases);
+        std::vector<std::vector<float>> coefficients(m_phases);
         for (uint32_t i = 0; i != m_phases; ++i)
-            m_coefficients[i].resize(m_orderPerLane, 0.0f);
+            coefficients[i].resize(m_orderPerLane, 0.0f);
 
-        const double cutoff = std::min(fs / 2.0, ft / 2.0);
-        auto set_filter = [this](const uint32_t i, const float v)
+        const double cutoff = std::min(m_fs / 2.0, m_ft / 2.0);
+        auto set_filter = [&](const uint32_t i, const float v)
         {
-            m_coefficients[i % m_phases][i / m_phases] = v;
+            coefficients[i % m_phases][i / m_phases] = v;
         };
 
-        const double wc = 2.0 * kPi * cutoff / (double(fs) * double(m_fsm) / double(1u << m_phaseShift));
+        const double wc = 2.0 * kPi * cutoff / (double(m_fs) * double(m_fsm) / double(1u << m_phaseShift));
         const double a = wc / kPi;
 
         for (uint32_t i = 1; i != hlen; ++i)
@@ -226,14 +309,21 @@ namespace synthLib
         {
             float s = 0.0f;
             for (uint32_t j = 0; j != m_orderPerLane; ++j)
-                s += m_coefficients[i][j];
+                s += coefficients[i][j];
             const float inv = (s != 0.0f) ? (1.0f / s) : 1.0f;
             for (uint32_t j = 0; j != m_orderPerLane; ++j)
-                m_coefficients[i][j] *= inv;
+                coefficients[i][j] *= inv;
         }
 
-        m_delta = m_ftm % m_fsm;
-        m_skip = m_ftm / m_fsm;
+        // store each phase reversed to be able to use a forward dot product in apply()
+        const uint32_t pad = m_orderPadded - m_orderPerLane;
+
+        auto result = std::make_shared<std::vector<float>>(static_cast<size_t>(m_phases) * m_orderPadded, 0.0f);
+
+        for (uint32_t i = 0; i != m_phases; ++i)
+            std::reverse_copy(coefficients[i].begin(), coefficients[i].end(), result->begin() + static_cast<size_t>(i) * m_orderPadded + pad);
+
+        return result;
     }
 
     uint32_t MameResamplerHq::computeGcd(uint32_t fs, uint32_t ft)
@@ -251,7 +341,7 @@ namespace synthLib
 
     uint32_t MameResamplerHq::historySize() const
     {
-        return m_orderPerLane + m_skip + 1;
+        return m_orderPadded + m_skip + 1;
     }
 
     int64_t MameResamplerHq::minSourceIndexForOutput(const uint64_t destSample) const
@@ -260,7 +350,7 @@ namespace synthLib
         const uint64_t dsamp = destSample % m_ft;
         const uint64_t ssamp = (dsamp * m_fs) / m_ft;
         const int64_t ssample = static_cast<int64_t>(ssamp + uint64_t(m_fs) * seconds);
-        return ssample - static_cast<int64_t>(m_orderPerLane) + 1;
+        return ssample - static_cast<int64_t>(m_orderPadded) + 1;
     }
 
     int64_t MameResamplerHq::maxSourceIndexNeeded(const uint64_t destSample, const uint32_t samples) const
@@ -288,7 +378,7 @@ namespace synthLib
         return maxS;
     }
 
-    void MameResamplerHq::apply(const std::deque<float>& src, const int64_t srcBase, float* dest, const uint64_t destSample, const uint32_t samples, const float gain) const
+    void MameResamplerHq::apply(const float* const* src, const int64_t srcBase, float* const* dest, const uint32_t channels, const uint64_t destSample, const uint32_t samples) const
     {
         if (samples == 0)
             return;
@@ -299,23 +389,16 @@ namespace synthLib
         int64_t s = static_cast<int64_t>(ssamp + uint64_t(m_fs) * seconds);
         uint32_t phase = (dsamp * m_ftm) % m_fsm;
 
-        // Copy needed source range to contiguous buffer for cache-friendly inner loop
-        const int64_t rangeStart = s - static_cast<int64_t>(m_orderPerLane) + 1;
-        const int64_t rangeEnd = maxSourceIndexNeeded(destSample, samples);
-        const size_t rangeSize = static_cast<size_t>(rangeEnd - rangeStart + 1);
-
-        m_scratchBuffer.resize(rangeSize);
-        for (size_t i = 0; i < rangeSize; ++i)
-            m_scratchBuffer[i] = sample_at(src, srcBase, rangeStart + static_cast<int64_t>(i));
+        assert(s - static_cast<int64_t>(m_orderPadded) + 1 >= srcBase);
 
         for (uint32_t sample = 0; sample != samples; ++sample)
         {
-            float acc = 0.0f;
-            const float* filter = m_coefficients[phase >> m_phaseShift].data();
-            const size_t srcOff = static_cast<size_t>(s - rangeStart);
-            for (uint32_t k = 0; k != m_orderPerLane; ++k)
-                acc += filter[k] * m_scratchBuffer[srcOff - k];
-            dest[sample] += acc * gain;
+            // all channels share the filter and the source position
+            const float* filter = &(*m_coefficients)[static_cast<size_t>(phase >> m_phaseShift) * m_orderPadded];
+            const size_t srcOff = static_cast<size_t>(s - srcBase + 1 - static_cast<int64_t>(m_orderPadded));
+
+            for (uint32_t c = 0; c != channels; ++c)
+                dest[c][sample] = dotProduct(filter, src[c] + srcOff, m_orderPadded);
 
             phase += m_delta;
             s += m_skip;
@@ -441,7 +524,7 @@ namespace synthLib
         return maxUsed;
     }
 
-    void MameResamplerLofi::apply(const std::deque<float>& src, const int64_t srcBase, float* dest, const uint64_t destSample, const uint32_t samples, const float gain) const
+    void MameResamplerLofi::apply(const float* const* src, const int64_t srcBase, float* const* dest, const uint32_t channels, const uint64_t destSample, const uint32_t samples) const
     {
         if (samples == 0)
             return;
@@ -450,58 +533,54 @@ namespace synthLib
         const uint64_t dsamp = destSample % m_ft;
         const uint64_t ssamp = (dsamp * m_fs * 0x1000ull) / m_ft;
         int64_t ssample = static_cast<int64_t>((ssamp >> 12) + uint64_t(m_fs) * seconds);
-        uint32_t phase = static_cast<uint32_t>(ssamp & 0xfff);
+        uint32_t startPhase = static_cast<uint32_t>(ssamp & 0xfff);
 
         if (m_sourceDivide > 1)
         {
             const uint32_t delta = static_cast<uint32_t>(ssample % static_cast<int64_t>(m_sourceDivide));
-            phase = (phase | (delta << 12)) / m_sourceDivide;
+            startPhase = (startPhase | (delta << 12)) / m_sourceDivide;
             ssample -= delta;
         }
 
         ssample -= static_cast<int64_t>(4 * m_sourceDivide);
 
-        // Copy needed source range to contiguous buffer
-        const int64_t rangeStart = ssample;
-        const int64_t rangeEnd = maxSourceIndexNeeded(destSample, samples);
-        const size_t rangeSize = static_cast<size_t>(rangeEnd - rangeStart + 1);
-
-        m_scratchBuffer.resize(rangeSize);
-        for (size_t i = 0; i < rangeSize; ++i)
-            m_scratchBuffer[i] = sample_at(src, srcBase, rangeStart + static_cast<int64_t>(i));
-
-        int64_t readPos = ssample;
+        assert(ssample >= srcBase);
 
-        auto reader = [&]() -> float
+        for (uint32_t c = 0; c != channels; ++c)
         {
-            float sm = 0.0f;
-            const size_t off = static_cast<size_t>(readPos - rangeStart);
-            for (uint32_t i = 0; i != m_sourceDivide; ++i)
-                sm += m_scratchBuffer[off + i];
-            readPos += m_sourceDivide;
-            return sm * m_invSourceDivide;
-        };
+            const float* in = src[c] + (ssample - srcBase);
+            float* out = dest[c];
 
-        phase <<= 12;
+            auto reader = [&]() -> float
+            {
+                float sm = 0.0f;
+                for (uint32_t i = 0; i != m_sourceDivide; ++i)
+                    sm += in[i];
+                in += m_sourceDivide;
+                return sm * m_invSourceDivide;
+            };
 
-        float s0 = reader();
-        float s1 = reader();
-        float s2 = reader();
-        float s3 = reader();
+            uint32_t phase = startPhase << 12;
 
-        for (uint32_t sample = 0; sample != samples; ++sample)
-        {
-            const uint32_t cphase = phase >> 12;
-            dest[sample] += gain * (-s0 * s_interpolationTable[0][0x1000 - cphase] + s1 * s_interpolationTable[1][0x1000 - cphase] + s2 * s_interpolationTable[1][cphase] - s3 * s_interpolationTable[0][cphase]);
+            float s0 = reader();
+            float s1 = reader();
+            float s2 = reader();
+            float s3 = reader();
 
-            phase += m_step;
-            if (phase & 0x1000000)
+            for (uint32_t sample = 0; sample != samples; ++sample)
             {
-                phase &= 0x00ffffff;
-                s0 = s1;
-                s1 = s2;
-                s2 = s3;
-                s3 = reader();
+                const uint32_t cphase = phase >> 12;
+                out[sample] = -s0 * s_interpolationTable[0][0x1000 - cphase] + s1 * s_interpolationTable[1][0x1000 - cphase] + s2 * s_interpolationTable[1][cphase] - s3 * s_interpolationTable[0][cphase];
+
+                phase += m_step;
+                if (phase & 0x1000000)
+                {
+                    phase &= 0x00ffffff;
+                    s0 = s1;
+                    s1 = s2;
+                    s2 = s3;
+                    s3 = reader();
+                }
             }
         }
     }
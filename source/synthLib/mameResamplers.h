@@ -3,7 +3,10 @@
 #include <array>
 #include <cstdint>
 #include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <tuple>
 #include <vector>
 
 namespace synthLib
@@ -14,6 +17,10 @@ namespace synthLib
         Lofi
     };
 
+    // A resampler instance is shared by all channels of a stream, they are processed in one pass.
+    // src[c] points to the source sample at index srcBase of channel c, the caller guarantees that every source index
+    // between minSourceIndexForOutput(destSample) and maxSourceIndexNeeded(destSample, samples) is readable.
+    // dest[c] is overwritten
     class MameResampler
     {
     public:
@@ -22,7 +29,7 @@ namespace synthLib
         virtual uint32_t historySize() const = 0;
         virtual int64_t minSourceIndexForOutput(uint64_t destSample) const = 0;
         virtual int64_t maxSourceIndexNeeded(uint64_t destSample, uint32_t samples) const = 0;
-        virtual void apply(const std::deque<float>& src, int64_t srcBase, float* dest, uint64_t destSample, uint32_t samples, float gain) const = 0;
+        virtual void apply(const float* const* src, int64_t srcBase, float* const* dest, uint32_t channels, uint64_t destSample, uint32_t samples) const = 0;
 
         static std::unique_ptr<MameResampler> create(MameResamplerMode mode, uint32_t fs, uint32_t ft);
     };
@@ -35,12 +42,27 @@ namespace synthLib
         uint32_t historySize() const override;
         int64_t minSourceIndexForOutput(uint64_t destSample) const override;
         int64_t maxSourceIndexNeeded(uint64_t destSample, uint32_t samples) const override;
-        void apply(const std::deque<float>& src, int64_t srcBase, float* dest, uint64_t destSample, uint32_t samples, float gain) const override;
+        void apply(const float* const* src, int64_t srcBase, float* const* dest, uint32_t channels, uint64_t destSample, uint32_t samples) const override;
 
     private:
+        // fs, ft, order per lane, phase shift
+        using CoefficientKey = std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>;
+
+        struct CoefficientCache
+        {
+            static constexpr size_t RecentCount = 4;
+
+            std::mutex mutex;
+            std::map<CoefficientKey, std::weak_ptr<const std::vector<float>>> tables;
+            std::deque<std::shared_ptr<const std::vector<float>>> recent;
+        };
+
         static uint32_t computeGcd(uint32_t fs, uint32_t ft);
+        static CoefficientCache& getCoefficientCache();
+        std::shared_ptr<const std::vector<float>> createCoefficients() const;
 
         uint32_t m_orderPerLane = 0;
+        uint32_t m_orderPadded = 0;     // m_orderPerLane rounded up to the SIMD width
         uint32_t m_ftm = 0;
         uint32_t m_fsm = 0;
         uint32_t m_ft = 0;
@@ -50,8 +72,9 @@ namespace synthLib
         uint32_t m_phases = 0;
         uint32_t m_phaseShift = 0;
 
-        std::vector<std::vector<float>> m_coefficients;
-        mutable std::vector<float> m_scratchBuffer;
+        // m_phases filters of m_orderPadded taps. Each is stored in reverse order and zero padded at the front to form a
+        // forward dot product with the source. Immutable, shared between all instances with the same parameters
+        std::shared_ptr<const std::vector<float>> m_coefficients;
     };
 
     class MameResamplerLofi final : public MameResampler
@@ -62,7 +85,7 @@ namespace synthLib
         uint32_t historySize() const override;
         int64_t minSourceIndexForOutput(uint64_t destSample) const override;
         int64_t maxSourceIndexNeeded(uint64_t destSample, uint32_t samples) const override;
-        void apply(const std::deque<float>& src, int64_t srcBase, float* dest, uint64_t destSample, uint32_t samples, float gain) const override;
+        void apply(const float* const* src, int64_t srcBase, float* const* dest, uint32_t channels, uint64_t destSample, uint32_t samples) const override;
 
     private:
         static const std::array<std::array<float, 0x1001>, 2> s_interpolationTable;
@@ -72,7 +95,6 @@ namespace synthLib
         uint32_t m_fs = 0;
         uint32_t m_ft = 0;
         uint32_t m_step = 0;
-        mutable std::vector<float> m_scratchBuffer;
     };
 }
 
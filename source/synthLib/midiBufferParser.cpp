@@ -81,12 +81,12 @@ namespace synthLib
 			return;
 
 		SMidiEvent ev(m_pendingEvent.source);
-		ev.sysex.swap(m_sysexBuffer);
+		ev.sysex = std::move(m_sysexBuffer);
 
 		if(ev.sysex.back() != M_ENDOFSYSEX)
 			ev.sysex.push_back(M_ENDOFSYSEX);
 
-		m_midiEvents.push_back(ev);
+		m_midiEvents.push_back(std::move(ev));
 		m_sysexBuffer.clear();
 	}
 
@@ -11,7 +11,7 @@ namespace synthLib
 		reset();
 	}
 
-	void MidiTranslator::process(std::vector<SMidiEvent>& _results, const SMidiEvent& _source)
+	void MidiTranslator::process(std::vector<SMidiEvent>& _results, SMidiEvent&& _source)
 	{
 		const size_t size = _source.sysex.size();
 
@@ -29,7 +29,7 @@ namespace synthLib
 			}
 			else
 			{
-				_results.push_back(_source);
+				_results.push_back(std::move(_source));
 			}
 
 			return;
@@ -37,7 +37,7 @@ namespace synthLib
 
 		if (size < 4 || _source.sysex.front() != 0xf0 || _source.sysex.back() != 0xf7 || _source.sysex[1] != ManufacturerId)
 		{
-			_results.push_back(_source);
+			_results.push_back(std::move(_source));
 			return;
 		}
 
@@ -46,11 +46,7 @@ namespace synthLib
 		case CmdSkipTranslation:
 			if (size == 7)
 			{
-				auto& result = _results.emplace_back(_source);
-				result.a = _source.sysex[3];
-				result.b = _source.sysex[4];
-				result.c = _source.sysex[5];
-				result.sysex.clear();
+				_results.emplace_back(_source.source, _source.sysex[3], _source.sysex[4], _source.sysex[5], _source.offset);
 			}
 			break;
 		case CmdAddTargetChannel:
@@ -36,7 +36,7 @@ namespace synthLib
 		MidiTranslator& operator = (const MidiTranslator&) = default;
 		MidiTranslator& operator = (MidiTranslator&&) = default;
 
-		virtual void process(std::vector<SMidiEvent>& _results, const SMidiEvent& _source);
+		virtual void process(std::vector<SMidiEvent>& _results, SMidiEvent&& _source);
 
 		bool addTargetChannel(uint8_t _sourceChannel, uint8_t _targetChannel);
 
@@ -1,7 +1,9 @@
 #include "plugin.h"
 #include "device.h"
 
+#include <algorithm>
 #include <cmath>
+#include <thread>
 
 #include "baseLib/os.h"
 
@@ -12,42 +14,68 @@ namespace synthLib
 	constexpr uint8_t g_stateVersion = 1;
 
 	Plugin::Plugin(Device* _device, CallbackDeviceInvalid _callbackDeviceInvalid)
-	: m_resampler(_device->getChannelCountIn(), _device->getChannelCountOut())
-	, m_device(_device)
+	: m_channelCountIn(_device->getChannelCountIn())
+	, m_channelCountOut(_device->getChannelCountOut())
 	, m_midiClock(*this)
-	, m_deviceSamplerate(_device->getSamplerate())
 	, m_callbackDeviceInvalid(std::move(_callbackDeviceInvalid))
 	{
+		auto config = std::make_unique<Config>();
+
+		config->device = _device;
+		config->deviceSamplerate = _device->getSamplerate();
+		config->resampler = std::make_shared<ResamplerInOut>(m_channelCountIn, m_channelCountOut);
+
+		publishConfig(std::move(config));
+
+		m_midiInOverflow.reserve(1024);
+		m_midiInOther.reserve(1024);
+		m_midiInOtherProcess.reserve(1024);
 	}
 
 	void Plugin::addMidiEvent(const SMidiEvent& _ev)
+	{
+		addMidiEvent(SMidiEvent(_ev));
+	}
+
+	void Plugin::addMidiEvent(SMidiEvent&& _ev)
 	{
 		std::lock_guard lock(m_lockAddMidiEvent);
 
-		if(m_midiInRingBuffer.full())
+		m_midiInOther.push_back(std::move(_ev));
+		m_hasMidiInOther = true;
+	}
+
+	void Plugin::addMidiEventFromAudioThread(SMidiEvent&& _ev)
+	{
+		// once the ring buffer overflowed, keep adding to the overflow list until it has been processed to preserve the order
+		if(m_midiInOverflow.empty() && !m_midiInRingBuffer.full())
 		{
-			std::lock_guard l(m_lock);
-			processMidiInEvent(m_midiInRingBuffer.pop_front());
+			m_midiInRingBuffer.push_back(std::move(_ev));
+			return;
 		}
-		m_midiInRingBuffer.push_back(_ev);
+
+		m_midiInOverflow.push_back(std::move(_ev));
 	}
 
 	bool Plugin::setPreferredDeviceSamplerate(const float _samplerate)
 	{
 		std::lock_guard lock(m_lock);
 
-		const auto sr = m_device->getDeviceSamplerate(_samplerate, m_hostSamplerate);
+		const auto& device = *m_config->device;
+
+		const auto sr = device.getDeviceSamplerate(_samplerate, m_config->hostSamplerate);
 
-		if(sr == m_deviceSamplerate)  // NOLINT(clang-diagnostic-float-equal)
+		if(sr == m_config->deviceSamplerate)  // NOLINT(clang-diagnostic-float-equal)
 			return true;
 
-		if(!m_device->setSamplerate(sr))
+		if(!device.isSamplerateSupported(sr))
 			return false;
 
-		m_deviceSamplerate = sr;
-		m_resampler.setSamplerates(m_hostSamplerate, m_deviceSamplerate);
-
-		updateDeviceLatency();
+		auto config = cloneConfig();
+		config->deviceSamplerate = sr;
+		createResampler(*config);
+		updateDeviceLatency(*config);
+		publishConfig(std::move(config));
 		return true;
 	}
 
@@ -55,21 +83,34 @@ namespace synthLib
 	{
 		std::lock_guard lock(m_lock);
 
-		m_deviceSamplerate = m_device->getDeviceSamplerate(_preferredDeviceSamplerate, _hostSamplerate);
-		m_device->setSamplerate(m_deviceSamplerate);
-		m_resampler.setSamplerates(_hostSamplerate, m_deviceSamplerate);
+		auto config = cloneConfig();
+
+		config->deviceSamplerate = config->device->getDeviceSamplerate(_preferredDeviceSamplerate, _hostSamplerate);
+		config->hostSamplerate = _hostSamplerate;
+		config->hostSamplerateInv = _hostSamplerate > 0 ? 1.0f / _hostSamplerate : 0.0f;
+
+		if(config->deviceSamplerate != m_config->deviceSamplerate || config->hostSamplerate != m_config->hostSamplerate)  // NOLINT(clang-diagnostic-float-equal)
+			createResampler(*config);
 
-		m_hostSamplerate = _hostSamplerate;
-		m_hostSamplerateInv = _hostSamplerate > 0 ? 1.0f / _hostSamplerate : 0.0f;
+		m_hostSamplerate = config->hostSamplerate;
+		m_hostSamplerateInv = config->hostSamplerateInv;
 
-		updateDeviceLatency();
+		updateDeviceLatency(*config);
+		publishConfig(std::move(config));
 	}
 
 	void Plugin::setResamplerMode(const Resampler::Mode _mode)
 	{
 		std::lock_guard lock(m_lock);
-		m_resampler.setResamplerMode(_mode);
-		updateDeviceLatency();
+
+		if(m_config->resamplerMode == _mode)
+			return;
+
+		auto config = cloneConfig();
+		config->resamplerMode = _mode;
+		createResampler(*config);
+		updateDeviceLatency(*config);
+		publishConfig(std::move(config));
 	}
 
 	void Plugin::process(const TAudioInputs& _inputs, const TAudioOutputs& _outputs, size_t _count, const float _bpm, const float _ppqPos, const bool _isPlaying)
@@ -85,26 +126,43 @@ namespace synthLib
 		for(size_t i=0; i<outputs.size(); ++i)
 			outputs[i] = _outputs[i] ? _outputs[i] : getDummyBuffer(_count);
 
-		std::lock_guard lock(m_lock);
+		// The audio thread never waits for a lock, configuration changes are picked up from the latest published config
+		const Config* config = acquireConfig();
 
-		if(!m_device->isValid())
+		if(!config->device->isValid())
 		{
-			m_device = m_callbackDeviceInvalid(m_device);
+			// the owner replaces the device via setDevice(), it is picked up with the next config
+			if(m_reportedInvalidDevice != config->deviceVersion + 1)
+			{
+				m_reportedInvalidDevice = config->deviceVersion + 1;
+				m_callbackDeviceInvalid(config->device);
+			}
 
-			if(!m_device || !m_device->isValid())
-				return;
+			m_processConfig = nullptr;
+
+			processMidiInEvents();
+			m_midiIn.clear();
+
+			for (auto* out : outputs)
+				std::fill_n(out, _count, 0.0f);
+			return;
 		}
 
+		if(config->version != m_appliedConfigVersion)
+			applyConfig(*config);
+
 		processMidiInEvents();
 		processMidiClock(_bpm, _ppqPos, _isPlaying, _count);
 
-		m_resampler.process(inputs, outputs, m_midiIn, m_midiOut, static_cast<uint32_t>(_count), 
-			[&](const TAudioInputs& _ins, const TAudioOutputs& _outs, size_t _c, const ResamplerInOut::TMidiVec& _midiIn, ResamplerInOut::TMidiVec& _midiOut)
+		config->resampler->process(inputs, outputs, m_midiIn, m_midiOut, static_cast<uint32_t>(_count), 
+			[&](const TAudioInputs& _ins, const TAudioOutputs& _outs, size_t _c, ResamplerInOut::TMidiVec& _midiIn, ResamplerInOut::TMidiVec& _midiOut)
 		{
-			m_device->process(_ins, _outs, _c, _midiIn, _midiOut);
+			config->device->process(_ins, _outs, _c, _midiIn, _midiOut);
 		});
 
 		m_midiIn.clear();
+
+		m_processConfig = nullptr;
 	}
 
 	void Plugin::getMidiOut(std::vector<SMidiEvent>& _midiOut)
@@ -115,7 +173,7 @@ namespace synthLib
 
 	bool Plugin::isValid() const
 	{
-		return m_device->isValid();
+		return getDevice()->isValid();
 	}
 
 	void Plugin::setDevice(Device* _device)
@@ -123,59 +181,83 @@ namespace synthLib
 		if(!_device)
 			return;
 
-		std::lock_guard lock(m_lock);
-
+		// Transferring the state and destroying the old device may take a while. Both are done without holding the lock,
+		// the new device is not visible to the audio thread before it is swapped in
 		std::vector<uint8_t> deviceState;
 		getState(deviceState, StateTypeGlobal);
 
-		delete m_device;
-
-		m_device = _device;
+		float samplerate;
+		{
+			std::lock_guard lock(m_lock);
+			samplerate = m_config->deviceSamplerate;
+		}
 
-		m_device->setSamplerate(m_deviceSamplerate);
+		_device->setSamplerate(samplerate);
 		if(!deviceState.empty())
-			setState(deviceState);
+			setState(*_device, deviceState);
+
+		Device* oldDevice;
+		{
+			std::lock_guard lock(m_lock);
+
+			auto config = cloneConfig();
+
+			oldDevice = config->device;
+			config->device = _device;
+			++config->deviceVersion;
 
-		// MIDI clock has to send the start event again, some device find it confusing and do strange things if there isn't any
-		m_midiClock.restart();
+			updateDeviceLatency(*config);
 
-		updateDeviceLatency();
+			// returns once the audio thread is done with the old device
+			publishConfig(std::move(config));
+		}
+
+		delete oldDevice;
 	}
 
 #if !SYNTHLIB_DEMO_MODE
 	bool Plugin::getState(std::vector<uint8_t>& _state, StateType _type) const
 	{
-		if(!m_device)
+		auto* device = getDevice();
+
+		if(!device)
 			return false;
 
 		_state.push_back(g_stateVersion);
 		_state.push_back(_type);
 
-		return m_device->getState(_state, _type);
+		return device->getState(_state, _type);
 	}
 
 	bool Plugin::setState(const std::vector<uint8_t>& _state) const
 	{
-		if(!m_device)
+		auto* device = getDevice();
+
+		if(!device)
 			return false;
 
+		return setState(*device, _state);
+	}
+
+	bool Plugin::setState(Device& _device, const std::vector<uint8_t>& _state)
+	{
 		if(_state.empty())
 			return false;
 
 		if(_state.size() < 2)
-			return m_device->setStateFromUnknownCustomData(_state);
+			return _device.setStateFromUnknownCustomData(_state);
 
 		const auto version = _state[0];
 
 		if(version != g_stateVersion)
-			return m_device->setStateFromUnknownCustomData(_state);
+			return _device.setStateFromUnknownCustomData(_state);
 
 		const auto stateType = static_cast<StateType>(_state[1]);
 
 		auto state = _state;
 		state.erase(state.begin(), state.begin() + 2);
 
-		return m_device->setState(state, stateType);
+		return _device.setState(state, stateType);
 	}
 #endif
 	void Plugin::insertMidiEvent(const SMidiEvent& _ev)
@@ -202,14 +284,22 @@ namespace synthLib
 	{
 		std::lock_guard lock(m_lock);
 
-		if(m_extraLatencyBlocks == _latencyBlocks)
+		if(m_config->extraLatencyBlocks == _latencyBlocks)
 			return false;
 
-		m_extraLatencyBlocks = _latencyBlocks;
-		updateDeviceLatency();
+		auto config = cloneConfig();
+		config->extraLatencyBlocks = _latencyBlocks;
+		updateDeviceLatency(*config);
+		publishConfig(std::move(config));
 		return true;
 	}
 
+	uint32_t Plugin::getLatencyBlocks() const
+	{
+		std::lock_guard lock(m_lock);
+		return m_config->extraLatencyBlocks;
+	}
+
 	void Plugin::processMidiClock(const float _bpm, const float _ppqPos, const bool _isPlaying, const size_t _sampleCount)
 	{
 		m_midiClock.process(_bpm, _ppqPos, _isPlaying, _sampleCount);
@@ -223,29 +313,128 @@ namespace synthLib
 		return m_dummyBuffer.data();
 	}
 
-	void Plugin::updateDeviceLatency()
+	Device* Plugin::getDevice() const
 	{
-		if(m_blockSize <= 0 || m_hostSamplerate <= 0)
+		std::lock_guard lock(m_lock);
+		return m_config->device;
+	}
+
+	std::unique_ptr<Plugin::Config> Plugin::cloneConfig() const
+	{
+		return std::make_unique<Config>(*m_config);
+	}
+
+	void Plugin::createResampler(Config& _config) const
+	{
+		// prewarming to calculate the latency takes a while, it is done here and not on the audio thread
+		auto resampler = std::make_shared<ResamplerInOut>(m_channelCountIn, m_channelCountOut);
+
+		resampler->setResamplerMode(_config.resamplerMode);
+		resampler->setSamplerates(_config.hostSamplerate, _config.deviceSamplerate);
+
+		_config.resamplerLatencyIn = resampler->getInputLatency();
+		_config.resamplerLatencyOut = resampler->getOutputLatency();
+		_config.resampler = std::move(resampler);
+	}
+
+	void Plugin::updateDeviceLatency(Config& _config)
+	{
+		if(_config.blockSize <= 0 || _config.hostSamplerate <= 0 || _config.deviceSamplerate <= 0)
 			return;
 
-		const auto latency = static_cast<uint32_t>(std::ceil(static_cast<float>(m_blockSize * m_extraLatencyBlocks) * m_device->getSamplerate() * m_hostSamplerateInv));
-		m_device->setExtraLatencySamples(latency);
+		const auto& device = *_config.device;
+
+		_config.extraLatencySamples = static_cast<uint32_t>(std::ceil(static_cast<float>(_config.blockSize * _config.extraLatencyBlocks) * _config.deviceSamplerate * _config.hostSamplerateInv));
+
+		_config.deviceLatencyMidiToOutput = static_cast<uint32_t>(static_cast<float>(device.getInternalLatencyMidiToOutput()) * _config.hostSamplerate / _config.deviceSamplerate);
+		_config.deviceLatencyInputToOutput = static_cast<uint32_t>(static_cast<float>(device.getInternalLatencyInputToOutput()) * _config.hostSamplerate / _config.deviceSamplerate);
+	}
+
+	void Plugin::publishConfig(std::unique_ptr<Config> _config)
+	{
+		_config->version = m_config ? m_config->version + 1 : 1;
+
+		const auto oldConfig = std::move(m_config);
+		m_config = std::move(_config);
+
+		m_publishedConfig = m_config.get();
+
+		// the old config is destroyed when we return, wait until the audio thread finished the block it is using it for
+		while(oldConfig && m_processConfig == oldConfig.get())
+			std::this_thread::yield();
+	}
+
+	const Plugin::Config* Plugin::acquireConfig()
+	{
+		// announce the config before using it and make sure that it has not been replaced in the meantime,
+		// publishConfig() does not destroy a config that is announced
+		const Config* config = m_publishedConfig;
+
+		while(true)
+		{
+			m_processConfig = config;
+
+			const Config* published = m_publishedConfig;
+
+			if(published == config)
+				return config;
+
+			config = published;
+		}
+	}
+
+	void Plugin::applyConfig(const Config& _config)
+	{
+		auto& device = *_config.device;
+
+		if(device.getSamplerate() != _config.deviceSamplerate)  // NOLINT(clang-diagnostic-float-equal)
+			device.setSamplerate(_config.deviceSamplerate);
+
+		if(device.getExtraLatencySamples() != _config.extraLatencySamples)
+			device.setExtraLatencySamples(_config.extraLatencySamples);
+
+		if(_config.deviceVersion != m_appliedDeviceVersion)
+		{
+			// MIDI clock has to send the start event again, some device find it confusing and do strange things if there isn't any
+			m_midiClock.restart();
+			m_appliedDeviceVersion = _config.deviceVersion;
+		}
 
-		m_deviceLatencyMidiToOutput = static_cast<uint32_t>(static_cast<float>(m_device->getInternalLatencyMidiToOutput()) * m_hostSamplerate / m_device->getSamplerate());
-		m_deviceLatencyInputToOutput = static_cast<uint32_t>(static_cast<float>(m_device->getInternalLatencyInputToOutput()) * m_hostSamplerate / m_device->getSamplerate());
+		m_appliedConfigVersion = _config.version;
 	}
 
 	void Plugin::processMidiInEvents()
 	{
 		while (!m_midiInRingBuffer.empty())
+			processMidiInEvent(m_midiInRingBuffer.pop_front());
+
+		// the ring buffer is empty now, everything in the overflow list has been added after the events we just processed
+		for (auto& ev : m_midiInOverflow)
+			processMidiInEvent(std::move(ev));
+
+		m_midiInOverflow.clear();
+
+		if(!m_hasMidiInOther)
+			return;
+
 		{
-			const auto ev = m_midiInRingBuffer.pop_front();
+			// try again with the next block if a producer is busy
+			std::unique_lock lock(m_lockAddMidiEvent, std::try_to_lock);
 
-			processMidiInEvent(ev);
+			if(!lock.owns_lock())
+				return;
+
+			std::swap(m_midiInOther, m_midiInOtherProcess);
+			m_hasMidiInOther = false;
 		}
+
+		for (auto& ev : m_midiInOtherProcess)
+			processMidiInEvent(std::move(ev));
+
+		m_midiInOtherProcess.clear();
 	}
 
-	void Plugin::processMidiInEvent(const SMidiEvent& _ev)
+	void Plugin::processMidiInEvent(SMidiEvent&& _ev)
 	{
 		// sysex might be sent in multiple chunks. Happens if coming from hardware
 		if (!_ev.sysex.empty())
@@ -254,7 +443,7 @@ namespace synthLib
 
 			if (isComplete)
 			{
-				m_midiIn.push_back(_ev);
+				m_midiIn.push_back(std::move(_ev));
 				return;
 			}
 
@@ -263,7 +452,7 @@ namespace synthLib
 
 			if (isStart)
 			{
-				m_pendingSysexInput = _ev;
+				m_pendingSysexInput = std::move(_ev);
 				return;
 			}
 
@@ -273,31 +462,36 @@ namespace synthLib
 
 				if (isEnd)
 				{
-					m_midiIn.push_back(m_pendingSysexInput);
+					m_midiIn.push_back(std::move(m_pendingSysexInput));
 					m_pendingSysexInput.sysex.clear();
 				}
 			}
 		}
 
-		m_midiIn.push_back(_ev);
+		m_midiIn.push_back(std::move(_ev));
 	}
 
 	void Plugin::setBlockSize(const uint32_t _blockSize)
 	{
 		std::lock_guard lock(m_lock);
-		m_blockSize = _blockSize;
-		updateDeviceLatency();
+
+		auto config = cloneConfig();
+		config->blockSize = _blockSize;
+		updateDeviceLatency(*config);
+		publishConfig(std::move(config));
 	}
 
 	uint32_t Plugin::getLatencyMidiToOutput() const
 	{
 		std::lock_guard lock(m_lock);
-		return m_blockSize * m_extraLatencyBlocks + m_deviceLatencyMidiToOutput + m_resampler.getOutputLatency();
+		const auto& c = *m_config;
+		return c.blockSize * c.extraLatencyBlocks + c.deviceLatencyMidiToOutput + c.resamplerLatencyOut;
 	}
 
 	uint32_t Plugin::getLatencyInputToOutput() const
 	{
 		std::lock_guard lock(m_lock);
-		return m_blockSize * m_extraLatencyBlocks + m_deviceLatencyInputToOutput + m_resampler.getOutputLatency() + m_resampler.getInputLatency();
+		const auto& c = *m_config;
+		return c.blockSize * c.extraLatencyBlocks + c.deviceLatencyInputToOutput + c.resamplerLatencyOut + c.resamplerLatencyIn;
 	}
 }
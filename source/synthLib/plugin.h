@@ -1,7 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <functional>
+#include <memory>
 
 #include "midiTypes.h"
 #include "resamplerInOut.h"
@@ -19,11 +21,18 @@ namespace synthLib
 	class Plugin
 	{
 	public:
-		using CallbackDeviceInvalid = std::function<Device*(Device*)>;
+		// Called by the audio thread, once per device, if the device became invalid. It must return quickly, the owner is
+		// expected to replace the device via setDevice() from another thread. Silence is output until then
+		using CallbackDeviceInvalid = std::function<void(Device*)>;
 
 		Plugin(Device* _device, CallbackDeviceInvalid _callbackDeviceInvalid);
 
+		// thread-safe, for all threads but the audio thread
 		void addMidiEvent(const SMidiEvent& _ev);
+		void addMidiEvent(SMidiEvent&& _ev);
+
+		// lock-free, only to be called by the audio thread between calls to process()
+		void addMidiEventFromAudioThread(SMidiEvent&& _ev);
 
 		bool setPreferredDeviceSamplerate(float _samplerate);
 
@@ -51,42 +60,85 @@ namespace synthLib
 		void insertMidiEvent(const SMidiEvent& _ev);
 
 		bool setLatencyBlocks(uint32_t _latencyBlocks);
-		uint32_t getLatencyBlocks() const { return m_extraLatencyBlocks; }
+		uint32_t getLatencyBlocks() const;
 
 	private:
+		// Everything the audio thread needs to process a block. A config is never modified once it has been published,
+		// changes create a new one that is picked up at the start of the next block
+		struct Config
+		{
+			uint32_t version = 0;
+
+			Device* device = nullptr;
+			uint32_t deviceVersion = 0;
+
+			std::shared_ptr<ResamplerInOut> resampler;
+			Resampler::Mode resamplerMode = Resampler::Mode::Legacy;
+
+			float hostSamplerate = 0.0f;
+			float hostSamplerateInv = 0.0f;
+			float deviceSamplerate = 0.0f;
+
+			uint32_t blockSize = 0;
+			uint32_t extraLatencyBlocks = 1;
+			uint32_t extraLatencySamples = 0;
+
+			uint32_t deviceLatencyMidiToOutput = 0;
+			uint32_t deviceLatencyInputToOutput = 0;
+			uint32_t resamplerLatencyIn = 0;
+			uint32_t resamplerLatencyOut = 0;
+		};
+
+		Device* getDevice() const;
+		std::unique_ptr<Config> cloneConfig() const;
+		void createResampler(Config& _config) const;
+		static void updateDeviceLatency(Config& _config);
+		void publishConfig(std::unique_ptr<Config> _config);
+		const Config* acquireConfig();
+		void applyConfig(const Config& _config);
+
 		void processMidiClock(float _bpm, float _ppqPos, bool _isPlaying, size_t _sampleCount);
 		float* getDummyBuffer(size_t _minimumSize);
-		void updateDeviceLatency();
 		void processMidiInEvents();
-		void processMidiInEvent(const SMidiEvent& _ev);
+		void processMidiInEvent(SMidiEvent&& _ev);
+#if !SYNTHLIB_DEMO_MODE
+		static bool setState(Device& _device, const std::vector<uint8_t>& _state);
+#endif
 
+		// MIDI from the audio thread. Single producer, single consumer, the overflow list is used by the audio thread only
 		dsp56k::RingBuffer<SMidiEvent, 1024, false> m_midiInRingBuffer;
+		std::vector<SMidiEvent> m_midiInOverflow;
+
+		// MIDI from all other threads, guarded by m_lockAddMidiEvent. The audio thread swaps it with its own list if it gets the lock
+		std::vector<SMidiEvent> m_midiInOther;
+		std::vector<SMidiEvent> m_midiInOtherProcess;
+		std::atomic<bool> m_hasMidiInOther = false;
+
 		std::vector<SMidiEvent> m_midiIn;
 		std::vector<SMidiEvent> m_midiOut;
 
 		SMidiEvent m_pendingSysexInput;
 
-		ResamplerInOut m_resampler;
-		mutable std::recursive_mutex m_lock;
+		const uint32_t m_channelCountIn;
+		const uint32_t m_channelCountOut;
+
+		mutable std::recursive_mutex m_lock;		// serializes configuration changes, never taken by the audio thread
 		mutable std::mutex m_lockAddMidiEvent;
 
-		Device* m_device;
+		std::unique_ptr<Config> m_config;						// guarded by m_lock
+		std::atomic<const Config*> m_publishedConfig = nullptr;
+		std::atomic<const Config*> m_processConfig = nullptr;	// config in use by the audio thread, must not be destroyed
+		uint32_t m_appliedConfigVersion = 0;					// audio thread only
+		uint32_t m_appliedDeviceVersion = 0;					// audio thread only
+		uint32_t m_reportedInvalidDevice = 0;					// audio thread only, device version + 1 of the last invalid device reported
 
 		std::vector<float> m_dummyBuffer;
 
-		float m_hostSamplerate = 0.0f;
-		float m_hostSamplerateInv = 0.0f;
-
-		uint32_t m_blockSize = 0;
-
-		uint32_t m_deviceLatencyMidiToOutput = 0;
-		uint32_t m_deviceLatencyInputToOutput = 0;
+		std::atomic<float> m_hostSamplerate = 0.0f;
+		std::atomic<float> m_hostSamplerateInv = 0.0f;
 
 		MidiClock m_midiClock;
 
-		uint32_t m_extraLatencyBlocks = 1;
-
-		float m_deviceSamplerate = 0.0f;
 		CallbackDeviceInvalid m_callbackDeviceInvalid;
 	};
 }
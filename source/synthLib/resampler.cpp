@@ -61,23 +61,24 @@ uint32_t synthLib::Resampler::process(TAudioOutputs& _output, const uint32_t _nu
 
 uint32_t synthLib::Resampler::processResampleMame(const TAudioOutputs& _output, const uint32_t _numChannels, const uint32_t _numSamples, const TProcessFunc& _processFunc)
 {
-	if (m_mameResamplerOut.empty())
+	if (!m_mameResampler)
 		return 0;
 
-	const int64_t maxNeeded = m_mameResamplerOut[0]->maxSourceIndexNeeded(m_mameDestSample, _numSamples);
-	const int64_t currentEnd = m_mameSourceBaseSample + static_cast<int64_t>(m_mameTempOutput[0].size()) - 1;
+	const int64_t maxNeeded = m_mameResampler->maxSourceIndexNeeded(m_mameDestSample, _numSamples);
+	const int64_t currentEnd = m_mameSourceBaseSample + static_cast<int64_t>(m_mameHistory[0].size() - m_mameHistoryOffset) - 1;
 	const uint32_t requiredInput = (maxNeeded > currentEnd) ? static_cast<uint32_t>(maxNeeded - currentEnd) : 0u;
 
 	ensureMameInput(_numChannels, requiredInput, _processFunc);
 
+	TAudioOutputsT<const float> src;
+	src.fill(nullptr);
 	for (uint32_t i = 0; i < _numChannels; ++i)
-	{
-		std::fill(_output[i], _output[i] + _numSamples, 0.0f);
-		m_mameResamplerOut[i]->apply(m_mameTempOutput[i], m_mameSourceBaseSample, _output[i], m_mameDestSample, _numSamples, 1.0f);
-	}
+		src[i] = &m_mameHistory[i][m_mameHistoryOffset];
+
+	m_mameResampler->apply(src.data(), m_mameSourceBaseSample, _output.data(), _numChannels, m_mameDestSample, _numSamples);
 
 	m_mameDestSample += _numSamples;
-	trimMameHistory(_numChannels);
+	trimMameHistory();
 	return _numSamples;
 }
 
@@ -135,53 +136,46 @@ void synthLib::Resampler::ensureMameInput(const uint32_t _numChannels, const uin
 	if (_requiredInputSamples == 0)
 		return;
 
+	// let the device render directly into the history
 	TAudioOutputs tempBuffers;
 	tempBuffers.fill(nullptr);
-	m_mameInputTemp.resize(_numChannels);
 	for (uint32_t i = 0; i < _numChannels; ++i)
 	{
-		m_mameInputTemp[i].assign(_requiredInputSamples, 0.0f);
-		tempBuffers[i] = m_mameInputTemp[i].data();
+		auto& history = m_mameHistory[i];
+		const auto size = history.size();
+		history.resize(size + _requiredInputSamples, 0.0f);
+		tempBuffers[i] = &history[size];
 	}
 
 	_processFunc(tempBuffers, _requiredInputSamples);
-
-	for (uint32_t i = 0; i < _numChannels; ++i)
-	{
-		auto& dst = m_mameTempOutput[i];
-		dst.insert(dst.end(), m_mameInputTemp[i].begin(), m_mameInputTemp[i].end());
-	}
 }
 
-void synthLib::Resampler::trimMameHistory(const uint32_t _numChannels)
+void synthLib::Resampler::trimMameHistory()
 {
-	if (m_mameResamplerOut.empty() || m_mameTempOutput.empty() || m_mameTempOutput[0].empty())
+	if (!m_mameResampler || m_mameHistory.empty())
 		return;
 
-	int64_t minNeeded = m_mameResamplerOut[0]->minSourceIndexForOutput(m_mameDestSample);
-	uint32_t historyKeep = m_mameResamplerOut[0]->historySize();
-	for (uint32_t i = 1; i < _numChannels; ++i)
-	{
-		minNeeded = std::min(minNeeded, m_mameResamplerOut[i]->minSourceIndexForOutput(m_mameDestSample));
-		historyKeep = std::max(historyKeep, m_mameResamplerOut[i]->historySize());
-	}
-
-	int64_t safeBase = minNeeded - static_cast<int64_t>(historyKeep);
-	if (safeBase < 0)
-		safeBase = 0;
+	const int64_t minNeeded = m_mameResampler->minSourceIndexForOutput(m_mameDestSample);
+	const int64_t safeBase = minNeeded - static_cast<int64_t>(m_mameResampler->historySize());
 
 	if (safeBase <= m_mameSourceBaseSample)
 		return;
 
-	const int64_t drop64 = safeBase - m_mameSourceBaseSample;
-	const size_t drop = static_cast<size_t>(std::min<int64_t>(drop64, static_cast<int64_t>(m_mameTempOutput[0].size())));
+	const auto available = m_mameHistory[0].size() - m_mameHistoryOffset;
+	const size_t drop = static_cast<size_t>(std::min<int64_t>(safeBase - m_mameSourceBaseSample, static_cast<int64_t>(available)));
 	if (drop == 0)
 		return;
 
-	for (uint32_t i = 0; i < _numChannels; ++i)
-		m_mameTempOutput[i].erase(m_mameTempOutput[i].begin(), m_mameTempOutput[i].begin() + static_cast<std::ptrdiff_t>(drop));
-
+	m_mameHistoryOffset += drop;
 	m_mameSourceBaseSample += static_cast<int64_t>(drop);
+
+	if (m_mameHistoryOffset < m_mameHistory[0].size() / 2)
+		return;
+
+	for (auto& history : m_mameHistory)
+		history.erase(history.begin(), history.begin() + static_cast<std::ptrdiff_t>(m_mameHistoryOffset));
+
+	m_mameHistoryOffset = 0;
 }
 
 void synthLib::Resampler::destroyResamplers()
@@ -192,9 +186,9 @@ void synthLib::Resampler::destroyResamplers()
 			resample_close(resampler);
 	}
 	m_resamplerOut.clear();
-	m_mameResamplerOut.clear();
-	m_mameTempOutput.clear();
-	m_mameInputTemp.clear();
+	m_mameResampler.reset();
+	m_mameHistory.clear();
+	m_mameHistoryOffset = 0;
 	m_mameSourceBaseSample = 0;
 	m_mameDestSample = 0;
 }
@@ -208,21 +202,23 @@ void synthLib::Resampler::setChannelCount(uint32_t _numChannels)
 
 	m_resamplerOut.resize(_numChannels);
 	m_tempOutput.resize(_numChannels);
-	m_mameResamplerOut.resize(_numChannels);
-	m_mameTempOutput.resize(_numChannels);
 
 	for (auto& buf : m_tempOutput)
 		buf.clear();
-	for (auto& buf : m_mameTempOutput)
-		buf.clear();
 
 	const auto factor = static_cast<double>(m_factorOutToIn);
 
 	if (useMameResampler())
 	{
 		const auto mode = (m_mode == Mode::MameLofi) ? MameResamplerMode::Lofi : MameResamplerMode::Hq;
-		for (auto& resampler : m_mameResamplerOut)
-			resampler = MameResampler::create(mode, static_cast<uint32_t>(m_samplerateIn), static_cast<uint32_t>(m_samplerateOut));
+		m_mameResampler = MameResampler::create(mode, static_cast<uint32_t>(m_samplerateIn), static_cast<uint32_t>(m_samplerateOut));
+
+		// source samples before the start are silence, prefill the history so that the resampler never reads outside of it
+		const auto historySize = m_mameResampler->historySize();
+		m_mameHistory.resize(_numChannels);
+		for (auto& history : m_mameHistory)
+			history.assign(historySize, 0.0f);
+		m_mameSourceBaseSample = -static_cast<int64_t>(historySize);
 	}
 	else
 	{
@@ -4,7 +4,6 @@
 
 #include <functional>
 #include <vector>
-#include <deque>
 #include <memory>
 
 #include <cstdint>
@@ -48,7 +47,7 @@ namespace synthLib
 		uint32_t processResample(const TAudioOutputs& _output, uint32_t _numChannels, uint32_t _numSamples, const TProcessFunc& _processFunc);
 		uint32_t processResampleMame(const TAudioOutputs& _output, uint32_t _numChannels, uint32_t _numSamples, const TProcessFunc& _processFunc);
 		void ensureMameInput(uint32_t _numChannels, uint32_t _requiredInputSamples, const TProcessFunc& _processFunc);
-		void trimMameHistory(uint32_t _numChannels);
+		void trimMameHistory();
 		void destroyResamplers();
 		void setChannelCount(uint32_t _numChannels);
 		bool useMameResampler() const { return m_mode != Mode::Legacy; }
@@ -62,9 +61,11 @@ namespace synthLib
 		double m_inputLen = 0.0;
 
 		std::vector<void*> m_resamplerOut;
-		std::vector<std::unique_ptr<MameResampler>> m_mameResamplerOut;
-		std::vector<std::deque<float>> m_mameTempOutput;
-		std::vector<std::vector<float>> m_mameInputTemp;
+		std::unique_ptr<MameResampler> m_mameResampler;
+		// contiguous source history per channel. Element m_mameHistoryOffset is source sample m_mameSourceBaseSample,
+		// consumed samples are only moved out when they occupy more than half of the buffer
+		std::vector<std::vector<float>> m_mameHistory;
+		size_t m_mameHistoryOffset = 0;
 		int64_t m_mameSourceBaseSample = 0;
 		uint64_t m_mameDestSample = 0;
 
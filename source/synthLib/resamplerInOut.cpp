@@ -85,31 +85,31 @@ namespace synthLib
 			outs[i] = i >= data.size() ? nullptr : &data[i][0];
 
 		TMidiVec midiIn, midiOut;
-		process(ins, outs, TMidiVec(), midiOut, static_cast<uint32_t>(data[0].size()), [&](const TAudioInputs&, const TAudioOutputs&, size_t, const TMidiVec&, TMidiVec&)
+		process(ins, outs, midiIn, midiOut, static_cast<uint32_t>(data[0].size()), [&](const TAudioInputs&, const TAudioOutputs&, size_t, TMidiVec&, TMidiVec&)
 		{
 		});
 	}
 
-	void ResamplerInOut::scaleMidiEvents(TMidiVec& _dst, const TMidiVec& _src, float _scale)
+	void ResamplerInOut::scaleMidiEvents(TMidiVec& _dst, TMidiVec& _src, float _scale)
 	{
 		_dst.clear();
 		_dst.reserve(_src.size());
 
 		for(size_t i=0; i<_src.size(); ++i)
 		{
-			_dst.push_back(_src[i]);
-			_dst[i].offset = floor_int(static_cast<float>(_src[i].offset) * _scale);
+			_dst.push_back(std::move(_src[i]));
+			_dst[i].offset = floor_int(static_cast<float>(_dst[i].offset) * _scale);
 		}
 	}
 
-	void ResamplerInOut::clampMidiEvents(TMidiVec& _dst, const TMidiVec& _src, uint32_t _offsetMin, uint32_t _offsetMax)
+	void ResamplerInOut::clampMidiEvents(TMidiVec& _dst, TMidiVec& _src, uint32_t _offsetMin, uint32_t _offsetMax)
 	{
 		_dst.clear();
 		_dst.reserve(_src.size());
 
 		for(size_t i=0; i<_src.size(); ++i)
 		{
-			_dst.push_back(_src[i]);
+			_dst.push_back(std::move(_src[i]));
 			_dst[i].offset = clamp(_dst[i].offset, _offsetMin, _offsetMax);
 		}
 	}
@@ -128,7 +128,7 @@ namespace synthLib
 		}
 	}
 
-	void ResamplerInOut::process(const TAudioInputs& _inputs, TAudioOutputs& _outputs, const TMidiVec& _midiIn, TMidiVec& _midiOut, const uint32_t _numSamples, const TProcessFunc& _processFunc)
+	void ResamplerInOut::process(const TAudioInputs& _inputs, TAudioOutputs& _outputs, TMidiVec& _midiIn, TMidiVec& _midiOut, const uint32_t _numSamples, const TProcessFunc& _processFunc)
 	{
 		if(!m_in || !m_out)
 			return;
@@ -12,7 +12,7 @@ namespace synthLib
 	{
 	public:
 		using TMidiVec = std::vector<SMidiEvent>;
-		using TProcessFunc = std::function<void(const TAudioInputs&, const TAudioOutputs&, size_t, const TMidiVec&, TMidiVec&)>;
+		using TProcessFunc = std::function<void(const TAudioInputs&, const TAudioOutputs&, size_t, TMidiVec&, TMidiVec&)>;
 
 		ResamplerInOut(uint32_t _channelCountIn, uint32_t _channelCountOut);
 
@@ -21,15 +21,16 @@ namespace synthLib
 		void setHostSamplerate(float _samplerate);
 		void setSamplerates(float _hostSamplerate, float _deviceSamplerate);
 
-		void process(const TAudioInputs& _inputs, TAudioOutputs& _outputs, const TMidiVec& _midiIn, TMidiVec& _midiOut, uint32_t _numSamples, const TProcessFunc& _processFunc);
+		// events are moved out of _midiIn
+		void process(const TAudioInputs& _inputs, TAudioOutputs& _outputs, TMidiVec& _midiIn, TMidiVec& _midiOut, uint32_t _numSamples, const TProcessFunc& _processFunc);
 
 		uint32_t getOutputLatency() const { return m_outputLatency; }
 		uint32_t getInputLatency() const { return m_inputLatency; }
 
 	private:
 		void recreate();
-		static void scaleMidiEvents(TMidiVec& _dst, const TMidiVec& _src, float _scale);
-		static void clampMidiEvents(TMidiVec& _dst, const TMidiVec& _src, uint32_t _offsetMin, uint32_t _offsetMax);
+		static void scaleMidiEvents(TMidiVec& _dst, TMidiVec& _src, float _scale);
+		static void clampMidiEvents(TMidiVec& _dst, TMidiVec& _src, uint32_t _offsetMin, uint32_t _offsetMax);
 		static void extractMidiEvents(TMidiVec& _dst, const TMidiVec& _src, uint32_t _offsetMin, uint32_t _offsetMax);
 
 		const uint32_t m_channelCountIn;
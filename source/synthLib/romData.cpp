@@ -0,0 +1,118 @@
+#include "romData.h"
+
+#include <map>
+#include <mutex>
+
+#include "romIndex.h"
+
+#include "baseLib/filesystem.h"
+
+namespace synthLib
+{
+	namespace
+	{
+		struct Registry
+		{
+			std::mutex mutex;
+			std::map<baseLib::MD5, std::weak_ptr<const RomData>> byHash;
+			std::map<std::string, std::pair<baseLib::filesystem::FileInfo, std::weak_ptr<const RomData>>> byFile;
+		};
+
+		Registry& getRegistry()
+		{
+			static Registry registry;
+			return registry;
+		}
+	}
+
+	RomData::Ptr RomData::fromFile(const std::string& _filename)
+	{
+		baseLib::filesystem::FileInfo fileInfo;
+
+		if (!baseLib::filesystem::getFileInfo(fileInfo, _filename))
+			return {};
+
+		auto& registry = getRegistry();
+
+		{
+			std::scoped_lock lock(registry.mutex);
+
+			const auto it = registry.byFile.find(_filename);
+
+			if (it != registry.byFile.end() && it->second.first == fileInfo)
+			{
+				if (auto existing = it->second.second.lock())
+					return existing;
+			}
+		}
+
+		std::shared_ptr<RomData> rom(new RomData());
+
+		if (!rom->m_file.open(_filename))
+			return {};
+
+		rom->m_begin = rom->m_file.data();
+		rom->m_size = rom->m_file.size();
+
+		// hashing a large image is not free, use the index if it knows the file already
+		RomIndex::Entry entry;
+
+		if (RomIndex::instance().get(entry, _filename) && entry.fileInfo.size == rom->m_size && entry.hash != baseLib::MD5())
+			rom->m_hash = entry.hash;
+		else
+			rom->m_hash = baseLib::MD5(rom->m_begin, static_cast<uint32_t>(rom->m_size));
+
+		auto result = share(std::move(rom));
+
+		std::scoped_lock lock(registry.mutex);
+		registry.byFile[_filename] = {fileInfo, result};
+
+		return result;
+	}
+
+	RomData::Ptr RomData::fromData(std::vector<uint8_t>&& _data)
+	{
+		std::shared_ptr<RomData> rom(new RomData());
+
+		rom->m_data = std::move(_data);
+		rom->m_begin = rom->m_data.data();
+		rom->m_size = rom->m_data.size();
+		rom->m_hash = baseLib::MD5(rom->m_data);
+
+		return share(std::move(rom));
+	}
+
+	RomData::Ptr RomData::share(std::shared_ptr<RomData>&& _rom)
+	{
+		auto& registry = getRegistry();
+
+		std::scoped_lock lock(registry.mutex);
+
+		auto& weak = registry.byHash[_rom->m_hash];
+
+		// an identical image is already in use, drop the new one and hand out the existing one instead
+		if (auto existing = weak.lock())
+			return existing;
+
+		// remove entries of images that are no longer in use
+		for (auto it = registry.byHash.begin(); it != registry.byHash.end();)
+		{
+			if (it->second.expired() && &it->second != &weak)
+				it = registry.byHash.erase(it);
+			else
+				++it;
+		}
+
+		for (auto it = registry.byFile.begin(); it != registry.byFile.end();)
+		{
+			if (it->second.second.expired())
+				it = registry.byFile.erase(it);
+			else
+				++it;
+		}
+
+		Ptr result = std::move(_rom);
+		weak = result;
+		return result;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "baseLib/mappedFile.h"
+#include "baseLib/md5.h"
+
+namespace synthLib
+{
+	// Immutable ROM image that is shared by all users in the process. Images that are used as stored on disk are memory
+	// mapped, images created from data are deduplicated by their content hash
+	class RomData
+	{
+	public:
+		using Ptr = std::shared_ptr<const RomData>;
+
+		RomData(const RomData&) = delete;
+		RomData(RomData&&) = delete;
+		RomData& operator = (const RomData&) = delete;
+		RomData& operator = (RomData&&) = delete;
+
+		~RomData() = default;
+
+		static Ptr fromFile(const std::string& _filename);
+		static Ptr fromData(std::vector<uint8_t>&& _data);
+
+		const uint8_t* data() const { return m_begin; }
+		size_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+
+		const uint8_t* begin() const { return m_begin; }
+		const uint8_t* end() const { return m_begin + m_size; }
+
+		uint8_t operator[](const size_t _index) const { return m_begin[_index]; }
+
+		const baseLib::MD5& getHash() const { return m_hash; }
+
+		std::vector<uint8_t> toVector() const { return {begin(), end()}; }
+
+	private:
+		RomData() = default;
+
+		static Ptr share(std::shared_ptr<RomData>&& _rom);
+
+		baseLib::MappedFile m_file;
+		std::vector<uint8_t> m_data;
+
+		const uint8_t* m_begin = nullptr;
+		size_t m_size = 0;
+
+		baseLib::MD5 m_hash;
+	};
+}
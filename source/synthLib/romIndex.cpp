@@ -0,0 +1,152 @@
+#include "romIndex.h"
+
+#include <stdexcept>
+
+#include "baseLib/binarystream.h"
+
+namespace synthLib
+{
+	namespace
+	{
+		constexpr char g_chunkId[] = "RIDX";
+		constexpr uint32_t g_chunkVersion = 1;
+	}
+
+	RomIndex::RomIndex()
+	{
+		const auto folder = baseLib::filesystem::getSpecialFolderPath(baseLib::filesystem::SpecialFolderType::PrivateAppData);
+
+		if (!folder.empty())
+			m_storageFile = baseLib::filesystem::validatePath(folder) + "The Usual Suspects/romIndex.bin";
+
+		load();
+	}
+
+	RomIndex& RomIndex::instance()
+	{
+		static RomIndex index;
+		return index;
+	}
+
+	void RomIndex::setStorageFile(const std::string& _filename)
+	{
+		std::scoped_lock lock(m_mutex);
+
+		if (m_storageFile == _filename)
+			return;
+
+		m_storageFile = _filename;
+		m_entries.clear();
+		m_dirty = false;
+
+		load();
+	}
+
+	bool RomIndex::get(Entry& _entry, const std::string& _filename)
+	{
+		baseLib::filesystem::FileInfo fileInfo;
+
+		if (!baseLib::filesystem::getFileInfo(fileInfo, _filename))
+			return false;
+
+		std::scoped_lock lock(m_mutex);
+
+		const auto it = m_entries.find(_filename);
+
+		if (it == m_entries.end() || it->second.fileInfo != fileInfo)
+			return false;
+
+		_entry = it->second;
+		return true;
+	}
+
+	void RomIndex::set(const std::string& _filename, const Entry& _entry)
+	{
+		std::scoped_lock lock(m_mutex);
+
+		auto& e = m_entries[_filename];
+
+		if (e.fileInfo == _entry.fileInfo && e.hash == _entry.hash && e.info == _entry.info)
+			return;
+
+		e = _entry;
+		m_dirty = true;
+	}
+
+	void RomIndex::save()
+	{
+		baseLib::BinaryStream s;
+		std::string filename;
+
+		{
+			std::scoped_lock lock(m_mutex);
+
+			if (!m_dirty || m_storageFile.empty())
+				return;
+
+			m_dirty = false;
+			filename = m_storageFile;
+
+			baseLib::ChunkWriter cw(s, g_chunkId, g_chunkVersion);
+
+			s.write(static_cast<uint32_t>(m_entries.size()));
+
+			for (const auto& [name, entry] : m_entries)
+			{
+				s.write(name);
+				s.write(entry.fileInfo.size);
+				s.write(entry.fileInfo.modificationTime);
+				s.write(entry.hash);
+				s.write(entry.info);
+			}
+		}
+
+		baseLib::filesystem::createDirectory(baseLib::filesystem::getPath(filename));
+
+		std::vector<uint8_t> data;
+		s.toVector(data);
+
+		baseLib::filesystem::writeFile(filename, data);
+	}
+
+	void RomIndex::load()
+	{
+		if (m_storageFile.empty() || !baseLib::filesystem::exists(m_storageFile))
+			return;
+
+		std::vector<uint8_t> data;
+
+		if (!baseLib::filesystem::readFile(data, m_storageFile))
+			return;
+
+		try
+		{
+			baseLib::BinaryStream inStream(data);
+
+			auto s = inStream.tryReadChunk(g_chunkId, g_chunkVersion);
+
+			if (!s)
+				return;
+
+			const auto count = s.read<uint32_t>();
+
+			for (uint32_t i=0; i<count; ++i)
+			{
+				const auto name = s.readString();
+
+				Entry e;
+				s.read(e.fileInfo.size);
+				s.read(e.fileInfo.modificationTime);
+				s.read(e.hash);
+				e.info = s.readString();
+
+				m_entries.insert({name, e});
+			}
+		}
+		catch (std::range_error&)
+		{
+			// a partially written index is discarded, it will be rebuilt
+			m_entries.clear();
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "baseLib/filesystem.h"
+#include "baseLib/md5.h"
+
+namespace synthLib
+{
+	// Persistent index of ROM candidates found during discovery. An entry stays valid as long as size and modification
+	// time of the file are unchanged, which allows to skip reading and analyzing files that have been seen before
+	class RomIndex
+	{
+	public:
+		struct Entry
+		{
+			baseLib::filesystem::FileInfo fileInfo;
+			baseLib::MD5 hash;
+			std::string info;	// result of the loader specific analysis, for example the detected model
+		};
+
+		static RomIndex& instance();
+
+		// an empty filename disables persistence, the index is kept in memory only
+		void setStorageFile(const std::string& _filename);
+
+		// returns false if the file is unknown or has been modified since it has been indexed
+		bool get(Entry& _entry, const std::string& _filename);
+
+		void set(const std::string& _filename, const Entry& _entry);
+
+		// writes the index to disk if it has been modified
+		void save();
+
+	private:
+		RomIndex();
+
+		void load();
+
+		std::mutex m_mutex;
+		std::map<std::string, Entry> m_entries;
+		std::string m_storageFile;
+		bool m_dirty = false;
+	};
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace synthLib
+{
+	// Lock-free state exchange between one writer (usually the audio thread) and any number of readers (usually the
+	// UI). The writer never waits, readers retry if they raced with a write.
+	// The sequence number only changes if the written state is different from the previous one, which allows readers to
+	// skip unchanged state without copying it
+	template<typename T>
+	class Seqlock
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "state needs to be trivially copyable");
+
+		static constexpr size_t WordCount = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+	public:
+		Seqlock()
+		{
+			for (auto& w : m_words)
+				w.store(0, std::memory_order_relaxed);
+		}
+
+		// returns false if the state did not change since the last write
+		bool write(const T& _state)
+		{
+			std::array<uint32_t, WordCount> words{};
+			::memcpy(words.data(), &_state, sizeof(T));
+
+			if(m_sequence.load(std::memory_order_relaxed) != 0 && words == m_lastWords)
+				return false;
+
+			m_lastWords = words;
+
+			const auto seq = m_sequence.load(std::memory_order_relaxed);
+
+			// odd sequence = write in progress
+			m_sequence.store(seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			for(size_t i=0; i<WordCount; ++i)
+				m_words[i].store(words[i], std::memory_order_relaxed);
+
+			m_sequence.store(seq + 2, std::memory_order_release);
+			return true;
+		}
+
+		// Copies the state if it changed since _sequence, which is updated. Start with a sequence of zero, which is
+		// never returned, to receive the first state that has been written
+		bool read(T& _state, uint32_t& _sequence) const
+		{
+			std::array<uint32_t, WordCount> words;
+
+			while(true)
+			{
+				const auto seqBegin = m_sequence.load(std::memory_order_acquire);
+
+				if(seqBegin == _sequence)
+					return false;
+
+				if(seqBegin & 1)
+					continue;
+
+				for(size_t i=0; i<WordCount; ++i)
+					words[i] = m_words[i].load(std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if(m_sequence.load(std::memory_order_relaxed) != seqBegin)
+					continue;
+
+				::memcpy(&_state, words.data(), sizeof(T));
+				_sequence = seqBegin;
+				return true;
+			}
+		}
+
+		uint32_t getSequence() const
+		{
+			return m_sequence.load(std::memory_order_acquire);
+		}
+
+	private:
+		std::atomic<uint32_t> m_sequence{0};
+		std::array<std::atomic<uint32_t>, WordCount> m_words;
+
+		// writer only
+		std::array<uint32_t, WordCount> m_lastWords{};
+	};
+}
@@ -0,0 +1,133 @@
+#include "sysexArena.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace synthLib::sysexArena
+{
+	namespace
+	{
+		constexpr uint32_t g_invalidIndex = 0xffffffff;
+
+		// Free list of fixed size blocks. The head stores the index of the first free block in the lower 32 bits and a
+		// counter that is bumped on every change in the upper 32 bits, which protects the CAS loops against ABA
+		class BlockPool
+		{
+		public:
+			BlockPool(const uint32_t _blockSize, const uint32_t _blockCount)
+				: m_blockSize(_blockSize)
+				, m_blockCount(_blockCount)
+				, m_storage(new uint8_t[static_cast<size_t>(_blockSize) * _blockCount])
+				, m_next(new std::atomic<uint32_t>[_blockCount])
+			{
+				for(uint32_t i=0; i<_blockCount; ++i)
+					m_next[i].store(i + 1 < _blockCount ? i + 1 : g_invalidIndex, std::memory_order_relaxed);
+
+				m_head.store(0, std::memory_order_release);
+			}
+
+			uint32_t getBlockSize() const { return m_blockSize; }
+
+			bool owns(const void* _ptr) const
+			{
+				const auto* p = static_cast<const uint8_t*>(_ptr);
+				return p >= m_storage.get() && p < m_storage.get() + static_cast<size_t>(m_blockSize) * m_blockCount;
+			}
+
+			void* pop()
+			{
+				uint64_t head = m_head.load(std::memory_order_acquire);
+
+				while(true)
+				{
+					const auto index = static_cast<uint32_t>(head);
+
+					if(index == g_invalidIndex)
+						return nullptr;
+
+					const uint64_t next = m_next[index].load(std::memory_order_relaxed);
+
+					if(m_head.compare_exchange_weak(head, nextTag(head) | next, std::memory_order_acq_rel, std::memory_order_acquire))
+						return m_storage.get() + static_cast<size_t>(index) * m_blockSize;
+				}
+			}
+
+			void push(void* _ptr)
+			{
+				const auto index = static_cast<uint32_t>((static_cast<uint8_t*>(_ptr) - m_storage.get()) / m_blockSize);
+
+				uint64_t head = m_head.load(std::memory_order_relaxed);
+
+				do
+				{
+					m_next[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+				}
+				while(!m_head.compare_exchange_weak(head, nextTag(head) | index, std::memory_order_release, std::memory_order_relaxed));
+			}
+
+		private:
+			static uint64_t nextTag(const uint64_t _head)
+			{
+				return ((_head >> 32) + 1) << 32;
+			}
+
+			const uint32_t m_blockSize;
+			const uint32_t m_blockCount;
+			const std::unique_ptr<uint8_t[]> m_storage;
+			const std::unique_ptr<std::atomic<uint32_t>[]> m_next;
+			std::atomic<uint64_t> m_head{static_cast<uint64_t>(g_invalidIndex)};
+		};
+
+		struct Arena
+		{
+			// short messages, single and multi dumps, bank chunks. 576 KiB in total
+			std::array<BlockPool, 3> pools
+			{
+				BlockPool(64, 1024),
+				BlockPool(1024, 256),
+				BlockPool(16384, 16)
+			};
+		};
+
+		Arena& getArena()
+		{
+			// intentionally leaked, events with static storage duration may outlive a function-local static arena
+			static auto* arena = new Arena();
+			return *arena;
+		}
+	}
+
+	void* allocate(const size_t _size)
+	{
+		for (auto& pool : getArena().pools)
+		{
+			if(_size > pool.getBlockSize())
+				continue;
+
+			if(auto* p = pool.pop())
+				return p;
+		}
+
+		return ::operator new(_size);
+	}
+
+	void deallocate(void* _ptr) noexcept
+	{
+		if(!_ptr)
+			return;
+
+		for (auto& pool : getArena().pools)
+		{
+			if(pool.owns(_ptr))
+			{
+				pool.push(_ptr);
+				return;
+			}
+		}
+
+		::operator delete(_ptr);
+	}
+}
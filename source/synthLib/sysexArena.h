@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+namespace synthLib
+{
+	// Backing storage of sysex buffers. Buffers up to a few KiB are carved from preallocated fixed size blocks that are
+	// recycled via lock-free free lists, so that events carrying sysex can be created, copied and destroyed on the
+	// audio thread without locking or calling into the heap. Larger buffers, or all of them once a size class has run
+	// dry, fall back to the heap
+	namespace sysexArena
+	{
+		void* allocate(size_t _size);
+		void deallocate(void* _ptr) noexcept;
+	}
+
+	// Stateless, all instances are interchangeable. Buffers can be swapped and moved between each other freely
+	template<typename T> struct SysexAllocator
+	{
+		using value_type = T;
+
+		SysexAllocator() noexcept = default;
+		template<typename U> SysexAllocator(const SysexAllocator<U>&) noexcept {}
+
+		T* allocate(const size_t _count)
+		{
+			return static_cast<T*>(sysexArena::allocate(_count * sizeof(T)));
+		}
+
+		void deallocate(T* _ptr, size_t) noexcept
+		{
+			sysexArena::deallocate(_ptr);
+		}
+
+		template<typename U> bool operator == (const SysexAllocator<U>&) const noexcept { return true; }
+		template<typename U> bool operator != (const SysexAllocator<U>&) const noexcept { return false; }
+	};
+}
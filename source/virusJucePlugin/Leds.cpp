@@ -11,7 +11,7 @@ namespace genericVirusUI
 
 	constexpr const char* g_lfoNames[3] = {"Lfo1LedOn", "Lfo2LedOn", "Lfo3LedOn"};
 
-	Leds::Leds(const VirusEditor& _editor, virus::VirusProcessor& _processor) : m_processor(_processor), m_logoAnimationEnabled(_processor.getConfig().getBoolValue(g_logoAnimKey, true))
+	Leds::Leds(const VirusEditor& _editor, virus::VirusProcessor& _processor) : m_editor(_editor), m_processor(_processor), m_logoAnimationEnabled(_processor.getConfig().getBoolValue(g_logoAnimKey, true))
 	{
 		m_onFrontPanelStateChanged.set(_editor.getController().onFrontPanelStateChanged, [this](const virusLib::FrontpanelState& _frontpanelState)
 		{
@@ -43,6 +43,8 @@ namespace genericVirusUI
 		}
 
 		onFrontPanelStateChanged(_editor.getController().getFrontpanelState());
+
+		startTimer(1000/60);
 	}
 
 	Leds::~Leds()
@@ -59,6 +61,12 @@ namespace genericVirusUI
 		m_processor.getConfig().saveIfNeeded();
 	}
 
+	void Leds::timerCallback()
+	{
+		// local devices do not send the front panel state, it needs to be polled
+		m_editor.getController().updateFrontpanelState();
+	}
+
 	void Leds::onFrontPanelStateChanged(const virusLib::FrontpanelState& _frontpanelState) const
 	{
 		for(size_t i=0; i<_frontpanelState.m_lfoPhases.size(); ++i)
@@ -9,6 +9,8 @@
 
 #include "virusLib/frontpanelState.h"
 
+#include "juce_events/juce_events.h"	// juce:Timer
+
 namespace juce
 {
 	class MouseListener;
@@ -28,11 +30,11 @@ namespace genericVirusUI
 {
 	class VirusEditor;
 
-	class Leds
+	class Leds : juce::Timer
 	{
 	public:
 		Leds(const VirusEditor& _editor, virus::VirusProcessor& _processor);
-		~Leds();
+		~Leds() override;
 
 		void toggleLogoAnimation();
 
@@ -40,9 +42,11 @@ namespace genericVirusUI
 		bool isLogoAnimationEnabled() const { return m_logoAnimationEnabled; }
 
 	private:
+		void timerCallback() override;
 		void onFrontPanelStateChanged(const virusLib::FrontpanelState& _frontpanelState) const;
 		void addLogoClickListener(Rml::Element* _logo);
 
+		const VirusEditor& m_editor;
 		virus::VirusProcessor& m_processor;
 		bool m_logoAnimationEnabled = true;
 
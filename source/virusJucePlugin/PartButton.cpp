@@ -37,7 +37,7 @@ namespace genericVirusUI
 			const auto patches = pm->loadPatchesFromFiles(std::vector<std::string>{_files.front()});
 			if (!patches.empty())
 			{
-				const auto type = PatchManager::detectPatchType(patches.front()->sysex);
+				const auto type = PatchManager::detectPatchType(patches.front()->getSysex());
 				if (type == PatchManager::PatchType::Multi || type == PatchManager::PatchType::Arrangement)
 				{
 					const auto& name = m_editor.getProcessor().getProperties().name;
@@ -328,7 +328,7 @@ namespace genericVirusUI
 			patch->tags.add(pluginLib::patchDB::TagType::CustomC,
 				patchType == PatchType::Arrangement ? "Arrangement" : "Multi");
 
-			patch->sysex = std::move(_sysex);
+			patch->setSysex(std::move(_sysex));
 			return patch;
 		}
 
@@ -374,7 +374,7 @@ namespace genericVirusUI
 			memcpy(patch->hash.data(), md5.getChecksumDataArray(), std::size(patch->hash));
 		}
 
-		patch->sysex = std::move(_sysex);
+		patch->setSysex(std::move(_sysex));
 
 		patch->name = m_controller.getSinglePresetName(parameterValues);
 
@@ -432,10 +432,10 @@ namespace genericVirusUI
 
 	pluginLib::patchDB::Data PatchManager::applyModificationsSingle(const pluginLib::patchDB::PatchPtr& _patch) const
 	{
-		if (_patch->sysex.size() < 267)
-			return _patch->sysex;
+		if (_patch->getSysex().size() < 267)
+			return _patch->getSysex();
 
-		auto result = _patch->sysex;
+		auto result = _patch->getSysex();
 
 		// apply name
 		if (!_patch->getName().empty())
@@ -532,13 +532,13 @@ namespace genericVirusUI
 
 	pluginLib::patchDB::Data PatchManager::applyModifications(const pluginLib::patchDB::PatchPtr& _patch, const pluginLib::FileType& _fileType, pluginLib::ExportType _exportType) const
 	{
-		const auto patchType = detectPatchType(_patch->sysex);
+		const auto patchType = detectPatchType(_patch->getSysex());
 
 		if (patchType == PatchType::Single)
 			return applyModificationsSingle(_patch);
 
 		if (patchType == PatchType::Multi)
-			return applyModificationsMulti(_patch->sysex, _patch);
+			return applyModificationsMulti(_patch->getSysex(), _patch);
 
 		if (patchType == PatchType::Arrangement)
 		{
@@ -546,10 +546,10 @@ namespace genericVirusUI
 			// follow carry their own names/bank/program — they get sent into
 			// parts on activation so they keep their original identifiers.
 			synthLib::SysexBufferList msgs;
-			synthLib::MidiToSysex::splitMultipleSysex(msgs, _patch->sysex);
+			synthLib::MidiToSysex::splitMultipleSysex(msgs, _patch->getSysex());
 
 			if (msgs.size() != 17 || msgs.front()[6] != virusLib::SysexMessageType::DUMP_MULTI)
-				return _patch->sysex;
+				return _patch->getSysex();
 
 			auto multi = applyModificationsMulti(pluginLib::patchDB::Data(msgs.front().begin(), msgs.front().end()), _patch);
 
@@ -559,7 +559,7 @@ namespace genericVirusUI
 			return result;
 		}
 
-		return _patch->sysex;
+		return _patch->getSysex();
 	}
 
 	bool PatchManager::parseFileData(pluginLib::patchDB::DataList& _results, const pluginLib::patchDB::Data& _data, const std::string& _filename)
@@ -792,7 +792,7 @@ namespace genericVirusUI
 		pluginLib::MidiPacket::Data dataA, dataB;
 		pluginLib::MidiPacket::AnyPartParamValues parameterValuesA, parameterValuesB;
 
-		if (!m_controller.parseSingle(dataA, parameterValuesA, _a->sysex) || !m_controller.parseSingle(dataB, parameterValuesB, _b->sysex))
+		if (!m_controller.parseSingle(dataA, parameterValuesA, _a->getSysex()) || !m_controller.parseSingle(dataB, parameterValuesB, _b->getSysex()))
 			return false;
 
 		if(parameterValuesA.size() != parameterValuesB.size())
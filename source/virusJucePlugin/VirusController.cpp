@@ -125,6 +125,17 @@ namespace virus
 		return false;
     }
 
+	bool Controller::updateFrontpanelState()
+	{
+		const auto& telemetry = m_processor.getFrontpanelTelemetry();
+
+		if(!telemetry || !telemetry->read(m_frontpanelState, m_frontpanelTelemetryReader))
+			return false;
+
+		onFrontPanelStateChanged(m_frontpanelState);
+		return true;
+	}
+
     bool Controller::parseControllerMessage(const synthLib::SMidiEvent& e)
     {
 		return parseControllerDump(e);
@@ -6,6 +6,7 @@
 #include "baseLib/event.h"
 
 #include "virusLib/frontpanelState.h"
+#include "virusLib/frontpanelTelemetry.h"
 #include "virusLib/microcontrollerTypes.h"
 #include "virusLib/romfile.h"
 
@@ -174,6 +175,9 @@ namespace virus
 
 		const auto& getFrontpanelState() const { return m_frontpanelState; }
 
+		// reads the front panel state of a local device, needs to be called periodically
+		bool updateFrontpanelState();
+
 		std::vector<uint8_t> getPartsForMidiChannel(uint8_t _channel) override;
 
     private:
@@ -199,5 +203,6 @@ namespace virus
         PresetSource m_currentPresetSource[16]{PresetSource::Unknown};
 		baseLib::EventListener<const virusLib::ROMFile*> m_onRomChanged;
         virusLib::FrontpanelState m_frontpanelState;
+		virusLib::FrontpanelTelemetry::Reader m_frontpanelTelemetryReader;
     };
 }; // namespace Virus
@@ -89,7 +89,9 @@ namespace virus
 	{
 		synthLib::DeviceCreateParams p;
 		getRemoteDeviceParams(p);
-		return new virusLib::Device(p, true);
+		auto* device = new virusLib::Device(p, true);
+		device->setFrontpanelTelemetry(m_frontpanelTelemetry);
+		return device;
 	}
 
 	void VirusProcessor::getRemoteDeviceParams(synthLib::DeviceCreateParams& _params) const
@@ -106,7 +108,7 @@ namespace virus
 		}
 
 		_params.romName = rom->getFilename();
-		_params.romData = rom->getRomFileData();
+		_params.romData = rom->getRomFileData()->toVector();
 		_params.customData = static_cast<uint32_t>(rom->getModel());
 	}
 
@@ -51,6 +51,8 @@ namespace virus
 		    return getModel() == virusLib::DeviceModel::Snow ? 4 : 16;
 	    }
 
+		const auto& getFrontpanelTelemetry() const { return m_frontpanelTelemetry; }
+
 	protected:
 	    void postConstruct(std::vector<virusLib::ROMFile>&& _roms);
 
@@ -77,6 +79,9 @@ namespace virus
 
 		uint32_t							m_clockTempoParam = 0xffffffff;
 
+		// shared with local devices, remote devices send the front panel state as sysex
+		std::shared_ptr<virusLib::FrontpanelTelemetry> m_frontpanelTelemetry = std::make_shared<virusLib::FrontpanelTelemetry>();
+
 	public:
 	    baseLib::Event<const virusLib::ROMFile*> evRomChanged;
 	};
@@ -19,7 +19,7 @@ namespace virusLib
 {
 	Device::Device(const synthLib::DeviceCreateParams& _params, const bool _createDebugger/* = false*/)
 		: synthLib::Device(_params)
-		, m_rom(_params.romData, _params.romName, static_cast<DeviceModel>(_params.customData))
+		, m_rom(_params.getRom(), _params.romName, static_cast<DeviceModel>(_params.customData))
 		, m_samplerate(getDeviceSamplerate(_params.preferredSamplerate, _params.hostSamplerate))
 	{
 		m_frontpanelStateMidiEvent.source = synthLib::MidiEventSource::Internal;
@@ -141,7 +141,7 @@ namespace virusLib
 		return m_rom.isValid();
 	}
 
-	void Device::process(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, size_t _size, const std::vector<synthLib::SMidiEvent>& _midiIn, std::vector<synthLib::SMidiEvent>& _midiOut)
+	void Device::process(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, size_t _size, std::vector<synthLib::SMidiEvent>& _midiIn, std::vector<synthLib::SMidiEvent>& _midiOut)
 	{
 		m_frontpanelStateDSP.clear();
 
@@ -179,8 +179,15 @@ namespace virusLib
 
 		m_numSamplesProcessed += static_cast<uint32_t>(_size);
 
-		m_frontpanelStateDSP.toMidiEvent(m_frontpanelStateMidiEvent);
-		_midiOut.push_back(m_frontpanelStateMidiEvent);
+		if(m_frontpanelTelemetry)
+		{
+			m_frontpanelTelemetry->write(m_frontpanelStateDSP);
+		}
+		else
+		{
+			m_frontpanelStateDSP.toMidiEvent(m_frontpanelStateMidiEvent);
+			_midiOut.push_back(m_frontpanelStateMidiEvent);
+		}
 	}
 
 #if !SYNTHLIB_DEMO_MODE
@@ -2,6 +2,7 @@
 
 #include "dspSingle.h"
 #include "frontpanelState.h"
+#include "frontpanelTelemetry.h"
 #include "synthLib/midiTypes.h"
 #include "synthLib/device.h"
 
@@ -29,7 +30,7 @@ namespace virusLib
 
 		bool isValid() const override;
 
-		void process(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, size_t _size, const std::vector<synthLib::SMidiEvent>& _midiIn, std::vector<synthLib::SMidiEvent>& _midiOut) override;
+		void process(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, size_t _size, std::vector<synthLib::SMidiEvent>& _midiIn, std::vector<synthLib::SMidiEvent>& _midiOut) override;
 
 #if !SYNTHLIB_DEMO_MODE
 		bool getState(std::vector<uint8_t>& _state, synthLib::StateType _type) override;
@@ -60,6 +61,9 @@ namespace virusLib
 		static void applyDspMemoryPatches(const DspSingle* _dspA, const DspSingle* _dspB, const ROMFile& _rom);
 		void applyDspMemoryPatches() const;
 
+		// if set, the front panel state is written to the telemetry instead of being sent as sysex
+		void setFrontpanelTelemetry(std::shared_ptr<FrontpanelTelemetry> _telemetry) { m_frontpanelTelemetry = std::move(_telemetry); }
+
 	private:
 		bool sendMidi(const synthLib::SMidiEvent& _ev, std::vector<synthLib::SMidiEvent>& _response) override;
 		void readMidiOut(std::vector<synthLib::SMidiEvent>& _midiOut) override;
@@ -77,5 +81,6 @@ namespace virusLib
 		float m_samplerate;
 		FrontpanelState m_frontpanelStateDSP;
 		synthLib::SMidiEvent m_frontpanelStateMidiEvent;
+		std::shared_ptr<FrontpanelTelemetry> m_frontpanelTelemetry;
 	};
 }
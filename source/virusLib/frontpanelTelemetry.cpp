@@ -0,0 +1,40 @@
+#include "frontpanelTelemetry.h"
+
+#include "frontpanelState.h"
+
+namespace virusLib
+{
+	void FrontpanelTelemetry::write(const FrontpanelState& _state)
+	{
+		for(size_t i=0; i<m_state.midiEventCounts.size(); ++i)
+		{
+			if(_state.m_midiEventReceived[i])
+				++m_state.midiEventCounts[i];
+		}
+
+		m_state.lfoPhases = _state.m_lfoPhases;
+		m_state.logo = _state.m_logo;
+		m_state.bpm = _state.m_bpm;
+
+		m_seqlock.write(m_state);
+	}
+
+	bool FrontpanelTelemetry::read(FrontpanelState& _state, Reader& _reader) const
+	{
+		State state;
+
+		if(!m_seqlock.read(state, _reader.sequence))
+			return false;
+
+		for(size_t i=0; i<state.midiEventCounts.size(); ++i)
+			_state.m_midiEventReceived[i] = state.midiEventCounts[i] != _reader.midiEventCounts[i];
+
+		_reader.midiEventCounts = state.midiEventCounts;
+
+		_state.m_lfoPhases = state.lfoPhases;
+		_state.m_logo = state.logo;
+		_state.m_bpm = state.bpm;
+
+		return true;
+	}
+}
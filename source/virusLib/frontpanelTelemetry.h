@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "synthLib/seqlock.h"
+
+namespace virusLib
+{
+	struct FrontpanelState;
+
+	// Hands the front panel state of a local device to the editor. Devices that have no telemetry send the state as
+	// sysex instead, which is what remote devices do
+	class FrontpanelTelemetry
+	{
+	public:
+		struct Reader
+		{
+			uint32_t sequence = 0;
+			std::array<uint32_t, 16> midiEventCounts{};
+		};
+
+		// called by the device once per block
+		void write(const FrontpanelState& _state);
+
+		// returns false if the state did not change since the last read with the same reader
+		bool read(FrontpanelState& _state, Reader& _reader) const;
+
+	private:
+		struct State
+		{
+			// number of blocks in which MIDI has been received on each channel. A counter instead of a flag so that
+			// readers that poll less often than blocks are processed do not miss any events
+			std::array<uint32_t, 16> midiEventCounts;
+			std::array<float, 3> lfoPhases;
+			float logo;
+			float bpm;
+		};
+
+		State m_state{};
+		synthLib::Seqlock<State> m_seqlock;
+	};
+}
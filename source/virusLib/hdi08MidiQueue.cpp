@@ -40,7 +40,13 @@ namespace virusLib
 
 	void Hdi08MidiQueue::add(const synthLib::SMidiEvent& ev)
 	{
-		m_pendingMidiEvents.push_back(ev);
+		// only the short message is sent to the DSP, leave the sysex payload behind
+		add(synthLib::SMidiEvent(ev.source, ev.a, ev.b, ev.c, ev.offset));
+	}
+
+	void Hdi08MidiQueue::add(synthLib::SMidiEvent&& ev)
+	{
+		m_pendingMidiEvents.push_back(std::move(ev));
 	}
 
 	void Hdi08MidiQueue::sendMidiToDSP(uint8_t _a, const uint8_t _b, const uint8_t _c) const
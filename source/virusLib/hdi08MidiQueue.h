@@ -33,6 +33,7 @@ namespace virusLib
 		void sendPendingMidiEvents(uint32_t _maxOffset);
 
 		void add(const synthLib::SMidiEvent& ev);
+		void add(synthLib::SMidiEvent&& ev);
 
 		void onAudioWritten();
 
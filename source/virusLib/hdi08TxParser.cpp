@@ -163,8 +163,9 @@ namespace virusLib
 					}
 
 					synthLib::SMidiEvent ev(synthLib::MidiEventSource::Device);
-					std::swap(ev.sysex, m_sysexData);
-					m_midiData.emplace_back(ev);
+					ev.sysex = std::move(m_sysexData);
+					m_sysexData.clear();
+					m_midiData.emplace_back(std::move(ev));
 
 					return true;
 				}
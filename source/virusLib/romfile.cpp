@@ -17,22 +17,35 @@
 namespace virusLib
 {
 
-ROMFile::ROMFile(std::vector<uint8_t> _data, std::string _name, const DeviceModel _model/* = DeviceModel::ABC*/) : m_model(_model), m_romFileName(std::move(_name)), m_romFileData(std::move(_data))
+ROMFile::ROMFile(std::vector<uint8_t> _data, std::string _name, const DeviceModel _model/* = DeviceModel::ABC*/)
+	: ROMFile(_data.empty() ? synthLib::RomData::Ptr() : synthLib::RomData::fromData(std::move(_data)), std::move(_name), _model)
 {
-	if(initialize())
+}
+
+ROMFile::ROMFile(synthLib::RomData::Ptr _data, std::string _name, const DeviceModel _model/* = DeviceModel::ABC*/) : m_model(_model), m_romFileName(std::move(_name)), m_romFileData(std::move(_data))
+{
+	if(m_romFileData && initialize())
+	{
+		m_romDataHash = m_romFileData->getHash();
 		return;
-	m_romFileData.clear();
+	}
+	m_romFileData.reset();
 	m_bootRom.size = 0;
 }
 
+ROMFile::ROMFile(Loader _loader, std::string _name, const DeviceModel _model) : m_model(_model), m_romFileName(std::move(_name)), m_deferred(std::make_shared<Deferred>())
+{
+	m_deferred->loader = std::move(_loader);
+}
+
 ROMFile ROMFile::invalid()
 {
-	return ROMFile({}, {}, DeviceModel::Invalid);
+	return ROMFile(synthLib::RomData::Ptr(), {}, DeviceModel::Invalid);
 }
 
 bool ROMFile::initialize()
 {
-	std::unique_ptr<std::istream> dsp(new imemstream(reinterpret_cast<std::vector<char>&>(m_romFileData)));
+	std::unique_ptr<std::istream> dsp(new imemstream(m_romFileData->data(), m_romFileData->size()));
 
 	ROMUnpacker::Firmware fw;
 
@@ -138,7 +151,7 @@ bool ROMFile::initialize()
 		//load presets in a fixed order, TI first, Snow last
 		auto loadFirmwarePresets = [this](const DeviceModel _model)
 		{
-			const std::unique_ptr<imemstream> file(new imemstream(reinterpret_cast<std::vector<char>&>(m_romFileData)));
+			const std::unique_ptr<imemstream> file(new imemstream(m_romFileData->data(), m_romFileData->size()));
 			const auto firmware = ROMUnpacker::getFirmware(*file, _model);
 			if(!firmware.Presets.empty())
 			{
@@ -322,8 +335,28 @@ bool ROMFile::loadPresetFile(std::istream& _file, DeviceModel _model)
 	return true;
 }
 
+const ROMFile& ROMFile::get() const
+{
+	if(!m_deferred)
+		return *this;
+
+	std::call_once(m_deferred->once, [this]
+	{
+		m_deferred->rom.reset(new ROMFile(m_deferred->loader(), m_romFileName, m_model));
+		m_deferred->loader = {};
+
+		if(!m_deferred->rom->isValid())
+			LOG("Failed to load ROM " << m_romFileName);
+	});
+
+	return *m_deferred->rom;
+}
+
 std::thread ROMFile::bootDSP(DspSingle& _dsp) const
 {
+	if(m_deferred)
+		return get().bootDSP(_dsp);
+
 	return _dsp.boot(m_bootRom, m_commandStream);
 }
 
@@ -334,6 +367,9 @@ std::string ROMFile::getModelName() const
 
 bool ROMFile::getSingle(const int _bank, const int _presetNumber, TPreset& _out) const
 {
+	if(m_deferred)
+		return get().getSingle(_bank, _presetNumber, _out);
+
 	if(isTIFamily())
 	{
 		const auto offset = _bank * getSinglesPerBank() + _presetNumber;
@@ -350,6 +386,9 @@ bool ROMFile::getSingle(const int _bank, const int _presetNumber, TPreset& _out)
 
 bool ROMFile::getMulti(const int _presetNumber, TPreset& _out) const
 {
+	if(m_deferred)
+		return get().getMulti(_presetNumber, _out);
+
 	if(isTIFamily())
 	{
 		if (_presetNumber >= m_multis.size())
@@ -364,10 +403,13 @@ bool ROMFile::getMulti(const int _presetNumber, TPreset& _out) const
 
 bool ROMFile::getPreset(const uint32_t _offset, TPreset& _out) const
 {
-	if(_offset + getSinglePresetSize() > m_romFileData.size())
+	if(m_deferred)
+		return get().getPreset(_offset, _out);
+
+	if(!m_romFileData || _offset + getSinglePresetSize() > m_romFileData->size())
 		return false;
 
-	memcpy(_out.data(), &m_romFileData[_offset], getSinglePresetSize());
+	memcpy(_out.data(), m_romFileData->data() + _offset, getSinglePresetSize());
 	return true;
 }
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <string>
@@ -8,6 +11,8 @@
 
 #include "baseLib/md5.h"
 
+#include "synthLib/romData.h"
+
 #include "deviceModel.h"
 
 namespace dsp56k
@@ -40,7 +45,13 @@ public:
 
 	using TPreset = std::array<uint8_t, 512>;
 
+	using Loader = std::function<synthLib::RomData::Ptr()>;
+
 	explicit ROMFile(std::vector<uint8_t> _data, std::string _name, DeviceModel _model = DeviceModel::ABC);
+	explicit ROMFile(synthLib::RomData::Ptr _data, std::string _name, DeviceModel _model = DeviceModel::ABC);
+
+	// Name and model are known upfront, the ROM data is loaded and parsed on first access
+	explicit ROMFile(Loader _loader, std::string _name, DeviceModel _model);
 
 	static ROMFile invalid();
 
@@ -54,7 +65,7 @@ public:
 
 	std::thread bootDSP(DspSingle& _dsp) const;
 
-	bool isValid() const { return m_bootRom.size > 0; }
+	bool isValid() const { return get().m_bootRom.size > 0; }
 
 	DeviceModel getModel() const { return m_model; }
 
@@ -116,19 +127,31 @@ public:
 	uint32_t getNumSingleBanks() const
 	{
 		if (isTIFamily())
-			return static_cast<uint32_t>(m_singles.size() / getSinglesPerBank());
+			return static_cast<uint32_t>(get().m_singles.size() / getSinglesPerBank());
 		return getRomBankCount(m_model);
 	}
 
-	const std::vector<uint8_t>& getDemoData() const { return m_demoData; }
+	const std::vector<uint8_t>& getDemoData() const { return get().m_demoData; }
 
-	std::string getFilename() const { return isValid() ? m_romFileName : std::string(); }
+	// does not load a deferred ROM, it has been validated when it was added to the ROM index
+	std::string getFilename() const { return m_deferred || isValid() ? m_romFileName : std::string(); }
 
-	const auto& getHash() const { return m_romDataHash; }
+	const auto& getHash() const { return get().m_romDataHash; }
 
-	const auto& getRomFileData() const { return m_romFileData; }
+	// shared with all other ROMFile instances of the same image
+	const synthLib::RomData::Ptr& getRomFileData() const { return get().m_romFileData; }
 
 private:
+	struct Deferred
+	{
+		Loader loader;
+		std::once_flag once;
+		std::unique_ptr<ROMFile> rom;
+	};
+
+	// returns this instance or, if deferred, the loaded ROM
+	const ROMFile& get() const;
+
 	std::vector<Chunk> readChunks(std::istream& _file) const;
 	bool loadPresetFiles();
 	bool loadPresetFile(std::istream& _file, DeviceModel _model);
@@ -145,8 +168,10 @@ private:
 	std::vector<uint8_t> m_demoData;
 
 	std::string m_romFileName;
-	std::vector<uint8_t> m_romFileData;
+	synthLib::RomData::Ptr m_romFileData;
 	baseLib::MD5 m_romDataHash;
+
+	std::shared_ptr<Deferred> m_deferred;
 };
 
 }
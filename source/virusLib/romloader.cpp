@@ -1,11 +1,14 @@
 #include "romloader.h"
 
 #include <algorithm>
+#include <sstream>
 
 #include "midiFileToRomData.h"
 
 #include "baseLib/filesystem.h"
 
+#include "synthLib/romIndex.h"
+
 namespace virusLib
 {
 	static constexpr uint32_t g_midiSizeMinABC = 500 * 1024;
@@ -14,6 +17,11 @@ namespace virusLib
 	static constexpr uint32_t g_binSizeTImin = 6 * 1024 * 1024;
 	static constexpr uint32_t g_binSizeTImax = 9 * 1024 * 1024;
 
+	// ROM index info of files that are not a usable ROM, they are skipped without reading them again
+	static constexpr char g_indexInfoInvalid[] = "invalid";
+	// ROM index info of usable files: "rom <type> <model> <decoded size>", they are not read until a ROM is used
+	static constexpr char g_indexInfoRom[] = "rom";
+
 	std::vector<ROMFile> ROMLoader::findROMs(const DeviceModel _model/* = DeviceModel::ABC*/)
 	{
 		return findROMs(std::string(), _model);
@@ -80,52 +88,99 @@ namespace virusLib
 		return ROMFile::invalid();
 	}
 
-	ROMLoader::FileData ROMLoader::loadFile(const std::string& _name)
+	bool ROMLoader::loadFile(FileData& _data, const std::string& _name)
 	{
-		FileData data;
-		data.filename = _name;
-
-		if(!baseLib::filesystem::readFile(data.data, _name))
-			return {};
+		_data.filename = _name;
+		_data.type = Invalid;
+		_data.data.reset();
+		_data.size = 0;
 
 		if(baseLib::filesystem::hasExtension(_name, ".bin"))
 		{
-			data.type = BinaryRom;
-			return data;
+			// used as-is, map it instead of reading it
+			_data.data = synthLib::RomData::fromFile(_name);
+			if(!_data.data)
+				return false;
+			_data.type = BinaryRom;
+			_data.size = _data.data->size();
+			return true;
 		}
 
 		if(!baseLib::filesystem::hasExtension(_name, ".mid"))
-			return {};
+			return true;
+
+		std::vector<uint8_t> fileData;
+		if(!baseLib::filesystem::readFile(fileData, _name))
+			return false;
 
 		MidiFileToRomData midiLoader;
-		if(!midiLoader.load(data.data, true))
-			return {};
+		if(!midiLoader.load(fileData, true))
+			return true;
 
-		data.data = midiLoader.getData();
+		auto romData = midiLoader.getData();
 
-		if(data.data.size() != (ROMFile::getRomSizeModelABC()>>1))
+		if(romData.size() != (ROMFile::getRomSizeModelABC()>>1))
 		{
-			if(data.data.size() == 0x38000)
+			if(romData.size() == 0x38000)
 			{
 				// Virus A midi OS update has $2000 less than all others
-				data.data.resize(ROMFile::getRomSizeModelABC()>>1, 0xff);
+				romData.resize(ROMFile::getRomSizeModelABC()>>1, 0xff);
 			}
 			else
 			{
-				return {};
+				return true;
 			}
 		}
 
+		FileType type;
+
 		if(midiLoader.getFirstSector() == 0)
-			data.type = MidiRom;
+			type = MidiRom;
 		else if(midiLoader.getFirstSector() == 8)
-			data.type = MidiPresets;
+			type = MidiPresets;
 		else
+			return true;
+
+		_data.data = synthLib::RomData::fromData(std::move(romData));
+		_data.size = _data.data->size();
+		_data.type = type;
+		return true;
+	}
+
+	synthLib::RomData::Ptr ROMLoader::getData(const FileData& _file)
+	{
+		if(_file.data)
+			return _file.data;
+
+		FileData fd;
+
+		// the file may have been replaced after it has been indexed
+		if(!loadFile(fd, _file.filename) || fd.type != _file.type || fd.size != _file.size)
 			return {};
-		return data;
+
+		return fd.data;
+	}
+
+	ROMFile::Loader ROMLoader::createLoader(const FileData& _rom, const FileData* _presets)
+	{
+		if(!_presets)
+			return [rom = _rom] { return getData(rom); };
+
+		return [rom = _rom, presets = *_presets]() -> synthLib::RomData::Ptr
+		{
+			const auto romData = getData(rom);
+			const auto presetData = getData(presets);
+
+			if(!romData || !presetData)
+				return {};
+
+			auto data = romData->toVector();
+			data.insert(data.end(), presetData->begin(), presetData->end());
+			return synthLib::RomData::fromData(std::move(data));
+		};
 	}
 
-	DeviceModel ROMLoader::detectModel(const std::vector<uint8_t>& _data)
+	DeviceModel ROMLoader::detectModel(const synthLib::RomData& _data)
 	{
 		// examples
 		// A: (C)ACCESS [08-20-2001-16:58:54][v280g]
@@ -167,6 +222,59 @@ namespace virusLib
 		return DeviceModel::Invalid;
 	}
 
+	void ROMLoader::addToIndex(const FileData& _file, const DeviceModel _model)
+	{
+		synthLib::RomIndex::Entry entry;
+
+		if(!baseLib::filesystem::getFileInfo(entry.fileInfo, _file.filename))
+			return;
+
+		// the hash describes the file contents, midi files are decoded before they are used
+		if(_file.type == BinaryRom && _file.data)
+			entry.hash = _file.data->getHash();
+
+		std::stringstream ss;
+		ss << g_indexInfoRom << ' ' << static_cast<int>(_file.type) << ' ' << static_cast<int>(_model) << ' ' << _file.size;
+		entry.info = ss.str();
+
+		synthLib::RomIndex::instance().set(_file.filename, entry);
+	}
+
+	void ROMLoader::addInvalidToIndex(const std::string& _filename)
+	{
+		synthLib::RomIndex::Entry entry;
+
+		if(!baseLib::filesystem::getFileInfo(entry.fileInfo, _filename))
+			return;
+
+		entry.info = g_indexInfoInvalid;
+
+		synthLib::RomIndex::instance().set(_filename, entry);
+	}
+
+	bool ROMLoader::readIndex(FileData& _file, const std::string& _info)
+	{
+		std::stringstream ss(_info);
+
+		std::string key;
+		int type = Invalid;
+		int model = static_cast<int>(DeviceModel::Invalid);
+		size_t size = 0;
+
+		ss >> key >> type >> model >> size;
+
+		if(ss.fail() || key != g_indexInfoRom || size == 0)
+			return false;
+
+		if(type != BinaryRom && type != MidiRom && type != MidiPresets)
+			return false;
+
+		_file.type = static_cast<FileType>(type);
+		_file.size = size;
+		_file.indexedModel = static_cast<DeviceModel>(model);
+		return true;
+	}
+
 	std::vector<ROMFile> ROMLoader::initializeRoms(const std::vector<std::string>& _files, const DeviceModel _model)
 	{
 		if(_files.empty())
@@ -175,17 +283,47 @@ namespace virusLib
 		std::vector<FileData> fileDatas;
 		fileDatas.reserve(_files.size());
 
+		auto& index = synthLib::RomIndex::instance();
+
 		for (const auto& file : _files)
 		{
-			auto data = loadFile(file);
-			if(!data.isValid())
+			synthLib::RomIndex::Entry entry;
+			const auto isIndexed = index.get(entry, file);
+
+			if(isIndexed && entry.info == g_indexInfoInvalid)
 				continue;
 
+			FileData data;
+			data.filename = file;
+
+			// classified before, the file is not read until the ROM is used
+			if(isIndexed && readIndex(data, entry.info))
+			{
+				fileDatas.emplace_back(std::move(data));
+				continue;
+			}
+
+			// could not be read, might be locked or still being copied. Try again on next scan
+			if(!loadFile(data, file))
+				continue;
+
+			if(data.type == Invalid)
+			{
+				addInvalidToIndex(file);
+				continue;
+			}
+
+			if(data.type == MidiPresets)
+				addToIndex(data, DeviceModel::Invalid);
+
 			fileDatas.emplace_back(std::move(data));
 		}
 
 		if(fileDatas.empty())
+		{
+			index.save();
 			return {};
+		}
 
 		std::vector<ROMFile> roms;
 		roms.reserve(fileDatas.size());
@@ -203,6 +341,9 @@ namespace virusLib
 			if(fd.type == MidiPresets)
 				continue;
 
+			// try to combine midi ROMs with presets
+			const FileData* p = fd.type == MidiRom && !presets.empty() ? presets.front() : nullptr;
+
 			DeviceModel model;
 
 			if(isTIFamily(_model))
@@ -210,53 +351,63 @@ namespace virusLib
 				// model is specified externally as firmware has every model inside
 				model = _model;
 			}
+			else if(!fd.data)
+			{
+				model = fd.indexedModel;
+
+				if(model == DeviceModel::Invalid)
+					continue;
+			}
 			else
 			{
-				model = detectModel(fd.data);
+				model = detectModel(*fd.data);
 
 				if(model == DeviceModel::Invalid)
 				{
 					// disable load if model is not detected, because we now have other synths that have roms of the same size
 //					assert(false && "retry model detection for debugging purposes below");
-					detectModel(fd.data);
+					detectModel(*fd.data);
+					addInvalidToIndex(fd.filename);
 					continue;
 //					model = _model;	// Must be based on DSP 56362 or hell breaks loose
 				}
 			}
 
-			if(fd.type == BinaryRom)
+			if(!fd.data)
 			{
-				// load as-is
-				auto& rom = roms.emplace_back(fd.data, fd.filename, model);
-				if(!rom.isValid())
-					roms.pop_back();
+				// validated when it was indexed, defer loading until the ROM is used
+				roms.emplace_back(createLoader(fd, p), fd.filename, model);
 			}
-			else if(fd.type == MidiRom)
+			else
 			{
-				// try to combine with presets
-				if(presets.empty())
-				{
-					// none available, use without presets
-					auto& rom = roms.emplace_back(fd.data, fd.filename, model);
-					if(!rom.isValid())
-						roms.pop_back();
-				}
-				else
+				auto data = p ? createLoader(fd, p)() : fd.data;
+
+				// presets could not be read, try again on next scan
+				if(!data)
+					continue;
+
+				const auto& rom = roms.emplace_back(std::move(data), fd.filename, model);
+
+				if(!rom.isValid())
 				{
-					// build data with presets included and create rom
-					auto& p = *presets.front();
-					auto data = fd.data;
-					data.insert(data.end(), p.data.begin(), p.data.end());
-
-					auto& rom = roms.emplace_back(data, fd.filename, model);
-					if(!rom.isValid())
-						roms.pop_back();
-					else if(presets.size() > 1)
-						presets.erase(presets.begin());	// do not use preset file more than once if we have multiple
+					roms.pop_back();
+
+					// the content has been parsed, it will not become valid later on. TI firmware is unpacked for the requested model only, it may be valid for another one
+					if(!isTIFamily(_model))
+						addInvalidToIndex(fd.filename);
+					continue;
 				}
+
+				// TI firmware contains all models, the model is not a property of the file
+				addToIndex(fd, isTIFamily(_model) ? DeviceModel::Invalid : model);
 			}
+
+			if(p && presets.size() > 1)
+				presets.erase(presets.begin());	// do not use preset file more than once if we have multiple
 		}
 
+		index.save();
+
 		return roms;
 	}
 }
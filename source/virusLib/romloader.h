@@ -20,10 +20,10 @@ namespace virusLib
 		struct FileData
 		{
 			std::string filename;
-			FileType type;
-			std::vector<uint8_t> data;
-
-			bool isValid() const { return type != Invalid && !data.empty(); }
+			FileType type = Invalid;
+			synthLib::RomData::Ptr data;	// null if classified by the ROM index, loaded on first use
+			size_t size = 0;				// size of the decoded data
+			DeviceModel indexedModel = DeviceModel::Invalid;
 		};
 
 		static std::vector<ROMFile> findROMs(DeviceModel _model = DeviceModel::ABC);
@@ -33,9 +33,16 @@ namespace virusLib
 		static ROMFile findROM(const std::string& _filename, DeviceModel _model = DeviceModel::ABC);
 
 	private:
-		static FileData loadFile(const std::string& _name);
+		// returns false if the file could not be read. If it was read but is not a ROM, the type is set to Invalid
+		static bool loadFile(FileData& _data, const std::string& _name);
+		static synthLib::RomData::Ptr getData(const FileData& _file);
+		static ROMFile::Loader createLoader(const FileData& _rom, const FileData* _presets);
+
+		static DeviceModel detectModel(const synthLib::RomData& _data);
 
-		static DeviceModel detectModel(const std::vector<uint8_t>& _data);
+		static void addToIndex(const FileData& _file, DeviceModel _model);
+		static void addInvalidToIndex(const std::string& _filename);
+		static bool readIndex(FileData& _file, const std::string& _info);
 
 		static std::vector<ROMFile> initializeRoms(const std::vector<std::string>& _files, DeviceModel _model);
 	};
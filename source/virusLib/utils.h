@@ -25,6 +25,12 @@ namespace virusLib
 			this->setg(p, p, p + base.size());
 		}
 
+		membuf(const uint8_t* base, const size_t size)
+		{
+			char* p(const_cast<char*>(reinterpret_cast<const char*>(base)));
+			this->setg(p, p, p + size);
+		}
+
 	protected:
 		pos_type seekpos(pos_type sp, std::ios_base::openmode which) override
 		{
@@ -51,5 +57,10 @@ namespace virusLib
 				: membuf(base), std::istream(static_cast<std::streambuf*>(this))
 		{
 		}
+
+		imemstream(const uint8_t* base, const size_t size)
+				: membuf(base, size), std::istream(static_cast<std::streambuf*>(this))
+		{
+		}
 	};
 }
@@ -20,7 +20,7 @@ namespace wLib
 
 	protected:
 		virtual dsp56k::EsxiClock* getDspEsxiClock() const = 0;
-		void process(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, size_t _size, const std::vector<synthLib::SMidiEvent>& _midiIn, std::vector<synthLib::SMidiEvent>& _midiOut) override;
+		void process(const synthLib::TAudioInputs& _inputs, const synthLib::TAudioOutputs& _outputs, size_t _size, std::vector<synthLib::SMidiEvent>& _midiIn, std::vector<synthLib::SMidiEvent>& _midiOut) override;
 
 		std::vector<uint8_t>				m_midiOutBuffer;
 		synthLib::MidiBufferParser			m_midiOutParser;
@@ -63,7 +63,7 @@ namespace xtJucePlugin
 				while(p->name.back() == ' ')
 					p->name.pop_back();
 
-				p->sysex = std::move(_sysex);
+				p->setSysex(std::move(_sysex));
 
 				p->tags.add(pluginLib::patchDB::TagType::CustomA, "MW1");
 				return p;
@@ -98,7 +98,7 @@ namespace xtJucePlugin
 
 		auto p = std::make_shared<pluginLib::patchDB::Patch>();
 
-		p->sysex = std::move(_sysex);
+		p->setSysex(std::move(_sysex));
 		p->name = m_controller.getSingleName(parameters);
 
 		p->tags.add(pluginLib::patchDB::TagType::CustomA, "MW2");
@@ -147,16 +147,16 @@ namespace xtJucePlugin
 			return true;
 		};
 
-		if (xt::State::getCommand(_patch->sysex) == xt::SysexCommand::SingleDump)
+		if (xt::State::getCommand(_patch->getSysex()) == xt::SysexCommand::SingleDump)
 		{
-			auto result = _patch->sysex;
+			auto result = _patch->getSysex();
 
 			if (applyModifications(result))
 				return result;
 
 			std::vector<xt::SysEx> dumps;
 
-			if (xt::State::splitCombinedPatch(dumps, _patch->sysex))
+			if (xt::State::splitCombinedPatch(dumps, _patch->getSysex()))
 			{
 				if (applyModifications(dumps[0]))
 				{
@@ -177,7 +177,7 @@ namespace xtJucePlugin
 			}
 		}
 
-		return _patch->sysex;
+		return _patch->getSysex();
 	}
 
 	uint32_t PatchManager::getCurrentPart() const
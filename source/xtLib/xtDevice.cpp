@@ -11,7 +11,7 @@ namespace xt
 {
 	Device::Device(const synthLib::DeviceCreateParams& _params)
 		: wLib::Device(_params)
-		, m_xt(_params.romData, _params.romName, (_params.customData & 1) != 0)
+		, m_xt(_params.getRomData(), _params.romName, (_params.customData & 1) != 0)
 		, m_wavePreview(m_xt), m_state(m_xt, m_wavePreview), m_sysexRemote(m_xt)
 	{
 		while(!m_xt.isBootCompleted())
@@ -69,7 +69,7 @@ namespace xt
 			for (auto& response : responses)
 			{
 				auto& r = _midiOut.emplace_back(synthLib::MidiEventSource::Device);
-				std::swap(response, r.sysex);
+				r.sysex = std::move(response);
 			}
 		}
 
@@ -110,7 +110,7 @@ namespace xt
 		for (auto& response : responses)
 		{
 			auto& r = _response.emplace_back(synthLib::MidiEventSource::Device);
-			std::swap(response, r.sysex);
+			r.sysex = std::move(response);
 		}
 
 		// do not forward to device if our cache was able to reply. It might have sent something to the device already on its own if a cache miss occured